@@ -697,6 +697,29 @@ std::string GetTempFilenameForAtomicWrite(const std::string &path)
 	return abs + ".xxx";
 }
 
+std::string CreateTempDir()
+{
+#ifdef _WIN32
+	TCHAR temp[MAX_PATH];
+	TCHAR name[MAX_PATH];
+	if (!GetTempPath(MAX_PATH, temp) || !GetTempFileName(temp, _T("dol"), 0, name))
+		return "";
+
+	// GetTempFileName reserves the name with an empty file
+	DeleteFile(name);
+	std::string dir = TStrToUTF8(name);
+	if (!CreateDir(dir))
+		return "";
+	return dir;
+#else
+	const char* base = getenv("TMPDIR");
+	std::string dir = std::string(base && *base ? base : "/tmp") + "/dolphin.XXXXXX";
+	if (!mkdtemp(&dir[0]))
+		return "";
+	return dir;
+#endif
+}
+
 #if defined(__APPLE__)
 std::string GetBundleDirectory()
 {
@@ -126,6 +126,10 @@ bool SetCurrentDir(const std::string &directory);
 // Get a filename that can hopefully be atomically renamed to the given path.
 std::string GetTempFilenameForAtomicWrite(const std::string &path);
 
+// Creates a new, empty directory in the system's temp directory and returns
+// its path, or an empty string on failure.
+std::string CreateTempDir();
+
 // Returns a pointer to a string with a Dolphin data dir in the user's home
 // directory. To be used in "multi-user" mode (that is, installed).
 const std::string& GetUserPath(const unsigned int DirIDX, const std::string &newPath="");
@@ -0,0 +1,38 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+
+#include "Common/Common.h"
+#include "Common/CommonTypes.h"
+
+namespace File
+{
+
+// Maps a whole file read-only into memory, so the OS only reads the parts
+// which are actually used and can drop them again when it runs low on RAM.
+class MappedFile : public NonCopyable
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool Open(const std::string& filename);
+	void Close();
+
+	bool IsOpen() const { return m_data != nullptr; }
+	const u8* GetData() const { return m_data; }
+	u64 GetSize() const { return m_size; }
+
+	// Whether [offset, offset + size) lies within the file.
+	bool Contains(u64 offset, u64 size) const { return offset <= m_size && size <= m_size - offset; }
+
+private:
+	const u8* m_data;
+	u64 m_size;
+};
+
+}  // namespace File
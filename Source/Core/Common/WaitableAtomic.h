@@ -0,0 +1,91 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// An atomic value which one thread advances while another one may wait for
+// it to reach some state, e.g. the progress of a single consumer through a
+// buffer which a single producer fills. Unlike a mutex and condition variable
+// pair, updating it is a plain atomic store unless the other side actually
+// went to sleep waiting for it.
+//
+// * Store(value): updates the value and wakes up the waiting thread, if any.
+// * Load(): returns the current value.
+// * Wait(pred): returns once pred() is true. Spins for a short while before
+//               it goes to sleep. pred may check other state as well, in
+//               which case Notify() has to be called after changing it.
+// * Notify(): wakes up the waiting thread so it checks its predicate again.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace Common {
+
+template <typename T>
+class WaitableAtomic final
+{
+public:
+	explicit WaitableAtomic(T initial_value = T()) : m_value(initial_value), m_waiting(false) {}
+
+	T Load() const
+	{
+		return m_value.load();
+	}
+
+	void Store(T value)
+	{
+		// Both this and the waiting flag use sequentially consistent
+		// accesses, so either the waiting thread sees the new value before
+		// it goes to sleep, or we see that it's waiting.
+		m_value.store(value);
+		if (m_waiting.load())
+			Notify();
+	}
+
+	void Notify()
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_condvar.notify_all();
+	}
+
+	template <typename Predicate>
+	void Wait(Predicate pred)
+	{
+		for (int i = 0; i < SPIN_COUNT; i++)
+		{
+			if (pred())
+				return;
+			std::this_thread::yield();
+		}
+
+		std::unique_lock<std::mutex> lk(m_mutex);
+		m_waiting.store(true);
+		m_condvar.wait(lk, pred);
+		m_waiting.store(false);
+	}
+
+	WaitableAtomic<T>& operator=(T value)
+	{
+		Store(value);
+		return *this;
+	}
+
+	operator T() const
+	{
+		return Load();
+	}
+
+private:
+	// The other side usually catches up within a few microseconds.
+	enum { SPIN_COUNT = 100 };
+
+	std::atomic<T> m_value;
+	std::atomic<bool> m_waiting;
+	std::condition_variable m_condvar;
+	std::mutex m_mutex;
+};
+
+}  // namespace Common
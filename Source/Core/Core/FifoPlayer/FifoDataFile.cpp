@@ -3,15 +3,32 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <string>
+#include <zlib.h>
 
 #include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
 
 #include "Core/FifoPlayer/FifoDataFile.h"
 #include "Core/FifoPlayer/FifoFileStruct.h"
 
 using namespace FifoFileStruct;
 
+static bool CompressData(const u8 *data, u32 size, std::vector<u8> &compressed)
+{
+	uLongf compressedSize = compressBound(size);
+	compressed.resize(compressedSize);
+
+	// Recording happens while the game runs, so this has to be quick.
+	if (compress2(compressed.data(), &compressedSize, data, size, Z_BEST_SPEED) != Z_OK)
+		return false;
+
+	compressed.resize(compressedSize);
+	return true;
+}
+
 FifoDataFile::FifoDataFile() :
 	m_Flags(0)
 {
@@ -19,13 +36,17 @@ FifoDataFile::FifoDataFile() :
 
 FifoDataFile::~FifoDataFile()
 {
-	for (auto& frame : m_Frames)
+	// Uncompressed FIFO data always points into the mapped file, and
+	// decompressed FIFO data is freed once nothing uses it anymore.
+	for (const StoredFrame &stored : m_StoredFrames)
 	{
-		for (auto& update : frame.memoryUpdates)
-			delete []update.data;
-
-		delete []frame.fifoData;
+		if (stored.ownsCompressedData)
+			delete []stored.compressedData;
 	}
+
+	// Memory update data is either in here or in the mapped file
+	for (auto& data : m_Data)
+		delete []data.second.first;
 }
 
 void FifoDataFile::SetIsWii(bool isWii)
@@ -40,7 +61,80 @@ bool FifoDataFile::GetIsWii() const
 
 void FifoDataFile::AddFrame(const FifoFrameInfo &frameInfo)
 {
-	m_Frames.push_back(frameInfo);
+	FifoFrameInfo frame = frameInfo;
+
+	// Games upload the same textures and vertex data over and over again
+	for (auto& update : frame.memoryUpdates)
+		update.data = StoreData(update.data, update.size);
+
+	StoredFrame stored;
+	std::vector<u8> compressed;
+	if (CompressData(frame.fifoData.get(), frame.fifoDataSize, compressed))
+	{
+		u8 *compressedData = new u8[compressed.size()];
+		memcpy(compressedData, compressed.data(), compressed.size());
+
+		stored.compressedData = compressedData;
+		stored.compressedSize = (u32)compressed.size();
+		stored.ownsCompressedData = true;
+	}
+	else
+	{
+		// zlib only fails when it runs out of memory, so drop the frame's data
+		ERROR_LOG(VIDEO, "Failed to compress the FIFO data of frame %u", GetFrameCount());
+
+		static const u8 emptyStream[] = { 0x78, 0x01, 0x03, 0x00, 0x00, 0x00, 0x00, 0x01 };
+		stored.compressedData = emptyStream;
+		stored.compressedSize = sizeof(emptyStream);
+		stored.ownsCompressedData = false;
+		frame.fifoDataSize = 0;
+	}
+
+	frame.fifoData.reset();
+
+	m_Frames.push_back(frame);
+	m_StoredFrames.push_back(stored);
+}
+
+FifoFrameInfo FifoDataFile::GetFrame(u32 frame)
+{
+	FifoFrameInfo &frameInfo = m_Frames[frame];
+	const StoredFrame &stored = m_StoredFrames[frame];
+
+	if (!stored.compressedData)
+		return frameInfo;
+
+	std::lock_guard<std::mutex> lk(m_CacheLock);
+
+	auto cached = std::find(m_CachedFrames.begin(), m_CachedFrames.end(), frame);
+	if (cached != m_CachedFrames.end())
+	{
+		m_CachedFrames.erase(cached);
+		m_CachedFrames.insert(m_CachedFrames.begin(), frame);
+		return frameInfo;
+	}
+
+	if (m_CachedFrames.size() >= MAX_CACHED_FRAMES)
+	{
+		// Whoever still uses its FIFO data keeps it alive
+		m_Frames[m_CachedFrames.back()].fifoData.reset();
+		m_CachedFrames.pop_back();
+	}
+
+	frameInfo.fifoData.reset(new u8[frameInfo.fifoDataSize], std::default_delete<u8[]>());
+
+	uLongf size = frameInfo.fifoDataSize;
+	if (uncompress(frameInfo.fifoData.get(), &size, stored.compressedData, stored.compressedSize) != Z_OK ||
+	    size != frameInfo.fifoDataSize)
+	{
+		// A frame of NOPs is the least harmful thing we can play back
+		ERROR_LOG(VIDEO, "Failed to decompress the FIFO data of frame %u", frame);
+		memset(frameInfo.fifoData.get(), 0, frameInfo.fifoDataSize);
+	}
+
+	m_CachedFrames.insert(m_CachedFrames.begin(), frame);
+
+	return frameInfo;
 }
 
 bool FifoDataFile::Save(const std::string& filename)
@@ -70,6 +164,7 @@ bool FifoDataFile::Save(const std::string& filename)
 
 	// Write header
 	FileHeader header;
+	memset(&header, 0, sizeof(header));
 	header.fileId = FILE_ID;
 	header.file_version = VERSION_NUMBER;
 	header.min_loader_version = MIN_LOADER_VERSION;
@@ -94,25 +189,45 @@ bool FifoDataFile::Save(const std::string& filename)
 	file.Seek(0, SEEK_SET);
 	file.WriteBytes(&header, sizeof(FileHeader));
 
+	DataOffsetMap dataOffsets;
+
 	// Write frames list
 	for (unsigned int i = 0; i < m_Frames.size(); ++i)
 	{
 		const FifoFrameInfo &srcFrame = m_Frames[i];
+		const StoredFrame &stored = m_StoredFrames[i];
 
-		// Write FIFO data
+		// Write FIFO data, compressing it if it was loaded from an old file
 		file.Seek(0, SEEK_END);
 		u64 dataOffset = file.Tell();
-		file.WriteBytes(srcFrame.fifoData, srcFrame.fifoDataSize);
 
-		u64 memoryUpdatesOffset = WriteMemoryUpdates(srcFrame.memoryUpdates, file);
+		u32 compressedSize;
+		if (stored.compressedData)
+		{
+			file.WriteBytes(stored.compressedData, stored.compressedSize);
+			compressedSize = stored.compressedSize;
+		}
+		else
+		{
+			std::vector<u8> compressed;
+			if (!CompressData(srcFrame.fifoData.get(), srcFrame.fifoDataSize, compressed))
+				return false;
+
+			file.WriteBytes(compressed.data(), compressed.size());
+			compressedSize = (u32)compressed.size();
+		}
+
+		u64 memoryUpdatesOffset = WriteMemoryUpdates(srcFrame.memoryUpdates, dataOffsets, file);
 
 		FileFrameInfo dstFrame;
+		memset(&dstFrame, 0, sizeof(dstFrame));
 		dstFrame.fifoDataSize = srcFrame.fifoDataSize;
 		dstFrame.fifoDataOffset = dataOffset;
 		dstFrame.fifoStart = srcFrame.fifoStart;
 		dstFrame.fifoEnd = srcFrame.fifoEnd;
 		dstFrame.memoryUpdatesOffset = memoryUpdatesOffset;
 		dstFrame.numMemoryUpdates = (u32)srcFrame.memoryUpdates.size();
+		dstFrame.compressedSize = compressedSize;
 
 		// Write frame info
 		u64 frameOffset = frameListOffset + (i * sizeof(FileFrameInfo));
@@ -128,22 +243,24 @@ bool FifoDataFile::Save(const std::string& filename)
 
 FifoDataFile *FifoDataFile::Load(const std::string &filename, bool flagsOnly)
 {
-	File::IOFile file;
-	file.Open(filename, "rb");
-	if (!file)
+	FifoDataFile* dataFile = new FifoDataFile;
+	File::MappedFile &file = dataFile->m_MappedFile;
+
+	if (!file.Open(filename) || !file.Contains(0, sizeof(FileHeader)))
+	{
+		delete dataFile;
 		return nullptr;
+	}
 
 	FileHeader header;
-	file.ReadBytes(&header, sizeof(header));
+	memcpy(&header, file.GetData(), sizeof(header));
 
 	if (header.fileId != FILE_ID || header.min_loader_version > VERSION_NUMBER)
 	{
-		file.Close();
+		delete dataFile;
 		return nullptr;
 	}
 
-	FifoDataFile* dataFile = new FifoDataFile;
-
 	dataFile->m_Flags = header.flags;
 
 	if (flagsOnly)
@@ -152,45 +269,58 @@ FifoDataFile *FifoDataFile::Load(const std::string &filename, bool flagsOnly)
 		return dataFile;
 	}
 
-	u32 size = std::min((u32)BP_MEM_SIZE, header.bpMemSize);
-	file.Seek(header.bpMemOffset, SEEK_SET);
-	file.ReadArray(dataFile->m_BPMem, size);
-
-	size = std::min((u32)CP_MEM_SIZE, header.cpMemSize);
-	file.Seek(header.cpMemOffset, SEEK_SET);
-	file.ReadArray(dataFile->m_CPMem, size);
-
-	size = std::min((u32)XF_MEM_SIZE, header.xfMemSize);
-	file.Seek(header.xfMemOffset, SEEK_SET);
-	file.ReadArray(dataFile->m_XFMem, size);
-
-	size = std::min((u32)XF_REGS_SIZE, header.xfRegsSize);
-	file.Seek(header.xfRegsOffset, SEEK_SET);
-	file.ReadArray(dataFile->m_XFRegs, size);
+	bool valid =
+		dataFile->ReadRegisters(header.bpMemOffset, header.bpMemSize, dataFile->m_BPMem, BP_MEM_SIZE) &&
+		dataFile->ReadRegisters(header.cpMemOffset, header.cpMemSize, dataFile->m_CPMem, CP_MEM_SIZE) &&
+		dataFile->ReadRegisters(header.xfMemOffset, header.xfMemSize, dataFile->m_XFMem, XF_MEM_SIZE) &&
+		dataFile->ReadRegisters(header.xfRegsOffset, header.xfRegsSize, dataFile->m_XFRegs, XF_REGS_SIZE) &&
+		file.Contains(header.frameListOffset, (u64)header.frameCount * sizeof(FileFrameInfo));
 
-	// Read frames
-	for (u32 i = 0; i < header.frameCount; ++i)
+	// Read frames. Their data stays in the mapped file until it's used.
+	for (u32 i = 0; valid && i < header.frameCount; ++i)
 	{
 		u64 frameOffset = header.frameListOffset + (i * sizeof(FileFrameInfo));
-		file.Seek(frameOffset, SEEK_SET);
 		FileFrameInfo srcFrame;
-		file.ReadBytes(&srcFrame, sizeof(FileFrameInfo));
+		memcpy(&srcFrame, file.GetData() + frameOffset, sizeof(FileFrameInfo));
 
 		FifoFrameInfo dstFrame;
-		dstFrame.fifoData = new u8[srcFrame.fifoDataSize];
 		dstFrame.fifoDataSize = srcFrame.fifoDataSize;
 		dstFrame.fifoStart = srcFrame.fifoStart;
 		dstFrame.fifoEnd = srcFrame.fifoEnd;
 
-		file.Seek(srcFrame.fifoDataOffset, SEEK_SET);
-		file.ReadBytes(dstFrame.fifoData, srcFrame.fifoDataSize);
+		StoredFrame stored;
+		stored.ownsCompressedData = false;
+
+		// Version 1 files don't compress the FIFO data
+		const u8 *fifoData = file.GetData() + srcFrame.fifoDataOffset;
+		if (header.file_version >= 2)
+		{
+			valid = file.Contains(srcFrame.fifoDataOffset, srcFrame.compressedSize);
+
+			stored.compressedData = fifoData;
+			stored.compressedSize = srcFrame.compressedSize;
+		}
+		else
+		{
+			valid = file.Contains(srcFrame.fifoDataOffset, srcFrame.fifoDataSize);
 
-		ReadMemoryUpdates(srcFrame.memoryUpdatesOffset, srcFrame.numMemoryUpdates, dstFrame.memoryUpdates, file);
+			// Owned by the mapped file
+			dstFrame.fifoData.reset(const_cast<u8*>(fifoData), [](u8*) {});
+			stored.compressedData = nullptr;
+			stored.compressedSize = 0;
+		}
 
-		dataFile->AddFrame(dstFrame);
+		valid = valid && dataFile->ReadMemoryUpdates(srcFrame.memoryUpdatesOffset, srcFrame.numMemoryUpdates, dstFrame.memoryUpdates);
+
+		dataFile->m_Frames.push_back(dstFrame);
+		dataFile->m_StoredFrames.push_back(stored);
 	}
 
-	file.Close();
+	if (!valid)
+	{
+		delete dataFile;
+		return nullptr;
+	}
 
 	return dataFile;
 }
@@ -214,7 +344,29 @@ bool FifoDataFile::GetFlag(u32 flag) const
 	return !!(m_Flags & flag);
 }
 
-u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates, File::IOFile &file)
+u8 *FifoDataFile::StoreData(u8 *data, u32 size)
+{
+	u64 hash = GetMurmurHash3(data, size, 0);
+
+	auto range = m_Data.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		u8 *storedData = it->second.first;
+		if (storedData == data)
+			return data;
+
+		if (it->second.second == size && memcmp(storedData, data, size) == 0)
+		{
+			delete []data;
+			return storedData;
+		}
+	}
+
+	m_Data.insert(std::make_pair(hash, std::make_pair(data, size)));
+	return data;
+}
+
+u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates, DataOffsetMap &dataOffsets, File::IOFile &file)
 {
 	// Add space for memory update list
 	u64 updateListOffset = file.Tell();
@@ -224,12 +376,25 @@ u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates
 	{
 		const MemoryUpdate &srcUpdate = memUpdates[i];
 
-		// Write memory
-		file.Seek(0, SEEK_END);
-		u64 dataOffset = file.Tell();
-		file.WriteBytes(srcUpdate.data, srcUpdate.size);
+		// Write memory, unless another update already wrote the same data
+		auto key = std::make_pair((const u8*)srcUpdate.data, srcUpdate.size);
+		auto written = dataOffsets.find(key);
+
+		u64 dataOffset;
+		if (written != dataOffsets.end())
+		{
+			dataOffset = written->second;
+		}
+		else
+		{
+			file.Seek(0, SEEK_END);
+			dataOffset = file.Tell();
+			file.WriteBytes(srcUpdate.data, srcUpdate.size);
+			dataOffsets[key] = dataOffset;
+		}
 
 		FileMemoryUpdate dstUpdate;
+		memset(&dstUpdate, 0, sizeof(dstUpdate));
 		dstUpdate.address = srcUpdate.address;
 		dstUpdate.dataOffset = dataOffset;
 		dstUpdate.dataSize = srcUpdate.size;
@@ -244,25 +409,40 @@ u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates
 	return updateListOffset;
 }
 
-void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates, std::vector<MemoryUpdate> &memUpdates, File::IOFile &file)
+bool FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates, std::vector<MemoryUpdate> &memUpdates)
 {
+	if (!m_MappedFile.Contains(fileOffset, (u64)numUpdates * sizeof(FileMemoryUpdate)))
+		return false;
+
 	memUpdates.resize(numUpdates);
 
 	for (u32 i = 0; i < numUpdates; ++i)
 	{
 		u64 updateOffset = fileOffset + (i * sizeof(FileMemoryUpdate));
-		file.Seek(updateOffset, SEEK_SET);
 		FileMemoryUpdate srcUpdate;
-		file.ReadBytes(&srcUpdate, sizeof(FileMemoryUpdate));
+		memcpy(&srcUpdate, m_MappedFile.GetData() + updateOffset, sizeof(FileMemoryUpdate));
+
+		if (!m_MappedFile.Contains(srcUpdate.dataOffset, srcUpdate.dataSize))
+			return false;
 
+		// The data is only ever read, straight from the mapped file
 		MemoryUpdate &dstUpdate = memUpdates[i];
 		dstUpdate.address = srcUpdate.address;
 		dstUpdate.fifoPosition = srcUpdate.fifoPosition;
 		dstUpdate.size = srcUpdate.dataSize;
-		dstUpdate.data = new u8[srcUpdate.dataSize];
+		dstUpdate.data = const_cast<u8*>(m_MappedFile.GetData() + srcUpdate.dataOffset);
 		dstUpdate.type = (MemoryUpdate::Type)srcUpdate.type;
-
-		file.Seek(srcUpdate.dataOffset, SEEK_SET);
-		file.ReadBytes(dstUpdate.data, srcUpdate.dataSize);
 	}
+
+	return true;
+}
+
+bool FifoDataFile::ReadRegisters(u64 fileOffset, u32 count, u32 *registers, u32 maxCount)
+{
+	u32 size = std::min(maxCount, count);
+	if (!m_MappedFile.Contains(fileOffset, size * sizeof(u32)))
+		return false;
+
+	memcpy(registers, m_MappedFile.GetData() + fileOffset, size * sizeof(u32));
+	return true;
 }
@@ -4,10 +4,14 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/MappedFile.h"
 
 namespace File
 {
@@ -33,7 +37,9 @@ struct MemoryUpdate
 
 struct FifoFrameInfo
 {
-	u8 *fifoData;
+	// Shared, so the FIFO data of a frame stays valid while it's used, even
+	// if the file drops the frame from its cache of decompressed frames.
+	std::shared_ptr<u8> fifoData;
 	u32 fifoDataSize;
 
 	u32 fifoStart;
@@ -65,27 +71,62 @@ public:
 	u32 *GetXFMem() { return m_XFMem; }
 	u32 *GetXFRegs() { return m_XFRegs; }
 
+	// Takes ownership of the memory update data of the frame. The FIFO data is
+	// compressed right away and identical memory update data is only kept once.
 	void AddFrame(const FifoFrameInfo &frameInfo);
-	const FifoFrameInfo &GetFrame(u32 frame) const { return m_Frames[frame]; }
-	u32 GetFrameCount() { return static_cast<u32>(m_Frames.size()); }
+
+	// Compressed FIFO data is only decompressed while it's used, the file keeps
+	// the FIFO data of the last MAX_CACHED_FRAMES frames which were requested.
+	// The returned copy holds on to its FIFO data for as long as it's around.
+	FifoFrameInfo GetFrame(u32 frame);
+	u32 GetFrameCount() const { return static_cast<u32>(m_Frames.size()); }
+
+	// These don't need the FIFO data of the frame.
+	u32 GetFifoDataSize(u32 frame) const { return m_Frames[frame].fifoDataSize; }
+	const std::vector<MemoryUpdate> &GetMemoryUpdates(u32 frame) const { return m_Frames[frame].memoryUpdates; }
 
 	bool Save(const std::string& filename);
 
+	// Maps the file into memory instead of reading it, so frames and memory
+	// updates are only read once they're used.
 	static FifoDataFile *Load(const std::string &filename, bool flagsOnly);
 
+	enum
+	{
+		MAX_CACHED_FRAMES = 4
+	};
+
 private:
 	enum
 	{
 		FLAG_IS_WII = 1
 	};
 
+	// Where the FIFO data of a frame is kept while nothing uses it.
+	struct StoredFrame
+	{
+		// Compressed FIFO data, either in the mapped file or owned by us.
+		// Null if the FIFO data isn't compressed and fifoData is always set.
+		const u8 *compressedData;
+		u32 compressedSize;
+		bool ownsCompressedData;
+	};
+
+	// Memory update data added by AddFrame, by its hash.
+	typedef std::multimap<u64, std::pair<u8*, u32>> DataMap;
+	// File offsets of the memory update data which was already written.
+	typedef std::map<std::pair<const u8*, u32>, u64> DataOffsetMap;
+
 	void PadFile(size_t numBytes, File::IOFile &file);
 
 	void SetFlag(u32 flag, bool set);
 	bool GetFlag(u32 flag) const;
 
-	u64 WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates, File::IOFile &file);
-	static void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates, std::vector<MemoryUpdate> &memUpdates, File::IOFile &file);
+	u8 *StoreData(u8 *data, u32 size);
+
+	u64 WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates, DataOffsetMap &dataOffsets, File::IOFile &file);
+	bool ReadMemoryUpdates(u64 fileOffset, u32 numUpdates, std::vector<MemoryUpdate> &memUpdates);
+	bool ReadRegisters(u64 fileOffset, u32 count, u32 *registers, u32 maxCount);
 
 	u32 m_BPMem[BP_MEM_SIZE];
 	u32 m_CPMem[CP_MEM_SIZE];
@@ -95,4 +136,13 @@ private:
 	u32 m_Flags;
 
 	std::vector<FifoFrameInfo> m_Frames;
+	std::vector<StoredFrame> m_StoredFrames;
+
+	// Frames with decompressed FIFO data, the most recently used one first.
+	std::vector<u32> m_CachedFrames;
+	std::mutex m_CacheLock;
+
+	DataMap m_Data;
+
+	File::MappedFile m_MappedFile;
 };
@@ -9,11 +9,13 @@
 namespace FifoFileStruct
 {
 
+// Version 2: the FIFO data of every frame is compressed with zlib on its own,
+//            and memory updates with identical data share a single copy of it.
 enum
 {
 	FILE_ID            = 0x0d01f1f0,
-	VERSION_NUMBER     = 1,
-	MIN_LOADER_VERSION = 1,
+	VERSION_NUMBER     = 2,
+	MIN_LOADER_VERSION = 2,
 };
 
 #pragma pack(push, 4)
@@ -50,6 +52,9 @@ union FileFrameInfo
 		u32 fifoEnd;
 		u64 memoryUpdatesOffset;
 		u32 numMemoryUpdates;
+		// Version 2: size of the zlib stream at fifoDataOffset, which
+		// decompresses to fifoDataSize bytes.
+		u32 compressedSize;
 	};
 	u32 rawData[16];
 };
@@ -50,7 +50,8 @@ void FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile *file, std::vector<Analyze
 
 	for (u32 frameIdx = 0; frameIdx < file->GetFrameCount(); ++frameIdx)
 	{
-		const FifoFrameInfo& frame = file->GetFrame(frameIdx);
+		const FifoFrameInfo frame = file->GetFrame(frameIdx);
+		u8* fifoData = frame.fifoData.get();
 		AnalyzedFrameInfo& analyzed = frameInfo[frameIdx];
 
 		m_DrawingObject = false;
@@ -74,12 +75,12 @@ void FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile *file, std::vector<Analyze
 
 			bool wasDrawing = m_DrawingObject;
 
-			u32 cmdSize = DecodeCommand(&frame.fifoData[cmdStart]);
+			u32 cmdSize = DecodeCommand(&fifoData[cmdStart]);
 
 #if LOG_FIFO_CMDS
 			CmdData cmdData;
 			cmdData.offset = cmdStart;
-			cmdData.ptr = &frame.fifoData[cmdStart];
+			cmdData.ptr = &fifoData[cmdStart];
 			cmdData.size = cmdSize;
 			prevCmds.push_back(cmdData);
 #endif
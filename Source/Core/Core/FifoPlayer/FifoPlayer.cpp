@@ -226,7 +226,7 @@ void FifoPlayer::WriteFrame(const FifoFrameInfo &frame, const AnalyzedFrameInfo
 
 void FifoPlayer::WriteFramePart(u32 dataStart, u32 dataEnd, u32 &nextMemUpdate, const FifoFrameInfo &frame, const AnalyzedFrameInfo &info)
 {
-	u8 *data = frame.fifoData;
+	u8 *data = frame.fifoData.get();
 
 	while (nextMemUpdate < frame.memoryUpdates.size() && dataStart < dataEnd)
 	{
@@ -261,8 +261,7 @@ void FifoPlayer::WriteAllMemoryUpdates()
 
 	for (u32 frameNum = 0; frameNum < m_File->GetFrameCount(); ++frameNum)
 	{
-		const FifoFrameInfo &frame = m_File->GetFrame(frameNum);
-		for (auto& update : frame.memoryUpdates)
+		for (auto& update : m_File->GetMemoryUpdates(frameNum))
 		{
 			WriteMemory(update);
 		}
@@ -311,7 +310,7 @@ void FifoPlayer::SetupFifo()
 	WriteCP(0x02, 0); // disable read, BP, interrupts
 	WriteCP(0x04, 7); // clear overflow, underflow, metrics
 
-	const FifoFrameInfo& frame = m_File->GetFrame(m_CurrentFrame);
+	const FifoFrameInfo frame = m_File->GetFrame(m_CurrentFrame);
 
 	// Set fifo bounds
 	WriteCP(0x20, frame.fifoStart);
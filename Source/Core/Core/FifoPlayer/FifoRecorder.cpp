@@ -79,13 +79,13 @@ void FifoRecorder::WriteGPCommand(u8 *data, u32 size)
 	{
 		size_t dataSize = m_FifoData.size();
 		m_CurrentFrame.fifoDataSize = (u32)dataSize;
-		m_CurrentFrame.fifoData = new u8[dataSize];
-		memcpy(m_CurrentFrame.fifoData, m_FifoData.data(), dataSize);
+		m_CurrentFrame.fifoData.reset(new u8[dataSize], std::default_delete<u8[]>());
+		memcpy(m_CurrentFrame.fifoData.get(), m_FifoData.data(), dataSize);
 
 		sMutex.lock();
 
 		// Copy frame to file
-		// The file will be responsible for freeing the memory allocated for each frame's fifoData
+		// The file will be responsible for freeing the memory allocated for each frame's memory updates
 		m_File->AddFrame(m_CurrentFrame);
 
 		if (m_FinishedCb && m_RequestedRecordingEnd)
@@ -93,6 +93,7 @@ void FifoRecorder::WriteGPCommand(u8 *data, u32 size)
 
 		sMutex.unlock();
 
+		m_CurrentFrame.fifoData.reset();
 		m_CurrentFrame.memoryUpdates.clear();
 		m_FifoData.clear();
 		m_FrameEnded = false;
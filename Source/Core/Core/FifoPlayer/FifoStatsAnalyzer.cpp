@@ -0,0 +1,321 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+
+#include "Core/FifoPlayer/FifoAnalyzer.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+#include "Core/FifoPlayer/FifoStatsAnalyzer.h"
+
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/TextureDecoder.h"
+
+using namespace FifoAnalyzer;
+
+bool FifoStatsAnalyzer::TextureKey::operator<(const TextureKey &other) const
+{
+	if (address != other.address)
+		return address < other.address;
+	if (width != other.width)
+		return width < other.width;
+	if (height != other.height)
+		return height < other.height;
+	return format < other.format;
+}
+
+FifoWriteStats::FifoWriteStats() :
+	writes(0),
+	redundantWrites(0)
+{
+}
+
+FifoFrameStats::FifoFrameStats() :
+	fifoBytes(0),
+	memoryUpdateBytes(0),
+	efbCopiesToTexture(0),
+	efbCopiesToXfb(0),
+	efbClears(0),
+	xfIndexedLoads(0),
+	complete(true)
+{
+	memset(draws, 0, sizeof(draws));
+	memset(vertices, 0, sizeof(vertices));
+}
+
+FifoStatsAnalyzer::FifoStatsAnalyzer()
+{
+	FifoAnalyzer::Init();
+}
+
+void FifoStatsAnalyzer::AnalyzeFrames(FifoDataFile *file, std::vector<FifoFrameStats> &frameStats)
+{
+	memcpy(&m_BpMem, file->GetBPMem(), sizeof(BPMemory));
+	memcpy(m_CpRegs, file->GetCPMem(), sizeof(m_CpRegs));
+	memcpy(m_XfMem, file->GetXFMem(), sizeof(m_XfMem));
+	memcpy(m_XfRegs, file->GetXFRegs(), sizeof(m_XfRegs));
+
+	memset(&m_CpMem, 0, sizeof(m_CpMem));
+	FifoAnalyzer::LoadCPReg(0x50, m_CpRegs[0x50], m_CpMem);
+	FifoAnalyzer::LoadCPReg(0x60, m_CpRegs[0x60], m_CpMem);
+
+	for (int i = 0; i < 8; ++i)
+	{
+		FifoAnalyzer::LoadCPReg(0x70 + i, m_CpRegs[0x70 + i], m_CpMem);
+		FifoAnalyzer::LoadCPReg(0x80 + i, m_CpRegs[0x80 + i], m_CpMem);
+		FifoAnalyzer::LoadCPReg(0x90 + i, m_CpRegs[0x90 + i], m_CpMem);
+	}
+
+	frameStats.clear();
+	frameStats.resize(file->GetFrameCount());
+
+	for (u32 frameIdx = 0; frameIdx < file->GetFrameCount(); ++frameIdx)
+	{
+		const FifoFrameInfo frame = file->GetFrame(frameIdx);
+		u8* fifoData = frame.fifoData.get();
+		FifoFrameStats& stats = frameStats[frameIdx];
+
+		stats.fifoBytes = frame.fifoDataSize;
+
+		for (const MemoryUpdate& update : frame.memoryUpdates)
+			stats.memoryUpdateBytes += update.size;
+
+		m_FrameTextures.clear();
+
+		u32 cmdStart = 0;
+		while (cmdStart < frame.fifoDataSize)
+		{
+			u32 cmdSize = DecodeCommand(&fifoData[cmdStart], stats);
+			if (cmdSize == 0)
+			{
+				ERROR_LOG(VIDEO, "Unknown opcode 0x%x in frame %u, skipping the rest of it", fifoData[cmdStart], frameIdx);
+				stats.complete = false;
+				break;
+			}
+
+			cmdStart += cmdSize;
+		}
+	}
+}
+
+u32 FifoStatsAnalyzer::DecodeCommand(u8 *data, FifoFrameStats &stats)
+{
+	u8 *dataStart = data;
+
+	int cmd = ReadFifo8(data);
+
+	switch (cmd)
+	{
+	case GX_NOP:
+	case 0x44:
+	case GX_CMD_INVL_VC:
+		break;
+
+	case GX_LOAD_CP_REG:
+		{
+			u32 cmd2 = ReadFifo8(data);
+			u32 value = ReadFifo32(data);
+
+			stats.cp.writes++;
+			if (m_CpRegs[cmd2] == value)
+				stats.cp.redundantWrites++;
+
+			m_CpRegs[cmd2] = value;
+			FifoAnalyzer::LoadCPReg(cmd2, value, m_CpMem);
+		}
+		break;
+
+	case GX_LOAD_XF_REG:
+		{
+			u32 cmd2 = ReadFifo32(data);
+			u32 streamSize = ((cmd2 >> 16) & 15) + 1;
+
+			LoadXF(cmd2 & 0xFFFF, streamSize, data, stats);
+			data += streamSize * 4;
+		}
+		break;
+
+	case GX_LOAD_INDX_A:
+	case GX_LOAD_INDX_B:
+	case GX_LOAD_INDX_C:
+	case GX_LOAD_INDX_D:
+		stats.xfIndexedLoads++;
+		data += 4;
+		break;
+
+	case GX_CMD_CALL_DL:
+		// The recorder expands display lists into the FIFO stream
+		data += 8;
+		break;
+
+	case GX_LOAD_BP_REG:
+		LoadBP(ReadFifo32(data), stats);
+		break;
+
+	default:
+		if (cmd & 0x80)
+		{
+			u16 streamSize = ReadFifo16(data);
+			AddDraw(cmd, streamSize, stats);
+
+			data += streamSize * FifoAnalyzer::CalculateVertexSize(cmd & GX_VAT_MASK, m_CpMem);
+		}
+		else
+		{
+			return 0;
+		}
+		break;
+	}
+
+	return (u32)(data - dataStart);
+}
+
+bool FifoStatsAnalyzer::IsBPCommand(u32 address)
+{
+	// Writing these does something even if the value doesn't change
+	switch (address)
+	{
+	case BPMEM_SETDRAWDONE:
+	case BPMEM_PE_TOKEN_ID:
+	case BPMEM_PE_TOKEN_INT_ID:
+	case BPMEM_TRIGGER_EFB_COPY:
+	case BPMEM_CLEARBBOX1:
+	case BPMEM_CLEARBBOX2:
+	case BPMEM_CLEAR_PIXEL_PERF:
+	case BPMEM_PRELOAD_MODE:
+	case BPMEM_LOADTLUT1:
+	case BPMEM_TEXINVALIDATE:
+	case BPMEM_BP_MASK:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void FifoStatsAnalyzer::LoadBP(u32 value, FifoFrameStats &stats)
+{
+	BPCmd bp = FifoAnalyzer::DecodeBPCmd(value, m_BpMem);
+
+	stats.bp.writes++;
+	if (bp.changes == 0 && !IsBPCommand(bp.address))
+		stats.bp.redundantWrites++;
+
+	FifoAnalyzer::LoadBPReg(bp, m_BpMem);
+
+	if (bp.address == BPMEM_TRIGGER_EFB_COPY)
+	{
+		UPE_Copy peCopy = m_BpMem.triggerEFBCopy;
+		if (peCopy.copy_to_xfb)
+			stats.efbCopiesToXfb++;
+		else
+			stats.efbCopiesToTexture++;
+
+		if (peCopy.clear)
+			stats.efbClears++;
+	}
+}
+
+void FifoStatsAnalyzer::LoadXF(u32 address, u32 count, u8 *data, FifoFrameStats &stats)
+{
+	for (u32 i = 0; i < count; ++i, ++address)
+	{
+		u32 value = ReadFifo32(data);
+
+		// The registers start right after the memory, at 0x1000
+		u32 *reg = nullptr;
+		if (address < FifoDataFile::XF_MEM_SIZE)
+			reg = &m_XfMem[address];
+		else if (address - FifoDataFile::XF_MEM_SIZE < FifoDataFile::XF_REGS_SIZE)
+			reg = &m_XfRegs[address - FifoDataFile::XF_MEM_SIZE];
+
+		stats.xf.writes++;
+		if (reg)
+		{
+			if (*reg == value)
+				stats.xf.redundantWrites++;
+			*reg = value;
+		}
+	}
+}
+
+void FifoStatsAnalyzer::AddDraw(u8 cmd, u16 numVertices, FifoFrameStats &stats)
+{
+	const u32 primitive = (cmd & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT;
+	stats.draws[primitive]++;
+	stats.vertices[primitive] += numVertices;
+
+	const u32 vatIndex = cmd & GX_VAT_MASK;
+	const VAT &vat = m_CpMem.vtxAttr[vatIndex];
+	VertexLoaderUID uid(m_CpMem.vtxDesc, vat);
+
+	auto format = stats.vertexFormats.find(uid);
+	if (format == stats.vertexFormats.end())
+	{
+		FifoVertexFormatStats formatStats;
+		formatStats.vtxDesc = m_CpMem.vtxDesc.Hex;
+		formatStats.vat[0] = vat.g0.Hex;
+		formatStats.vat[1] = vat.g1.Hex;
+		formatStats.vat[2] = vat.g2.Hex;
+		formatStats.vertexSize = FifoAnalyzer::CalculateVertexSize(vatIndex, m_CpMem);
+		formatStats.draws = 0;
+		formatStats.vertices = 0;
+		format = stats.vertexFormats.insert(std::make_pair(uid, formatStats)).first;
+	}
+
+	format->second.draws++;
+	format->second.vertices += numVertices;
+
+	// Same as VertexManager::Flush
+	u32 usedTextures = 0;
+	for (u32 i = 0; i < m_BpMem.genMode.numtevstages + 1u; ++i)
+		if (m_BpMem.tevorders[i / 2].getEnable(i & 1))
+			usedTextures |= 1 << m_BpMem.tevorders[i / 2].getTexMap(i & 1);
+
+	if (m_BpMem.genMode.numindstages > 0)
+		for (u32 i = 0; i < m_BpMem.genMode.numtevstages + 1u; ++i)
+			if (m_BpMem.tevind[i].IsActive() && m_BpMem.tevind[i].bt < m_BpMem.genMode.numindstages)
+				usedTextures |= 1 << m_BpMem.tevindref.getTexMap(m_BpMem.tevind[i].bt);
+
+	for (u32 i = 0; i < 8; ++i)
+		if (usedTextures & (1 << i))
+			AddTexture(i, stats);
+}
+
+void FifoStatsAnalyzer::AddTexture(u32 texMap, FifoFrameStats &stats)
+{
+	const FourTexUnits &tex = m_BpMem.tex[texMap >> 2];
+	const u32 id = texMap & 3;
+
+	TextureKey key;
+	key.address = tex.texImage3[id].image_base << 5;
+	key.width = tex.texImage0[id].width + 1;
+	key.height = tex.texImage0[id].height + 1;
+	key.format = tex.texImage0[id].format;
+
+	if (!m_FrameTextures.insert(key).second)
+		return;
+
+	// Same as TextureCache::Load
+	const bool useMipmaps = (tex.texMode0[id].min_filter & 3) != 0;
+	const u32 levels = useMipmaps ? (tex.texMode1[id].max_lod + 0xf) / 0x10 + 1 : 1;
+	const u32 blockWidth = TexDecoder_GetBlockWidthInTexels(key.format) - 1;
+	const u32 blockHeight = TexDecoder_GetBlockHeightInTexels(key.format) - 1;
+
+	u64 bytes = 0;
+	for (u32 level = 0; level < levels; ++level)
+	{
+		const u32 width = std::max(key.width >> level, 1u);
+		const u32 height = std::max(key.height >> level, 1u);
+		const u32 expandedWidth = (width + blockWidth) & ~blockWidth;
+		const u32 expandedHeight = (height + blockHeight) & ~blockHeight;
+		bytes += TexDecoder_GetTextureSizeInBytes(expandedWidth, expandedHeight, key.format);
+	}
+
+	FifoTextureFormatStats &formatStats = stats.textureFormats[key.format];
+	formatStats.textures++;
+	formatStats.bytes += bytes;
+}
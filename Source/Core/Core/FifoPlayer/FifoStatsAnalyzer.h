@@ -0,0 +1,111 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "Core/FifoPlayer/FifoAnalyzer.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+
+#include "VideoCommon/VertexLoader.h"
+
+struct FifoWriteStats
+{
+	FifoWriteStats();
+
+	u32 writes;
+	// Writes which didn't change the value of the register
+	u32 redundantWrites;
+};
+
+struct FifoVertexFormatStats
+{
+	// Registers of the first draw which used the format
+	u64 vtxDesc;
+	u32 vat[3];
+	u32 vertexSize;
+
+	u32 draws;
+	u32 vertices;
+};
+
+struct FifoTextureFormatStats
+{
+	// Distinct textures, by address, size and format
+	u32 textures;
+	// Size of all of their mipmap levels in RAM, which is what a cold
+	// texture cache has to decode
+	u64 bytes;
+};
+
+// Everything the GPU has to do for a frame, without actually doing it.
+struct FifoFrameStats
+{
+	FifoFrameStats();
+
+	u32 fifoBytes;
+	u32 memoryUpdateBytes;
+
+	// By primitive type, GX_DRAW_QUADS to GX_DRAW_POINTS
+	u32 draws[8];
+	u32 vertices[8];
+
+	std::map<VertexLoaderUID, FifoVertexFormatStats> vertexFormats;
+	// By GX_TF_* format
+	std::map<u32, FifoTextureFormatStats> textureFormats;
+
+	u32 efbCopiesToTexture;
+	u32 efbCopiesToXfb;
+	// EFB copies which also clear the EFB
+	u32 efbClears;
+
+	FifoWriteStats bp;
+	FifoWriteStats cp;
+	FifoWriteStats xf;
+	// XF loads from RAM, which can't be checked for redundancy
+	u32 xfIndexedLoads;
+
+	// False if the frame contained an unknown command, which ends the analysis
+	// of the frame.
+	bool complete;
+};
+
+class FifoStatsAnalyzer
+{
+public:
+	FifoStatsAnalyzer();
+
+	void AnalyzeFrames(FifoDataFile *file, std::vector<FifoFrameStats> &frameStats);
+
+private:
+	struct TextureKey
+	{
+		u32 address;
+		u32 width;
+		u32 height;
+		u32 format;
+
+		bool operator<(const TextureKey &other) const;
+	};
+
+	u32 DecodeCommand(u8 *data, FifoFrameStats &stats);
+	void LoadBP(u32 value, FifoFrameStats &stats);
+	void LoadXF(u32 address, u32 count, u8 *data, FifoFrameStats &stats);
+	void AddDraw(u8 cmd, u16 numVertices, FifoFrameStats &stats);
+	void AddTexture(u32 texMap, FifoFrameStats &stats);
+
+	static bool IsBPCommand(u32 address);
+
+	BPMemory m_BpMem;
+	FifoAnalyzer::CPMemory m_CpMem;
+	u32 m_CpRegs[FifoDataFile::CP_MEM_SIZE];
+	u32 m_XfMem[FifoDataFile::XF_MEM_SIZE];
+	u32 m_XfRegs[FifoDataFile::XF_REGS_SIZE];
+
+	// Textures which were already used in the current frame
+	std::set<TextureKey> m_FrameTextures;
+};
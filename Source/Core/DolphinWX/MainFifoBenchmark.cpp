@@ -0,0 +1,672 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Replays FIFO logs without any user interface and writes the time every
+// frame took, along with the statistics of the video backend, as JSON.
+//
+// The CPU and GPU run on the same thread unless --dual-core is given, so the
+// time of a frame includes all of the GPU work for it.
+//
+// With --analyze, the logs aren't replayed at all. Instead, the GPU commands
+// of every frame are decoded and counted, which shows what a game makes the
+// GPU do without depending on the speed of any backend.
+//
+// With --triangles, the results also include the triangles every frame draws
+// and how many of them were drawn per second, which measures the rasterizer
+// throughput of the software renderer on real games.
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <getopt.h>
+#include <string>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/StringUtil.h"
+#include "Common/Timer.h"
+
+#include "Core/BootManager.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreParameter.h"
+#include "Core/Host.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+#include "Core/FifoPlayer/FifoPlaybackAnalyzer.h"
+#include "Core/FifoPlayer/FifoPlayer.h"
+#include "Core/FifoPlayer/FifoStatsAnalyzer.h"
+#include "Core/PowerPC/PowerPC.h"
+
+#include "UICommon/UICommon.h"
+
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/VideoBackendBase.h"
+
+#if HAVE_X11
+#include <X11/Xlib.h>
+#endif
+
+// Statistics of the video backend at the end of a frame. The counters are
+// totals, so the differences between frames show what each frame added.
+struct FrameResult
+{
+	u32 frame;
+	u64 us;
+	u32 objects;
+	u32 drawCalls;
+	int texturesCreated;
+	int texturesAlive;
+	int pixelShadersCreated;
+	int pixelShadersAlive;
+	int vertexShadersCreated;
+	int vertexShadersAlive;
+};
+
+struct RunResult
+{
+	u64 totalUs;
+	std::vector<FrameResult> frames;
+};
+
+struct FileResult
+{
+	std::string filename;
+	u32 frameCount;
+	u32 objectCount;
+	// Only counted with --triangles
+	std::vector<u32> frameTriangles;
+	std::vector<RunResult> runs;
+};
+
+static Common::Event updateMainFrameEvent;
+static Common::Event playbackDoneEvent;
+
+// Only touched by the CPU thread while a log is replayed.
+static RunResult* s_run;
+static bool s_frame_started;
+static u32 s_frame;
+static u64 s_frame_start_time;
+static int s_frame_start_draw_calls;
+
+void Host_NotifyMapLoaded() {}
+void Host_RefreshDSPDebuggerWindow() {}
+void Host_UpdateTitle(const std::string& title) {}
+void Host_UpdateDisasmDialog() {}
+void Host_RequestRenderWindowSize(int width, int height) {}
+void Host_RequestFullscreen(bool enable_fullscreen) {}
+void Host_ConnectWiimote(int wm_idx, bool connect) {}
+void Host_SetWiiMoteConnectionState(int _State) {}
+void Host_ShowVideoConfig(void*, const std::string&, const std::string&) {}
+
+static void* s_window_handle;
+void* Host_GetRenderHandle()
+{
+	return s_window_handle;
+}
+
+void Host_UpdateMainFrame()
+{
+	updateMainFrameEvent.Set();
+}
+
+void Host_SetStartupDebuggingParameters()
+{
+	SCoreStartupParameter& StartUp = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	StartUp.bEnableDebugging = false;
+	StartUp.bBootToPause = false;
+}
+
+bool Host_UIHasFocus()
+{
+	return false;
+}
+
+bool Host_RendererHasFocus()
+{
+	return false;
+}
+
+// The per frame counter starts over when the backend swaps, which usually
+// happens in the middle of a replayed frame.
+static int GetTotalDrawCalls()
+{
+	return stats.numDrawCallsInPastFrames + stats.thisFrame.numDrawCalls;
+}
+
+static void EndFrame()
+{
+	if (!s_frame_started)
+		return;
+
+	FrameResult result;
+	result.frame = s_frame;
+	result.us = Common::Timer::GetTimeUs() - s_frame_start_time;
+	result.objects = (u32)FifoPlayer::GetInstance().GetAnalyzedFrameInfo(s_frame).objectStarts.size();
+	result.drawCalls = (u32)(GetTotalDrawCalls() - s_frame_start_draw_calls);
+	result.texturesCreated = stats.numTexturesCreated;
+	result.texturesAlive = stats.numTexturesAlive;
+	result.pixelShadersCreated = stats.numPixelShadersCreated;
+	result.pixelShadersAlive = stats.numPixelShadersAlive;
+	result.vertexShadersCreated = stats.numVertexShadersCreated;
+	result.vertexShadersAlive = stats.numVertexShadersAlive;
+
+	s_run->totalUs += result.us;
+	s_run->frames.push_back(result);
+	s_frame_started = false;
+}
+
+// Called by the FIFO player right before it writes the next frame.
+static void FrameWritten()
+{
+	EndFrame();
+
+	s_frame = FifoPlayer::GetInstance().GetCurrentFrameNum();
+	s_frame_start_time = Common::Timer::GetTimeUs();
+	s_frame_start_draw_calls = GetTotalDrawCalls();
+	s_frame_started = true;
+}
+
+void Host_Message(int Id)
+{
+	// Sent by the FIFO player once the last frame was written.
+	if (Id == WM_USER_STOP)
+	{
+		EndFrame();
+		playbackDoneEvent.Set();
+	}
+}
+
+static bool ReplayFile(const std::string& filename, RunResult* run)
+{
+	run->totalUs = 0;
+	s_run = run;
+	s_frame_started = false;
+	playbackDoneEvent.Reset();
+
+	if (!BootManager::BootCore(filename))
+		return false;
+
+	// Also sent if the core fails to start.
+	playbackDoneEvent.Wait();
+
+	Core::Stop();
+	while (PowerPC::GetState() != PowerPC::CPU_POWERDOWN)
+		updateMainFrameEvent.Wait();
+	Core::Shutdown();
+
+	return !run->frames.empty();
+}
+
+static std::string EscapeJSON(const std::string& str)
+{
+	std::string escaped;
+	for (char c : str)
+	{
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+
+		if ((unsigned char)c < 0x20)
+			escaped += StringFromFormat("\\u%04x", c);
+		else
+			escaped += c;
+	}
+	return escaped;
+}
+
+// Triangles the draws of a frame make up, lines and points aren't counted.
+static u32 CountTriangles(const FifoFrameStats& frame)
+{
+	u32 triangles = frame.vertices[GX_DRAW_TRIANGLES] / 3;
+	triangles += frame.vertices[GX_DRAW_QUADS] / 4 * 2;
+	triangles += frame.vertices[GX_DRAW_QUADS_2] / 4 * 2;
+	for (u32 primitive : { GX_DRAW_TRIANGLE_STRIP, GX_DRAW_TRIANGLE_FAN })
+	{
+		if (frame.vertices[primitive] > frame.draws[primitive] * 2)
+			triangles += frame.vertices[primitive] - frame.draws[primitive] * 2;
+	}
+	return triangles;
+}
+
+static u64 TrianglesPerSecond(u64 triangles, u64 us)
+{
+	return us ? triangles * 1000000 / us : 0;
+}
+
+static void WriteJSON(FILE* out, const std::string& backend, bool dualCore, int repeat, bool triangles, const std::vector<FileResult>& files)
+{
+	fprintf(out, "{\n");
+	fprintf(out, "  \"version\": \"%s\",\n", EscapeJSON(scm_rev_str).c_str());
+	fprintf(out, "  \"backend\": \"%s\",\n", EscapeJSON(backend).c_str());
+	fprintf(out, "  \"dual_core\": %s,\n", dualCore ? "true" : "false");
+	fprintf(out, "  \"repeat\": %d,\n", repeat);
+	fprintf(out, "  \"files\": [");
+
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		const FileResult& file = files[i];
+		u64 triangleCount = 0;
+		for (u32 frameTriangles : file.frameTriangles)
+			triangleCount += frameTriangles;
+
+		fprintf(out, "%s\n    {\n", i ? "," : "");
+		fprintf(out, "      \"file\": \"%s\",\n", EscapeJSON(file.filename).c_str());
+		fprintf(out, "      \"frame_count\": %u,\n", file.frameCount);
+		fprintf(out, "      \"object_count\": %u,\n", file.objectCount);
+		if (triangles)
+			fprintf(out, "      \"triangle_count\": %llu,\n", (unsigned long long)triangleCount);
+		fprintf(out, "      \"runs\": [");
+
+		for (size_t j = 0; j < file.runs.size(); j++)
+		{
+			const RunResult& run = file.runs[j];
+			fprintf(out, "%s\n        {\n", j ? "," : "");
+			fprintf(out, "          \"total_us\": %llu,\n", (unsigned long long)run.totalUs);
+			if (triangles)
+			{
+				fprintf(out, "          \"triangles_per_second\": %llu,\n",
+				        (unsigned long long)TrianglesPerSecond(triangleCount, run.totalUs));
+			}
+			fprintf(out, "          \"frames\": [");
+
+			for (size_t k = 0; k < run.frames.size(); k++)
+			{
+				const FrameResult& frame = run.frames[k];
+				fprintf(out, "%s\n            { \"frame\": %u, \"us\": %llu, \"objects\": %u, \"draw_calls\": %u, "
+				        "\"textures_created\": %d, \"textures_alive\": %d, "
+				        "\"pixel_shaders_created\": %d, \"pixel_shaders_alive\": %d, "
+				        "\"vertex_shaders_created\": %d, \"vertex_shaders_alive\": %d",
+				        k ? "," : "", frame.frame, (unsigned long long)frame.us, frame.objects, frame.drawCalls,
+				        frame.texturesCreated, frame.texturesAlive,
+				        frame.pixelShadersCreated, frame.pixelShadersAlive,
+				        frame.vertexShadersCreated, frame.vertexShadersAlive);
+				if (triangles)
+				{
+					const u32 frameTriangles = frame.frame < file.frameTriangles.size() ? file.frameTriangles[frame.frame] : 0;
+					fprintf(out, ", \"triangles\": %u, \"triangles_per_second\": %llu",
+					        frameTriangles, (unsigned long long)TrianglesPerSecond(frameTriangles, frame.us));
+				}
+				fprintf(out, " }");
+			}
+
+			fprintf(out, "\n          ]\n        }");
+		}
+
+		fprintf(out, "\n      ]\n    }");
+	}
+
+	fprintf(out, "\n  ]\n}\n");
+}
+
+static const char* GetPrimitiveName(u32 primitive)
+{
+	static const char* names[8] =
+	{
+		"quads", "quads_2", "triangles", "triangle_strip",
+		"triangle_fan", "lines", "line_strip", "points"
+	};
+	return names[primitive];
+}
+
+static const char* GetTextureFormatName(u32 format)
+{
+	switch (format)
+	{
+	case GX_TF_I4:     return "I4";
+	case GX_TF_I8:     return "I8";
+	case GX_TF_IA4:    return "IA4";
+	case GX_TF_IA8:    return "IA8";
+	case GX_TF_RGB565: return "RGB565";
+	case GX_TF_RGB5A3: return "RGB5A3";
+	case GX_TF_RGBA8:  return "RGBA8";
+	case GX_TF_C4:     return "C4";
+	case GX_TF_C8:     return "C8";
+	case GX_TF_C14X2:  return "C14X2";
+	case GX_TF_CMPR:   return "CMPR";
+	default:           return "unknown";
+	}
+}
+
+static void WriteFrameStatsJSON(FILE* out, u32 frameIdx, const FifoFrameStats& stats)
+{
+	fprintf(out, "          \"frame\": %u,\n", frameIdx);
+	fprintf(out, "          \"complete\": %s,\n", stats.complete ? "true" : "false");
+	fprintf(out, "          \"fifo_bytes\": %u,\n", stats.fifoBytes);
+	fprintf(out, "          \"memory_update_bytes\": %u,\n", stats.memoryUpdateBytes);
+
+	fprintf(out, "          \"primitives\": {");
+	bool first = true;
+	for (u32 i = 0; i < 8; i++)
+	{
+		if (stats.draws[i] == 0)
+			continue;
+
+		fprintf(out, "%s \"%s\": { \"draws\": %u, \"vertices\": %u }",
+		        first ? "" : ",", GetPrimitiveName(i), stats.draws[i], stats.vertices[i]);
+		first = false;
+	}
+	fprintf(out, " },\n");
+
+	fprintf(out, "          \"vertex_formats\": [");
+	first = true;
+	for (const auto& format : stats.vertexFormats)
+	{
+		const FifoVertexFormatStats& formatStats = format.second;
+		fprintf(out, "%s\n            { \"vtx_desc\": \"0x%llx\", \"vat\": [\"0x%08x\", \"0x%08x\", \"0x%08x\"], "
+		        "\"vertex_size\": %u, \"draws\": %u, \"vertices\": %u }",
+		        first ? "" : ",", (unsigned long long)formatStats.vtxDesc,
+		        formatStats.vat[0], formatStats.vat[1], formatStats.vat[2],
+		        formatStats.vertexSize, formatStats.draws, formatStats.vertices);
+		first = false;
+	}
+	fprintf(out, "%s],\n", first ? "" : "\n          ");
+
+	fprintf(out, "          \"texture_formats\": [");
+	first = true;
+	for (const auto& format : stats.textureFormats)
+	{
+		fprintf(out, "%s\n            { \"format\": \"%s\", \"textures\": %u, \"bytes\": %llu }",
+		        first ? "" : ",", GetTextureFormatName(format.first),
+		        format.second.textures, (unsigned long long)format.second.bytes);
+		first = false;
+	}
+	fprintf(out, "%s],\n", first ? "" : "\n          ");
+
+	fprintf(out, "          \"efb_copies_to_texture\": %u,\n", stats.efbCopiesToTexture);
+	fprintf(out, "          \"efb_copies_to_xfb\": %u,\n", stats.efbCopiesToXfb);
+	fprintf(out, "          \"efb_clears\": %u,\n", stats.efbClears);
+	fprintf(out, "          \"bp_writes\": %u,\n", stats.bp.writes);
+	fprintf(out, "          \"bp_redundant_writes\": %u,\n", stats.bp.redundantWrites);
+	fprintf(out, "          \"cp_writes\": %u,\n", stats.cp.writes);
+	fprintf(out, "          \"cp_redundant_writes\": %u,\n", stats.cp.redundantWrites);
+	fprintf(out, "          \"xf_writes\": %u,\n", stats.xf.writes);
+	fprintf(out, "          \"xf_redundant_writes\": %u,\n", stats.xf.redundantWrites);
+	fprintf(out, "          \"xf_indexed_loads\": %u\n", stats.xfIndexedLoads);
+}
+
+static void WriteAnalysisJSON(FILE* out, const std::vector<std::string>& filenames, const std::vector<std::vector<FifoFrameStats>>& files)
+{
+	fprintf(out, "{\n");
+	fprintf(out, "  \"version\": \"%s\",\n", EscapeJSON(scm_rev_str).c_str());
+	fprintf(out, "  \"files\": [");
+
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		fprintf(out, "%s\n    {\n", i ? "," : "");
+		fprintf(out, "      \"file\": \"%s\",\n", EscapeJSON(filenames[i]).c_str());
+		fprintf(out, "      \"frame_count\": %u,\n", (u32)files[i].size());
+		fprintf(out, "      \"frames\": [");
+
+		for (size_t j = 0; j < files[i].size(); j++)
+		{
+			fprintf(out, "%s\n        {\n", j ? "," : "");
+			WriteFrameStatsJSON(out, (u32)j, files[i][j]);
+			fprintf(out, "        }");
+		}
+
+		fprintf(out, "\n      ]\n    }");
+	}
+
+	fprintf(out, "\n  ]\n}\n");
+}
+
+static FILE* OpenOutput(const std::string& outputFilename)
+{
+	FILE* out = outputFilename.empty() ? stdout : fopen(outputFilename.c_str(), "w");
+	if (!out)
+		fprintf(stderr, "Could not open %s\n", outputFilename.c_str());
+	return out;
+}
+
+static int AnalyzeFiles(int argc, char* argv[], const std::string& outputFilename)
+{
+	std::vector<std::string> filenames;
+	std::vector<std::vector<FifoFrameStats>> results;
+
+	for (int i = optind; i < argc; i++)
+	{
+		FifoDataFile* dataFile = FifoDataFile::Load(argv[i], false);
+		if (!dataFile)
+		{
+			fprintf(stderr, "%s is not a FIFO log\n", argv[i]);
+			return 1;
+		}
+
+		filenames.push_back(argv[i]);
+		results.push_back(std::vector<FifoFrameStats>());
+
+		FifoStatsAnalyzer analyzer;
+		analyzer.AnalyzeFrames(dataFile, results.back());
+		delete dataFile;
+	}
+
+	FILE* out = OpenOutput(outputFilename);
+	if (!out)
+		return 1;
+
+	WriteAnalysisJSON(out, filenames, results);
+	if (out != stdout)
+		fclose(out);
+
+	return 0;
+}
+
+static std::string GetBackendNames()
+{
+	std::string names;
+	for (VideoBackend* backend : g_available_video_backends)
+	{
+		if (!names.empty())
+			names += ", ";
+		names += backend->GetName();
+	}
+	return names;
+}
+
+int main(int argc, char* argv[])
+{
+	int ch, help = 0;
+	std::string backend;
+	std::string outputFilename;
+	int repeat = 1;
+	bool dualCore = false;
+	bool analyze = false;
+	bool triangles = false;
+
+	struct option longopts[] = {
+		{ "backend",   required_argument, nullptr, 'b' },
+		{ "repeat",    required_argument, nullptr, 'n' },
+		{ "output",    required_argument, nullptr, 'o' },
+		{ "dual-core", no_argument,       nullptr, 'd' },
+		{ "analyze",   no_argument,       nullptr, 'a' },
+		{ "triangles", no_argument,       nullptr, 't' },
+		{ "help",      no_argument,       nullptr, 'h' },
+		{ "version",   no_argument,       nullptr, 'v' },
+		{ nullptr,     0,                 nullptr,  0  }
+	};
+
+	while ((ch = getopt_long(argc, argv, "b:n:o:dath?v", longopts, 0)) != -1)
+	{
+		switch (ch)
+		{
+		case 'b':
+			backend = optarg;
+			break;
+		case 'n':
+			repeat = atoi(optarg);
+			break;
+		case 'o':
+			outputFilename = optarg;
+			break;
+		case 'd':
+			dualCore = true;
+			break;
+		case 'a':
+			analyze = true;
+			break;
+		case 't':
+			triangles = true;
+			break;
+		case 'h':
+		case '?':
+			help = 1;
+			break;
+		case 'v':
+			fprintf(stderr, "%s\n", scm_rev_str);
+			return 1;
+		}
+	}
+
+	if (help == 1 || argc == optind || repeat < 1)
+	{
+		fprintf(stderr, "%s\n\n", scm_rev_str);
+		fprintf(stderr, "Replays FIFO logs and reports how long each frame took\n\n");
+		fprintf(stderr, "Usage: %s [options] <file.dff>...\n", argv[0]);
+		fprintf(stderr, "  -b, --backend <name>  Video backend to replay the logs with\n");
+		fprintf(stderr, "  -n, --repeat <count>  Number of times each log is replayed\n");
+		fprintf(stderr, "  -o, --output <file>   Write the results there instead of to stdout\n");
+		fprintf(stderr, "  -d, --dual-core       Run the GPU on a separate thread\n");
+		fprintf(stderr, "  -a, --analyze         Count what the GPU has to do for each frame instead\n");
+		fprintf(stderr, "  -t, --triangles       Also report how many triangles per second were drawn\n");
+		fprintf(stderr, "  -h, --help            Show this help message\n");
+		fprintf(stderr, "  -v, --version         Print version and exit\n");
+		return 1;
+	}
+
+	if (analyze)
+		return AnalyzeFiles(argc, argv, outputFilename);
+
+	UICommon::Init();
+
+	SCoreStartupParameter& StartUp = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	if (backend.empty())
+		backend = StartUp.m_strVideoBackend;
+
+	bool backendFound = false;
+	for (VideoBackend* videoBackend : g_available_video_backends)
+		backendFound |= videoBackend->GetName() == backend;
+	if (!backendFound)
+	{
+		fprintf(stderr, "Unknown video backend %s, available: %s\n", backend.c_str(), GetBackendNames().c_str());
+		UICommon::Shutdown();
+		return 1;
+	}
+
+	// Restored before the configuration is saved on shutdown.
+	const std::string oldBackend = StartUp.m_strVideoBackend;
+	const bool oldCPUThread = StartUp.bCPUThread;
+	const bool oldLoopFifoReplay = StartUp.bLoopFifoReplay;
+	const unsigned int oldFramelimit = SConfig::GetInstance().m_Framelimit;
+	const std::string oldSoundBackend = SConfig::GetInstance().sBackend;
+	const std::string oldLastFilename = SConfig::GetInstance().m_LastFilename;
+
+	StartUp.m_strVideoBackend = backend;
+	StartUp.bCPUThread = dualCore;
+	StartUp.bLoopFifoReplay = false;
+	SConfig::GetInstance().m_Framelimit = 0;
+	SConfig::GetInstance().sBackend = BACKEND_NULLSOUND;
+	VideoBackend::ActivateBackend(backend);
+
+#if HAVE_X11
+	// The OpenGL based backends draw into a child window of this one.
+	XInitThreads();
+	Display* dpy = XOpenDisplay(nullptr);
+	if (dpy)
+	{
+		Window win = XCreateSimpleWindow(dpy, DefaultRootWindow(dpy), 0, 0,
+		                                 StartUp.iRenderWindowWidth, StartUp.iRenderWindowHeight,
+		                                 0, 0, BlackPixel(dpy, 0));
+		XMapRaised(dpy, win);
+		XFlush(dpy);
+		s_window_handle = (void*) win;
+	}
+#endif
+
+	FifoPlayer::GetInstance().SetFrameWrittenCallback(FrameWritten);
+
+	int ret = 0;
+	std::vector<FileResult> results;
+	for (int i = optind; i < argc && ret == 0; i++)
+	{
+		FileResult file;
+		file.filename = argv[i];
+		file.frameCount = 0;
+		file.objectCount = 0;
+
+		// The FIFO player silently does nothing for logs without frames.
+		FifoDataFile* dataFile = FifoDataFile::Load(file.filename, false);
+		if (!dataFile || dataFile->GetFrameCount() == 0)
+		{
+			fprintf(stderr, "%s is not a FIFO log with any frames\n", file.filename.c_str());
+			delete dataFile;
+			ret = 1;
+			break;
+		}
+		file.frameCount = dataFile->GetFrameCount();
+		if (triangles)
+		{
+			std::vector<FifoFrameStats> frameStats;
+			FifoStatsAnalyzer analyzer;
+			analyzer.AnalyzeFrames(dataFile, frameStats);
+			for (const FifoFrameStats& frame : frameStats)
+				file.frameTriangles.push_back(CountTriangles(frame));
+		}
+		delete dataFile;
+
+		for (int run = 0; run < repeat; run++)
+		{
+			file.runs.push_back(RunResult());
+			if (!ReplayFile(file.filename, &file.runs.back()))
+			{
+				fprintf(stderr, "Could not replay %s\n", file.filename.c_str());
+				ret = 1;
+				break;
+			}
+		}
+
+		if (!file.runs.empty())
+		{
+			for (const FrameResult& frame : file.runs.front().frames)
+				file.objectCount += frame.objects;
+		}
+
+		results.push_back(file);
+	}
+
+	FifoPlayer::GetInstance().SetFrameWrittenCallback(nullptr);
+
+	if (ret == 0)
+	{
+		FILE* out = OpenOutput(outputFilename);
+		if (out)
+		{
+			WriteJSON(out, backend, dualCore, repeat, triangles, results);
+			if (out != stdout)
+				fclose(out);
+		}
+		else
+		{
+			ret = 1;
+		}
+	}
+
+	StartUp.m_strVideoBackend = oldBackend;
+	StartUp.bCPUThread = oldCPUThread;
+	StartUp.bLoopFifoReplay = oldLoopFifoReplay;
+	SConfig::GetInstance().m_Framelimit = oldFramelimit;
+	SConfig::GetInstance().sBackend = oldSoundBackend;
+	SConfig::GetInstance().m_LastFilename = oldLastFilename;
+
+	UICommon::Shutdown();
+
+#if HAVE_X11
+	if (dpy)
+		XCloseDisplay(dpy);
+#endif
+
+	return ret;
+}
@@ -81,6 +81,10 @@ SoftwareVideoConfigDialog::SoftwareVideoConfigDialog(wxWindow* parent, const std
 
 	// xfb
 	szr_rendering->Add(new SettingCheckBox(page_general, _("Bypass XFB"), "", vconfig.bBypassXFB));
+
+	// threads
+	szr_rendering->Add(new wxStaticText(page_general, wxID_ANY, _("Rasterizer threads:")), 1, wxALIGN_CENTER_VERTICAL, 5);
+	szr_rendering->Add(new IntegerSetting<int>(page_general, _("Rasterizer threads"), vconfig.iRasterizerThreads, 0, 16));
 	}
 
 	// - info
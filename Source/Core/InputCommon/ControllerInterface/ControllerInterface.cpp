@@ -55,10 +55,15 @@ void ControllerInterface::Initialize(void* const hwnd)
 	ciface::XInput::Init(m_devices);
 #endif
 #ifdef CIFACE_USE_XLIB
-	ciface::Xlib::Init(m_devices, hwnd);
-	#ifdef CIFACE_USE_X11_XINPUT2
-	ciface::XInput2::Init(m_devices, hwnd);
-	#endif
+	// Headless runs, e.g. with the Null video backend, have no window to
+	// read the keyboard and mouse from.
+	if (hwnd)
+	{
+		ciface::Xlib::Init(m_devices, hwnd);
+		#ifdef CIFACE_USE_X11_XINPUT2
+		ciface::XInput2::Init(m_devices, hwnd);
+		#endif
+	}
 #endif
 #ifdef CIFACE_USE_OSX
 	ciface::OSX::Init(m_devices, hwnd);
@@ -414,6 +414,7 @@ ID3D11Buffer* &PixelShaderCache::GetConstantBuffer()
 		memcpy(map.pData, &PixelShaderManager::constants, sizeof(PixelShaderConstants));
 		D3D::context->Unmap(pscbuf, 0);
 		PixelShaderManager::dirty = false;
+		PixelShaderManager::dirty_range.Clear();
 
 		ADDSTAT(stats.thisFrame.bytesUniformStreamed, sizeof(PixelShaderConstants));
 	}
@@ -32,7 +32,7 @@
 #include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/FPSCounter.h"
-#include "VideoCommon/ImageWrite.h"
+#include "VideoCommon/ImageWriteQueue.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/Statistics.h"
@@ -649,14 +649,15 @@ bool Renderer::SaveScreenshot(const std::string &filename, const TargetRectangle
 	D3D11_MAPPED_SUBRESOURCE map;
 	D3D::context->Map(s_screenshot_texture, 0, D3D11_MAP_READ_WRITE, 0, &map);
 
-	bool saved_png = TextureToPng((u8*)map.pData, map.RowPitch, filename, rc.GetWidth(), rc.GetHeight(), false);
+	// Only queued, the writer thread logs if writing it fails
+	bool queued_png = ImageWriteQueue::TextureToPng((u8*)map.pData, map.RowPitch, filename, rc.GetWidth(), rc.GetHeight(), false, ImageWriteQueue::WAIT_IF_FULL);
 
 	D3D::context->Unmap(s_screenshot_texture, 0);
 
 
-	if (saved_png)
+	if (queued_png)
 	{
-		OSD::AddMessage(StringFromFormat("Saved %i x %i %s", rc.GetWidth(),
+		OSD::AddMessage(StringFromFormat("Saving %i x %i %s", rc.GetWidth(),
 		                                 rc.GetHeight(), filename.c_str()));
 	}
 	else
@@ -664,7 +665,7 @@ bool Renderer::SaveScreenshot(const std::string &filename, const TargetRectangle
 		OSD::AddMessage(StringFromFormat("Error saving %s", filename.c_str()));
 	}
 
-	return saved_png;
+	return queued_png;
 }
 
 void formatBufferDump(const u8* in, u8* out, int w, int h, int p)
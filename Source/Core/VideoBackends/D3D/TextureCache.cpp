@@ -13,7 +13,7 @@
 #include "VideoBackends/D3D/TextureCache.h"
 #include "VideoBackends/D3D/TextureEncoder.h"
 #include "VideoBackends/D3D/VertexShaderCache.h"
-#include "VideoCommon/ImageWrite.h"
+#include "VideoCommon/ImageWriteQueue.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -66,7 +66,7 @@ bool TextureCache::TCacheEntry::Save(const std::string& filename, unsigned int l
 		HRESULT hr = D3D::context->Map(pNewTexture, 0, D3D11_MAP_READ_WRITE, 0, &map);
 		if (SUCCEEDED(hr))
 		{
-			saved_png = TextureToPng((u8*)map.pData, map.RowPitch, filename, desc.Width, desc.Height);
+			saved_png = ImageWriteQueue::TextureToPng((u8*)map.pData, map.RowPitch, filename, desc.Width, desc.Height, true, ImageWriteQueue::WAIT_IF_FULL);
 			D3D::context->Unmap(pNewTexture, 0);
 		}
 		SAFE_RELEASE(pNewTexture);
@@ -50,6 +50,7 @@ ID3D11Buffer* &VertexShaderCache::GetConstantBuffer()
 		memcpy(map.pData, &VertexShaderManager::constants, sizeof(VertexShaderConstants));
 		D3D::context->Unmap(vscbuf, 0);
 		VertexShaderManager::dirty = false;
+		VertexShaderManager::dirty_range.Clear();
 
 		ADDSTAT(stats.thisFrame.bytesUniformStreamed, sizeof(VertexShaderConstants));
 	}
@@ -28,6 +28,7 @@
 #include "VideoCommon/BPStructs.h"
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/ImageWriteQueue.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/OpcodeDecoding.h"
@@ -209,6 +210,7 @@ void VideoBackend::Shutdown()
 		VertexShaderManager::Shutdown();
 		OpcodeDecoder_Shutdown();
 		VertexLoaderManager::Shutdown();
+		ImageWriteQueue::Shutdown();
 
 		// internal interfaces
 		D3D::ShutdownUtils();
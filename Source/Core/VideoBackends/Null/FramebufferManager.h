@@ -0,0 +1,37 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "VideoCommon/FramebufferManagerBase.h"
+#include "VideoCommon/RenderBase.h"
+
+namespace Null
+{
+
+struct XFBSource : public XFBSourceBase
+{
+	void DecodeToTexture(u32 xfbAddr, u32 fbWidth, u32 fbHeight) override {}
+	void CopyEFB(float Gamma) override {}
+};
+
+class FramebufferManager : public FramebufferManagerBase
+{
+private:
+	XFBSourceBase* CreateXFBSource(unsigned int target_width, unsigned int target_height) override
+	{
+		return new XFBSource;
+	}
+
+	void GetTargetSize(unsigned int *width, unsigned int *height, const EFBRectangle& sourceRc) override
+	{
+		*width = Renderer::GetTargetWidth();
+		*height = Renderer::GetTargetHeight();
+	}
+
+	// There is no EFB to encode, so the XFB in RAM keeps whatever the game put there.
+	void CopyToRealXFB(u32 xfbAddr, u32 fbWidth, u32 fbHeight, const EFBRectangle& sourceRc, float Gamma) override {}
+};
+
+}
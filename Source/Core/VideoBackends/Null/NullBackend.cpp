@@ -0,0 +1,148 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "Common/FileUtil.h"
+#include "Common/IniFile.h"
+
+#include "Core/Host.h"
+
+#include "VideoBackends/Null/Render.h"
+#include "VideoBackends/Null/TextureCache.h"
+#include "VideoBackends/Null/VertexManager.h"
+#include "VideoBackends/Null/VideoBackend.h"
+
+#include "VideoCommon/BPStructs.h"
+#include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/Fifo.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/MainBase.h"
+#include "VideoCommon/OnScreenDisplay.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/PerfQueryBase.h"
+#include "VideoCommon/PixelEngine.h"
+#include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace Null
+{
+
+static void InitBackendInfo()
+{
+	g_Config.backend_info.APIType = API_NONE;
+	g_Config.backend_info.bUseMinimalMipCount = false;
+	g_Config.backend_info.bSupportsExclusiveFullscreen = false;
+	g_Config.backend_info.bSupportsDualSourceBlend = true;
+	g_Config.backend_info.bSupportsPrimitiveRestart = true;
+	g_Config.backend_info.bSupportsOversizedViewports = true;
+	g_Config.backend_info.bSupportsStereoscopy = false;
+	g_Config.backend_info.bSupports3DVision = false;
+	g_Config.backend_info.bSupportsEarlyZ = true;
+	g_Config.backend_info.bSupportsBindingLayout = true;
+	// Let the vertex loader track the bounding box, nothing else could.
+	g_Config.backend_info.bSupportsBBox = false;
+	g_Config.backend_info.bSupportsGSInstancing = false;
+
+	g_Config.backend_info.Adapters.clear();
+	g_Config.backend_info.AAModes.assign(1, _trans("None"));
+	g_Config.backend_info.PPShaders.clear();
+}
+
+std::string VideoBackend::GetName() const
+{
+	return "Null";
+}
+
+void VideoBackend::ShowConfig(void* parent)
+{
+	InitBackendInfo();
+	Host_ShowVideoConfig(parent, GetDisplayName(), "gfx_null");
+}
+
+bool VideoBackend::Initialize(void* window_handle)
+{
+	InitializeShared();
+	InitBackendInfo();
+
+	frameCount = 0;
+
+	const std::string ini_file = File::GetUserPath(D_CONFIG_IDX) + "gfx_null.ini";
+	g_Config.Load(ini_file);
+
+	// Any other backend would silently draw nothing, so this isn't one of
+	// the shared hacks.
+	IniFile ini;
+	ini.Load(ini_file);
+	ini.GetOrCreateSection("Null")->Get("SkipVertexLoading", &g_Config.bSkipVertexLoading, false);
+
+	g_Config.GameIniLoad();
+	g_Config.UpdateProjectionHack();
+	g_Config.VerifyValidity();
+	UpdateActiveConfig();
+
+	// Do our OSD callbacks
+	OSD::DoCallbacks(OSD::OSD_INIT);
+
+	s_BackendInitialized = true;
+
+	return true;
+}
+
+// This is called after Initialize() from the Core
+// Run from the graphics thread
+void VideoBackend::Video_Prepare()
+{
+	g_renderer = new Renderer;
+	g_vertex_manager = new VertexManager;
+	g_perf_query = new PerfQueryBase;
+	g_texture_cache = new TextureCache;
+
+	// VideoCommon
+	BPInit();
+	Fifo_Init();
+	IndexGenerator::Init();
+	VertexLoaderManager::Init();
+	OpcodeDecoder_Init();
+	VertexShaderManager::Init();
+	PixelShaderManager::Init();
+	CommandProcessor::Init();
+	PixelEngine::Init();
+
+	// Notify the core that the video backend is ready
+	Host_Message(WM_USER_CREATE);
+}
+
+void VideoBackend::Shutdown()
+{
+	s_BackendInitialized = false;
+	g_Config.bSkipVertexLoading = false;
+
+	// Do our OSD callbacks
+	OSD::DoCallbacks(OSD::OSD_SHUTDOWN);
+}
+
+void VideoBackend::Video_Cleanup()
+{
+	if (g_renderer)
+	{
+		Fifo_Shutdown();
+		CommandProcessor::Shutdown();
+		PixelShaderManager::Shutdown();
+		VertexShaderManager::Shutdown();
+		OpcodeDecoder_Shutdown();
+		VertexLoaderManager::Shutdown();
+
+		delete g_texture_cache;
+		g_texture_cache = nullptr;
+		delete g_perf_query;
+		g_perf_query = nullptr;
+		delete g_vertex_manager;
+		g_vertex_manager = nullptr;
+		delete g_renderer;
+		g_renderer = nullptr;
+	}
+}
+
+}
@@ -0,0 +1,57 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Null/FramebufferManager.h"
+#include "VideoBackends/Null/Render.h"
+
+#include "VideoCommon/TextureCacheBase.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace Null
+{
+
+Renderer::Renderer()
+{
+	// There is no window, so pretend the backbuffer has the native size.
+	s_backbuffer_width = EFB_WIDTH;
+	s_backbuffer_height = EFB_HEIGHT;
+
+	FramebufferManagerBase::SetLastXfbWidth(MAX_XFB_WIDTH);
+	FramebufferManagerBase::SetLastXfbHeight(MAX_XFB_HEIGHT);
+
+	UpdateDrawRectangle(s_backbuffer_width, s_backbuffer_height);
+
+	s_LastEFBScale = g_ActiveConfig.iEFBScale;
+	CalculateTargetSize(s_backbuffer_width, s_backbuffer_height);
+
+	g_framebuffer_manager = new FramebufferManager;
+}
+
+Renderer::~Renderer()
+{
+	delete g_framebuffer_manager;
+	g_framebuffer_manager = nullptr;
+}
+
+TargetRectangle Renderer::ConvertEFBRectangle(const EFBRectangle& rc)
+{
+	TargetRectangle result;
+	result.left   = EFBToScaledX(rc.left);
+	result.top    = EFBToScaledY(rc.top);
+	result.right  = EFBToScaledX(rc.right);
+	result.bottom = EFBToScaledY(rc.bottom);
+	return result;
+}
+
+void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const EFBRectangle& rc, float Gamma)
+{
+	// Nothing is presented, but the frame still ends like it does with the
+	// other backends: Renderer::Swap counts it and notifies the core.
+	TextureCache::Cleanup();
+
+	UpdateActiveConfig();
+	TextureCache::OnConfigChanged(g_ActiveConfig);
+}
+
+}
@@ -0,0 +1,39 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Null/VertexManager.h"
+
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/Statistics.h"
+
+namespace Null
+{
+
+VertexManager::VertexManager()
+	: m_local_v_buffer(MAXVBUFFERSIZE), m_local_i_buffer(MAXIBUFFERSIZE)
+{
+}
+
+VertexManager::~VertexManager()
+{
+}
+
+NativeVertexFormat* VertexManager::CreateNativeVertexFormat()
+{
+	return new NullNativeVertexFormat;
+}
+
+void VertexManager::ResetBuffer(u32 stride)
+{
+	s_pCurBufferPointer = s_pBaseBufferPointer = m_local_v_buffer.data();
+	s_pEndBufferPointer = s_pBaseBufferPointer + m_local_v_buffer.size();
+	IndexGenerator::Start(m_local_i_buffer.data());
+}
+
+void VertexManager::vFlush(bool useDstAlpha)
+{
+	INCSTAT(stats.thisFrame.numDrawCalls);
+}
+
+}
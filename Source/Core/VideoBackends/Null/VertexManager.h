@@ -0,0 +1,41 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/VertexManagerBase.h"
+
+namespace Null
+{
+
+class NullNativeVertexFormat : public NativeVertexFormat
+{
+public:
+	void Initialize(const PortableVertexDeclaration &vtx_decl) override { vertex_stride = vtx_decl.stride; }
+	void SetupVertexPointers() override {}
+};
+
+// Vertices and indices are converted into plain memory and dropped on every flush.
+class VertexManager : public ::VertexManager
+{
+public:
+	VertexManager();
+	~VertexManager();
+
+	NativeVertexFormat* CreateNativeVertexFormat() override;
+
+protected:
+	void ResetBuffer(u32 stride) override;
+
+private:
+	void vFlush(bool useDstAlpha) override;
+
+	std::vector<u8> m_local_v_buffer;
+	std::vector<u16> m_local_i_buffer;
+};
+
+}
@@ -0,0 +1,32 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include "VideoCommon/VideoBackendBase.h"
+
+namespace Null
+{
+
+// Runs the command processor, the opcode decoder, vertex loading and texture
+// decoding like any other hardware backend, but never talks to a graphics API.
+// Useful for measuring the CPU side of the emulation on its own and for
+// running on machines without a GPU driver.
+class VideoBackend : public VideoBackendHardware
+{
+	bool Initialize(void *) override;
+	void Shutdown() override;
+
+	std::string GetName() const override;
+
+	void Video_Prepare() override;
+	void Video_Cleanup() override;
+
+	void ShowConfig(void* parent) override;
+
+	unsigned int PeekMessages() override { return 0; }
+};
+
+}
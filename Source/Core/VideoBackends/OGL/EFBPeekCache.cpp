@@ -0,0 +1,174 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstring>
+
+#include "VideoBackends/OGL/EFBPeekCache.h"
+#include "VideoBackends/OGL/FramebufferManager.h"
+#include "VideoBackends/OGL/GLInterfaceBase.h"
+#include "VideoBackends/OGL/Render.h"
+
+#include "VideoCommon/VideoConfig.h"
+
+namespace OGL
+{
+
+EFBPeekCache::EFBPeekCache()
+	: m_fence(0), m_valid(false), m_frames_since_peek(IDLE_FRAMES)
+{
+	m_color.resize(EFB_WIDTH * EFB_HEIGHT);
+	m_depth.resize(EFB_WIDTH * EFB_HEIGHT);
+
+	glActiveTexture(GL_TEXTURE0 + 9);
+
+	GLuint textures[2];
+	glGenTextures(2, textures);
+	m_color_texture = textures[0];
+	m_depth_texture = textures[1];
+
+	// The formats have to match the EFB, otherwise it can't be blitted.
+	glBindTexture(GL_TEXTURE_2D, m_color_texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, EFB_WIDTH, EFB_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	glBindTexture(GL_TEXTURE_2D, m_depth_texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, EFB_WIDTH, EFB_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_color_texture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depth_texture, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, FramebufferManager::GetEFBFramebuffer());
+
+	GLuint buffers[2];
+	glGenBuffers(2, buffers);
+	m_color_pbo = buffers[0];
+	m_depth_pbo = buffers[1];
+	for (GLuint pbo : buffers)
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+		glBufferData(GL_PIXEL_PACK_BUFFER, EFB_WIDTH * EFB_HEIGHT * sizeof(u32), nullptr, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+EFBPeekCache::~EFBPeekCache()
+{
+	if (m_fence)
+		glDeleteSync(m_fence);
+
+	GLuint buffers[2] = { m_color_pbo, m_depth_pbo };
+	glDeleteBuffers(2, buffers);
+	glDeleteFramebuffers(1, &m_framebuffer);
+	GLuint textures[2] = { m_color_texture, m_depth_texture };
+	glDeleteTextures(2, textures);
+}
+
+void EFBPeekCache::QueueReadback()
+{
+	if (!g_ActiveConfig.bEFBFastAccess || !g_ogl_config.bSupportsGLSync ||
+	    m_frames_since_peek++ >= IDLE_FRAMES)
+	{
+		// Don't answer the next peek with a frame from long ago.
+		m_valid = false;
+		return;
+	}
+
+	// Games which peek a lot keep peeking, so it doesn't matter if a frame
+	// gets skipped because the GPU is behind.
+	if (m_fence && !RetrieveReadback())
+		return;
+
+	g_renderer->ResetAPIState();
+
+	const EFBRectangle efb_rc(0, 0, EFB_WIDTH, EFB_HEIGHT);
+	const TargetRectangle target_rc = g_renderer->ConvertEFBRectangle(efb_rc);
+
+	// Multisampled framebuffers can't be scaled while they are blitted.
+	GLuint source_framebuffer = FramebufferManager::GetEFBFramebuffer();
+	if (FramebufferManager::GetResolvedFramebuffer())
+	{
+		FramebufferManager::GetEFBColorTexture(efb_rc);
+		FramebufferManager::GetEFBDepthTexture(efb_rc);
+		source_framebuffer = FramebufferManager::GetResolvedFramebuffer();
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, source_framebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffer);
+	glBlitFramebuffer(target_rc.left, target_rc.bottom, target_rc.right, target_rc.top,
+	                  0, 0, EFB_WIDTH, EFB_HEIGHT, GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_color_pbo);
+	if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3)
+		glReadPixels(0, 0, EFB_WIDTH, EFB_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	else
+		glReadPixels(0, 0, EFB_WIDTH, EFB_HEIGHT, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_depth_pbo);
+	glReadPixels(0, 0, EFB_WIDTH, EFB_HEIGHT, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	m_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, FramebufferManager::GetEFBFramebuffer());
+	g_renderer->RestoreAPIState();
+}
+
+bool EFBPeekCache::RetrieveReadback()
+{
+	GLenum result = glClientWaitSync(m_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+		return false;
+
+	glDeleteSync(m_fence);
+	m_fence = 0;
+
+	const u32 size = EFB_WIDTH * EFB_HEIGHT * sizeof(u32);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_color_pbo);
+	void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+	memcpy(m_color.data(), data, size);
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_depth_pbo);
+	data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+	memcpy(m_depth.data(), data, size);
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	m_valid = true;
+	return true;
+}
+
+bool EFBPeekCache::Peek(EFBAccessType type, u32 x, u32 y, u32* value)
+{
+	m_frames_since_peek = 0;
+
+	if (m_fence)
+		RetrieveReadback();
+
+	if (!m_valid)
+		return false;
+
+	// The readback is upside down.
+	const u32 index = (EFB_HEIGHT - 1 - y) * EFB_WIDTH + x;
+	*value = (type == PEEK_Z) ? m_depth[index] : m_color[index];
+	return true;
+}
+
+void EFBPeekCache::Poke(EFBAccessType type, u32 x, u32 y, u32 value)
+{
+	if (!m_valid)
+		return;
+
+	const u32 index = (EFB_HEIGHT - 1 - y) * EFB_WIDTH + x;
+	if (type == POKE_Z)
+		m_depth[index] = (value & 0xFFFFFF) << 8;
+	else
+		m_color[index] = value;
+}
+
+}
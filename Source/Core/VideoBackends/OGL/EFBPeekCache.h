@@ -0,0 +1,53 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "VideoBackends/OGL/GLUtil.h"
+#include "VideoCommon/VideoBackendBase.h"
+
+namespace OGL
+{
+
+// Answers EFB peeks from a copy of the last frame instead of stalling the GPU.
+// Once a frame is done, the whole EFB is downsampled to native resolution and
+// read back into pixel buffers; peeks use the newest readback which finished.
+class EFBPeekCache : NonCopyable
+{
+public:
+	EFBPeekCache();
+	~EFBPeekCache();
+
+	// Starts a readback, unless the previous one is still in flight or the
+	// game hasn't peeked for a while.
+	void QueueReadback();
+
+	// Returns false if no readback finished yet.
+	bool Peek(EFBAccessType type, u32 x, u32 y, u32* value);
+
+	// Keeps the cached copy in sync with the pokes of the CPU.
+	void Poke(EFBAccessType type, u32 x, u32 y, u32 value);
+
+private:
+	// Games which stopped peeking don't pay for the readbacks.
+	enum { IDLE_FRAMES = 60 };
+
+	bool RetrieveReadback();
+
+	GLuint m_framebuffer;
+	GLuint m_color_texture;
+	GLuint m_depth_texture;
+	GLuint m_color_pbo;
+	GLuint m_depth_pbo;
+	GLsync m_fence;
+
+	bool m_valid;
+	int m_frames_since_peek;
+	std::vector<u32> m_color;
+	std::vector<u32> m_depth;
+};
+
+}
@@ -0,0 +1,83 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "VideoBackends/OGL/FrameDumpReader.h"
+
+namespace OGL
+{
+
+FrameDumpReader::FrameDumpReader()
+	: m_current(0)
+{
+	GLuint buffers[2];
+	glGenBuffers(2, buffers);
+	for (int i = 0; i < 2; ++i)
+	{
+		m_readbacks[i].pbo = buffers[i];
+		m_readbacks[i].size = 0;
+		m_readbacks[i].width = 0;
+		m_readbacks[i].height = 0;
+		m_readbacks[i].ticks = 0;
+		m_readbacks[i].pending = false;
+	}
+}
+
+FrameDumpReader::~FrameDumpReader()
+{
+	GLuint buffers[2] = { m_readbacks[0].pbo, m_readbacks[1].pbo };
+	glDeleteBuffers(2, buffers);
+}
+
+void FrameDumpReader::ReadFrame(const TargetRectangle& rc, u64 ticks, const FrameCallback& callback)
+{
+	Readback& readback = m_readbacks[m_current];
+	readback.width = rc.GetWidth();
+	readback.height = rc.GetHeight();
+	readback.ticks = ticks;
+
+	const u32 size = readback.width * readback.height * 3;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+	if (size > readback.size)
+	{
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+		readback.size = size;
+	}
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(rc.left, rc.bottom, readback.width, readback.height, GL_BGR, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	readback.pending = true;
+
+	// By now the GPU had a whole frame to finish the other readback.
+	m_current ^= 1;
+	RetrieveReadback(&m_readbacks[m_current], callback);
+}
+
+void FrameDumpReader::Flush(const FrameCallback& callback)
+{
+	RetrieveReadback(&m_readbacks[m_current], callback);
+	RetrieveReadback(&m_readbacks[m_current ^ 1], callback);
+}
+
+void FrameDumpReader::RetrieveReadback(Readback* readback, const FrameCallback& callback)
+{
+	if (!readback->pending)
+		return;
+	readback->pending = false;
+
+	const u32 size = readback->width * readback->height * 3;
+	if (size == 0)
+		return;
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+	const u8* data = (const u8*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+	if (data)
+	{
+		callback(data, readback->width, readback->height, readback->ticks);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+}
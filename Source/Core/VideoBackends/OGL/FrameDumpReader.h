@@ -0,0 +1,51 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+
+#include "VideoBackends/OGL/GLUtil.h"
+#include "VideoCommon/VideoCommon.h"
+
+namespace OGL
+{
+
+// Reads dumped frames back through pixel buffers, so that the GPU thread
+// doesn't wait for the GPU to finish each frame. A frame is handed on once
+// the next one was queued, so dumps are one frame behind.
+class FrameDumpReader : NonCopyable
+{
+public:
+	// Rows are BGR24 and bottom-up, without padding.
+	typedef std::function<void(const u8* data, int width, int height, u64 ticks)> FrameCallback;
+
+	FrameDumpReader();
+	~FrameDumpReader();
+
+	// Reads rc of the current read framebuffer, and hands the previous frame
+	// to callback. ticks is the emulated time of the frame.
+	void ReadFrame(const TargetRectangle& rc, u64 ticks, const FrameCallback& callback);
+
+	// Hands the last frame to callback, once dumping stops.
+	void Flush(const FrameCallback& callback);
+
+private:
+	struct Readback
+	{
+		GLuint pbo;
+		u32 size;
+		int width;
+		int height;
+		u64 ticks;
+		bool pending;
+	};
+
+	void RetrieveReadback(Readback* readback, const FrameCallback& callback);
+
+	Readback m_readbacks[2];
+	int m_current;
+};
+
+}
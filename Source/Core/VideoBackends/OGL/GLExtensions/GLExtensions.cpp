@@ -754,6 +754,9 @@ PFNGLMULTIDRAWELEMENTSBASEVERTEXPROC glMultiDrawElementsBaseVertex;
 // ARB_sample_shading
 PFNGLMINSAMPLESHADINGARBPROC glMinSampleShadingARB;
 
+// ARB_copy_buffer
+PFNGLCOPYBUFFERSUBDATAPROC glCopyBufferSubData;
+
 // ARB_debug_output
 PFNGLDEBUGMESSAGECALLBACKARBPROC glDebugMessageCallbackARB;
 PFNGLDEBUGMESSAGECONTROLARBPROC glDebugMessageControlARB;
@@ -1545,6 +1548,9 @@ const GLFunc gl_function_array[] =
 	// ARB_sample_shading
 	GLFUNC_REQUIRES(glMinSampleShadingARB, "GL_ARB_sample_shading"),
 
+	// ARB_copy_buffer
+	GLFUNC_REQUIRES(glCopyBufferSubData, "GL_ARB_copy_buffer"),
+
 	// ARB_debug_output
 	GLFUNC_REQUIRES(glDebugMessageCallbackARB, "GL_ARB_debug_output"),
 	GLFUNC_REQUIRES(glDebugMessageControlARB,  "GL_ARB_debug_output"),
@@ -1619,6 +1625,7 @@ namespace GLExtensions
 				"GL_ARB_get_program_binary",
 				"GL_ARB_sync",
 				"GL_ARB_ES2_compatibility",
+				"GL_ARB_copy_buffer",
 				"VERSION_GLES3",
 				"VERSION_3_0",
 				};
@@ -114,8 +114,33 @@ bool cInterfaceGLX::Create(void *window_handle)
 	return true;
 }
 
+cInterfaceBase* cInterfaceGLX::CreateSharedContext()
+{
+	GLXContext shared_ctx = glXCreateContext(dpy, vi, ctx, GL_TRUE);
+	if (!shared_ctx)
+	{
+		ERROR_LOG(VIDEO, "Unable to create shared GLX context.");
+		return nullptr;
+	}
+
+	// The shared context is only used to create objects, never to draw, so it
+	// can use the same window. Display connections are thread safe since
+	// XInitThreads is called at startup.
+	cInterfaceGLX* shared = new cInterfaceGLX();
+	shared->dpy = dpy;
+	shared->win = win;
+	shared->vi = vi;
+	shared->ctx = shared_ctx;
+	shared->m_is_shared = true;
+	shared->s_opengl_mode = s_opengl_mode;
+	return shared;
+}
+
 bool cInterfaceGLX::MakeCurrent()
 {
+	if (m_is_shared)
+		return glXMakeCurrent(dpy, win, ctx);
+
 	bool success = glXMakeCurrent(dpy, win, ctx);
 	if (success)
 	{
@@ -134,6 +159,13 @@ bool cInterfaceGLX::ClearCurrent()
 // Close backend
 void cInterfaceGLX::Shutdown()
 {
+	if (m_is_shared)
+	{
+		glXDestroyContext(dpy, ctx);
+		ctx = nullptr;
+		return;
+	}
+
 	XWindow.DestroyXWindow();
 	if (ctx)
 	{
@@ -18,12 +18,14 @@ private:
 	Window win;
 	GLXContext ctx;
 	XVisualInfo *vi;
+	bool m_is_shared = false;
 public:
 	friend class cX11Window;
 	void SwapInterval(int Interval) override;
 	void Swap() override;
 	void* GetFuncAddress(const std::string& name) override;
 	bool Create(void *window_handle);
+	cInterfaceBase* CreateSharedContext() override;
 	bool MakeCurrent() override;
 	bool ClearCurrent() override;
 	void Shutdown() override;
@@ -131,8 +131,34 @@ bool cInterfaceWGL::Create(void *window_handle)
 	return true;
 }
 
+cInterfaceBase* cInterfaceWGL::CreateSharedContext()
+{
+	HGLRC shared_rc = wglCreateContext(hDC);
+	if (!shared_rc)
+	{
+		ERROR_LOG(VIDEO, "Unable to create shared rendering context.");
+		return nullptr;
+	}
+
+	if (!wglShareLists(hRC, shared_rc))
+	{
+		ERROR_LOG(VIDEO, "Unable to share objects with the rendering context.");
+		wglDeleteContext(shared_rc);
+		return nullptr;
+	}
+
+	cInterfaceWGL* shared = new cInterfaceWGL();
+	shared->m_window_handle = m_window_handle;
+	shared->m_shared_rc = shared_rc;
+	shared->s_opengl_mode = s_opengl_mode;
+	return shared;
+}
+
 bool cInterfaceWGL::MakeCurrent()
 {
+	if (m_shared_rc)
+		return wglMakeCurrent(hDC, m_shared_rc) ? true : false;
+
 	bool success = wglMakeCurrent(hDC, hRC) ? true : false;
 	if (success)
 	{
@@ -161,6 +187,13 @@ void cInterfaceWGL::Update()
 // Close backend
 void cInterfaceWGL::Shutdown()
 {
+	if (m_shared_rc)
+	{
+		wglDeleteContext(m_shared_rc);
+		m_shared_rc = nullptr;
+		return;
+	}
+
 	if (hRC)
 	{
 		if (!wglMakeCurrent(nullptr, nullptr))
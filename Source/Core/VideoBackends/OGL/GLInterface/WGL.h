@@ -14,6 +14,7 @@ public:
 	void Swap();
 	void* GetFuncAddress(const std::string& name);
 	bool Create(void *window_handle);
+	cInterfaceBase* CreateSharedContext() override;
 	bool MakeCurrent();
 	bool ClearCurrent();
 	void Shutdown();
@@ -22,4 +23,8 @@ public:
 	bool PeekMessages();
 
 	HWND m_window_handle;
+
+private:
+	// Only set for contexts made by CreateSharedContext
+	HGLRC m_shared_rc = nullptr;
 };
@@ -2,11 +2,25 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "Common/Event.h"
+#include "Common/Flag.h"
+#include "Common/Hash.h"
 #include "Common/MathUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Common/Timer.h"
 
+#include "VideoBackends/OGL/GLInterfaceBase.h"
 #include "VideoBackends/OGL/ProgramShaderCache.h"
 #include "VideoBackends/OGL/Render.h"
 #include "VideoBackends/OGL/StreamBuffer.h"
@@ -14,6 +28,7 @@
 #include "VideoCommon/Debugger.h"
 #include "VideoCommon/DriverDetails.h"
 #include "VideoCommon/ImageWrite.h"
+#include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexShaderManager.h"
@@ -27,6 +42,9 @@ u32 ProgramShaderCache::s_ubo_buffer_size;
 s32 ProgramShaderCache::s_ubo_align;
 
 static StreamBuffer *s_buffer;
+// Holds the current constants if only the parts which changed are streamed,
+// they're copied into it on the GPU.
+static GLuint s_constant_buffer = 0;
 static int num_failures = 0;
 
 static LinearDiskCache<SHADERUID, u8> g_program_disk_cache;
@@ -40,6 +58,71 @@ UidChecker<GeometryShaderUid,ShaderCode> ProgramShaderCache::geometry_uid_checke
 
 static char s_glsl_header[1024] = "";
 
+// Every shader a game used, stored as generated source code. Unlike the
+// program binaries this stays valid across driver updates, it only depends
+// on the GLSL header and the GPU features which the shader generators use.
+static LinearDiskCache<SHADERUID, u8> s_uid_disk_cache;
+static std::set<SHADERUID> s_known_uids;
+static u64 s_source_hash;
+static bool s_uid_disk_cache_open;
+
+struct CompileJob
+{
+	SHADERUID uid;
+	std::string vcode, pcode, gcode;
+};
+
+struct CompiledProgram
+{
+	CompileJob job;
+	SHADER shader; // glprogid is 0 if compiling failed
+	bool precompiled;
+};
+
+// The shaders of earlier sessions. Not resized while the compiler thread runs.
+static std::vector<CompileJob> s_precompile_jobs;
+static size_t s_next_precompile_job;
+static std::atomic<int> s_precompile_done;
+static Common::Flag s_precompile_finished;
+static bool s_precompiling;
+static u32 s_precompile_start_time;
+static int s_precompile_reported;
+
+// Shaders a draw is waiting for, these are compiled before the precompile jobs
+static std::mutex s_async_jobs_lock;
+static std::deque<CompileJob> s_async_jobs;
+
+// Runs on its own GL context which shares objects with the main one. With
+// asynchronous compilation it stays around until shutdown, otherwise it
+// exits once all shaders are precompiled.
+static std::unique_ptr<cInterfaceBase> s_compiler_context;
+static std::thread s_compiler_thread;
+static Common::Event s_compiler_wakeup;
+static Common::Flag s_compiler_quit;
+static Common::Flag s_compiler_exited;
+static Common::Flag s_compiler_broken;
+static bool s_compiler_persistent;
+
+// Finished programs waiting to be picked up by the GPU thread
+static std::mutex s_compiled_lock;
+static std::vector<CompiledProgram> s_compiled;
+
+static u64 GetSourceHash()
+{
+	const auto& info = g_ActiveConfig.backend_info;
+	u64 features =
+		(info.bSupportsDualSourceBlend << 0) |
+		(info.bSupportsEarlyZ << 1) |
+		(info.bSupportsBindingLayout << 2) |
+		(info.bSupportsBBox << 3) |
+		(info.bSupportsGSInstancing << 4) |
+		(DriverDetails::HasBug(DriverDetails::BUG_NODYNUBOACCESS) << 5) |
+		(DriverDetails::HasBug(DriverDetails::BUG_ANNIHILATEDUBOS) << 6) |
+		(DriverDetails::HasBug(DriverDetails::BUG_BROKENNEGATEDBOOLEAN) << 7);
+
+	return GetMurmurHash3((const u8*)s_glsl_header, (int)strlen(s_glsl_header), 0) ^ features;
+}
+
 static std::string GetGLSLVersionString()
 {
 	GLSL_VERSION v = g_ogl_config.eSupportedGLSLVersion;
@@ -131,9 +214,39 @@ void SHADER::Bind()
 	}
 }
 
+static void UploadConstantRange(ConstantDirtyRange* range, const void* constants, u32 offset)
+{
+	if (range->IsEmpty())
+		return;
+
+	const u32 size = range->Size();
+	auto buffer = s_buffer->Map(size, 16);
+	memcpy(buffer.first, (const u8*)constants + range->begin, size);
+	s_buffer->Unmap(size);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, s_buffer->m_buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, s_constant_buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, buffer.second, offset + range->begin, size);
+
+	ADDSTAT(stats.thisFrame.bytesUniformStreamed, size);
+	range->Clear();
+}
+
 void ProgramShaderCache::UploadConstants()
 {
-	if (PixelShaderManager::dirty || VertexShaderManager::dirty)
+	if (s_constant_buffer)
+	{
+		if (PixelShaderManager::dirty || VertexShaderManager::dirty)
+		{
+			UploadConstantRange(&PixelShaderManager::dirty_range, &PixelShaderManager::constants, 0);
+			UploadConstantRange(&VertexShaderManager::dirty_range, &VertexShaderManager::constants,
+				ROUND_UP(sizeof(PixelShaderConstants), s_ubo_align));
+
+			PixelShaderManager::dirty = false;
+			VertexShaderManager::dirty = false;
+		}
+	}
+	else if (PixelShaderManager::dirty || VertexShaderManager::dirty)
 	{
 		auto buffer = s_buffer->Map(s_ubo_buffer_size, s_ubo_align);
 
@@ -150,7 +263,9 @@ void ProgramShaderCache::UploadConstants()
 					sizeof(VertexShaderConstants));
 
 		PixelShaderManager::dirty = false;
+		PixelShaderManager::dirty_range.Clear();
 		VertexShaderManager::dirty = false;
+		VertexShaderManager::dirty_range.Clear();
 
 		ADDSTAT(stats.thisFrame.bytesUniformStreamed, s_ubo_buffer_size);
 	}
@@ -171,6 +286,10 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 	{
 		if (uid == last_uid)
 		{
+			// Still being compiled, or compiling failed
+			if (!last_entry->shader.glprogid)
+				return nullptr;
+
 			GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
 			last_entry->shader.Bind();
 			return &last_entry->shader;
@@ -181,11 +300,27 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 
 	// Check if shader is already in cache
 	PCache::iterator iter = pshaders.find(uid);
+	if ((iter == pshaders.end() || !iter->second.shader.glprogid) && s_compiler_context)
+	{
+		// It may have been compiled since the last frame
+		RetrieveCompiledShaders();
+		iter = pshaders.find(uid);
+	}
+
 	if (iter != pshaders.end())
 	{
 		PCacheEntry *entry = &iter->second;
 		last_entry = entry;
 
+		if (!entry->shader.glprogid)
+			return nullptr;
+
+		if (entry->precompiled)
+		{
+			entry->precompiled = false;
+			INCSTAT(stats.numShaderStallsAvoided);
+		}
+
 		GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
 		last_entry->shader.Bind();
 		return &last_entry->shader;
@@ -195,6 +330,7 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 	PCacheEntry& newentry = pshaders[uid];
 	last_entry = &newentry;
 	newentry.in_cache = 0;
+	newentry.precompiled = false;
 
 	VertexShaderCode vcode;
 	PixelShaderCode pcode;
@@ -229,12 +365,33 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 	}
 #endif
 
+	if (g_ActiveConfig.bAsyncShaderCompilation && s_compiler_persistent && s_compiler_thread.joinable() &&
+	    !s_compiler_broken.IsSet())
+	{
+		// The draws which use it are skipped until it's ready
+		CompileJob job;
+		job.uid = uid;
+		job.vcode = vcode.GetBuffer();
+		job.pcode = pcode.GetBuffer();
+		if (gcode.GetBuffer())
+			job.gcode = gcode.GetBuffer();
+
+		{
+			std::lock_guard<std::mutex> lk(s_async_jobs_lock);
+			s_async_jobs.push_back(std::move(job));
+		}
+		s_compiler_wakeup.Set();
+		return nullptr;
+	}
+
 	if (!CompileShader(newentry.shader, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer()))
 	{
 		GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
 		return nullptr;
 	}
 
+	RecordShaderUid(uid, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer());
+
 	INCSTAT(stats.numPixelShadersCreated);
 	SETSTAT(stats.numPixelShadersAlive, pshaders.size());
 	GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
@@ -244,6 +401,15 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 }
 
 bool ProgramShaderCache::CompileShader(SHADER& shader, const char* vcode, const char* pcode, const char* gcode)
+{
+	if (!CompileProgram(shader, vcode, pcode, gcode))
+		return false;
+
+	shader.SetProgramVariables();
+	return true;
+}
+
+bool ProgramShaderCache::CompileProgram(SHADER& shader, const char* vcode, const char* pcode, const char* gcode)
 {
 	GLuint vsid = CompileSingleShader(GL_VERTEX_SHADER, vcode);
 	GLuint psid = CompileSingleShader(GL_FRAGMENT_SHADER, pcode);
@@ -319,11 +485,10 @@ bool ProgramShaderCache::CompileShader(SHADER& shader, const char* vcode, const
 
 		// Don't try to use this shader
 		glDeleteProgram(pid);
+		shader.glprogid = 0;
 		return false;
 	}
 
-	shader.SetProgramVariables();
-
 	return true;
 }
 
@@ -426,6 +591,30 @@ void ProgramShaderCache::Init()
 	// Then once more to get bytes
 	s_buffer = StreamBuffer::Create(GL_UNIFORM_BUFFER, UBO_LENGTH);
 
+	// Most draws only change a few constants, e.g. a single matrix. Rather
+	// than streaming both blocks as a whole, only the changed range of each
+	// is streamed and then copied into a buffer which stays bound.
+	if (GLExtensions::Supports("GL_ARB_copy_buffer"))
+	{
+		glGenBuffers(1, &s_constant_buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, s_constant_buffer);
+		glBufferData(GL_COPY_WRITE_BUFFER, s_ubo_buffer_size, nullptr, GL_DYNAMIC_DRAW);
+		glBindBufferRange(GL_UNIFORM_BUFFER, 1, s_constant_buffer, 0,
+					sizeof(PixelShaderConstants));
+		glBindBufferRange(GL_UNIFORM_BUFFER, 2, s_constant_buffer, ROUND_UP(sizeof(PixelShaderConstants), s_ubo_align),
+					sizeof(VertexShaderConstants));
+
+		// glBindBufferRange also changes the generic binding, but the stream
+		// buffer expects to stay bound there.
+		glBindBuffer(GL_UNIFORM_BUFFER, s_buffer->m_buffer);
+
+		// The new buffer doesn't hold anything yet.
+		PixelShaderManager::dirty = true;
+		PixelShaderManager::dirty_range.Add(0, sizeof(PixelShaderConstants));
+		VertexShaderManager::dirty = true;
+		VertexShaderManager::dirty_range.Add(0, sizeof(VertexShaderConstants));
+	}
+
 	// Read our shader cache, only if supported
 	if (g_ogl_config.bSupportsGLSLCache && !g_Config.bEnableShaderDebugging)
 	{
@@ -454,16 +643,53 @@ void ProgramShaderCache::Init()
 
 	CurrentProgram = 0;
 	last_entry = nullptr;
+
+	// Read the shaders of earlier sessions, this has to be done after the
+	// binary cache so those aren't compiled again.
+	if (!g_Config.bEnableShaderDebugging)
+	{
+		if (!File::Exists(File::GetUserPath(D_SHADERCACHE_IDX)))
+			File::CreateDir(File::GetUserPath(D_SHADERCACHE_IDX));
+
+		std::string uid_filename = StringFromFormat("%sogl-%s-uids.cache", File::GetUserPath(D_SHADERCACHE_IDX).c_str(),
+			SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID.c_str());
+
+		s_source_hash = GetSourceHash();
+		ShaderUidCacheInserter inserter;
+		s_uid_disk_cache.OpenAndRead(uid_filename, inserter);
+		s_uid_disk_cache_open = true;
+
+		StartShaderCompiler();
+	}
 }
 
 void ProgramShaderCache::Shutdown()
 {
+	// Keep what was compiled so far, so it ends up in the binary cache
+	if (s_compiler_thread.joinable())
+	{
+		s_compiler_quit.Set();
+		s_compiler_wakeup.Set();
+		s_compiler_thread.join();
+		RetrieveCompiledShaders();
+	}
+	s_precompile_jobs.clear();
+	s_async_jobs.clear();
+
+	if (s_uid_disk_cache_open)
+	{
+		s_uid_disk_cache.Sync();
+		s_uid_disk_cache.Close();
+		s_uid_disk_cache_open = false;
+	}
+	s_known_uids.clear();
+
 	// store all shaders in cache on disk
 	if (g_ogl_config.bSupportsGLSLCache && !g_Config.bEnableShaderDebugging)
 	{
 		for (auto& entry : pshaders)
 		{
-			if (entry.second.in_cache)
+			if (entry.second.in_cache || !entry.second.shader.glprogid)
 			{
 				continue;
 			}
@@ -501,6 +727,12 @@ void ProgramShaderCache::Shutdown()
 
 	delete s_buffer;
 	s_buffer = nullptr;
+
+	if (s_constant_buffer)
+	{
+		glDeleteBuffers(1, &s_constant_buffer);
+		s_constant_buffer = 0;
+	}
 }
 
 void ProgramShaderCache::CreateHeader()
@@ -589,5 +821,268 @@ void ProgramShaderCache::ProgramShaderCacheInserter::Read(const SHADERUID& key,
 	}
 }
 
+void ProgramShaderCache::ShaderUidCacheInserter::Read(const SHADERUID& key, const u8* value, u32 value_size)
+{
+	// Skip shaders which were generated for a GPU with other features
+	u64 hash;
+	if (value_size < sizeof(hash))
+		return;
+	memcpy(&hash, value, sizeof(hash));
+	if (hash != s_source_hash)
+		return;
+
+	// Followed by the null terminated vertex, pixel and geometry shader code
+	std::string code[3];
+	const char* ptr = (const char*)value + sizeof(hash);
+	const char* end = (const char*)value + value_size;
+	for (std::string& str : code)
+	{
+		const char* str_end = std::find(ptr, end, '\0');
+		if (str_end == end)
+			return;
+		str.assign(ptr, str_end);
+		ptr = str_end + 1;
+	}
+
+	s_known_uids.insert(key);
+	if (pshaders.find(key) != pshaders.end())
+		return;
+
+	CompileJob job;
+	job.uid = key;
+	job.vcode = std::move(code[0]);
+	job.pcode = std::move(code[1]);
+	job.gcode = std::move(code[2]);
+	s_precompile_jobs.push_back(std::move(job));
+}
+
+void ProgramShaderCache::RecordShaderUid(const SHADERUID& uid, const char* vcode, const char* pcode, const char* gcode)
+{
+	if (!s_uid_disk_cache_open || !s_known_uids.insert(uid).second)
+		return;
+
+	std::vector<u8> data(sizeof(s_source_hash));
+	memcpy(data.data(), &s_source_hash, sizeof(s_source_hash));
+	for (const char* code : { vcode, pcode, gcode })
+	{
+		if (code)
+			data.insert(data.end(), code, code + strlen(code));
+		data.push_back(0);
+	}
+
+	s_uid_disk_cache.Append(uid, data.data(), (u32)data.size());
+}
+
+void ProgramShaderCache::StartShaderCompiler()
+{
+	if (!g_ActiveConfig.bPrecompileShaders)
+		s_precompile_jobs.clear();
+
+	s_compiler_persistent = g_ActiveConfig.bAsyncShaderCompilation;
+	if (s_precompile_jobs.empty() && !s_compiler_persistent)
+		return;
+
+	s_precompile_start_time = Common::Timer::GetTimeMs();
+	s_next_precompile_job = 0;
+	s_precompile_done = 0;
+	s_precompile_reported = 0;
+	s_precompile_finished.Clear();
+	s_compiler_quit.Clear();
+	s_compiler_exited.Clear();
+	s_compiler_broken.Clear();
+
+	s_compiler_context.reset(GLInterface->CreateSharedContext());
+	if (s_compiler_context)
+	{
+		s_precompiling = !s_precompile_jobs.empty();
+		if (s_precompiling)
+			OSD::AddMessage(StringFromFormat("Precompiling %d shaders...", (int)s_precompile_jobs.size()), 5000);
+
+		s_compiler_thread = std::thread(ShaderCompilerThread);
+		return;
+	}
+
+	if (s_compiler_persistent)
+		WARN_LOG(VIDEO, "No shared context available, shaders are compiled synchronously.");
+
+	// Without a second context everything is compiled right away. Booting
+	// takes longer, but the game doesn't stutter later on.
+	for (const CompileJob& job : s_precompile_jobs)
+	{
+		SHADER shader;
+		if (!CompileShader(shader, job.vcode.c_str(), job.pcode.c_str(), job.gcode.empty() ? nullptr : job.gcode.c_str()))
+			continue;
+
+		PCacheEntry& entry = pshaders[job.uid];
+		entry.shader = shader;
+		entry.in_cache = 0;
+		entry.precompiled = true;
+		INCSTAT(stats.numShadersPrecompiled);
+	}
+	SETSTAT(stats.numPixelShadersAlive, pshaders.size());
+
+	if (!s_precompile_jobs.empty())
+	{
+		NOTICE_LOG(VIDEO, "Precompiled %d shaders in %u ms", (int)s_precompile_jobs.size(),
+			Common::Timer::GetTimeMs() - s_precompile_start_time);
+	}
+	s_precompile_jobs.clear();
+}
+
+void ProgramShaderCache::ShaderCompilerThread()
+{
+	Common::SetCurrentThreadName("Shader compiler");
+
+	const bool context_current = s_compiler_context->MakeCurrent();
+	if (!context_current)
+	{
+		// The jobs are still handed back, so waiting draws aren't skipped forever
+		ERROR_LOG(VIDEO, "Unable to make the shader compiler context current.");
+		s_compiler_broken.Set();
+	}
+
+	while (!s_compiler_quit.IsSet())
+	{
+		CompiledProgram program;
+		bool have_job = false;
+		{
+			std::lock_guard<std::mutex> lk(s_async_jobs_lock);
+			if (!s_async_jobs.empty())
+			{
+				program.job = std::move(s_async_jobs.front());
+				program.precompiled = false;
+				s_async_jobs.pop_front();
+				have_job = true;
+			}
+		}
+
+		if (!have_job && s_next_precompile_job < s_precompile_jobs.size())
+		{
+			program.job = std::move(s_precompile_jobs[s_next_precompile_job++]);
+			program.precompiled = true;
+			have_job = true;
+		}
+
+		if (!have_job)
+		{
+			if (!s_compiler_persistent)
+				break;
+
+			s_compiler_wakeup.Wait();
+			continue;
+		}
+
+		const CompileJob& job = program.job;
+		if (context_current &&
+		    CompileProgram(program.shader, job.vcode.c_str(), job.pcode.c_str(), job.gcode.empty() ? nullptr : job.gcode.c_str()))
+		{
+			// The program has to be complete before the GPU thread uses it.
+			glFinish();
+		}
+
+		const bool precompiled = program.precompiled;
+		if (!precompiled || program.shader.glprogid)
+		{
+			std::lock_guard<std::mutex> lk(s_compiled_lock);
+			s_compiled.push_back(std::move(program));
+		}
+
+		if (precompiled)
+		{
+			s_precompile_done++;
+			if (s_next_precompile_job == s_precompile_jobs.size())
+				s_precompile_finished.Set();
+		}
+	}
+
+	if (context_current)
+		s_compiler_context->ClearCurrent();
+
+	s_compiler_exited.Set();
+}
+
+void ProgramShaderCache::RetrieveCompiledShaders()
+{
+	if (!s_compiler_context)
+		return;
+
+	// Checked first, no programs are added once this is set.
+	const bool exited = s_compiler_exited.IsSet();
+	if (exited && s_compiler_thread.joinable())
+		s_compiler_thread.join();
+
+	std::vector<CompiledProgram> programs;
+	{
+		std::lock_guard<std::mutex> lk(s_compiled_lock);
+		programs.swap(s_compiled);
+	}
+
+	for (CompiledProgram& program : programs)
+	{
+		const CompileJob& job = program.job;
+		PCache::iterator iter = pshaders.find(job.uid);
+
+		if (!program.shader.glprogid)
+		{
+			// Without a usable context, compile it on the GPU thread next time
+			if (s_compiler_broken.IsSet() && iter != pshaders.end() && !iter->second.shader.glprogid)
+			{
+				if (last_entry == &iter->second)
+					last_entry = nullptr;
+				pshaders.erase(iter);
+			}
+			continue;
+		}
+
+		// Compiled twice, or not needed any more
+		if ((iter != pshaders.end() && iter->second.shader.glprogid) ||
+		    (iter == pshaders.end() && !program.precompiled))
+		{
+			program.shader.Destroy();
+			continue;
+		}
+
+		PCacheEntry& entry = pshaders[job.uid];
+		entry.shader = program.shader;
+		entry.in_cache = 0;
+		entry.precompiled = program.precompiled;
+		entry.shader.SetProgramVariables();
+
+		if (program.precompiled)
+		{
+			INCSTAT(stats.numShadersPrecompiled);
+		}
+		else
+		{
+			RecordShaderUid(job.uid, job.vcode.c_str(), job.pcode.c_str(), job.gcode.empty() ? nullptr : job.gcode.c_str());
+			INCSTAT(stats.numPixelShadersCreated);
+			INCSTAT(stats.numShadersCompiledAsync);
+		}
+	}
+	SETSTAT(stats.numPixelShadersAlive, pshaders.size());
+
+	if (s_precompiling)
+	{
+		const int total = (int)s_precompile_jobs.size();
+		if (s_precompile_finished.IsSet() || exited)
+		{
+			OSD::AddMessage(StringFromFormat("Precompiled %d of %d shaders in %u ms", (int)s_precompile_done, total,
+				Common::Timer::GetTimeMs() - s_precompile_start_time), 5000);
+			s_precompiling = false;
+		}
+		else if (s_precompile_done * 4 / total > s_precompile_reported)
+		{
+			s_precompile_reported = s_precompile_done * 4 / total;
+			OSD::AddMessage(StringFromFormat("Precompiling shaders: %d/%d", (int)s_precompile_done, total), 2000);
+		}
+	}
+
+	if (exited)
+	{
+		s_compiler_context->Shutdown();
+		s_compiler_context.reset();
+		s_precompile_jobs.clear();
+	}
+}
 
 } // namespace OGL
@@ -77,6 +77,7 @@ public:
 	{
 		SHADER shader;
 		bool in_cache;
+		bool precompiled; // compiled in the background and not used yet
 
 		void Destroy()
 		{
@@ -99,6 +100,10 @@ public:
 	static void Shutdown();
 	static void CreateHeader();
 
+	// Moves the programs which were compiled in the background into the
+	// cache. Called once per frame.
+	static void RetrieveCompiledShaders();
+
 private:
 	class ProgramShaderCacheInserter : public LinearDiskCacheReader<SHADERUID, u8>
 	{
@@ -106,6 +111,19 @@ private:
 		void Read(const SHADERUID &key, const u8 *value, u32 value_size) override;
 	};
 
+	// Reads the shaders a game used in earlier sessions, to compile them at boot.
+	class ShaderUidCacheInserter : public LinearDiskCacheReader<SHADERUID, u8>
+	{
+	public:
+		void Read(const SHADERUID &key, const u8 *value, u32 value_size) override;
+	};
+
+	// CompileShader without SetProgramVariables, which needs the GPU thread.
+	static bool CompileProgram(SHADER &shader, const char* vcode, const char* pcode, const char* gcode);
+	static void StartShaderCompiler();
+	static void ShaderCompilerThread();
+	static void RecordShaderUid(const SHADERUID& uid, const char* vcode, const char* pcode, const char* gcode);
+
 	static PCache pshaders;
 	static PCacheEntry* last_entry;
 	static SHADERUID last_uid;
@@ -19,9 +19,12 @@
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/CoreTiming.h"
 #include "Core/Movie.h"
 
 #include "VideoBackends/OGL/BoundingBox.h"
+#include "VideoBackends/OGL/EFBPeekCache.h"
+#include "VideoBackends/OGL/FrameDumpReader.h"
 #include "VideoBackends/OGL/FramebufferManager.h"
 #include "VideoBackends/OGL/GLInterfaceBase.h"
 #include "VideoBackends/OGL/GLUtil.h"
@@ -31,6 +34,7 @@
 #include "VideoBackends/OGL/RasterFont.h"
 #include "VideoBackends/OGL/Render.h"
 #include "VideoBackends/OGL/SamplerCache.h"
+#include "VideoBackends/OGL/StateManager.h"
 #include "VideoBackends/OGL/StreamBuffer.h"
 #include "VideoBackends/OGL/TextureCache.h"
 #include "VideoBackends/OGL/TextureConverter.h"
@@ -41,7 +45,8 @@
 #include "VideoCommon/DriverDetails.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/FPSCounter.h"
-#include "VideoCommon/ImageWrite.h"
+#include "VideoCommon/FrameDumpThread.h"
+#include "VideoCommon/ImageWriteQueue.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/Statistics.h"
@@ -92,7 +97,8 @@ static int s_LastMultisampleMode = 0;
 
 static bool s_LastStereo = false;
 
-static u32 s_blendMode;
+// The state draws of the emulated GPU use, it's applied right before them.
+static RenderState s_gx_state;
 
 static bool s_vsync;
 
@@ -103,6 +109,8 @@ static const u32 EFB_CACHE_HEIGHT = (EFB_HEIGHT + EFB_CACHE_RECT_SIZE - 1) / EFB
 static bool s_efbCacheValid[2][EFB_CACHE_WIDTH * EFB_CACHE_HEIGHT];
 static bool s_efbCacheIsCleared = false;
 static std::vector<u32> s_efbCache[2][EFB_CACHE_WIDTH * EFB_CACHE_HEIGHT]; // 2 for PEEK_Z and PEEK_COLOR
+static EFBPeekCache* s_efb_peek_cache = nullptr;
+static FrameDumpReader* s_frame_dump_reader = nullptr;
 
 static int GetNumMSAASamples(int MSAAMode)
 {
@@ -362,7 +370,8 @@ Renderer::Renderer()
 	OSDInternalH = 0;
 
 	s_ShowEFBCopyRegions_VBO = 0;
-	s_blendMode = 0;
+	s_gx_state = RenderState();
+	s_gx_state.scissor_test = true;
 
 	bool bSuccess = true;
 
@@ -646,6 +655,8 @@ Renderer::Renderer()
 	glBlendColor(0, 0, 0, 0.5f);
 	glClearDepthf(1.0f);
 
+	StateManager::Init();
+
 	if (g_ActiveConfig.backend_info.bSupportsPrimitiveRestart)
 	{
 		if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3)
@@ -674,6 +685,18 @@ Renderer::~Renderer()
 {
 }
 
+// Called by the frame dump reader once a frame was read back. Skipped frames
+// aren't dumped again: the dumpers keep showing the previous frame until the
+// emulated time of the next one.
+static void DumpFrame(const u8* data, int w, int h, u64 ticks)
+{
+#if defined(HAVE_LIBAV) || defined(_WIN32)
+	AVIDump::AddFrame(data, w, h, ticks);
+#else
+	FrameDumpThread::AddFrame(data, w, h, 3, w * 3, ticks, 1);
+#endif
+}
+
 void Renderer::Shutdown()
 {
 	delete g_framebuffer_manager;
@@ -687,6 +710,12 @@ void Renderer::Shutdown()
 
 	delete s_pfont;
 	s_pfont = nullptr;
+	delete s_efb_peek_cache;
+	s_efb_peek_cache = nullptr;
+	// The last dumped frame is still in the pixel buffers
+	s_frame_dump_reader->Flush(DumpFrame);
+	delete s_frame_dump_reader;
+	s_frame_dump_reader = nullptr;
 	s_ShowEFBCopyRegions.Destroy();
 
 	delete m_post_processor;
@@ -704,6 +733,8 @@ void Renderer::Init()
 	m_post_processor = new OpenGLPostProcessing();
 
 	s_pfont = new RasterFont();
+	s_efb_peek_cache = new EFBPeekCache();
+	s_frame_dump_reader = new FrameDumpReader();
 
 	ProgramShaderCache::CompileShader(s_ShowEFBCopyRegions,
 		"in vec2 rawpos;\n"
@@ -942,15 +973,16 @@ void Renderer::SetScissorRect(const EFBRectangle& rc)
 void Renderer::SetColorMask()
 {
 	// Only enable alpha channel if it's supported by the current EFB format
-	GLenum ColorMask = GL_FALSE, AlphaMask = GL_FALSE;
+	bool ColorMask = false, AlphaMask = false;
 	if (bpmem.alpha_test.TestResult() != AlphaTest::FAIL)
 	{
 		if (bpmem.blendmode.colorupdate)
-			ColorMask = GL_TRUE;
+			ColorMask = true;
 		if (bpmem.blendmode.alphaupdate && (bpmem.zcontrol.pixel_format == PEControl::RGBA6_Z24))
-			AlphaMask = GL_TRUE;
+			AlphaMask = true;
 	}
-	glColorMask(ColorMask,  ColorMask,  ColorMask,  AlphaMask);
+	s_gx_state.color_write = ColorMask;
+	s_gx_state.alpha_write = AlphaMask;
 }
 
 void ClearEFBCache()
@@ -1040,32 +1072,37 @@ u32 Renderer::AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data)
 		{
 			u32 z;
 
-			if (!s_efbCacheValid[0][cacheRectIdx])
+			INCSTAT(stats.thisFrame.numEFBPeeks);
+			if (!g_ActiveConfig.bEFBFastAccess || !s_efb_peek_cache->Peek(type, x, y, &z))
 			{
-				if (s_MSAASamples > 1)
+				if (!s_efbCacheValid[0][cacheRectIdx])
 				{
-					g_renderer->ResetAPIState();
+					INCSTAT(stats.thisFrame.numEFBPeekStalls);
+					if (s_MSAASamples > 1)
+					{
+						g_renderer->ResetAPIState();
 
-					// Resolve our rectangle.
-					FramebufferManager::GetEFBDepthTexture(efbPixelRc);
-					glBindFramebuffer(GL_READ_FRAMEBUFFER, FramebufferManager::GetResolvedFramebuffer());
+						// Resolve our rectangle.
+						FramebufferManager::GetEFBDepthTexture(efbPixelRc);
+						glBindFramebuffer(GL_READ_FRAMEBUFFER, FramebufferManager::GetResolvedFramebuffer());
 
-					g_renderer->RestoreAPIState();
-				}
+						g_renderer->RestoreAPIState();
+					}
 
-				u32* depthMap = new u32[targetPixelRcWidth * targetPixelRcHeight];
+					u32* depthMap = new u32[targetPixelRcWidth * targetPixelRcHeight];
 
-				glReadPixels(targetPixelRc.left, targetPixelRc.bottom, targetPixelRcWidth, targetPixelRcHeight,
-				             GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, depthMap);
+					glReadPixels(targetPixelRc.left, targetPixelRc.bottom, targetPixelRcWidth, targetPixelRcHeight,
+					             GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, depthMap);
 
-				UpdateEFBCache(type, cacheRectIdx, efbPixelRc, targetPixelRc, depthMap);
+					UpdateEFBCache(type, cacheRectIdx, efbPixelRc, targetPixelRc, depthMap);
 
-				delete[] depthMap;
-			}
+					delete[] depthMap;
+				}
 
-			u32 xRect = x % EFB_CACHE_RECT_SIZE;
-			u32 yRect = y % EFB_CACHE_RECT_SIZE;
-			z = s_efbCache[0][cacheRectIdx][yRect * EFB_CACHE_RECT_SIZE + xRect];
+				u32 xRect = x % EFB_CACHE_RECT_SIZE;
+				u32 yRect = y % EFB_CACHE_RECT_SIZE;
+				z = s_efbCache[0][cacheRectIdx][yRect * EFB_CACHE_RECT_SIZE + xRect];
+			}
 
 			// Scale the 32-bit value returned by glReadPixels to a 24-bit
 			// value (GC uses a 24-bit Z-buffer).
@@ -1092,37 +1129,42 @@ u32 Renderer::AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data)
 
 			u32 color;
 
-			if (!s_efbCacheValid[1][cacheRectIdx])
+			INCSTAT(stats.thisFrame.numEFBPeeks);
+			if (!g_ActiveConfig.bEFBFastAccess || !s_efb_peek_cache->Peek(type, x, y, &color))
 			{
-				if (s_MSAASamples > 1)
+				if (!s_efbCacheValid[1][cacheRectIdx])
 				{
-					g_renderer->ResetAPIState();
+					INCSTAT(stats.thisFrame.numEFBPeekStalls);
+					if (s_MSAASamples > 1)
+					{
+						g_renderer->ResetAPIState();
 
-					// Resolve our rectangle.
-					FramebufferManager::GetEFBColorTexture(efbPixelRc);
-					glBindFramebuffer(GL_READ_FRAMEBUFFER, FramebufferManager::GetResolvedFramebuffer());
+						// Resolve our rectangle.
+						FramebufferManager::GetEFBColorTexture(efbPixelRc);
+						glBindFramebuffer(GL_READ_FRAMEBUFFER, FramebufferManager::GetResolvedFramebuffer());
 
-					g_renderer->RestoreAPIState();
-				}
+						g_renderer->RestoreAPIState();
+					}
 
-				u32* colorMap = new u32[targetPixelRcWidth * targetPixelRcHeight];
+					u32* colorMap = new u32[targetPixelRcWidth * targetPixelRcHeight];
 
-				if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3)
-				// XXX: Swap colours
-					glReadPixels(targetPixelRc.left, targetPixelRc.bottom, targetPixelRcWidth, targetPixelRcHeight,
-						     GL_RGBA, GL_UNSIGNED_BYTE, colorMap);
-				else
-					glReadPixels(targetPixelRc.left, targetPixelRc.bottom, targetPixelRcWidth, targetPixelRcHeight,
-						     GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, colorMap);
+					if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3)
+					// XXX: Swap colours
+						glReadPixels(targetPixelRc.left, targetPixelRc.bottom, targetPixelRcWidth, targetPixelRcHeight,
+							     GL_RGBA, GL_UNSIGNED_BYTE, colorMap);
+					else
+						glReadPixels(targetPixelRc.left, targetPixelRc.bottom, targetPixelRcWidth, targetPixelRcHeight,
+							     GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, colorMap);
 
-				UpdateEFBCache(type, cacheRectIdx, efbPixelRc, targetPixelRc, colorMap);
+					UpdateEFBCache(type, cacheRectIdx, efbPixelRc, targetPixelRc, colorMap);
 
-				delete[] colorMap;
-			}
+					delete[] colorMap;
+				}
 
-			u32 xRect = x % EFB_CACHE_RECT_SIZE;
-			u32 yRect = y % EFB_CACHE_RECT_SIZE;
-			color = s_efbCache[1][cacheRectIdx][yRect * EFB_CACHE_RECT_SIZE + xRect];
+				u32 xRect = x % EFB_CACHE_RECT_SIZE;
+				u32 yRect = y % EFB_CACHE_RECT_SIZE;
+				color = s_efbCache[1][cacheRectIdx][yRect * EFB_CACHE_RECT_SIZE + xRect];
+			}
 
 			// check what to do with the alpha channel (GX_PokeAlphaRead)
 			PixelEngine::UPEAlphaReadReg alpha_read_mode = PixelEngine::GetAlphaReadMode();
@@ -1157,52 +1199,64 @@ u32 Renderer::AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data)
 		}
 
 	case POKE_COLOR:
+	case POKE_Z:
 	{
-		ResetAPIState();
-
-		glClearColor(float((poke_data >> 16) & 0xFF) / 255.0f,
-		             float((poke_data >>  8) & 0xFF) / 255.0f,
-		             float((poke_data >>  0) & 0xFF) / 255.0f,
-		             float((poke_data >> 24) & 0xFF) / 255.0f);
-
-		glEnable(GL_SCISSOR_TEST);
-		glScissor(targetPixelRc.left, targetPixelRc.bottom, targetPixelRc.GetWidth(), targetPixelRc.GetHeight());
-
-		glClear(GL_COLOR_BUFFER_BIT);
-
-		RestoreAPIState();
-
-		// TODO: Could just update the EFB cache with the new value
-		ClearEFBCache();
+		EfbPokeData poke = { type, x, y, poke_data };
+		PokeEFB(&poke, 1);
+		break;
+	}
 
+	default:
 		break;
 	}
 
-	case POKE_Z:
-	{
-		ResetAPIState();
+	return 0;
+}
+
+void Renderer::PokeEFB(const EfbPokeData* pokes, size_t num_pokes)
+{
+	ResetAPIState();
 
-		glDepthMask(GL_TRUE);
-		glClearDepthf(float(poke_data & 0xFFFFFF) / float(0xFFFFFF));
+	RenderState state = GetResetState();
+	state.scissor_test = true;
+	state.depth_write = true;
+	StateManager::Apply(state);
 
-		glEnable(GL_SCISSOR_TEST);
+	for (size_t i = 0; i < num_pokes; i++)
+	{
+		const EfbPokeData& poke = pokes[i];
+		const u32 poke_data = poke.data;
+		TargetRectangle targetPixelRc = ConvertEFBRectangle(EFBRectangle(poke.x, poke.y, poke.x + 1, poke.y + 1));
 		glScissor(targetPixelRc.left, targetPixelRc.bottom, targetPixelRc.GetWidth(), targetPixelRc.GetHeight());
 
-		glClear(GL_DEPTH_BUFFER_BIT);
+		if (poke.type == POKE_COLOR)
+		{
+			glClearColor(float((poke_data >> 16) & 0xFF) / 255.0f,
+			             float((poke_data >>  8) & 0xFF) / 255.0f,
+			             float((poke_data >>  0) & 0xFF) / 255.0f,
+			             float((poke_data >> 24) & 0xFF) / 255.0f);
+			glClear(GL_COLOR_BUFFER_BIT);
+		}
+		else
+		{
+			glClearDepthf(float(poke_data & 0xFFFFFF) / float(0xFFFFFF));
+			glClear(GL_DEPTH_BUFFER_BIT);
+		}
 
-		RestoreAPIState();
+		s_efb_peek_cache->Poke(poke.type, poke.x, poke.y, poke_data);
+	}
 
-		// TODO: Could just update the EFB cache with the new value
-		ClearEFBCache();
+	RestoreAPIState();
 
-		break;
-	}
+	// TODO: Could just update the EFB cache with the new value
+	ClearEFBCache();
 
-	default:
-		break;
-	}
+	ADDSTAT(stats.thisFrame.numEFBPokes, num_pokes);
+}
 
-	return 0;
+void Renderer::PrefetchEFB()
+{
+	s_efb_peek_cache->QueueReadback();
 }
 
 u16 Renderer::BBoxRead(int index)
@@ -1302,11 +1356,13 @@ void Renderer::ClearScreen(const EFBRectangle& rc, bool colorEnable, bool alphaE
 {
 	ResetAPIState();
 
-	// color
-	GLboolean const
-		color_mask = colorEnable ? GL_TRUE : GL_FALSE,
-		alpha_mask = alphaEnable ? GL_TRUE : GL_FALSE;
-	glColorMask(color_mask,  color_mask,  color_mask,  alpha_mask);
+	// glColorMask/glDepthMask/glScissor affect glClear (glViewport does not)
+	RenderState state = GetResetState();
+	state.color_write = colorEnable;
+	state.alpha_write = alphaEnable;
+	state.depth_write = zEnable;
+	state.scissor_test = true;
+	StateManager::Apply(state);
 
 	glClearColor(
 		float((color >> 16) & 0xFF) / 255.0f,
@@ -1314,18 +1370,12 @@ void Renderer::ClearScreen(const EFBRectangle& rc, bool colorEnable, bool alphaE
 		float((color >> 0) & 0xFF) / 255.0f,
 		float((color >> 24) & 0xFF) / 255.0f);
 
-	// depth
-	glDepthMask(zEnable ? GL_TRUE : GL_FALSE);
-
 	glClearDepthf(float(z & 0xFFFFFF) / float(0xFFFFFF));
 
 	// Update rect for clearing the picture
-	glEnable(GL_SCISSOR_TEST);
-
 	TargetRectangle const targetRc = ConvertEFBRectangle(rc);
 	glScissor(targetRc.left, targetRc.bottom, targetRc.GetWidth(), targetRc.GetHeight());
 
-	// glColorMask/glDepthMask/glScissor affect glClear (glViewport does not)
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	RestoreAPIState();
@@ -1377,96 +1427,56 @@ void Renderer::SetBlendMode(bool forceUpdate)
 		(target_has_alpha) ? GL_ONE_MINUS_DST_ALPHA : (GLenum)GL_ZERO
 	};
 
-	// blend mode bit mask
-	// 0 - blend enable
-	// 1 - dst alpha enabled
-	// 2 - reverse subtract enable (else add)
-	// 3-5 - srcRGB function
-	// 6-8 - dstRGB function
-
-	u32 newval = useDualSource << 1;
-	newval |= bpmem.blendmode.subtract << 2;
-
+	RenderState& state = s_gx_state;
+	u32 srcidx, dstidx;
 	if (bpmem.blendmode.subtract)
 	{
-		newval |= 0x0049;   // enable blending src 1 dst 1
+		state.blend = true;
+		srcidx = BlendMode::ONE;
+		dstidx = BlendMode::ONE;
 	}
-	else if (bpmem.blendmode.blendenable)
+	else
 	{
-		newval |= 1;    // enable blending
-		newval |= bpmem.blendmode.srcfactor << 3;
-		newval |= bpmem.blendmode.dstfactor << 6;
+		state.blend = bpmem.blendmode.blendenable != 0;
+		srcidx = bpmem.blendmode.srcfactor;
+		dstidx = bpmem.blendmode.dstfactor;
 	}
 
-	u32 changes = forceUpdate ? 0xFFFFFFFF : newval ^ s_blendMode;
+	state.blend_op_rgb = bpmem.blendmode.subtract ? GL_FUNC_REVERSE_SUBTRACT : GL_FUNC_ADD;
+	state.blend_op_alpha = useDualSource ? GL_FUNC_ADD : state.blend_op_rgb;
 
-	if (changes & 1)
-	{
-		// blend enable change
-		(newval & 1) ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
-	}
+	state.src_factor_rgb = glSrcFactors[srcidx];
+	state.dst_factor_rgb = glDestFactors[dstidx];
 
-	if (changes & 4)
+	// adjust alpha factors
+	if (useDualSource)
 	{
-		// subtract enable change
-		GLenum equation = newval & 4 ? GL_FUNC_REVERSE_SUBTRACT : GL_FUNC_ADD;
-		GLenum equationAlpha = useDualSource ? GL_FUNC_ADD : equation;
-
-		glBlendEquationSeparate(equation, equationAlpha);
+		srcidx = BlendMode::ONE;
+		dstidx = BlendMode::ZERO;
 	}
-
-	if (changes & 0x1FA)
+	else
 	{
-		u32 srcidx = (newval >> 3) & 7;
-		u32 dstidx = (newval >> 6) & 7;
-		GLenum srcFactor = glSrcFactors[srcidx];
-		GLenum dstFactor = glDestFactors[dstidx];
-
-		// adjust alpha factors
-		if (useDualSource)
-		{
-			srcidx = BlendMode::ONE;
-			dstidx = BlendMode::ZERO;
-		}
-		else
-		{
-			// we can't use GL_DST_COLOR or GL_ONE_MINUS_DST_COLOR for source in alpha channel so use their alpha equivalent instead
-			if (srcidx == BlendMode::DSTCLR)
-				srcidx = BlendMode::DSTALPHA;
-			else if (srcidx == BlendMode::INVDSTCLR)
-				srcidx = BlendMode::INVDSTALPHA;
-
-			// we can't use GL_SRC_COLOR or GL_ONE_MINUS_SRC_COLOR for destination in alpha channel so use their alpha equivalent instead
-			if (dstidx == BlendMode::SRCCLR)
-				dstidx = BlendMode::SRCALPHA;
-			else if (dstidx == BlendMode::INVSRCCLR)
-				dstidx = BlendMode::INVSRCALPHA;
-		}
-		GLenum srcFactorAlpha = glSrcFactors[srcidx];
-		GLenum dstFactorAlpha = glDestFactors[dstidx];
-		// blend RGB change
-		glBlendFuncSeparate(srcFactor, dstFactor, srcFactorAlpha, dstFactorAlpha);
-	}
-	s_blendMode = newval;
-}
+		// we can't use GL_DST_COLOR or GL_ONE_MINUS_DST_COLOR for source in alpha channel so use their alpha equivalent instead
+		if (srcidx == BlendMode::DSTCLR)
+			srcidx = BlendMode::DSTALPHA;
+		else if (srcidx == BlendMode::INVDSTCLR)
+			srcidx = BlendMode::INVDSTALPHA;
 
-static void DumpFrame(const std::vector<u8>& data, int w, int h)
-{
-#if defined(HAVE_LIBAV) || defined(_WIN32)
-	if (SConfig::GetInstance().m_DumpFrames && !data.empty())
-	{
-		AVIDump::AddFrame(&data[0], w, h);
+		// we can't use GL_SRC_COLOR or GL_ONE_MINUS_SRC_COLOR for destination in alpha channel so use their alpha equivalent instead
+		if (dstidx == BlendMode::SRCCLR)
+			dstidx = BlendMode::SRCALPHA;
+		else if (dstidx == BlendMode::INVSRCCLR)
+			dstidx = BlendMode::INVSRCALPHA;
 	}
-#endif
+	state.src_factor_alpha = glSrcFactors[srcidx];
+	state.dst_factor_alpha = glDestFactors[dstidx];
 }
 
 // This function has the final picture. We adjust the aspect ratio here.
 void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const EFBRectangle& rc, float Gamma)
 {
-	static int w = 0, h = 0;
 	if (g_bSkipCurrentFrame || (!XFBWrited && !g_ActiveConfig.RealXFBEnabled()) || !fbWidth || !fbHeight)
 	{
-		DumpFrame(frame_data, w, h);
 		Core::Callback_VideoCopiedToXFB(false);
 		return;
 	}
@@ -1475,7 +1485,6 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 	const XFBSourceBase* const* xfbSourceList = FramebufferManager::GetXFBSource(xfbAddr, fbStride, fbHeight, &xfbCount);
 	if (g_ActiveConfig.VirtualXFBEnabled() && (!xfbSourceList || xfbCount == 0))
 	{
-		DumpFrame(frame_data, w, h);
 		Core::Callback_VideoCopiedToXFB(false);
 		return;
 	}
@@ -1581,15 +1590,8 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 		if (SConfig::GetInstance().m_DumpFrames)
 		{
 			std::lock_guard<std::mutex> lk(s_criticalScreenshot);
-			if (frame_data.empty() || w != flipped_trc.GetWidth() ||
-				     h != flipped_trc.GetHeight())
-			{
-				w = flipped_trc.GetWidth();
-				h = flipped_trc.GetHeight();
-				frame_data.resize(3 * w * h);
-			}
-			glPixelStorei(GL_PACK_ALIGNMENT, 1);
-			glReadPixels(flipped_trc.left, flipped_trc.bottom, w, h, GL_BGR, GL_UNSIGNED_BYTE, &frame_data[0]);
+			const int w = flipped_trc.GetWidth();
+			const int h = flipped_trc.GetHeight();
 			if (w > 0 && h > 0)
 			{
 				if (!bLastFrameDumped)
@@ -1611,13 +1613,7 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 					}
 				}
 				if (bAVIDumping)
-				{
-					#ifndef _WIN32
-						FlipImageData(&frame_data[0], w, h);
-					#endif
-
-						AVIDump::AddFrame(&frame_data[0], w, h);
-				}
+					s_frame_dump_reader->ReadFrame(flipped_trc, CoreTiming::GetTicks(), DumpFrame);
 
 				bLastFrameDumped = true;
 			}
@@ -1630,8 +1626,7 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 		{
 			if (bLastFrameDumped && bAVIDumping)
 			{
-				std::vector<u8>().swap(frame_data);
-				w = h = 0;
+				s_frame_dump_reader->Flush(DumpFrame);
 				AVIDump::Stop();
 				bAVIDumping = false;
 				OSD::AddMessage("Stop dumping frames", 2000);
@@ -1643,11 +1638,8 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 		{
 			std::lock_guard<std::mutex> lk(s_criticalScreenshot);
 			std::string movie_file_name;
-			w = GetTargetRectangle().GetWidth();
-			h = GetTargetRectangle().GetHeight();
-			frame_data.resize(3 * w * h);
-			glPixelStorei(GL_PACK_ALIGNMENT, 1);
-			glReadPixels(GetTargetRectangle().left, GetTargetRectangle().bottom, w, h, GL_BGR, GL_UNSIGNED_BYTE, &frame_data[0]);
+			const int w = GetTargetRectangle().GetWidth();
+			const int h = GetTargetRectangle().GetHeight();
 
 			if (!bLastFrameDumped)
 			{
@@ -1661,20 +1653,29 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 				else
 				{
 					OSD::AddMessage(StringFromFormat("Dumping Frames to \"%s\" (%dx%d RGB24)", movie_file_name.c_str(), w, h), 2000);
+
+					// The readback is bottom-up, so write the rows backwards
+					File::IOFile* file = &pFrameDump;
+					FrameDumpThread::Start([file](const FrameDumpThread::Frame& frame) {
+						const int row_size = frame.width * 3;
+						for (int y = frame.height - 1; y >= 0; --y)
+							file->WriteBytes(&frame.data[y * row_size], row_size);
+						file->Flush();
+					});
 				}
 			}
 			if (pFrameDump)
-			{
-				FlipImageData(&frame_data[0], w, h);
-				pFrameDump.WriteBytes(&frame_data[0], w * 3 * h);
-				pFrameDump.Flush();
-			}
+				s_frame_dump_reader->ReadFrame(GetTargetRectangle(), CoreTiming::GetTicks(), DumpFrame);
 			bLastFrameDumped = true;
 		}
 		else
 		{
 			if (bLastFrameDumped)
+			{
+				s_frame_dump_reader->Flush(DumpFrame);
+				FrameDumpThread::Stop();
 				pFrameDump.Close();
+			}
 			bLastFrameDumped = false;
 		}
 #endif
@@ -1727,8 +1728,12 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 	// ---------------------------------------------------------------------
 	if (!DriverDetails::HasBug(DriverDetails::BUG_BROKENSWAP))
 	{
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		RenderState state = GetResetState();
+		state.blend = true;
+		state.blend_op_rgb = state.blend_op_alpha = GL_FUNC_ADD;
+		state.src_factor_rgb = state.src_factor_alpha = GL_SRC_ALPHA;
+		state.dst_factor_rgb = state.dst_factor_alpha = GL_ONE_MINUS_SRC_ALPHA;
+		StateManager::Apply(state);
 
 		DrawDebugInfo();
 		DrawDebugText();
@@ -1755,6 +1760,7 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 
 	// Clean out old stuff from caches. It's not worth it to clean out the shader caches.
 	TextureCache::Cleanup();
+	ProgramShaderCache::RetrieveCompiledShaders();
 
 	// Render to the framebuffer.
 	FramebufferManager::SetFramebuffer(0);
@@ -1775,25 +1781,32 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 	ClearEFBCache();
 }
 
-// ALWAYS call RestoreAPIState for each ResetAPIState call you're doing
-void Renderer::ResetAPIState()
+RenderState Renderer::GetResetState()
 {
 	// Gets us to a reasonably sane state where it's possible to do things like
 	// image copies with textured quads, etc.
-	glDisable(GL_SCISSOR_TEST);
-	glDisable(GL_DEPTH_TEST);
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_BLEND);
-	if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGL)
-		glDisable(GL_COLOR_LOGIC_OP);
-	glDepthMask(GL_FALSE);
-	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	RenderState state = s_gx_state;
+	state.scissor_test = false;
+	state.depth_test = false;
+	state.cull_face = false;
+	state.blend = false;
+	state.logic_op = false;
+	state.depth_write = false;
+	state.color_write = true;
+	state.alpha_write = true;
+	return state;
+}
+
+// ALWAYS call RestoreAPIState for each ResetAPIState call you're doing
+void Renderer::ResetAPIState()
+{
+	StateManager::Apply(GetResetState());
 }
 
 void Renderer::RestoreAPIState()
 {
-	// Gets us back into a more game-like state.
-	glEnable(GL_SCISSOR_TEST);
+	// Gets us back into a more game-like state. The state itself is only
+	// applied by the next draw.
 	SetGenerationMode();
 	BPFunctions::SetScissor();
 	SetColorMask();
@@ -1816,16 +1829,9 @@ void Renderer::RestoreAPIState()
 void Renderer::SetGenerationMode()
 {
 	// none, ccw, cw, ccw
-	if (bpmem.genMode.cullmode > 0)
-	{
-		// TODO: GX_CULL_ALL not supported, yet!
-		glEnable(GL_CULL_FACE);
-		glFrontFace(bpmem.genMode.cullmode == 2 ? GL_CCW : GL_CW);
-	}
-	else
-	{
-		glDisable(GL_CULL_FACE);
-	}
+	// TODO: GX_CULL_ALL not supported, yet!
+	s_gx_state.cull_face = bpmem.genMode.cullmode > 0;
+	s_gx_state.front_face = bpmem.genMode.cullmode == 2 ? GL_CCW : GL_CW;
 }
 
 void Renderer::SetDepthMode()
@@ -1842,19 +1848,12 @@ void Renderer::SetDepthMode()
 		GL_ALWAYS
 	};
 
-	if (bpmem.zmode.testenable)
-	{
-		glEnable(GL_DEPTH_TEST);
-		glDepthMask(bpmem.zmode.updateenable ? GL_TRUE : GL_FALSE);
-		glDepthFunc(glCmpFuncs[bpmem.zmode.func]);
-	}
-	else
-	{
-		// if the test is disabled write is disabled too
-		// TODO: When PE performance metrics are being emulated via occlusion queries, we should (probably?) enable depth test with depth function ALWAYS here
-		glDisable(GL_DEPTH_TEST);
-		glDepthMask(GL_FALSE);
-	}
+	s_gx_state.depth_test = bpmem.zmode.testenable != 0;
+	s_gx_state.depth_func = glCmpFuncs[bpmem.zmode.func];
+
+	// if the test is disabled write is disabled too
+	// TODO: When PE performance metrics are being emulated via occlusion queries, we should (probably?) enable depth test with depth function ALWAYS here
+	s_gx_state.depth_write = bpmem.zmode.testenable && bpmem.zmode.updateenable;
 }
 
 void Renderer::SetLogicOpMode()
@@ -1882,23 +1881,31 @@ void Renderer::SetLogicOpMode()
 		GL_SET
 	};
 
-	if (bpmem.blendmode.logicopenable && !bpmem.blendmode.blendenable)
-	{
-		glEnable(GL_COLOR_LOGIC_OP);
-		glLogicOp(glLogicOpCodes[bpmem.blendmode.logicmode]);
-	}
-	else
-	{
-		glDisable(GL_COLOR_LOGIC_OP);
-	}
+	s_gx_state.logic_op = bpmem.blendmode.logicopenable && !bpmem.blendmode.blendenable;
+	s_gx_state.logic_op_mode = glLogicOpCodes[bpmem.blendmode.logicmode];
 }
 
 void Renderer::SetDitherMode()
 {
-	if (bpmem.blendmode.dither)
-		glEnable(GL_DITHER);
+	s_gx_state.dither = bpmem.blendmode.dither != 0;
+}
+
+void Renderer::ApplyState(bool bUseDstAlpha)
+{
+	if (bUseDstAlpha)
+	{
+		// The second pass of destination alpha without dual source blending
+		// only writes alpha.
+		RenderState state = s_gx_state;
+		state.color_write = false;
+		state.alpha_write = true;
+		state.blend = false;
+		StateManager::Apply(state);
+	}
 	else
-		glDisable(GL_DITHER);
+	{
+		StateManager::Apply(s_gx_state);
+	}
 }
 
 void Renderer::SetLineWidth()
@@ -1956,7 +1963,7 @@ bool Renderer::SaveScreenshot(const std::string &filename, const TargetRectangle
 	// Turn image upside down
 	FlipImageData(data.get(), W, H, 4);
 
-	return TextureToPng(data.get(), W * 4, filename, W, H, false);
+	return ImageWriteQueue::TextureToPng(data.get(), W * 4, filename, W, H, false, ImageWriteQueue::WAIT_IF_FULL);
 
 }
 
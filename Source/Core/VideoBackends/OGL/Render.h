@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include "VideoBackends/OGL/StateManager.h"
 #include "VideoCommon/RenderBase.h"
 
 namespace OGL
@@ -62,8 +63,10 @@ public:
 	void SetInterlacingMode() override;
 	void SetViewport() override;
 
-	// TODO: Implement and use these
-	void ApplyState(bool bUseDstAlpha) override {}
+	// Applies the state set by the functions above. bUseDstAlpha selects the
+	// state of the extra pass which only writes destination alpha.
+	void ApplyState(bool bUseDstAlpha) override;
+	// The next ApplyState or ResetAPIState changes whatever differs.
 	void RestoreState() override {}
 
 	void RenderText(const std::string& text, int left, int top, u32 color) override;
@@ -71,6 +74,8 @@ public:
 	void FlipImageData(u8 *data, int w, int h, int pixel_width = 3);
 
 	u32 AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data) override;
+	void PokeEFB(const EfbPokeData* pokes, size_t num_pokes) override;
+	void PrefetchEFB() override;
 
 	u16 BBoxRead(int index) override;
 	void BBoxWrite(int index, u16 value) override;
@@ -91,6 +96,9 @@ public:
 	int GetMaxTextureSize() override;
 
 private:
+	// The state ResetAPIState applies, for changing it further.
+	static RenderState GetResetState();
+
 	void UpdateEFBCache(EFBAccessType type, u32 cacheRectIdx, const EFBRectangle& efbPixelRc, const TargetRectangle& targetPixelRc, const u32* data);
 };
 
@@ -0,0 +1,169 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "VideoBackends/OGL/GLInterfaceBase.h"
+#include "VideoBackends/OGL/StateManager.h"
+#include "VideoCommon/Statistics.h"
+
+namespace OGL
+{
+
+RenderState::RenderState()
+	: scissor_test(false)
+	, cull_face(false)
+	, front_face(GL_CCW)
+	, depth_test(false)
+	, depth_write(true)
+	, depth_func(GL_LESS)
+	, blend(false)
+	, blend_op_rgb(GL_FUNC_ADD)
+	, blend_op_alpha(GL_FUNC_ADD)
+	, src_factor_rgb(GL_ONE)
+	, dst_factor_rgb(GL_ZERO)
+	, src_factor_alpha(GL_ONE)
+	, dst_factor_alpha(GL_ZERO)
+	, logic_op(false)
+	, logic_op_mode(GL_COPY)
+	, dither(true)
+	, color_write(true)
+	, alpha_write(true)
+{
+}
+
+namespace StateManager
+{
+
+// No valid value of any of the enums.
+static const GLenum UNKNOWN_ENUM = 0xFFFFFFFF;
+
+static RenderState s_current;
+// Whether the capabilities and write masks in s_current are known, the
+// enums use UNKNOWN_ENUM instead.
+static bool s_current_valid;
+static bool s_supports_logic_op;
+
+static void SetCapability(GLenum cap, bool enable)
+{
+	if (enable)
+		glEnable(cap);
+	else
+		glDisable(cap);
+	INCSTAT(stats.thisFrame.numGLStateCalls);
+}
+
+void Init()
+{
+	// Logic ops aren't available in GLES
+	s_supports_logic_op = GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGL;
+	Invalidate();
+}
+
+void Invalidate()
+{
+	s_current_valid = false;
+	s_current.front_face = UNKNOWN_ENUM;
+	s_current.depth_func = UNKNOWN_ENUM;
+	s_current.blend_op_rgb = UNKNOWN_ENUM;
+	s_current.blend_op_alpha = UNKNOWN_ENUM;
+	s_current.src_factor_rgb = UNKNOWN_ENUM;
+	s_current.dst_factor_rgb = UNKNOWN_ENUM;
+	s_current.src_factor_alpha = UNKNOWN_ENUM;
+	s_current.dst_factor_alpha = UNKNOWN_ENUM;
+	s_current.logic_op_mode = UNKNOWN_ENUM;
+}
+
+void Apply(const RenderState& state)
+{
+	const bool force = !s_current_valid;
+
+	if (force || state.scissor_test != s_current.scissor_test)
+		SetCapability(GL_SCISSOR_TEST, state.scissor_test);
+
+	if (force || state.cull_face != s_current.cull_face)
+		SetCapability(GL_CULL_FACE, state.cull_face);
+	if (state.cull_face && state.front_face != s_current.front_face)
+	{
+		glFrontFace(state.front_face);
+		INCSTAT(stats.thisFrame.numGLStateCalls);
+		s_current.front_face = state.front_face;
+	}
+
+	if (force || state.depth_test != s_current.depth_test)
+		SetCapability(GL_DEPTH_TEST, state.depth_test);
+	if (force || state.depth_write != s_current.depth_write)
+	{
+		glDepthMask(state.depth_write ? GL_TRUE : GL_FALSE);
+		INCSTAT(stats.thisFrame.numGLStateCalls);
+	}
+	if (state.depth_test && state.depth_func != s_current.depth_func)
+	{
+		glDepthFunc(state.depth_func);
+		INCSTAT(stats.thisFrame.numGLStateCalls);
+		s_current.depth_func = state.depth_func;
+	}
+
+	if (force || state.blend != s_current.blend)
+		SetCapability(GL_BLEND, state.blend);
+	if (state.blend)
+	{
+		if (state.blend_op_rgb != s_current.blend_op_rgb ||
+		    state.blend_op_alpha != s_current.blend_op_alpha)
+		{
+			glBlendEquationSeparate(state.blend_op_rgb, state.blend_op_alpha);
+			INCSTAT(stats.thisFrame.numGLStateCalls);
+			s_current.blend_op_rgb = state.blend_op_rgb;
+			s_current.blend_op_alpha = state.blend_op_alpha;
+		}
+		if (state.src_factor_rgb != s_current.src_factor_rgb ||
+		    state.dst_factor_rgb != s_current.dst_factor_rgb ||
+		    state.src_factor_alpha != s_current.src_factor_alpha ||
+		    state.dst_factor_alpha != s_current.dst_factor_alpha)
+		{
+			glBlendFuncSeparate(state.src_factor_rgb, state.dst_factor_rgb,
+			                    state.src_factor_alpha, state.dst_factor_alpha);
+			INCSTAT(stats.thisFrame.numGLStateCalls);
+			s_current.src_factor_rgb = state.src_factor_rgb;
+			s_current.dst_factor_rgb = state.dst_factor_rgb;
+			s_current.src_factor_alpha = state.src_factor_alpha;
+			s_current.dst_factor_alpha = state.dst_factor_alpha;
+		}
+	}
+
+	if (s_supports_logic_op)
+	{
+		if (force || state.logic_op != s_current.logic_op)
+			SetCapability(GL_COLOR_LOGIC_OP, state.logic_op);
+		if (state.logic_op && state.logic_op_mode != s_current.logic_op_mode)
+		{
+			glLogicOp(state.logic_op_mode);
+			INCSTAT(stats.thisFrame.numGLStateCalls);
+			s_current.logic_op_mode = state.logic_op_mode;
+		}
+	}
+
+	if (force || state.dither != s_current.dither)
+		SetCapability(GL_DITHER, state.dither);
+
+	if (force || state.color_write != s_current.color_write || state.alpha_write != s_current.alpha_write)
+	{
+		const GLboolean color = state.color_write ? GL_TRUE : GL_FALSE;
+		glColorMask(color, color, color, state.alpha_write ? GL_TRUE : GL_FALSE);
+		INCSTAT(stats.thisFrame.numGLStateCalls);
+	}
+
+	s_current.scissor_test = state.scissor_test;
+	s_current.cull_face = state.cull_face;
+	s_current.depth_test = state.depth_test;
+	s_current.depth_write = state.depth_write;
+	s_current.blend = state.blend;
+	s_current.logic_op = state.logic_op;
+	s_current.dither = state.dither;
+	s_current.color_write = state.color_write;
+	s_current.alpha_write = state.alpha_write;
+	s_current_valid = true;
+}
+
+}
+
+}
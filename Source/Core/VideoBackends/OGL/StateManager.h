@@ -0,0 +1,62 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "VideoBackends/OGL/GLUtil.h"
+
+namespace OGL
+{
+
+// The fixed function state which draws depend on. Parameters of disabled
+// state (e.g. the blend factors while blending is disabled) are ignored.
+struct RenderState
+{
+	// Initializes everything to the OpenGL defaults.
+	RenderState();
+
+	bool scissor_test;
+
+	bool cull_face;
+	GLenum front_face;
+
+	bool depth_test;
+	bool depth_write;
+	GLenum depth_func;
+
+	bool blend;
+	GLenum blend_op_rgb;
+	GLenum blend_op_alpha;
+	GLenum src_factor_rgb;
+	GLenum dst_factor_rgb;
+	GLenum src_factor_alpha;
+	GLenum dst_factor_alpha;
+
+	bool logic_op;
+	GLenum logic_op_mode;
+
+	bool dither;
+
+	bool color_write;
+	bool alpha_write;
+};
+
+// Remembers which state OpenGL is in. A whole RenderState can be applied for
+// every draw, but only the calls for what actually differs are made.
+// OpenGL has no pipeline objects, so unlike the D3D state cache there's
+// nothing to look up, the state is compared directly.
+namespace StateManager
+{
+
+void Init();
+
+// Forgets the current state, so the next Apply sets everything. Has to be
+// called after changing any of the state without going through Apply.
+void Invalidate();
+
+void Apply(const RenderState& state);
+
+}
+
+}
@@ -10,6 +10,7 @@
 
 #include "VideoCommon/DriverDetails.h"
 #include "VideoCommon/OnScreenDisplay.h"
+#include "VideoCommon/Statistics.h"
 
 namespace OGL
 {
@@ -83,6 +84,7 @@ void StreamBuffer::AllocMemory(u32 size)
 	for (int i = SLOT(m_used_iterator); i < SLOT(m_iterator); i++)
 	{
 		fences[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		INCSTAT(stats.thisFrame.numStreamingGLCalls);
 	}
 	m_used_iterator = m_iterator;
 
@@ -91,6 +93,7 @@ void StreamBuffer::AllocMemory(u32 size)
 	{
 		glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
 		glDeleteSync(fences[i]);
+		ADDSTAT(stats.thisFrame.numStreamingGLCalls, 2);
 	}
 	m_free_iterator = m_iterator + size;
 
@@ -101,6 +104,7 @@ void StreamBuffer::AllocMemory(u32 size)
 		for (int i = SLOT(m_used_iterator); i < SYNC_POINTS; i++)
 		{
 			fences[i] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			INCSTAT(stats.thisFrame.numStreamingGLCalls);
 		}
 
 		// move to the start
@@ -111,6 +115,7 @@ void StreamBuffer::AllocMemory(u32 size)
 		{
 			glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
 			glDeleteSync(fences[i]);
+			ADDSTAT(stats.thisFrame.numStreamingGLCalls, 2);
 		}
 		m_free_iterator = m_iterator + size;
 	}
@@ -142,16 +147,20 @@ public:
 		{
 			glBufferData(m_buffertype, m_size, nullptr, GL_STREAM_DRAW);
 			m_iterator = 0;
+			INCSTAT(stats.thisFrame.numStreamingGLCalls);
 		}
 		u8* pointer = (u8*)glMapBufferRange(m_buffertype, m_iterator, size,
 			GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		INCSTAT(stats.thisFrame.numStreamingGLCalls);
 		return std::make_pair(pointer, m_iterator);
 	}
 
 	void Unmap(u32 used_size) override
 	{
+		ADDSTAT(stats.thisFrame.bytesUploaded, used_size);
 		glFlushMappedBufferRange(m_buffertype, 0, used_size);
 		glUnmapBuffer(m_buffertype);
+		ADDSTAT(stats.thisFrame.numStreamingGLCalls, 2);
 		m_iterator += used_size;
 	}
 };
@@ -183,13 +192,16 @@ public:
 		AllocMemory(size);
 		u8* pointer = (u8*)glMapBufferRange(m_buffertype, m_iterator, size,
 			GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		INCSTAT(stats.thisFrame.numStreamingGLCalls);
 		return std::make_pair(pointer, m_iterator);
 	}
 
 	void Unmap(u32 used_size) override
 	{
+		ADDSTAT(stats.thisFrame.bytesUploaded, used_size);
 		glFlushMappedBufferRange(m_buffertype, 0, used_size);
 		glUnmapBuffer(m_buffertype);
+		ADDSTAT(stats.thisFrame.numStreamingGLCalls, 2);
 		m_iterator += used_size;
 	}
 };
@@ -239,7 +251,9 @@ public:
 
 	void Unmap(u32 used_size) override
 	{
+		ADDSTAT(stats.thisFrame.bytesUploaded, used_size);
 		glFlushMappedBufferRange(m_buffertype, m_iterator, used_size);
+		INCSTAT(stats.thisFrame.numStreamingGLCalls);
 		m_iterator += used_size;
 	}
 
@@ -283,6 +297,7 @@ public:
 
 	void Unmap(u32 used_size) override
 	{
+		ADDSTAT(stats.thisFrame.bytesUploaded, used_size);
 		m_iterator += used_size;
 	}
 
@@ -317,7 +332,9 @@ public:
 
 	void Unmap(u32 used_size) override
 	{
+		ADDSTAT(stats.thisFrame.bytesUploaded, used_size);
 		glBufferSubData(m_buffertype, 0, used_size, m_pointer);
+		INCSTAT(stats.thisFrame.numStreamingGLCalls);
 	}
 
 	u8* m_pointer;
@@ -349,7 +366,9 @@ public:
 
 	void Unmap(u32 used_size) override
 	{
+		ADDSTAT(stats.thisFrame.bytesUploaded, used_size);
 		glBufferData(m_buffertype, used_size, m_pointer, GL_STREAM_DRAW);
+		INCSTAT(stats.thisFrame.numStreamingGLCalls);
 	}
 
 	u8* m_pointer;
@@ -22,12 +22,12 @@
 #include "VideoBackends/OGL/GLInterfaceBase.h"
 #include "VideoBackends/OGL/ProgramShaderCache.h"
 #include "VideoBackends/OGL/Render.h"
+#include "VideoBackends/OGL/StreamBuffer.h"
 #include "VideoBackends/OGL/TextureCache.h"
 #include "VideoBackends/OGL/TextureConverter.h"
 
 #include "VideoCommon/BPStructs.h"
 #include "VideoCommon/HiresTextures.h"
-#include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VideoConfig.h"
@@ -47,7 +47,29 @@ static u32 s_DepthCbufid;
 static u32 s_Textures[8];
 static u32 s_ActiveTexture;
 
-bool SaveTexture(const std::string& filename, u32 textarget, u32 tex, int virtual_width, int virtual_height, unsigned int level)
+// Texture data is staged in a ring buffer, so the driver doesn't have to copy
+// it before glTexImage returns. Only used if it can stay mapped.
+static StreamBuffer* s_upload_buffer = nullptr;
+static const u32 UPLOAD_BUFFER_SIZE = 32 * 1024 * 1024;
+
+static u32 GetPixelSize(PC_TexFormat pcfmt)
+{
+	switch (pcfmt)
+	{
+	case PC_TEX_FMT_I4_AS_I8:
+	case PC_TEX_FMT_I8:
+		return 1;
+	case PC_TEX_FMT_IA4_AS_IA8:
+	case PC_TEX_FMT_IA8:
+	case PC_TEX_FMT_RGB565:
+		return 2;
+	default:
+		return 4;
+	}
+}
+
+bool SaveTexture(const std::string& filename, u32 textarget, u32 tex, int virtual_width, int virtual_height, unsigned int level,
+                 ImageWriteQueue::FullQueuePolicy policy)
 {
 	if (GLInterface->GetMode() != GLInterfaceMode::MODE_OPENGL)
 		return false;
@@ -60,7 +82,7 @@ bool SaveTexture(const std::string& filename, u32 textarget, u32 tex, int virtua
 	glBindTexture(textarget, 0);
 	TextureCache::SetStage();
 
-	return TextureToPng(data.data(), width * 4, filename, width, height, true);
+	return ImageWriteQueue::TextureToPng(data.data(), width * 4, filename, width, height, true, policy);
 }
 
 TextureCache::TCacheEntry::~TCacheEntry()
@@ -105,7 +127,7 @@ void TextureCache::TCacheEntry::Bind(unsigned int stage)
 
 bool TextureCache::TCacheEntry::Save(const std::string& filename, unsigned int level)
 {
-	return SaveTexture(filename, GL_TEXTURE_2D_ARRAY, texture, virtual_width, virtual_height, level);
+	return SaveTexture(filename, GL_TEXTURE_2D_ARRAY, texture, virtual_width, virtual_height, level, ImageWriteQueue::WAIT_IF_FULL);
 }
 
 TextureCache::TCacheEntryBase* TextureCache::CreateTexture(unsigned int width,
@@ -194,7 +216,26 @@ void TextureCache::TCacheEntry::Load(unsigned int width, unsigned int height,
 		if (expanded_width != width)
 			glPixelStorei(GL_UNPACK_ROW_LENGTH, expanded_width);
 
-		glTexImage3D(GL_TEXTURE_2D_ARRAY, level, gl_iformat, width, height, 1, 0, gl_format, gl_type, temp);
+		const u32 upload_size = expanded_width * height * GetPixelSize(pcfmt);
+
+		// Huge textures would make the ring buffer wait for the GPU too often.
+		if (s_upload_buffer && upload_size <= UPLOAD_BUFFER_SIZE / 4)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_upload_buffer->m_buffer);
+			auto buffer = s_upload_buffer->Map(upload_size, 4);
+			memcpy(buffer.first, temp, upload_size);
+			s_upload_buffer->Unmap(upload_size);
+
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, level, gl_iformat, width, height, 1, 0, gl_format, gl_type,
+			             (void*)(uintptr_t)buffer.second);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		else
+		{
+			// Staged uploads are counted by the stream buffer
+			ADDSTAT(stats.thisFrame.bytesUploaded, upload_size);
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, level, gl_iformat, width, height, 1, 0, gl_format, gl_type, temp);
+		}
 
 		if (expanded_width != width)
 			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
@@ -292,16 +333,9 @@ void TextureCache::TCacheEntry::FromRenderTarget(u32 dstAddr, unsigned int dstFo
 			scaleByHalf,
 			srcRect);
 
-		u8* dst = Memory::GetPointer(addr);
-		u64 const new_hash = GetHash64(dst,encoded_size,g_ActiveConfig.iSafeTextureCache_ColorSamples);
-
-		// Mark texture entries in destination address range dynamic unless caching is enabled and the texture entry is up to date
-		if (!g_ActiveConfig.bEFBCopyCacheEnable)
-			TextureCache::MakeRangeDynamic(addr,encoded_size);
-		else if (!TextureCache::Find(addr, new_hash))
-			TextureCache::MakeRangeDynamic(addr,encoded_size);
-
-		hash = new_hash;
+		// Deferred copies are finished once they are written back.
+		if (!g_ActiveConfig.bDeferEFBCopies)
+			TextureCache::FinishEFBCopyToRam(addr, encoded_size);
 	}
 
 	FramebufferManager::SetFramebuffer(0);
@@ -310,7 +344,7 @@ void TextureCache::TCacheEntry::FromRenderTarget(u32 dstAddr, unsigned int dstFo
 	{
 		static int count = 0;
 		SaveTexture(StringFromFormat("%sefb_frame_%i.png", File::GetUserPath(D_DUMPTEXTURES_IDX).c_str(),
-			count++), GL_TEXTURE_2D_ARRAY, texture, virtual_width, virtual_height, 0);
+			count++), GL_TEXTURE_2D_ARRAY, texture, virtual_width, virtual_height, 0, ImageWriteQueue::DROP_IF_FULL);
 	}
 
 	g_renderer->RestoreAPIState();
@@ -323,12 +357,24 @@ TextureCache::TextureCache()
 	s_ActiveTexture = -1;
 	for (auto& gtex : s_Textures)
 		gtex = -1;
+
+	// The other streaming methods map or copy the buffer on every upload,
+	// which is no better than letting the driver copy the texture.
+	if (g_ogl_config.bSupportsGLSync && g_ogl_config.bSupportsGLBaseVertex &&
+	    (g_ogl_config.bSupportsGLBufferStorage || g_ogl_config.bSupportsGLPinnedMemory))
+	{
+		s_upload_buffer = StreamBuffer::Create(GL_PIXEL_UNPACK_BUFFER, UPLOAD_BUFFER_SIZE);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
 }
 
 
 TextureCache::~TextureCache()
 {
 	DeleteShaders();
+
+	delete s_upload_buffer;
+	s_upload_buffer = nullptr;
 }
 
 void TextureCache::DisableStage(unsigned int stage)
@@ -441,4 +487,19 @@ void TextureCache::DeleteShaders()
 	s_DepthMatrixProgram.Destroy();
 }
 
+void TextureCache::FlushEFBCopies()
+{
+	TextureConverter::FlushEFBCopies();
+}
+
+void TextureCache::FlushEFBCopies(u32 address, u32 size)
+{
+	TextureConverter::FlushEFBCopies(address, size);
+}
+
+void TextureCache::DiscardEFBCopies()
+{
+	TextureConverter::DiscardEFBCopies();
+}
+
 }
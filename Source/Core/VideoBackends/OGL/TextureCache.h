@@ -8,6 +8,7 @@
 
 #include "VideoBackends/OGL/GLUtil.h"
 #include "VideoCommon/BPStructs.h"
+#include "VideoCommon/ImageWriteQueue.h"
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VideoCommon.h"
 
@@ -60,8 +61,13 @@ private:
 
 	void CompileShaders() override;
 	void DeleteShaders() override;
+
+	void FlushEFBCopies() override;
+	void FlushEFBCopies(u32 address, u32 size) override;
+	void DiscardEFBCopies() override;
 };
 
-bool SaveTexture(const std::string& filename, u32 textarget, u32 tex, int virtual_width, int virtual_height, unsigned int level);
+bool SaveTexture(const std::string& filename, u32 textarget, u32 tex, int virtual_width, int virtual_height, unsigned int level,
+                 ImageWriteQueue::FullQueuePolicy policy);
 
 }
@@ -4,7 +4,9 @@
 
 // Fast image conversion using OpenGL shaders.
 
+#include <deque>
 #include <string>
+#include <vector>
 
 #include "Common/FileUtil.h"
 #include "Common/StringUtil.h"
@@ -50,6 +52,24 @@ static int s_encodingUniforms[NUM_ENCODING_PROGRAMS];
 
 static GLuint s_PBO = 0; // for readback with different strides
 
+// EFB copies to RAM which were encoded and are being read back, but haven't
+// been written to guest memory yet.
+struct PendingCopy
+{
+	u32 address;
+	int encoded_size;
+	GLuint pbo;
+	int read_size;
+	int read_stride;
+	int write_stride;
+	int read_loops;
+};
+
+// Keeps the number of buffers in flight bounded.
+const size_t MAX_PENDING_COPIES = 16;
+static std::deque<PendingCopy> s_pending_copies;
+static std::vector<GLuint> s_free_pbos;
+
 static void CreatePrograms()
 {
 	/* TODO: Accuracy Improvements
@@ -194,6 +214,12 @@ void Init()
 
 void Shutdown()
 {
+	// Guest memory might already be gone, so pending copies are dropped.
+	DiscardEFBCopies();
+	if (!s_free_pbos.empty())
+		glDeleteBuffers((GLsizei)s_free_pbos.size(), s_free_pbos.data());
+	s_free_pbos.clear();
+
 	glDeleteTextures(1, &s_srcTexture);
 	glDeleteTextures(1, &s_dstTexture);
 	glDeleteBuffers(1, &s_PBO);
@@ -212,12 +238,8 @@ void Shutdown()
 	s_texConvFrameBuffer[1] = 0;
 }
 
-static void EncodeToRamUsingShader(GLuint srcTexture,
-						u8* destAddr, int dstWidth, int dstHeight, int readStride,
-						bool linearFilter)
+static void EncodeUsingShader(GLuint srcTexture, int dstWidth, int dstHeight, bool linearFilter)
 {
-
-
 	// switch to texture converter frame buffer
 	// attach render buffer as color destination
 	FramebufferManager::SetFramebuffer(s_texConvFrameBuffer[0]);
@@ -242,6 +264,13 @@ static void EncodeToRamUsingShader(GLuint srcTexture,
 	glViewport(0, 0, (GLsizei)dstWidth, (GLsizei)dstHeight);
 
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+static void EncodeToRamUsingShader(GLuint srcTexture,
+						u8* destAddr, int dstWidth, int dstHeight, int readStride,
+						bool linearFilter)
+{
+	EncodeUsingShader(srcTexture, dstWidth, dstHeight, linearFilter);
 
 	// .. and then read back the results.
 	// TODO: make this less slow.
@@ -279,6 +308,101 @@ static void EncodeToRamUsingShader(GLuint srcTexture,
 	}
 }
 
+static void WriteBackCopy(const PendingCopy& copy)
+{
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, copy.pbo);
+	const u8* pbo = (const u8*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, copy.read_size, GL_MAP_READ_BIT);
+	u8* dest_ptr = Memory::GetPointer(copy.address);
+
+	if (copy.write_stride != copy.read_stride && copy.read_loops > 1)
+	{
+		for (int i = 0; i < copy.read_loops; i++)
+		{
+			memcpy(dest_ptr, pbo, copy.read_stride);
+			pbo += copy.read_stride;
+			dest_ptr += copy.write_stride;
+		}
+	}
+	else
+	{
+		memcpy(dest_ptr, pbo, copy.read_size);
+	}
+
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	s_free_pbos.push_back(copy.pbo);
+
+	TextureCache::FinishEFBCopyToRam(copy.address, copy.encoded_size);
+}
+
+static void FlushCopies(size_t count)
+{
+	// In order, so later copies to the same memory win.
+	for (size_t i = 0; i < count; i++)
+	{
+		WriteBackCopy(s_pending_copies.front());
+		s_pending_copies.pop_front();
+	}
+}
+
+// Starts reading back the encoded copy, the results are only waited for once
+// the copy is written back.
+static void QueueCopy(u32 address, int encoded_size, int dstWidth, int dstHeight, int readStride)
+{
+	if (s_pending_copies.size() >= MAX_PENDING_COPIES)
+		FlushCopies(1);
+
+	PendingCopy copy;
+	copy.address = address;
+	copy.encoded_size = encoded_size;
+	copy.read_size = dstWidth * dstHeight * 4;
+	copy.read_stride = readStride;
+	copy.write_stride = bpmem.copyMipMapStrideChannels * 32;
+	copy.read_loops = dstHeight / (readStride / dstWidth / 4);
+
+	if (s_free_pbos.empty())
+	{
+		glGenBuffers(1, &copy.pbo);
+	}
+	else
+	{
+		copy.pbo = s_free_pbos.back();
+		s_free_pbos.pop_back();
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, copy.pbo);
+	glBufferData(GL_PIXEL_PACK_BUFFER, copy.read_size, nullptr, GL_STREAM_READ);
+	glReadPixels(0, 0, (GLsizei)dstWidth, (GLsizei)dstHeight, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	s_pending_copies.push_back(copy);
+}
+
+void FlushEFBCopies()
+{
+	FlushCopies(s_pending_copies.size());
+}
+
+void FlushEFBCopies(u32 address, u32 size)
+{
+	// Everything up to the last overlapping copy, as older copies might overlap it as well.
+	size_t count = 0;
+	for (size_t i = 0; i < s_pending_copies.size(); i++)
+	{
+		const PendingCopy& copy = s_pending_copies[i];
+		if (copy.address < address + size && address < copy.address + copy.encoded_size)
+			count = i + 1;
+	}
+	FlushCopies(count);
+}
+
+void DiscardEFBCopies()
+{
+	for (const PendingCopy& copy : s_pending_copies)
+		s_free_pbos.push_back(copy.pbo);
+	s_pending_copies.clear();
+}
+
 int EncodeToRamFromTexture(u32 address,GLuint source_texture, bool bFromZBuffer, bool bIsIntensityFmt, u32 copyfmt, int bScaleByHalf, const EFBRectangle& source)
 {
 	u32 format = copyfmt;
@@ -326,6 +450,15 @@ int EncodeToRamFromTexture(u32 address,GLuint source_texture, bool bFromZBuffer,
 
 	int readStride = (expandedWidth * cacheBytes) /
 		TexDecoder_GetBlockWidthInTexels(format);
+
+	if (g_ActiveConfig.bDeferEFBCopies)
+	{
+		EncodeUsingShader(source_texture, expandedWidth / samples, expandedHeight,
+			bScaleByHalf > 0 && !bFromZBuffer);
+		QueueCopy(address, size_in_bytes, expandedWidth / samples, expandedHeight, readStride);
+		return size_in_bytes;
+	}
+
 	EncodeToRamUsingShader(source_texture,
 		dest_ptr, expandedWidth / samples, expandedHeight, readStride,
 		bScaleByHalf > 0 && !bFromZBuffer);
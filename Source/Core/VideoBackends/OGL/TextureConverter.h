@@ -24,8 +24,16 @@ void EncodeToRamYUYV(GLuint srcTexture, const TargetRectangle& sourceRc,
 void DecodeToTexture(u32 xfbAddr, int srcWidth, int srcHeight, GLuint destTexture);
 
 // returns size of the encoded data (in bytes)
+// With deferred EFB copies, the data only reaches RAM once the copy is flushed.
 int EncodeToRamFromTexture(u32 address, GLuint source_texture, bool bFromZBuffer, bool bIsIntensityFmt, u32 copyfmt, int bScaleByHalf, const EFBRectangle& source);
 
+// Writes back pending EFB copies, either all of them or the ones which
+// overlap the given range.
+void FlushEFBCopies();
+void FlushEFBCopies(u32 address, u32 size);
+// Drops pending copies, their buffers are kept for later copies.
+void DiscardEFBCopies();
+
 }
 
 }  // namespace OGL
@@ -140,13 +140,22 @@ void VertexManager::vFlush(bool useDstAlpha)
 
 	// If host supports GL_ARB_blend_func_extended, we can do dst alpha in
 	// the same pass as regular rendering.
+	SHADER* shader;
 	if (useDstAlpha && dualSourcePossible)
 	{
-		ProgramShaderCache::SetShader(DSTALPHA_DUAL_SOURCE_BLEND, nativeVertexFmt->m_components);
+		shader = ProgramShaderCache::SetShader(DSTALPHA_DUAL_SOURCE_BLEND, nativeVertexFmt->m_components);
 	}
 	else
 	{
-		ProgramShaderCache::SetShader(DSTALPHA_NONE, nativeVertexFmt->m_components);
+		shader = ProgramShaderCache::SetShader(DSTALPHA_NONE, nativeVertexFmt->m_components);
+	}
+
+	// The shader is still being compiled, or it failed to compile
+	if (!shader)
+	{
+		INCSTAT(stats.thisFrame.numDrawsSkipped);
+		ClearEFBCache();
+		return;
 	}
 
 	// upload global constants
@@ -155,25 +164,17 @@ void VertexManager::vFlush(bool useDstAlpha)
 	// setup the pointers
 	nativeVertexFmt->SetupVertexPointers();
 
+	g_renderer->ApplyState(false);
+
 	Draw(stride);
 
 	// run through vertex groups again to set alpha
-	if (useDstAlpha && !dualSourcePossible)
+	if (useDstAlpha && !dualSourcePossible && ProgramShaderCache::SetShader(DSTALPHA_ALPHA_PASS, nativeVertexFmt->m_components))
 	{
-		ProgramShaderCache::SetShader(DSTALPHA_ALPHA_PASS, nativeVertexFmt->m_components);
-
 		// only update alpha
-		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_TRUE);
-
-		glDisable(GL_BLEND);
+		g_renderer->ApplyState(true);
 
 		Draw(stride);
-
-		// restore color mask
-		g_renderer->SetColorMask();
-
-		if (bpmem.blendmode.blendenable || bpmem.blendmode.subtract)
-			glEnable(GL_BLEND);
 	}
 
 #if defined(_DEBUG) || defined(DEBUGFAST)
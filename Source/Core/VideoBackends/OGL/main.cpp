@@ -66,6 +66,7 @@ Make AA apply instantly during gameplay if possible
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/ImageWrite.h"
+#include "VideoCommon/ImageWriteQueue.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/LookUpTables.h"
 #include "VideoCommon/MainBase.h"
@@ -236,6 +237,7 @@ void VideoBackend::Video_Cleanup()
 		BoundingBox::Shutdown();
 		TextureConverter::Shutdown();
 		VertexLoaderManager::Shutdown();
+		ImageWriteQueue::Shutdown();
 		delete g_sampler_cache;
 		g_sampler_cache = nullptr;
 		delete g_texture_cache;
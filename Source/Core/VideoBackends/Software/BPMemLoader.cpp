@@ -22,6 +22,7 @@ void InitBPMemory()
 {
 	memset(&bpmem, 0, sizeof(bpmem));
 	bpmem.bpMask = 0xFFFFFF;
+	Tev::InvalidateConfig();
 }
 
 void SWLoadBPReg(u32 value)
@@ -42,6 +43,14 @@ void SWLoadBPReg(u32 value)
 
 void SWBPWritten(int address, int newvalue)
 {
+	if (address == BPMEM_GENMODE ||
+	    (address >= BPMEM_TREF && address < BPMEM_TREF + 8) ||
+	    (address >= BPMEM_TEV_COLOR_ENV && address < BPMEM_TEV_COLOR_ENV + 32) ||
+	    (address >= BPMEM_TEV_KSEL && address < BPMEM_TEV_KSEL + 8))
+	{
+		Tev::InvalidateConfig();
+	}
+
 	switch (address)
 	{
 	case BPMEM_SCISSORTL:
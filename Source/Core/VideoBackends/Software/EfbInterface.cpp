@@ -20,6 +20,7 @@ static u8 efb[EFB_WIDTH*EFB_HEIGHT*6];
 namespace EfbInterface
 {
 	u32 perf_values[PQ_NUM_MEMBERS];
+	static u32 perf_quad_pixels[PQ_NUM_MEMBERS];
 
 	static inline u32 GetColorOffset(u16 x, u16 y)
 	{
@@ -31,6 +32,31 @@ namespace EfbInterface
 		return (x + y * EFB_WIDTH) * 3 + DEPTH_BUFFER_START;
 	}
 
+	// Only ever load and store the 3 bytes of a pixel, its neighbours may be
+	// drawn by another rasterizer thread at the same time.
+	static inline u32 LoadPixel(u32 offset)
+	{
+		return efb[offset] | (efb[offset + 1] << 8) | (efb[offset + 2] << 16);
+	}
+
+	static inline void StorePixel(u32 offset, u32 val)
+	{
+		efb[offset] = (u8)val;
+		efb[offset + 1] = (u8)(val >> 8);
+		efb[offset + 2] = (u8)(val >> 16);
+	}
+
+	void IncPerfCounterQuadCount(PerfQueryType type, u32 count)
+	{
+		// NOTE: hardware doesn't process individual pixels but quads instead.
+		// Current software renderer architecture works on pixels though, so
+		// we have this "quad" hack here to only increment the registers on
+		// every third rendered pixel
+		u32 pixels = perf_quad_pixels[type] + count;
+		perf_values[type] += pixels / 3;
+		perf_quad_pixels[type] = pixels % 3;
+	}
+
 	void DoState(PointerWrap &p)
 	{
 		p.DoArray(efb, EFB_WIDTH*EFB_HEIGHT*6);
@@ -48,10 +74,9 @@ namespace EfbInterface
 		case PEControl::RGBA6_Z24:
 			{
 				u32 a32 = a;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xffffffc0;
+				u32 val = LoadPixel(offset) & 0x00ffffc0;
 				val |= (a32 >> 2) & 0x0000003f;
-				*dst = val;
+				StorePixel(offset, val);
 			}
 			break;
 		default:
@@ -67,31 +92,26 @@ namespace EfbInterface
 		case PEControl::Z24:
 			{
 				u32 src = *(u32*)rgb;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= src >> 8;
-				*dst = val;
+				u32 val = src >> 8;
+				StorePixel(offset, val);
 			}
 			break;
 		case PEControl::RGBA6_Z24:
 			{
 				u32 src = *(u32*)rgb;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff00003f;
+				u32 val = LoadPixel(offset) & 0x0000003f;
 				val |= (src >> 4) & 0x00000fc0; // blue
 				val |= (src >> 6) & 0x0003f000; // green
 				val |= (src >> 8) & 0x00fc0000; // red
-				*dst = val;
+				StorePixel(offset, val);
 			}
 			break;
 		case PEControl::RGB565_Z16:
 			{
 				INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
 				u32 src = *(u32*)rgb;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= src >> 8;
-				*dst = val;
+				u32 val = src >> 8;
+				StorePixel(offset, val);
 			}
 			break;
 		default:
@@ -107,32 +127,26 @@ namespace EfbInterface
 		case PEControl::Z24:
 			{
 				u32 src = *(u32*)color;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= src >> 8;
-				*dst = val;
+				u32 val = src >> 8;
+				StorePixel(offset, val);
 			}
 			break;
 		case PEControl::RGBA6_Z24:
 			{
 				u32 src = *(u32*)color;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= (src >> 2) & 0x0000003f; // alpha
+				u32 val = (src >> 2) & 0x0000003f; // alpha
 				val |= (src >> 4) & 0x00000fc0; // blue
 				val |= (src >> 6) & 0x0003f000; // green
 				val |= (src >> 8) & 0x00fc0000; // red
-				*dst = val;
+				StorePixel(offset, val);
 			}
 			break;
 		case PEControl::RGB565_Z16:
 			{
 				INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
 				u32 src = *(u32*)color;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= src >> 8;
-				*dst = val;
+				u32 val = src >> 8;
+				StorePixel(offset, val);
 			}
 			break;
 		default:
@@ -147,7 +161,7 @@ namespace EfbInterface
 		case PEControl::RGB8_Z24:
 		case PEControl::Z24:
 			{
-				u32 src = *(u32*)&efb[offset];
+				u32 src = LoadPixel(offset);
 				u32 *dst = (u32*)color;
 				u32 val = 0xff | ((src & 0x00ffffff) << 8);
 				*dst = val;
@@ -155,7 +169,7 @@ namespace EfbInterface
 			break;
 		case PEControl::RGBA6_Z24:
 			{
-				u32 src = *(u32*)&efb[offset];
+				u32 src = LoadPixel(offset);
 				color[ALP_C] = Convert6To8(src & 0x3f);
 				color[BLU_C] = Convert6To8((src >> 6) & 0x3f);
 				color[GRN_C] = Convert6To8((src >> 12) & 0x3f);
@@ -165,7 +179,7 @@ namespace EfbInterface
 		case PEControl::RGB565_Z16:
 			{
 				INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-				u32 src = *(u32*)&efb[offset];
+				u32 src = LoadPixel(offset);
 				u32 *dst = (u32*)color;
 				u32 val = 0xff | ((src & 0x00ffffff) << 8);
 				*dst = val;
@@ -184,19 +198,15 @@ namespace EfbInterface
 		case PEControl::RGBA6_Z24:
 		case PEControl::Z24:
 			{
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= depth & 0x00ffffff;
-				*dst = val;
+				u32 val = depth & 0x00ffffff;
+				StorePixel(offset, val);
 			}
 			break;
 		case PEControl::RGB565_Z16:
 			{
 				INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= depth & 0x00ffffff;
-				*dst = val;
+				u32 val = depth & 0x00ffffff;
+				StorePixel(offset, val);
 			}
 			break;
 		default:
@@ -214,13 +224,13 @@ namespace EfbInterface
 		case PEControl::RGBA6_Z24:
 		case PEControl::Z24:
 			{
-				depth = (*(u32*)&efb[offset]) & 0x00ffffff;
+				depth = LoadPixel(offset) & 0x00ffffff;
 			}
 			break;
 		case PEControl::RGB565_Z16:
 			{
 				INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-				depth = (*(u32*)&efb[offset]) & 0x00ffffff;
+				depth = LoadPixel(offset) & 0x00ffffff;
 			}
 			break;
 		default:
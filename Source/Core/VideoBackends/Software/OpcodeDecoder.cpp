@@ -13,6 +13,7 @@
 #include "VideoBackends/Software/SWStatistics.h"
 #include "VideoBackends/Software/SWVertexLoader.h"
 #include "VideoBackends/Software/SWVideoConfig.h"
+#include "VideoBackends/Software/TextureSampler.h"
 #include "VideoBackends/Software/XFMemLoader.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/VertexLoaderUtils.h"
@@ -209,6 +210,9 @@ static void DecodeStandard(u32 bufferSize)
 			u8 primitiveType = (Cmd & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT;
 			vertexLoader.SetFormat(vatIndex, primitiveType);
 
+			// Textures may have been loaded or modified since the last draw.
+			TextureSampler::InvalidateCaches();
+
 			// switch to primitive processing
 			streamSize = DataReadU16();
 			currentFunction = DecodePrimitiveStream;
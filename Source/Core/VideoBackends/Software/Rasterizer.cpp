@@ -3,8 +3,17 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
 
+#include "Common/Common.h"
 #include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/Flag.h"
+#include "Common/Thread.h"
 #include "VideoBackends/Software/BPMemLoader.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/HwRasterizer.h"
@@ -16,9 +25,15 @@
 #include "VideoBackends/Software/XFMemLoader.h"
 #include "VideoCommon/BoundingBox.h"
 
+#ifdef _M_X86
+#include <emmintrin.h>
+#endif
 
 #define BLOCK_SIZE 2
 
+// The corners of a block are its pixels, and they fit in one SSE register.
+static_assert(BLOCK_SIZE == 2, "The rasterizer works on blocks of 2x2 pixels");
+
 #define CLAMP(x, a, b) (x>b)?b:(x<a)?a:x
 
 // returns approximation of log2(f) in s28.4
@@ -49,8 +64,25 @@ static s32 scissorTop = 0;
 static s32 scissorRight = 0;
 static s32 scissorBottom = 0;
 
-static Tev tev;
-static RasterBlock rasterBlock;
+// Depth and vertex colors of a pixel, interpolated along with the texture
+// coordinates of its block.
+struct PixelValues
+{
+	s32 z;
+	u8 color[2][4];
+};
+
+// Everything drawing a pixel modifies. The GPU thread draws with the main
+// context, every worker thread has its own.
+struct RasterContext
+{
+	Tev tev;
+	RasterBlock rasterBlock;
+	PixelValues blockValues[BLOCK_SIZE][BLOCK_SIZE];
+	u16 bboxCoords[4];
+};
+
+static RasterContext mainContext;
 
 void DoState(PointerWrap &p)
 {
@@ -70,13 +102,14 @@ void DoState(PointerWrap &p)
 	p.Do(scissorTop);
 	p.Do(scissorRight);
 	p.Do(scissorBottom);
-	tev.DoState(p);
-	p.Do(rasterBlock);
+	mainContext.tev.DoState(p);
+	p.Do(mainContext.rasterBlock);
 }
 
 void Init()
 {
-	tev.Init();
+	mainContext.tev.Init();
+	memset(&mainContext.rasterBlock, 0, sizeof(mainContext.rasterBlock));
 
 	// Set initial z reference plane in the unlikely case that zfreeze is enabled when drawing the first primitive.
 	// TODO: This is just a guess!
@@ -117,31 +150,57 @@ void SetScissor()
 
 void SetTevReg(int reg, int comp, bool konst, s16 color)
 {
-	tev.SetRegColor(reg, comp, konst, color);
+	mainContext.tev.SetRegColor(reg, comp, konst, color);
 }
 
-inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
+static inline PixelValues InterpolatePixel(s32 x, s32 y)
 {
-	INCSTAT(swstats.thisFrame.rasterizedPixels);
+	PixelValues values;
 
 	float dx = vertexOffsetX + (float)(x - vertex0X);
 	float dy = vertexOffsetY + (float)(y - vertex0Y);
 
-	s32 z = (s32)ZSlope.GetValue(dx, dy);
+	values.z = (s32)ZSlope.GetValue(dx, dy);
+
+	//  colors
+	for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
+	{
+		for (int comp = 0; comp < 4; comp++)
+		{
+			u16 color = (u16)ColorSlopes[i][comp].GetValue(dx, dy);
+
+			// clamp color value to 0
+			u16 mask = ~(color >> 8);
+
+			values.color[i][comp] = color & mask;
+		}
+	}
+
+	return values;
+}
+
+static inline void Draw(RasterContext& ctx, const PixelValues& values, s32 x, s32 y, s32 xi, s32 yi)
+{
+	Tev& tev = ctx.tev;
+	RasterBlock& rasterBlock = ctx.rasterBlock;
+
+	tev.Counters.rasterizedPixels++;
+
+	s32 z = values.z;
 	if (z < 0 || z > 0x00ffffff)
 		return;
 
 	if (!BoundingBox::active && bpmem.UseEarlyDepthTest() && g_SWVideoConfig.bZComploc)
 	{
 		// TODO: Test if perf regs are incremented even if test is disabled
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT_ZCOMPLOC);
+		tev.Counters.perfQuads[PQ_ZCOMP_INPUT_ZCOMPLOC]++;
 		if (bpmem.zmode.testenable)
 		{
 			// early z
 			if (!EfbInterface::ZCompare(x, y, z))
 				return;
 		}
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT_ZCOMPLOC);
+		tev.Counters.perfQuads[PQ_ZCOMP_OUTPUT_ZCOMPLOC]++;
 	}
 
 	RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
@@ -154,14 +213,7 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 	for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
 	{
 		for (int comp = 0; comp < 4; comp++)
-		{
-			u16 color = (u16)ColorSlopes[i][comp].GetValue(dx, dy);
-
-			// clamp color value to 0
-			u16 mask = ~(color >> 8);
-
-			tev.Color[i][comp] = color & mask;
-		}
+			tev.Color[i][comp] = values.color[i][comp];
 	}
 
 	// tex coords
@@ -211,7 +263,7 @@ static void InitSlope(Slope *slope, float f1, float f2, float f3, float DX31, fl
 	slope->f0 = f1;
 }
 
-static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoord)
+static inline void CalculateLOD(const RasterBlock& rasterBlock, s32* lodp, bool* linear, u32 texmap, u32 texcoord)
 {
 	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
 	u8 subTexmap = texmap & 3;
@@ -224,17 +276,17 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
 	float sDelta, tDelta;
 	if (tm0.diag_lod)
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
+		const float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+		const float *uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
 
 		sDelta = fabsf(uv0[0] - uv1[0]);
 		tDelta = fabsf(uv0[1] - uv1[1]);
 	}
 	else
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
-		float *uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
+		const float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+		const float *uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
+		const float *uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
 
 		sDelta = std::max(fabsf(uv0[0] - uv1[0]), fabsf(uv0[0] - uv2[0]));
 		tDelta = std::max(fabsf(uv0[1] - uv1[1]), fabsf(uv0[1] - uv2[1]));
@@ -258,8 +310,80 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
 	*lodp = lod;
 }
 
-static void BuildBlock(s32 blockX, s32 blockY)
+#ifdef _M_X86
+// Slope::GetValue for the four pixels of a block at once, with the same
+// operations in the same order so that the results are identical.
+static inline __m128 GetValues(const Slope& slope, __m128 dx, __m128 dy)
+{
+	__m128 value = _mm_add_ps(_mm_set1_ps(slope.f0), _mm_mul_ps(_mm_set1_ps(slope.dfdx), dx));
+	return _mm_add_ps(value, _mm_mul_ps(_mm_set1_ps(slope.dfdy), dy));
+}
+
+static void InterpolateBlock(RasterContext& ctx, s32 blockX, s32 blockY)
+{
+	RasterBlock& rasterBlock = ctx.rasterBlock;
+
+	// The lanes hold the pixels (0,0), (1,0), (0,1) and (1,1).
+	const __m128 dx = _mm_add_ps(_mm_set1_ps(vertexOffsetX),
+		_mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(blockX - vertex0X), _mm_setr_epi32(0, 1, 0, 1))));
+	const __m128 dy = _mm_add_ps(_mm_set1_ps(vertexOffsetY),
+		_mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(blockY - vertex0Y), _mm_setr_epi32(0, 0, 1, 1))));
+
+	GC_ALIGNED16(float lanes[4]);
+	GC_ALIGNED16(float lanes2[4]);
+	GC_ALIGNED16(s32 ilanes[4]);
+
+	const __m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), GetValues(WSlope, dx, dy));
+	_mm_store_ps(lanes, invW);
+	for (int lane = 0; lane < 4; lane++)
+		rasterBlock.Pixel[lane & 1][lane >> 1].InvW = lanes[lane];
+
+	// tex coords
+	for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
+	{
+		__m128 projection = invW;
+		if (xfmem.texMtxInfo[i].projection)
+		{
+			__m128 q = _mm_mul_ps(GetValues(TexSlopes[i][2], dx, dy), invW);
+			__m128 nonzero = _mm_cmpneq_ps(q, _mm_setzero_ps());
+			projection = _mm_or_ps(_mm_and_ps(nonzero, _mm_div_ps(invW, q)), _mm_andnot_ps(nonzero, invW));
+		}
+
+		_mm_store_ps(lanes, _mm_mul_ps(GetValues(TexSlopes[i][0], dx, dy), projection));
+		_mm_store_ps(lanes2, _mm_mul_ps(GetValues(TexSlopes[i][1], dx, dy), projection));
+		for (int lane = 0; lane < 4; lane++)
+		{
+			rasterBlock.Pixel[lane & 1][lane >> 1].Uv[i][0] = lanes[lane];
+			rasterBlock.Pixel[lane & 1][lane >> 1].Uv[i][1] = lanes2[lane];
+		}
+	}
+
+	_mm_store_si128((__m128i*)ilanes, _mm_cvttps_epi32(GetValues(ZSlope, dx, dy)));
+	for (int lane = 0; lane < 4; lane++)
+		ctx.blockValues[lane & 1][lane >> 1].z = ilanes[lane];
+
+	//  colors
+	const __m128i byteMask = _mm_set1_epi32(0xff);
+	for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
+	{
+		for (int comp = 0; comp < 4; comp++)
+		{
+			__m128i color = _mm_cvttps_epi32(GetValues(ColorSlopes[i][comp], dx, dy));
+
+			// clamp color value to 0, the low byte of the 16 bit color masked
+			// by its inverted high byte
+			__m128i high = _mm_and_si128(_mm_srli_epi32(color, 8), byteMask);
+			_mm_store_si128((__m128i*)ilanes, _mm_andnot_si128(high, _mm_and_si128(color, byteMask)));
+			for (int lane = 0; lane < 4; lane++)
+				ctx.blockValues[lane & 1][lane >> 1].color[i][comp] = (u8)ilanes[lane];
+		}
+	}
+}
+#else
+static void InterpolateBlock(RasterContext& ctx, s32 blockX, s32 blockY)
 {
+	RasterBlock& rasterBlock = ctx.rasterBlock;
+
 	for (s32 yi = 0; yi < BLOCK_SIZE; yi++)
 	{
 		for (s32 xi = 0; xi < BLOCK_SIZE; xi++)
@@ -286,8 +410,18 @@ static void BuildBlock(s32 blockX, s32 blockY)
 				pixel.Uv[i][0] = TexSlopes[i][0].GetValue(dx, dy) * projection;
 				pixel.Uv[i][1] = TexSlopes[i][1].GetValue(dx, dy) * projection;
 			}
+
+			ctx.blockValues[xi][yi] = InterpolatePixel(xi + blockX, yi + blockY);
 		}
 	}
+}
+#endif
+
+static void BuildBlock(RasterContext& ctx, s32 blockX, s32 blockY)
+{
+	RasterBlock& rasterBlock = ctx.rasterBlock;
+
+	InterpolateBlock(ctx, blockX, blockY);
 
 	u32 indref = bpmem.tevindref.hex;
 	for (unsigned int i = 0; i < bpmem.genMode.numindstages; i++)
@@ -297,7 +431,7 @@ static void BuildBlock(s32 blockX, s32 blockY)
 		u32 texcoord = indref & 3;
 		indref >>= 3;
 
-		CalculateLOD(&rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap, texcoord);
+		CalculateLOD(rasterBlock, &rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap, texcoord);
 	}
 
 	for (unsigned int i = 0; i <= bpmem.genMode.numtevstages; i++)
@@ -309,7 +443,7 @@ static void BuildBlock(s32 blockX, s32 blockY)
 			u32 texmap = order.getTexMap(stageOdd);
 			u32 texcoord = order.getTexCoord(stageOdd);
 
-			CalculateLOD(&rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap, texcoord);
+			CalculateLOD(rasterBlock, &rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap, texcoord);
 		}
 	}
 }
@@ -326,8 +460,325 @@ static inline void PrepareBlock(s32 blockX, s32 blockY)
 	{
 		x = blockX;
 		y = blockY;
-		BuildBlock(x, y);
+		BuildBlock(mainContext, x, y);
+	}
+}
+
+// Half-space functions of the edges of a triangle, see DrawTriangleFrontFace.
+struct TriangleEdges
+{
+	s32 minx;
+	s32 maxx;
+	s32 C1, C2, C3;
+	s32 DX12, DX23, DX31;
+	s32 DY12, DY23, DY31;
+};
+
+// Draws the blocks of the given rows which are covered by the triangle,
+// returns whether there was any.
+static bool DrawBlockRows(RasterContext& ctx, const TriangleEdges& edges, s32 miny, s32 maxy)
+{
+	const s32 minx = edges.minx;
+	const s32 maxx = edges.maxx;
+
+	const s32 C1 = edges.C1;
+	const s32 C2 = edges.C2;
+	const s32 C3 = edges.C3;
+
+	const s32 DX12 = edges.DX12;
+	const s32 DX23 = edges.DX23;
+	const s32 DX31 = edges.DX31;
+
+	const s32 DY12 = edges.DY12;
+	const s32 DY23 = edges.DY23;
+	const s32 DY31 = edges.DY31;
+
+	bool built = false;
+
+#ifdef _M_X86
+	const s32 FDX12 = DX12 << 4;
+	const s32 FDX23 = DX23 << 4;
+	const s32 FDX31 = DX31 << 4;
+
+	const s32 FDY12 = DY12 << 4;
+	const s32 FDY23 = DY23 << 4;
+	const s32 FDY31 = DY31 << 4;
+
+	// The half-space function of an edge at the four corners of a block, in
+	// the same order as the bits of the masks below. They are stepped from
+	// block to block, the wrapped around results are the same as the ones of
+	// the multiplications.
+	const __m128i corners1 = _mm_setr_epi32(0, -FDY12, FDX12, FDX12 - FDY12);
+	const __m128i corners2 = _mm_setr_epi32(0, -FDY23, FDX23, FDX23 - FDY23);
+	const __m128i corners3 = _mm_setr_epi32(0, -FDY31, FDX31, FDX31 - FDY31);
+
+	const __m128i step1 = _mm_set1_epi32(-FDY12 * BLOCK_SIZE);
+	const __m128i step2 = _mm_set1_epi32(-FDY23 * BLOCK_SIZE);
+	const __m128i step3 = _mm_set1_epi32(-FDY31 * BLOCK_SIZE);
+
+	const __m128i zero = _mm_setzero_si128();
+#endif
+
+	// Loop through blocks
+	for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
+	{
+#ifdef _M_X86
+		__m128i edge1 = _mm_add_epi32(_mm_set1_epi32(C1 + DX12 * (y << 4) - DY12 * (minx << 4)), corners1);
+		__m128i edge2 = _mm_add_epi32(_mm_set1_epi32(C2 + DX23 * (y << 4) - DY23 * (minx << 4)), corners2);
+		__m128i edge3 = _mm_add_epi32(_mm_set1_epi32(C3 + DX31 * (y << 4) - DY31 * (minx << 4)), corners3);
+#endif
+
+		for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
+		{
+#ifdef _M_X86
+			int a = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(edge1, zero)));
+			int b = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(edge2, zero)));
+			int c = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(edge3, zero)));
+
+			edge1 = _mm_add_epi32(edge1, step1);
+			edge2 = _mm_add_epi32(edge2, step2);
+			edge3 = _mm_add_epi32(edge3, step3);
+#else
+			// Corners of block
+			s32 x0 = x << 4;
+			s32 x1 = (x + BLOCK_SIZE - 1) << 4;
+			s32 y0 = y << 4;
+			s32 y1 = (y + BLOCK_SIZE - 1) << 4;
+
+			// Evaluate half-space functions
+			bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
+			bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
+			bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
+			bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
+			int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
+
+			bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
+			bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
+			bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
+			bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
+			int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
+
+			bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
+			bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
+			bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
+			bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
+			int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
+#endif
+
+			// Skip block when outside an edge
+			if (a == 0x0 || b == 0x0 || c == 0x0)
+				continue;
+
+			BuildBlock(ctx, x, y);
+			built = true;
+
+			// The corners of a block are its pixels, draw the ones inside
+			// of all edges
+			const int covered = a & b & c;
+			for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+			{
+				for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
+				{
+					if (covered & (1 << (iy * BLOCK_SIZE + ix)))
+						Draw(ctx, ctx.blockValues[ix][iy], x + ix, y + iy, ix, iy);
+				}
+			}
+		}
+	}
+
+	return built;
+}
+
+// Large triangles are split into tiles of block rows which are drawn by the
+// GPU thread and the worker threads at the same time. The pixels of one
+// triangle never overlap, so the EFB ends up exactly as if it was drawn on a
+// single thread. The rest of the state drawing a pixel modifies is per
+// context, the context which drew the last tile is copied back afterwards.
+enum
+{
+	TILE_ROWS = 16,
+	MIN_PARALLEL_PIXELS = 4096,
+	MAX_TILES = (EFB_HEIGHT + TILE_ROWS - 1) / TILE_ROWS
+};
+
+struct Job
+{
+	TriangleEdges edges;
+	s32 miny;
+	s32 maxy;
+	int num_tiles;
+
+	// Index of the context which drew the tile, -1 if it had nothing to do.
+	int built_by[MAX_TILES];
+	int shaded_by[MAX_TILES];
+};
+
+static std::vector<std::thread> s_threads;
+static std::vector<std::unique_ptr<Common::Event>> s_wake_events;
+static std::vector<std::unique_ptr<RasterContext>> s_worker_contexts;
+static Common::Event s_done_event;
+static Common::Flag s_quit;
+
+// Only written by the GPU thread while all workers are idle.
+static Job s_job;
+static std::atomic<int> s_next_tile;
+static std::atomic<int> s_workers_running;
+
+static void DrawTiles(RasterContext& ctx, int ctx_index)
+{
+	int tile;
+	while ((tile = s_next_tile++) < s_job.num_tiles)
+	{
+		const s32 miny = s_job.miny + tile * TILE_ROWS;
+		const s32 maxy = std::min(miny + TILE_ROWS, s_job.maxy);
+		const u32 shaded = ctx.tev.Counters.tevPixelsIn;
+
+		const bool built = DrawBlockRows(ctx, s_job.edges, miny, maxy);
+
+		s_job.built_by[tile] = built ? ctx_index : -1;
+		s_job.shaded_by[tile] = ctx.tev.Counters.tevPixelsIn != shaded ? ctx_index : -1;
+	}
+}
+
+static void WorkerThread(int id)
+{
+	Common::SetCurrentThreadName("Rasterizer worker");
+
+	while (true)
+	{
+		s_wake_events[id]->Wait();
+		if (s_quit.IsSet())
+			return;
+
+		DrawTiles(*s_worker_contexts[id], id + 1);
+
+		if (--s_workers_running == 0)
+			s_done_event.Set();
+	}
+}
+
+static void StartWorkers(int num_threads)
+{
+	s_quit.Clear();
+	for (int i = 0; i < num_threads; i++)
+	{
+		s_worker_contexts.emplace_back(new RasterContext);
+		s_worker_contexts.back()->tev.Init();
+		s_worker_contexts.back()->tev.BBoxCoords = s_worker_contexts.back()->bboxCoords;
+		s_wake_events.emplace_back(new Common::Event);
+		s_threads.emplace_back(WorkerThread, i);
+	}
+}
+
+void Shutdown()
+{
+	s_quit.Set();
+	for (auto& event : s_wake_events)
+		event->Set();
+	for (auto& thread : s_threads)
+		thread.join();
+
+	s_threads.clear();
+	s_wake_events.clear();
+	s_worker_contexts.clear();
+}
+
+static RasterContext& GetContext(int index)
+{
+	return index == 0 ? mainContext : *s_worker_contexts[index - 1];
+}
+
+// Returns false if the triangle should be drawn on the GPU thread only.
+static bool DrawParallel(const TriangleEdges& edges, s32 miny, s32 maxy)
+{
+	const int num_threads = std::max(g_SWVideoConfig.iRasterizerThreads, 0);
+	if (num_threads == 0 || (edges.maxx - edges.minx) * (maxy - miny) < MIN_PARALLEL_PIXELS)
+		return false;
+
+	// The dumps are written to shared buffers, and pixels which depend on the
+	// previous one have to be drawn in order.
+	if (g_SWVideoConfig.bDumpTevStages || g_SWVideoConfig.bDumpTevTextureFetches || mainContext.tev.ReadsPreviousPixel())
+		return false;
+
+	if (num_threads != (int)s_threads.size())
+	{
+		Shutdown();
+		StartWorkers(num_threads);
+	}
+
+	for (auto& ctx : s_worker_contexts)
+	{
+		ctx->tev.CopyState(mainContext.tev);
+		ctx->rasterBlock = mainContext.rasterBlock;
+		memcpy(ctx->bboxCoords, BoundingBox::coords, sizeof(ctx->bboxCoords));
 	}
+
+	s_job.edges = edges;
+	s_job.miny = miny;
+	s_job.maxy = maxy;
+	s_job.num_tiles = (maxy - miny + TILE_ROWS - 1) / TILE_ROWS;
+	s_next_tile = 0;
+	s_workers_running = num_threads;
+
+	for (auto& event : s_wake_events)
+		event->Set();
+
+	DrawTiles(mainContext, 0);
+
+	while (s_workers_running != 0)
+		s_done_event.Wait();
+
+	// Tiles are handed out in order, so whichever context drew the last
+	// non-empty tile didn't touch its state afterwards.
+	for (int tile = s_job.num_tiles - 1; tile >= 0; tile--)
+	{
+		if (s_job.shaded_by[tile] > 0)
+			mainContext.tev.CopyState(GetContext(s_job.shaded_by[tile]).tev);
+		if (s_job.shaded_by[tile] >= 0)
+			break;
+	}
+	for (int tile = s_job.num_tiles - 1; tile >= 0; tile--)
+	{
+		if (s_job.built_by[tile] > 0)
+			mainContext.rasterBlock = GetContext(s_job.built_by[tile]).rasterBlock;
+		if (s_job.built_by[tile] >= 0)
+			break;
+	}
+
+	Tev::PixelCounters& counters = mainContext.tev.Counters;
+	for (auto& ctx : s_worker_contexts)
+	{
+		const Tev::PixelCounters& worker_counters = ctx->tev.Counters;
+		counters.rasterizedPixels += worker_counters.rasterizedPixels;
+		counters.tevPixelsIn += worker_counters.tevPixelsIn;
+		counters.tevPixelsOut += worker_counters.tevPixelsOut;
+		for (int i = 0; i < PQ_NUM_MEMBERS; i++)
+			counters.perfQuads[i] += worker_counters.perfQuads[i];
+		memset(&ctx->tev.Counters, 0, sizeof(ctx->tev.Counters));
+
+		BoundingBox::coords[BoundingBox::LEFT] = std::min(ctx->bboxCoords[BoundingBox::LEFT], BoundingBox::coords[BoundingBox::LEFT]);
+		BoundingBox::coords[BoundingBox::RIGHT] = std::max(ctx->bboxCoords[BoundingBox::RIGHT], BoundingBox::coords[BoundingBox::RIGHT]);
+		BoundingBox::coords[BoundingBox::TOP] = std::min(ctx->bboxCoords[BoundingBox::TOP], BoundingBox::coords[BoundingBox::TOP]);
+		BoundingBox::coords[BoundingBox::BOTTOM] = std::max(ctx->bboxCoords[BoundingBox::BOTTOM], BoundingBox::coords[BoundingBox::BOTTOM]);
+	}
+
+	return true;
+}
+
+static void FlushCounters()
+{
+	Tev::PixelCounters& counters = mainContext.tev.Counters;
+
+	ADDSTAT(swstats.thisFrame.rasterizedPixels, counters.rasterizedPixels);
+	ADDSTAT(swstats.thisFrame.tevPixelsIn, counters.tevPixelsIn);
+	ADDSTAT(swstats.thisFrame.tevPixelsOut, counters.tevPixelsOut);
+	for (int i = 0; i < PQ_NUM_MEMBERS; i++)
+	{
+		if (counters.perfQuads[i])
+			EfbInterface::IncPerfCounterQuadCount((PerfQueryType)i, counters.perfQuads[i]);
+	}
+
+	memset(&counters, 0, sizeof(counters));
 }
 
 void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2)
@@ -434,84 +885,11 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 		minx &= ~(BLOCK_SIZE - 1);
 		miny &= ~(BLOCK_SIZE - 1);
 
-		// Loop through blocks
-		for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
-		{
-			for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
-			{
-				// Corners of block
-				s32 x0 = x << 4;
-				s32 x1 = (x + BLOCK_SIZE - 1) << 4;
-				s32 y0 = y << 4;
-				s32 y1 = (y + BLOCK_SIZE - 1) << 4;
-
-				// Evaluate half-space functions
-				bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
-				bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
-				bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
-				bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
-				int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
-
-				bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
-				bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
-				bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
-				bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
-				int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
-
-				bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
-				bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
-				bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
-				bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
-				int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
-
-				// Skip block when outside an edge
-				if (a == 0x0 || b == 0x0 || c == 0x0)
-					continue;
-
-				BuildBlock(x, y);
-
-				// Accept whole block when totally covered
-				if (a == 0xF && b == 0xF && c == 0xF)
-				{
-					for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-					{
-						for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-						{
-							Draw(x + ix, y + iy, ix, iy);
-						}
-					}
-				}
-				else // Partially covered block
-				{
-					s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
-					s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
-					s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
-
-					for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-					{
-						s32 CX1 = CY1;
-						s32 CX2 = CY2;
-						s32 CX3 = CY3;
-
-						for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-						{
-							if (CX1 > 0 && CX2 > 0 && CX3 > 0)
-							{
-								Draw(x + ix, y + iy, ix, iy);
-							}
-
-							CX1 -= FDY12;
-							CX2 -= FDY23;
-							CX3 -= FDY31;
-						}
-
-						CY1 += FDX12;
-						CY2 += FDX23;
-						CY3 += FDX31;
-					}
-				}
-			}
-		}
+		const TriangleEdges edges = { minx, maxx, C1, C2, C3, DX12, DX23, DX31, DY12, DY23, DY31 };
+		if (!DrawParallel(edges, miny, maxy))
+			DrawBlockRows(mainContext, edges, miny, maxy);
+
+		FlushCounters();
 	}
 	else
 	{
@@ -565,7 +943,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 				{
 					// Build the new raster block every other pixel
 					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+					Draw(mainContext, InterpolatePixel(x, y), x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
 					if (y >= BoundingBox::coords[BoundingBox::TOP])
 						break;
@@ -605,7 +983,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 				if (CY1 > 0 && CY2 > 0 && CY3 > 0)
 				{
 					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+					Draw(mainContext, InterpolatePixel(x, y), x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
 					if (x >= BoundingBox::coords[BoundingBox::LEFT])
 						break;
@@ -645,7 +1023,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 				{
 					// Build the new raster block every other pixel
 					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+					Draw(mainContext, InterpolatePixel(x, y), x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
 					if (y <= BoundingBox::coords[BoundingBox::BOTTOM])
 						break;
@@ -686,7 +1064,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 				{
 					// Build the new raster block every other pixel
 					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+					Draw(mainContext, InterpolatePixel(x, y), x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
 					if (x <= BoundingBox::coords[BoundingBox::RIGHT])
 						break;
@@ -701,6 +1079,8 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 			CX2 += FDY23;
 			CX3 += FDY31;
 		}
+
+		FlushCounters();
 	}
 }
 
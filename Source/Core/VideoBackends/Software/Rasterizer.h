@@ -12,6 +12,9 @@ namespace Rasterizer
 {
 	void Init();
 
+	// Stops the worker threads, they are restarted on demand.
+	void Shutdown();
+
 	void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2);
 
 	void SetScissor();
@@ -14,7 +14,7 @@
 #include "VideoBackends/Software/SWCommandProcessor.h"
 #include "VideoBackends/Software/SWRenderer.h"
 #include "VideoBackends/Software/SWStatistics.h"
-#include "VideoCommon/ImageWrite.h"
+#include "VideoCommon/ImageWriteQueue.h"
 #include "VideoCommon/OnScreenDisplay.h"
 
 static GLuint s_RenderTarget = 0;
@@ -225,7 +225,7 @@ void SWRenderer::DrawTexture(u8 *texture, int width, int height)
 	if (s_bScreenshot)
 	{
 		std::lock_guard<std::mutex> lk(s_criticalScreenshot);
-		TextureToPng(texture, width*4, s_sScreenshotName, width, height, false);
+		ImageWriteQueue::TextureToPng(texture, width*4, s_sScreenshotName, width, height, false, ImageWriteQueue::WAIT_IF_FULL);
 		// Reset settings
 		s_sScreenshotName.clear();
 		s_bScreenshot = false;
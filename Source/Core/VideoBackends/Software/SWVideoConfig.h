@@ -23,6 +23,9 @@ struct SWVideoConfig : NonCopyable
 	bool bHwRasterizer;
 	bool bBypassXFB;
 
+	// Number of threads helping to draw large triangles, 0 disables them.
+	int iRasterizerThreads;
+
 	// Emulation features
 	bool bZComploc;
 	bool bZFreeze;
@@ -2,10 +2,15 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Hash.h"
 #include "VideoBackends/Software/DebugUtil.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/SWStatistics.h"
@@ -108,20 +113,30 @@ void Tev::Init()
 		m_KonstLUT[31][comp] = &KonstantColors[3][ALP_C];
 	}
 
-	m_BiasLUT[0] = 0;
-	m_BiasLUT[1] = 128;
-	m_BiasLUT[2] = -128;
-	m_BiasLUT[3] = 0;
-
-	m_ScaleLShiftLUT[0] = 0;
-	m_ScaleLShiftLUT[1] = 1;
-	m_ScaleLShiftLUT[2] = 2;
-	m_ScaleLShiftLUT[3] = 0;
-
-	m_ScaleRShiftLUT[0] = 0;
-	m_ScaleRShiftLUT[1] = 0;
-	m_ScaleRShiftLUT[2] = 0;
-	m_ScaleRShiftLUT[3] = 1;
+	// The registers carry over from one pixel to the next, start drawing from
+	// a known state.
+	memset(Reg, 0, sizeof(Reg));
+	memset(KonstantColors, 0, sizeof(KonstantColors));
+	memset(TexColor, 0, sizeof(TexColor));
+	memset(RasColor, 0, sizeof(RasColor));
+	memset(StageKonst, 0, sizeof(StageKonst));
+	AlphaBump = 0;
+	memset(IndirectTex, 0, sizeof(IndirectTex));
+	TexCoord.s = TexCoord.t = 0;
+
+	memset(Position, 0, sizeof(Position));
+	memset(Color, 0, sizeof(Color));
+	memset(Uv, 0, sizeof(Uv));
+	memset(IndirectLod, 0, sizeof(IndirectLod));
+	memset(IndirectLinear, 0, sizeof(IndirectLinear));
+	memset(TextureLod, 0, sizeof(TextureLod));
+	memset(TextureLinear, 0, sizeof(TextureLinear));
+
+	m_config = nullptr;
+	m_config_version = 0;
+
+	memset(&Counters, 0, sizeof(Counters));
+	BBoxCoords = BoundingBox::coords;
 }
 
 static inline s16 Clamp255(s16 in)
@@ -134,28 +149,18 @@ static inline s16 Clamp1024(s16 in)
 	return in>1023?1023:(in<-1024?-1024:in);
 }
 
-void Tev::SetRasColor(int colorChan, int swaptable)
+void Tev::SetRasColor(const CompiledStage& stage)
 {
-	switch (colorChan)
+	switch (stage.rasChannel)
 	{
 	case 0: // Color0
-		{
-			u8 *color = Color[0];
-			RasColor[RED_C] = color[bpmem.tevksel[swaptable].swap1];
-			RasColor[GRN_C] = color[bpmem.tevksel[swaptable].swap2];
-			swaptable++;
-			RasColor[BLU_C] = color[bpmem.tevksel[swaptable].swap1];
-			RasColor[ALP_C] = color[bpmem.tevksel[swaptable].swap2];
-		}
-		break;
 	case 1: // Color1
 		{
-			u8 *color = Color[1];
-			RasColor[RED_C] = color[bpmem.tevksel[swaptable].swap1];
-			RasColor[GRN_C] = color[bpmem.tevksel[swaptable].swap2];
-			swaptable++;
-			RasColor[BLU_C] = color[bpmem.tevksel[swaptable].swap1];
-			RasColor[ALP_C] = color[bpmem.tevksel[swaptable].swap2];
+			u8 *color = Color[stage.rasChannel];
+			RasColor[RED_C] = color[stage.rasSwap[RED_C]];
+			RasColor[GRN_C] = color[stage.rasSwap[GRN_C]];
+			RasColor[BLU_C] = color[stage.rasSwap[BLU_C]];
+			RasColor[ALP_C] = color[stage.rasSwap[ALP_C]];
 		}
 		break;
 	case 5: // alpha bump
@@ -186,46 +191,158 @@ void Tev::SetRasColor(int colorChan, int swaptable)
 	}
 }
 
-void Tev::DrawColorRegular(TevStageCombiner::ColorCombiner &cc, const InputRegType inputs[4])
+// The mode is bits 16 to 21 of a combiner register: bias, op, clamp and shift.
+// A bias of 3 selects a compare mode, which is encoded in op and shift.
+template <u32 mode>
+void Tev::CombineColor(const InputRegType inputs[4], s16* reg)
 {
-	for (int i = 0; i < 3; i++)
+	enum
 	{
-		const InputRegType& InputReg = inputs[BLU_C + i];
+		BIAS = (mode & 3) == 1 ? 128 : (mode & 3) == 2 ? -128 : 0,
+		OP = (mode >> 2) & 1,
+		CLAMP = (mode >> 3) & 1,
+		SHIFT = mode >> 4,
+		LSHIFT = SHIFT == 3 ? 0 : SHIFT,
+		RSHIFT = SHIFT == 3 ? 1 : 0
+	};
+
+	if ((mode & 3) != 3)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			const InputRegType& InputReg = inputs[BLU_C + i];
 
-		u16 c = InputReg.c + (InputReg.c >> 7);
+			u16 c = InputReg.c + (InputReg.c >> 7);
 
-		s32 temp = InputReg.a * (256 - c) + (InputReg.b * c);
-		temp <<= m_ScaleLShiftLUT[cc.shift];
-		temp += (cc.shift == 3) ? 0 : (cc.op == 1) ? 127 : 128;
-		temp >>= 8;
-		temp = cc.op ? -temp : temp;
+			s32 temp = InputReg.a * (256 - c) + (InputReg.b * c);
+			temp <<= LSHIFT;
+			temp += (SHIFT == 3) ? 0 : (OP == 1) ? 127 : 128;
+			temp >>= 8;
+			temp = OP ? -temp : temp;
+
+			s32 result = ((InputReg.d + BIAS) << LSHIFT) + temp;
+			result = result >> RSHIFT;
 
-		s32 result = ((InputReg.d + m_BiasLUT[cc.bias]) << m_ScaleLShiftLUT[cc.shift]) + temp;
-		result = result >> m_ScaleRShiftLUT[cc.shift];
+			reg[BLU_C + i] = result;
+		}
+	}
+	else
+	{
+		for (int i = BLU_C; i <= RED_C; i++)
+		{
+			switch ((SHIFT << 1) | OP | 8)  // encoded compare mode
+			{
+			case TEVCMP_R8_GT:
+				reg[i] = inputs[i].d + ((inputs[RED_C].a > inputs[RED_C].b) ? inputs[i].c : 0);
+				break;
+
+			case TEVCMP_R8_EQ:
+				reg[i] = inputs[i].d + ((inputs[RED_C].a == inputs[RED_C].b) ? inputs[i].c : 0);
+				break;
+
+			case TEVCMP_GR16_GT:
+				{
+					u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
+					u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
+					reg[i] = inputs[i].d + ((a > b) ? inputs[i].c : 0);
+				}
+				break;
+
+			case TEVCMP_GR16_EQ:
+				{
+					u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
+					u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
+					reg[i] = inputs[i].d + ((a == b) ? inputs[i].c : 0);
+				}
+				break;
+
+			case TEVCMP_BGR24_GT:
+				{
+					u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
+					u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
+					reg[i] = inputs[i].d + ((a > b) ? inputs[i].c : 0);
+				}
+				break;
+
+			case TEVCMP_BGR24_EQ:
+				{
+					u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
+					u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
+					reg[i] = inputs[i].d + ((a == b) ? inputs[i].c : 0);
+				}
+				break;
+
+			case TEVCMP_RGB8_GT:
+				reg[i] = inputs[i].d + ((inputs[i].a > inputs[i].b) ? inputs[i].c : 0);
+				break;
+
+			case TEVCMP_RGB8_EQ:
+				reg[i] = inputs[i].d + ((inputs[i].a == inputs[i].b) ? inputs[i].c : 0);
+				break;
+			}
+		}
+	}
 
-		Reg[cc.dest][BLU_C + i] = result;
+	if (CLAMP)
+	{
+		reg[RED_C] = Clamp255(reg[RED_C]);
+		reg[GRN_C] = Clamp255(reg[GRN_C]);
+		reg[BLU_C] = Clamp255(reg[BLU_C]);
+	}
+	else
+	{
+		reg[RED_C] = Clamp1024(reg[RED_C]);
+		reg[GRN_C] = Clamp1024(reg[GRN_C]);
+		reg[BLU_C] = Clamp1024(reg[BLU_C]);
 	}
 }
 
-void Tev::DrawColorCompare(TevStageCombiner::ColorCombiner &cc, const InputRegType inputs[4])
+template <u32 mode>
+void Tev::CombineAlpha(const InputRegType inputs[4], s16* reg)
 {
-	for (int i = BLU_C; i <= RED_C; i++)
+	enum
+	{
+		BIAS = (mode & 3) == 1 ? 128 : (mode & 3) == 2 ? -128 : 0,
+		OP = (mode >> 2) & 1,
+		CLAMP = (mode >> 3) & 1,
+		SHIFT = mode >> 4,
+		LSHIFT = SHIFT == 3 ? 0 : SHIFT,
+		RSHIFT = SHIFT == 3 ? 1 : 0
+	};
+
+	if ((mode & 3) != 3)
 	{
-		switch ((cc.shift<<1)|cc.op|8)  // encoded compare mode
+		const InputRegType& InputReg = inputs[ALP_C];
+
+		u16 c = InputReg.c + (InputReg.c >> 7);
+
+		s32 temp = InputReg.a * (256 - c) + (InputReg.b * c);
+		temp <<= LSHIFT;
+		temp += (SHIFT != 3) ? 0 : (OP == 1) ? 127 : 128;
+		temp = OP ? (-temp >> 8) : (temp >> 8);
+
+		s32 result = ((InputReg.d + BIAS) << LSHIFT) + temp;
+		result = result >> RSHIFT;
+
+		reg[ALP_C] = result;
+	}
+	else
+	{
+		switch ((SHIFT << 1) | OP | 8)  // encoded compare mode
 		{
 		case TEVCMP_R8_GT:
-			Reg[cc.dest][i] = inputs[i].d + ((inputs[RED_C].a > inputs[RED_C].b) ? inputs[i].c : 0);
+			reg[ALP_C] = inputs[ALP_C].d + ((inputs[RED_C].a > inputs[RED_C].b) ? inputs[ALP_C].c : 0);
 			break;
 
 		case TEVCMP_R8_EQ:
-			Reg[cc.dest][i] = inputs[i].d + ((inputs[RED_C].a == inputs[RED_C].b) ? inputs[i].c : 0);
+			reg[ALP_C] = inputs[ALP_C].d + ((inputs[RED_C].a == inputs[RED_C].b) ? inputs[ALP_C].c : 0);
 			break;
 
 		case TEVCMP_GR16_GT:
 			{
 				u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
 				u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-				Reg[cc.dest][i] = inputs[i].d + ((a > b) ? inputs[i].c : 0);
+				reg[ALP_C] = inputs[ALP_C].d + ((a > b) ? inputs[ALP_C].c : 0);
 			}
 			break;
 
@@ -233,7 +350,7 @@ void Tev::DrawColorCompare(TevStageCombiner::ColorCombiner &cc, const InputRegTy
 			{
 				u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
 				u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-				Reg[cc.dest][i] = inputs[i].d + ((a == b) ? inputs[i].c : 0);
+				reg[ALP_C] = inputs[ALP_C].d + ((a == b) ? inputs[ALP_C].c : 0);
 			}
 			break;
 
@@ -241,7 +358,7 @@ void Tev::DrawColorCompare(TevStageCombiner::ColorCombiner &cc, const InputRegTy
 			{
 				u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
 				u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-				Reg[cc.dest][i] = inputs[i].d + ((a > b) ? inputs[i].c : 0);
+				reg[ALP_C] = inputs[ALP_C].d + ((a > b) ? inputs[ALP_C].c : 0);
 			}
 			break;
 
@@ -249,90 +366,145 @@ void Tev::DrawColorCompare(TevStageCombiner::ColorCombiner &cc, const InputRegTy
 			{
 				u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
 				u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-				Reg[cc.dest][i] = inputs[i].d + ((a == b) ? inputs[i].c : 0);
+				reg[ALP_C] = inputs[ALP_C].d + ((a == b) ? inputs[ALP_C].c : 0);
 			}
 			break;
 
-		case TEVCMP_RGB8_GT:
-			Reg[cc.dest][i] = inputs[i].d + ((inputs[i].a > inputs[i].b) ? inputs[i].c : 0);
+		case TEVCMP_A8_GT:
+			reg[ALP_C] = inputs[ALP_C].d + ((inputs[ALP_C].a > inputs[ALP_C].b) ? inputs[ALP_C].c : 0);
 			break;
 
-		case TEVCMP_RGB8_EQ:
-			Reg[cc.dest][i] = inputs[i].d + ((inputs[i].a == inputs[i].b) ? inputs[i].c : 0);
+		case TEVCMP_A8_EQ:
+			reg[ALP_C] = inputs[ALP_C].d + ((inputs[ALP_C].a == inputs[ALP_C].b) ? inputs[ALP_C].c : 0);
 			break;
 		}
 	}
+
+	if (CLAMP)
+		reg[ALP_C] = Clamp255(reg[ALP_C]);
+	else
+		reg[ALP_C] = Clamp1024(reg[ALP_C]);
 }
 
-void Tev::DrawAlphaRegular(TevStageCombiner::AlphaCombiner &ac, const InputRegType inputs[4])
-{
-	const InputRegType& InputReg = inputs[ALP_C];
+#define COMBINERS_4(f, n) &Tev::f<n>, &Tev::f<n + 1>, &Tev::f<n + 2>, &Tev::f<n + 3>
+#define COMBINERS_16(f, n) COMBINERS_4(f, n), COMBINERS_4(f, n + 4), COMBINERS_4(f, n + 8), COMBINERS_4(f, n + 12)
+#define COMBINERS_64(f) COMBINERS_16(f, 0), COMBINERS_16(f, 16), COMBINERS_16(f, 32), COMBINERS_16(f, 48)
 
-	u16 c = InputReg.c + (InputReg.c >> 7);
+const Tev::CombinerFunction Tev::s_color_combiners[64] = { COMBINERS_64(CombineColor) };
+const Tev::CombinerFunction Tev::s_alpha_combiners[64] = { COMBINERS_64(CombineAlpha) };
 
-	s32 temp = InputReg.a * (256 - c) + (InputReg.b * c);
-	temp <<= m_ScaleLShiftLUT[ac.shift];
-	temp += (ac.shift != 3) ? 0 : (ac.op == 1) ? 127 : 128;
-	temp = ac.op ? (-temp >> 8) : (temp >> 8);
+#undef COMBINERS_64
+#undef COMBINERS_16
+#undef COMBINERS_4
 
-	s32 result = ((InputReg.d + m_BiasLUT[ac.bias]) << m_ScaleLShiftLUT[ac.shift]) + temp;
-	result = result >> m_ScaleRShiftLUT[ac.shift];
+namespace
+{
+// All registers the compiled stages are decoded from. Stages past the last
+// one are left zero, so that they don't cause separate configurations.
+struct TevConfigKey
+{
+	u32 numStages;
+	u32 colorCombiners[16];
+	u32 alphaCombiners[16];
+	u32 orders[8];
+	u32 ksel[8];
 
-	Reg[ac.dest][ALP_C] = result;
-}
+	bool operator==(const TevConfigKey& other) const
+	{
+		return memcmp(this, &other, sizeof(*this)) == 0;
+	}
+};
 
-void Tev::DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4])
+struct TevConfigKeyHash
 {
-	switch ((ac.shift<<1)|ac.op|8)  // encoded compare mode
+	size_t operator()(const TevConfigKey& key) const
 	{
-	case TEVCMP_R8_GT:
-		Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((inputs[RED_C].a > inputs[RED_C].b) ? inputs[ALP_C].c : 0);
-		break;
+		return (size_t)GetMurmurHash3((const u8*)&key, sizeof(key), 0);
+	}
+};
+}
 
-	case TEVCMP_R8_EQ:
-		Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((inputs[RED_C].a == inputs[RED_C].b) ? inputs[ALP_C].c : 0);
-		break;
+// Compiled configurations are never removed, other threads may still be
+// drawing with them. Games only use a limited number of them anyway.
+static std::mutex s_config_lock;
+static std::unordered_map<TevConfigKey, Tev::CompiledConfig, TevConfigKeyHash> s_configs;
+static std::atomic<u32> s_config_version(1);
 
-	case TEVCMP_GR16_GT:
-		{
-			u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
-			u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-			Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((a > b) ? inputs[ALP_C].c : 0);
-		}
-		break;
+void Tev::InvalidateConfig()
+{
+	s_config_version++;
+}
 
-	case TEVCMP_GR16_EQ:
-		{
-			u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
-			u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-			Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((a == b) ? inputs[ALP_C].c : 0);
-		}
-		break;
+void Tev::UpdateConfig()
+{
+	TevConfigKey key;
+	memset(&key, 0, sizeof(key));
+	key.numStages = bpmem.genMode.numtevstages;
+	for (unsigned int stageNum = 0; stageNum <= key.numStages; stageNum++)
+	{
+		key.colorCombiners[stageNum] = bpmem.combiners[stageNum].colorC.hex;
+		key.alphaCombiners[stageNum] = bpmem.combiners[stageNum].alphaC.hex;
+		key.orders[stageNum >> 1] = bpmem.tevorders[stageNum >> 1].hex;
+	}
+	for (int i = 0; i < 8; i++)
+		key.ksel[i] = bpmem.tevksel[i].hex;
 
-	case TEVCMP_BGR24_GT:
-		{
-			u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
-			u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-			Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((a > b) ? inputs[ALP_C].c : 0);
-		}
-		break;
+	m_config_version = s_config_version.load();
 
-	case TEVCMP_BGR24_EQ:
-		{
-			u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
-			u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-			Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((a == b) ? inputs[ALP_C].c : 0);
-		}
-		break;
+	std::lock_guard<std::mutex> lk(s_config_lock);
 
-	case TEVCMP_A8_GT:
-		Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((inputs[ALP_C].a > inputs[ALP_C].b) ? inputs[ALP_C].c : 0);
-		break;
+	auto it = s_configs.find(key);
+	if (it != s_configs.end())
+	{
+		m_config = &it->second;
+		return;
+	}
 
-	case TEVCMP_A8_EQ:
-		Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((inputs[ALP_C].a == inputs[ALP_C].b) ? inputs[ALP_C].c : 0);
-		break;
+	CompiledConfig& config = s_configs[key];
+	for (unsigned int stageNum = 0; stageNum <= key.numStages; stageNum++)
+	{
+		int stageOdd = stageNum&1;
+		TwoTevStageOrders &order = bpmem.tevorders[stageNum >> 1];
+		TevKSel &kSel = bpmem.tevksel[stageNum >> 1];
+		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
+		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
+		CompiledStage& stage = config.stages[stageNum];
+
+		stage.colorCombiner = s_color_combiners[(cc.hex >> 16) & 0x3f];
+		stage.alphaCombiner = s_alpha_combiners[(ac.hex >> 16) & 0x3f];
+		stage.colorInputs[0] = cc.a;
+		stage.colorInputs[1] = cc.b;
+		stage.colorInputs[2] = cc.c;
+		stage.colorInputs[3] = cc.d;
+		stage.alphaInputs[0] = ac.a;
+		stage.alphaInputs[1] = ac.b;
+		stage.alphaInputs[2] = ac.c;
+		stage.alphaInputs[3] = ac.d;
+		stage.colorDest = cc.dest;
+		stage.alphaDest = ac.dest;
+
+		stage.konstColor = kSel.getKC(stageOdd);
+		stage.konstAlpha = kSel.getKA(stageOdd);
+
+		stage.texture = order.getEnable(stageOdd) != 0;
+		stage.texMap = order.getTexMap(stageOdd);
+		stage.texCoord = order.getTexCoord(stageOdd);
+		stage.rasChannel = order.getColorChan(stageOdd);
+
+		int swaptable = ac.tswap * 2;
+		stage.texSwap[RED_C] = bpmem.tevksel[swaptable].swap1;
+		stage.texSwap[GRN_C] = bpmem.tevksel[swaptable].swap2;
+		stage.texSwap[BLU_C] = bpmem.tevksel[swaptable + 1].swap1;
+		stage.texSwap[ALP_C] = bpmem.tevksel[swaptable + 1].swap2;
+
+		swaptable = ac.rswap * 2;
+		stage.rasSwap[RED_C] = bpmem.tevksel[swaptable].swap1;
+		stage.rasSwap[GRN_C] = bpmem.tevksel[swaptable].swap2;
+		stage.rasSwap[BLU_C] = bpmem.tevksel[swaptable + 1].swap1;
+		stage.rasSwap[ALP_C] = bpmem.tevksel[swaptable + 1].swap2;
 	}
+
+	m_config = &config;
 }
 
 static bool AlphaCompare(int alpha, int ref, AlphaTest::CompareMode comp)
@@ -509,7 +681,7 @@ void Tev::Draw()
 	_assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
 	_assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
 
-	INCSTAT(swstats.thisFrame.tevPixelsIn);
+	Counters.tevPixelsIn++;
 
 	for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages; stageNum++)
 	{
@@ -524,7 +696,7 @@ void Tev::Draw()
 		s32 scaleT = stageOdd ? texscale.ts1:texscale.ts0;
 
 		TextureSampler::Sample(Uv[texcoordSel].s >> scaleS, Uv[texcoordSel].t >> scaleT,
-			IndirectLod[stageNum], IndirectLinear[stageNum], texmap, IndirectTex[stageNum]);
+			IndirectLod[stageNum], IndirectLinear[stageNum], texmap, IndirectTex[stageNum], &m_texture_cache);
 
 #if ALLOW_TEV_DUMPS
 		if (g_SWVideoConfig.bDumpTevStages)
@@ -540,96 +712,59 @@ void Tev::Draw()
 #endif
 	}
 
+	if (!m_config || m_config_version != s_config_version.load(std::memory_order_relaxed))
+		UpdateConfig();
+
 	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
 	{
-		int stageNum2 = stageNum >> 1;
-		int stageOdd = stageNum&1;
-		TwoTevStageOrders &order = bpmem.tevorders[stageNum2];
-		TevKSel &kSel = bpmem.tevksel[stageNum2];
+		const CompiledStage& stage = m_config->stages[stageNum];
 
-		// stage combiners
-		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
-		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
-
-		int texcoordSel = order.getTexCoord(stageOdd);
-		int texmap = order.getTexMap(stageOdd);
-
-		Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
+		Indirect(stageNum, Uv[stage.texCoord].s, Uv[stage.texCoord].t);
 
 		// sample texture
-		if (order.getEnable(stageOdd))
+		if (stage.texture)
 		{
 			// RGBA
 			u8 texel[4];
 
-			TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum], texmap, texel);
+			TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum], stage.texMap, texel, &m_texture_cache);
 
 #if ALLOW_TEV_DUMPS
 			if (g_SWVideoConfig.bDumpTevTextureFetches)
 				DebugUtil::DrawTempBuffer(texel, DIRECT_TFETCH + stageNum);
 #endif
 
-			int swaptable = ac.tswap * 2;
-
-			TexColor[RED_C] = texel[bpmem.tevksel[swaptable].swap1];
-			TexColor[GRN_C] = texel[bpmem.tevksel[swaptable].swap2];
-			swaptable++;
-			TexColor[BLU_C] = texel[bpmem.tevksel[swaptable].swap1];
-			TexColor[ALP_C] = texel[bpmem.tevksel[swaptable].swap2];
+			TexColor[RED_C] = texel[stage.texSwap[RED_C]];
+			TexColor[GRN_C] = texel[stage.texSwap[GRN_C]];
+			TexColor[BLU_C] = texel[stage.texSwap[BLU_C]];
+			TexColor[ALP_C] = texel[stage.texSwap[ALP_C]];
 		}
 
 		// set konst for this stage
-		int kc = kSel.getKC(stageOdd);
-		int ka = kSel.getKA(stageOdd);
-		StageKonst[RED_C] = *(m_KonstLUT[kc][RED_C]);
-		StageKonst[GRN_C] = *(m_KonstLUT[kc][GRN_C]);
-		StageKonst[BLU_C] = *(m_KonstLUT[kc][BLU_C]);
-		StageKonst[ALP_C] = *(m_KonstLUT[ka][ALP_C]);
+		StageKonst[RED_C] = *(m_KonstLUT[stage.konstColor][RED_C]);
+		StageKonst[GRN_C] = *(m_KonstLUT[stage.konstColor][GRN_C]);
+		StageKonst[BLU_C] = *(m_KonstLUT[stage.konstColor][BLU_C]);
+		StageKonst[ALP_C] = *(m_KonstLUT[stage.konstAlpha][ALP_C]);
 
 		// set color
-		SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
+		SetRasColor(stage);
 
 		// combine inputs
 		InputRegType inputs[4];
 		for (int i = 0; i < 3; i++)
 		{
-			inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
-			inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
-			inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
-			inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
-		}
-		inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
-		inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
-		inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
-		inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
-
-		if (cc.bias != 3)
-			DrawColorRegular(cc, inputs);
-		else
-			DrawColorCompare(cc, inputs);
-
-		if (cc.clamp)
-		{
-			Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
-		}
-		else
-		{
-			Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
+			inputs[BLU_C + i].a = *m_ColorInputLUT[stage.colorInputs[0]][i];
+			inputs[BLU_C + i].b = *m_ColorInputLUT[stage.colorInputs[1]][i];
+			inputs[BLU_C + i].c = *m_ColorInputLUT[stage.colorInputs[2]][i];
+			inputs[BLU_C + i].d = *m_ColorInputLUT[stage.colorInputs[3]][i];
 		}
+		inputs[ALP_C].a = *m_AlphaInputLUT[stage.alphaInputs[0]];
+		inputs[ALP_C].b = *m_AlphaInputLUT[stage.alphaInputs[1]];
+		inputs[ALP_C].c = *m_AlphaInputLUT[stage.alphaInputs[2]];
+		inputs[ALP_C].d = *m_AlphaInputLUT[stage.alphaInputs[3]];
 
-		if (ac.bias != 3)
-			DrawAlphaRegular(ac, inputs);
-		else
-			DrawAlphaCompare(ac, inputs);
-
-		if (ac.clamp)
-			Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
-		else
-			Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+		stage.colorCombiner(inputs, Reg[stage.colorDest]);
+		stage.alphaCombiner(inputs, Reg[stage.alphaDest]);
 
 #if ALLOW_TEV_DUMPS
 		if (g_SWVideoConfig.bDumpTevStages)
@@ -643,8 +778,8 @@ void Tev::Draw()
 	// convert to 8 bits per component
 	// the results of the last tev stage are put onto the screen,
 	// regardless of the used destination register - TODO: Verify!
-	u32 color_index = bpmem.combiners[bpmem.genMode.numtevstages].colorC.dest;
-	u32 alpha_index = bpmem.combiners[bpmem.genMode.numtevstages].alphaC.dest;
+	u32 color_index = m_config->stages[bpmem.genMode.numtevstages].colorDest;
+	u32 alpha_index = m_config->stages[bpmem.genMode.numtevstages].alphaDest;
 	u8 output[4] = {(u8)Reg[alpha_index][ALP_C], (u8)Reg[color_index][BLU_C], (u8)Reg[color_index][GRN_C], (u8)Reg[color_index][RED_C]};
 
 	if (!TevAlphaTest(output[ALP_C]))
@@ -762,20 +897,20 @@ void Tev::Draw()
 		if (late_ztest && bpmem.zmode.testenable)
 		{
 			// TODO: Check against hw if these values get incremented even if depth testing is disabled
-			EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT);
+			Counters.perfQuads[PQ_ZCOMP_INPUT]++;
 
 			if (!EfbInterface::ZCompare(Position[0], Position[1], Position[2]))
 				return;
 
-			EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT);
+			Counters.perfQuads[PQ_ZCOMP_OUTPUT]++;
 		}
 	}
 
 	// branchless bounding box update
-	BoundingBox::coords[BoundingBox::LEFT] = std::min((u16)Position[0], BoundingBox::coords[BoundingBox::LEFT]);
-	BoundingBox::coords[BoundingBox::RIGHT] = std::max((u16)Position[0], BoundingBox::coords[BoundingBox::RIGHT]);
-	BoundingBox::coords[BoundingBox::TOP] = std::min((u16)Position[1], BoundingBox::coords[BoundingBox::TOP]);
-	BoundingBox::coords[BoundingBox::BOTTOM] = std::max((u16)Position[1], BoundingBox::coords[BoundingBox::BOTTOM]);
+	BBoxCoords[BoundingBox::LEFT] = std::min((u16)Position[0], BBoxCoords[BoundingBox::LEFT]);
+	BBoxCoords[BoundingBox::RIGHT] = std::max((u16)Position[0], BBoxCoords[BoundingBox::RIGHT]);
+	BBoxCoords[BoundingBox::TOP] = std::min((u16)Position[1], BBoxCoords[BoundingBox::TOP]);
+	BBoxCoords[BoundingBox::BOTTOM] = std::max((u16)Position[1], BBoxCoords[BoundingBox::BOTTOM]);
 
 	// if we are only calculating the bounding box,
 	// there's no need to actually draw anything
@@ -803,8 +938,8 @@ void Tev::Draw()
 	}
 #endif
 
-	INCSTAT(swstats.thisFrame.tevPixelsOut);
-	EfbInterface::IncPerfCounterQuadCount(PQ_BLEND_INPUT);
+	Counters.tevPixelsOut++;
+	Counters.perfQuads[PQ_BLEND_INPUT]++;
 
 	EfbInterface::BlendTev(Position[0], Position[1], output);
 }
@@ -821,6 +956,94 @@ void Tev::SetRegColor(int reg, int comp, bool konst, s16 color)
 	}
 }
 
+void Tev::CopyState(const Tev& other)
+{
+	memcpy(Reg, other.Reg, sizeof(Reg));
+	memcpy(KonstantColors, other.KonstantColors, sizeof(KonstantColors));
+	memcpy(TexColor, other.TexColor, sizeof(TexColor));
+	memcpy(RasColor, other.RasColor, sizeof(RasColor));
+	memcpy(StageKonst, other.StageKonst, sizeof(StageKonst));
+	AlphaBump = other.AlphaBump;
+	memcpy(IndirectTex, other.IndirectTex, sizeof(IndirectTex));
+	TexCoord = other.TexCoord;
+
+	memcpy(Position, other.Position, sizeof(Position));
+	memcpy(Color, other.Color, sizeof(Color));
+	memcpy(Uv, other.Uv, sizeof(Uv));
+	memcpy(IndirectLod, other.IndirectLod, sizeof(IndirectLod));
+	memcpy(IndirectLinear, other.IndirectLinear, sizeof(IndirectLinear));
+	memcpy(TextureLod, other.TextureLod, sizeof(TextureLod));
+	memcpy(TextureLinear, other.TextureLinear, sizeof(TextureLinear));
+
+	m_config = other.m_config;
+	m_config_version = other.m_config_version;
+}
+
+bool Tev::ReadsPreviousPixel() const
+{
+	// Registers written by any stage change from pixel to pixel, the others
+	// keep the values set through SetRegColor.
+	bool color_varies[4] = {};
+	bool alpha_varies[4] = {};
+	bool tex_varies = false;
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+	{
+		color_varies[bpmem.combiners[stageNum].colorC.dest] = true;
+		alpha_varies[bpmem.combiners[stageNum].alphaC.dest] = true;
+		tex_varies |= bpmem.tevorders[stageNum >> 1].getEnable(stageNum & 1) != 0;
+
+		// Indirect() leaves the texture coordinate alone for invalid matrices.
+		const TevStageIndirect& indirect = bpmem.tevind[stageNum];
+		if ((indirect.mid & 3) && (indirect.mid & 12) == 12)
+			return true;
+	}
+
+	// The first stage can add the coordinate of the previous one.
+	if (bpmem.tevind[0].fb_addprev)
+		return true;
+
+	bool color_written[4] = {};
+	bool alpha_written[4] = {};
+	bool tex_written = false;
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+	{
+		const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
+		const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
+
+		tex_written |= bpmem.tevorders[stageNum >> 1].getEnable(stageNum & 1) != 0;
+
+		// All inputs are read before either combiner writes its result.
+		const u32 color_inputs[4] = { cc.a, cc.b, cc.c, cc.d };
+		for (u32 input : color_inputs)
+		{
+			if (input < 8)
+			{
+				const u32 reg = input >> 1;
+				if ((input & 1) ? (alpha_varies[reg] && !alpha_written[reg]) : (color_varies[reg] && !color_written[reg]))
+					return true;
+			}
+			else if (input < 10 && tex_varies && !tex_written)
+			{
+				return true;
+			}
+		}
+
+		const u32 alpha_inputs[4] = { ac.a, ac.b, ac.c, ac.d };
+		for (u32 input : alpha_inputs)
+		{
+			if (input < 4 && alpha_varies[input] && !alpha_written[input])
+				return true;
+			if (input == 4 && tex_varies && !tex_written)
+				return true;
+		}
+
+		color_written[cc.dest] = true;
+		alpha_written[ac.dest] = true;
+	}
+
+	return false;
+}
+
 void Tev::DoState(PointerWrap &p)
 {
 	p.DoArray(Reg, sizeof(Reg));
@@ -836,10 +1059,6 @@ void Tev::DoState(PointerWrap &p)
 	p.DoArray(IndirectTex, sizeof(IndirectTex));
 	p.Do(TexCoord);
 
-	p.DoArray(m_BiasLUT,4);
-	p.DoArray(m_ScaleLShiftLUT,4);
-	p.DoArray(m_ScaleRShiftLUT,4);
-
 	p.DoArray(Position,3);
 	p.DoArray(Color, sizeof(Color));
 	p.DoArray(Uv, 8);
@@ -847,4 +1066,8 @@ void Tev::DoState(PointerWrap &p)
 	p.DoArray(IndirectLinear,4);
 	p.DoArray(TextureLod,16);
 	p.DoArray(TextureLinear,16);
+
+	// bpmem was loaded without going through the register writes.
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		InvalidateConfig();
 }
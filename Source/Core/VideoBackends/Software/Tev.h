@@ -5,6 +5,8 @@
 #pragma once
 
 #include "VideoBackends/Software/BPMemLoader.h"
+#include "VideoBackends/Software/TextureSampler.h"
+#include "VideoCommon/PerfQueryBase.h"
 
 class PointerWrap;
 
@@ -40,9 +42,6 @@ class Tev
 	s16 *m_ColorInputLUT[16][3];
 	s16 *m_AlphaInputLUT[8];        // values must point to ABGR color
 	s16 *m_KonstLUT[32][4];
-	s16 m_BiasLUT[4];
-	u8 m_ScaleLShiftLUT[4];
-	u8 m_ScaleRShiftLUT[4];
 
 	// enumeration for color input LUT
 	enum
@@ -59,12 +58,50 @@ class Tev
 		INDIRECT = 32
 	};
 
-	void SetRasColor(int colorChan, int swaptable);
+	// Combiners specialized for each mode, writing to the given register.
+	typedef void (*CombinerFunction)(const InputRegType inputs[4], s16* reg);
+	template <u32 mode> static void CombineColor(const InputRegType inputs[4], s16* reg);
+	template <u32 mode> static void CombineAlpha(const InputRegType inputs[4], s16* reg);
+	static const CombinerFunction s_color_combiners[64];
+	static const CombinerFunction s_alpha_combiners[64];
 
-	void DrawColorRegular(TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4]);
-	void DrawColorCompare(TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4]);
-	void DrawAlphaRegular(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
-	void DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
+public:
+	// A TEV stage with all its bit fields decoded and its combiners picked
+	// ahead of time, instead of doing so for every pixel.
+	struct CompiledStage
+	{
+		CombinerFunction colorCombiner;
+		CombinerFunction alphaCombiner;
+		u8 colorInputs[4];
+		u8 alphaInputs[4];
+		u8 colorDest;
+		u8 alphaDest;
+		u8 konstColor;
+		u8 konstAlpha;
+		bool texture;
+		u8 texMap;
+		u8 texCoord;
+		u8 texSwap[4];
+		u8 rasChannel;
+		u8 rasSwap[4];
+	};
+
+	struct CompiledConfig
+	{
+		CompiledStage stages[16];
+	};
+
+private:
+	// Shared by all instances with the same configuration, see UpdateConfig().
+	const CompiledConfig* m_config;
+	u32 m_config_version;
+
+	void UpdateConfig();
+
+	// Not copied by CopyState(), every instance decodes the texels it needs.
+	TextureSampler::Cache m_texture_cache;
+
+	void SetRasColor(const CompiledStage& stage);
 
 	void Indirect(unsigned int stageNum, s32 s, s32 t);
 
@@ -77,6 +114,20 @@ public:
 	s32 TextureLod[16];
 	bool TextureLinear[16];
 
+	// Counted per instance so that several of them can draw the pixels of a
+	// triangle at once, the rasterizer adds them up after each triangle.
+	struct PixelCounters
+	{
+		u32 rasterizedPixels;
+		u32 tevPixelsIn;
+		u32 tevPixelsOut;
+		u32 perfQuads[PQ_NUM_MEMBERS];
+	};
+	PixelCounters Counters;
+
+	// Bounding box updated by Draw(), usually BoundingBox::coords.
+	u16* BBoxCoords;
+
 	enum
 	{
 		ALP_C,
@@ -91,5 +142,18 @@ public:
 
 	void SetRegColor(int reg, int comp, bool konst, s16 color);
 
+	// Has to be called when any register the TEV stages are compiled from
+	// changes: the number of stages, the combiners, orders or swap tables.
+	static void InvalidateConfig();
+
+	// Copies all registers and pixel inputs, but not the counters.
+	void CopyState(const Tev& other);
+
+	// The stage results and texture colors of a pixel stay in the registers
+	// until the next pixel overwrites them. Returns true if the current TEV
+	// configuration reads any of them before writing them, i.e. if the output
+	// of a pixel depends on the previous one.
+	bool ReadsPreviousPixel() const;
+
 	void DoState(PointerWrap &p);
 };
@@ -3,7 +3,9 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstring>
 
 #include "Common/Common.h"
 #include "Core/HW/Memmap.h"
@@ -57,59 +59,20 @@ static inline void AddTexel(u8 *inTexel, u32 *outTexel, u32 fract)
 	outTexel[3] += inTexel[3] * fract;
 }
 
-void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8 *sample)
-{
-	int baseMip = 0;
-	bool mipLinear = false;
-
-#if (ALLOW_MIPMAP)
-	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
-	TexMode0& tm0 = texUnit.texMode0[texmap & 3];
-
-	s32 lodFract = lod & 0xf;
-
-	if (lod > 0 && tm0.min_filter & 3)
-	{
-		// use mipmap
-		baseMip = lod >> 4;
-		mipLinear = (lodFract && tm0.min_filter & 2);
-
-		// if using nearest mip filter and lodFract >= 0.5 round up to next mip
-		baseMip += (lodFract >> 3) & (tm0.min_filter & 1);
-	}
-
-	if (mipLinear)
-	{
-		u8 sampledTex[4];
-		u32 texel[4];
-
-		SampleMip(s, t, baseMip, linear, texmap, sampledTex);
-		SetTexel(sampledTex, texel, (16 - lodFract));
-
-		SampleMip(s, t, baseMip + 1, linear, texmap, sampledTex);
-		AddTexel(sampledTex, texel, lodFract);
+static std::atomic<u32> s_cache_invalidation(0);
 
-		sample[0] = (u8)(texel[0] >> 4);
-		sample[1] = (u8)(texel[1] >> 4);
-		sample[2] = (u8)(texel[2] >> 4);
-		sample[3] = (u8)(texel[3] >> 4);
-	}
-	else
-#endif
-	{
-		SampleMip(s, t, baseMip, linear, texmap, sample);
-	}
+void InvalidateCaches()
+{
+	s_cache_invalidation.fetch_add(1, std::memory_order_relaxed);
 }
 
-void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
+static void GetTexLevel(u8 texmap, s32 mip, TexLevel* level)
 {
 	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
 	u8 subTexmap = texmap & 3;
 
-	TexMode0& tm0 = texUnit.texMode0[subTexmap];
 	TexImage0& ti0 = texUnit.texImage0[subTexmap];
 	TexTLUT& texTlut = texUnit.texTlut[subTexmap];
-	TlutFormat tlutfmt = (TlutFormat) texTlut.tlut_format;
 
 	u8 *imageSrc, *imageSrcOdd = nullptr;
 	if (texUnit.texImage1[subTexmap].image_type)
@@ -127,10 +90,7 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 	int imageWidth = ti0.width;
 	int imageHeight = ti0.height;
 
-	int tlutAddress = texTlut.tmem_offset << 9;
-	const u8* tlut = &texMem[tlutAddress];
-
-	// reduce sample location and texture size to mip level
+	// reduce texture size to mip level
 	// move texture pointer to mip location
 	if (mip)
 	{
@@ -143,8 +103,6 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 
 		imageWidth >>= mip;
 		imageHeight >>= mip;
-		s >>= mip;
-		t >>= mip;
 
 		while (mip)
 		{
@@ -159,6 +117,183 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		}
 	}
 
+	level->src = imageSrc;
+	level->srcOdd = imageSrcOdd;
+	level->tlut = &texMem[texTlut.tmem_offset << 9];
+	level->width = imageWidth;
+	level->height = imageHeight;
+	level->format = ti0.format;
+	level->tlutFormat = (TlutFormat) texTlut.tlut_format;
+}
+
+static inline void DecodeTexel(const TexLevel& level, int s, int t, u8* texel)
+{
+	if (level.srcOdd)
+		TexDecoder_DecodeTexelRGBA8FromTmem(texel, level.src, level.srcOdd, s, t, level.width);
+	else
+		TexDecoder_DecodeTexel(texel, level.src, s, t, level.width, level.format, level.tlut, level.tlutFormat);
+}
+
+Cache::Cache()
+	: m_generation(1), m_invalidation(s_cache_invalidation.load(std::memory_order_relaxed))
+{
+	for (auto& texmapLevels : m_levels)
+		for (auto& level : texmapLevels)
+			level.generation = 0;
+}
+
+Cache::Level* Cache::GetLevel(u8 texmap, int mip)
+{
+	if (mip < 0 || mip >= MAX_LEVELS)
+		return nullptr;
+
+	u32 invalidation = s_cache_invalidation.load(std::memory_order_relaxed);
+	if (invalidation != m_invalidation)
+	{
+		m_invalidation = invalidation;
+
+		// Generation 0 marks tiles which were never decoded.
+		if (++m_generation == 0)
+		{
+			for (auto& texmapLevels : m_levels)
+			{
+				for (auto& level : texmapLevels)
+				{
+					level.generation = 0;
+					std::fill(level.tileGenerations.begin(), level.tileGenerations.end(), 0);
+				}
+			}
+			m_generation = 1;
+		}
+	}
+
+	Level& level = m_levels[texmap & 7][mip];
+	if (level.generation != m_generation)
+	{
+		GetTexLevel(texmap, mip, &level.params);
+
+		level.tilesPerRow = level.params.width / TILE_SIZE + 1;
+		size_t numTiles = level.tilesPerRow * (level.params.height / TILE_SIZE + 1);
+		if (level.tileGenerations.size() < numTiles)
+		{
+			level.texels.resize(numTiles * TILE_SIZE * TILE_SIZE);
+			level.tileGenerations.resize(numTiles, 0);
+		}
+		level.generation = m_generation;
+	}
+
+	return &level;
+}
+
+void Cache::DecodeTile(Level& level, int tileX, int tileY, u32* tile)
+{
+	int maxX = std::min<int>(TILE_SIZE - 1, level.params.width - tileX * TILE_SIZE);
+	int maxY = std::min<int>(TILE_SIZE - 1, level.params.height - tileY * TILE_SIZE);
+
+	for (int y = 0; y <= maxY; y++)
+	{
+		for (int x = 0; x <= maxX; x++)
+		{
+			DecodeTexel(level.params, tileX * TILE_SIZE + x, tileY * TILE_SIZE + y,
+			            (u8*)&tile[y * TILE_SIZE + x]);
+		}
+	}
+}
+
+void Cache::GetTexel(Level& level, int s, int t, u8* texel)
+{
+	// Invalid wrap modes leave the coordinates outside of the texture.
+	if ((u32)s > (u32)level.params.width || (u32)t > (u32)level.params.height)
+	{
+		DecodeTexel(level.params, s, t, texel);
+		return;
+	}
+
+	int tileX = s / TILE_SIZE;
+	int tileY = t / TILE_SIZE;
+	int tileIndex = tileY * level.tilesPerRow + tileX;
+	u32* tile = &level.texels[tileIndex * TILE_SIZE * TILE_SIZE];
+
+	if (level.tileGenerations[tileIndex] != m_generation)
+	{
+		DecodeTile(level, tileX, tileY, tile);
+		level.tileGenerations[tileIndex] = m_generation;
+	}
+
+	memcpy(texel, &tile[(t % TILE_SIZE) * TILE_SIZE + s % TILE_SIZE], 4);
+}
+
+void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8 *sample, Cache* cache)
+{
+	int baseMip = 0;
+	bool mipLinear = false;
+
+#if (ALLOW_MIPMAP)
+	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
+	TexMode0& tm0 = texUnit.texMode0[texmap & 3];
+
+	s32 lodFract = lod & 0xf;
+
+	if (lod > 0 && tm0.min_filter & 3)
+	{
+		// use mipmap
+		baseMip = lod >> 4;
+		mipLinear = (lodFract && tm0.min_filter & 2);
+
+		// if using nearest mip filter and lodFract >= 0.5 round up to next mip
+		baseMip += (lodFract >> 3) & (tm0.min_filter & 1);
+	}
+
+	if (mipLinear)
+	{
+		u8 sampledTex[4];
+		u32 texel[4];
+
+		SampleMip(s, t, baseMip, linear, texmap, sampledTex, cache);
+		SetTexel(sampledTex, texel, (16 - lodFract));
+
+		SampleMip(s, t, baseMip + 1, linear, texmap, sampledTex, cache);
+		AddTexel(sampledTex, texel, lodFract);
+
+		sample[0] = (u8)(texel[0] >> 4);
+		sample[1] = (u8)(texel[1] >> 4);
+		sample[2] = (u8)(texel[2] >> 4);
+		sample[3] = (u8)(texel[3] >> 4);
+	}
+	else
+#endif
+	{
+		SampleMip(s, t, baseMip, linear, texmap, sample, cache);
+	}
+}
+
+void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample, Cache* cache)
+{
+	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
+	TexMode0& tm0 = texUnit.texMode0[texmap & 3];
+
+	Cache::Level* cachedLevel = cache ? cache->GetLevel(texmap, mip) : nullptr;
+
+	TexLevel uncachedLevel;
+	if (!cachedLevel)
+		GetTexLevel(texmap, mip, &uncachedLevel);
+	const TexLevel& level = cachedLevel ? cachedLevel->params : uncachedLevel;
+
+	auto FetchTexel = [&](int imageS, int imageT, u8* texel)
+	{
+		if (cachedLevel)
+			cache->GetTexel(*cachedLevel, imageS, imageT, texel);
+		else
+			DecodeTexel(level, imageS, imageT, texel);
+	};
+
+	int imageWidth = level.width;
+	int imageHeight = level.height;
+
+	// reduce sample location to mip level
+	s >>= mip;
+	t >>= mip;
+
 	if (linear)
 	{
 		// offset linear sampling
@@ -184,34 +319,17 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		WrapCoord(&imageSPlus1, tm0.wrap_s, imageWidth);
 		WrapCoord(&imageTPlus1, tm0.wrap_t, imageHeight);
 
-		if (!(ti0.format == GX_TF_RGBA8 && texUnit.texImage1[subTexmap].image_type))
-		{
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageT, imageWidth, ti0.format, tlut, tlutfmt);
-			SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
-
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageT, imageWidth, ti0.format, tlut, tlutfmt);
-			AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
+		FetchTexel(imageS, imageT, sampledTex);
+		SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
 
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageTPlus1, imageWidth, ti0.format, tlut, tlutfmt);
-			AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
+		FetchTexel(imageSPlus1, imageT, sampledTex);
+		AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
 
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageTPlus1, imageWidth, ti0.format, tlut, tlutfmt);
-			AddTexel(sampledTex, texel, (fractS) * (fractT));
-		}
-		else
-		{
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageT, imageWidth);
-			SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
+		FetchTexel(imageS, imageTPlus1, sampledTex);
+		AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
 
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1, imageT, imageWidth);
-			AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageTPlus1, imageWidth);
-			AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1, imageTPlus1, imageWidth);
-			AddTexel(sampledTex, texel, (fractS) * (fractT));
-		}
+		FetchTexel(imageSPlus1, imageTPlus1, sampledTex);
+		AddTexel(sampledTex, texel, (fractS) * (fractT));
 
 		sample[0] = (u8)(texel[0] >> 14);
 		sample[1] = (u8)(texel[1] >> 14);
@@ -228,10 +346,7 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		WrapCoord(&imageS, tm0.wrap_s, imageWidth);
 		WrapCoord(&imageT, tm0.wrap_t, imageHeight);
 
-		if (!(ti0.format == GX_TF_RGBA8 && texUnit.texImage1[subTexmap].image_type))
-			TexDecoder_DecodeTexel(sample, imageSrc, imageS, imageT, imageWidth, ti0.format, tlut, tlutfmt);
-		else
-			TexDecoder_DecodeTexelRGBA8FromTmem(sample, imageSrc, imageSrcOdd, imageS, imageT, imageWidth);
+		FetchTexel(imageS, imageT, sample);
 	}
 }
 
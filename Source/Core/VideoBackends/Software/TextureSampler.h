@@ -4,13 +4,69 @@
 
 #pragma once
 
+#include <vector>
+
 #include "Common/CommonTypes.h"
+#include "VideoCommon/TextureDecoder.h"
 
 namespace TextureSampler
 {
-	void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8 *sample);
+	// Where the texels of one mip level of a texture map come from.
+	struct TexLevel
+	{
+		const u8* src;
+		const u8* srcOdd; // only used for RGBA8 textures preloaded to TMEM
+		const u8* tlut;
+		int width;        // size - 1, like in TexImage0
+		int height;
+		int format;
+		TlutFormat tlutFormat;
+	};
+
+	// Texels decoded to RGBA8 during the current draw, in tiles of 4x4 texels
+	// for every mip level of every texture map. A tile is only decoded when one
+	// of its texels is sampled for the first time, so sampling a few texels of a
+	// large texture stays cheap. Every rasterizer thread has its own cache.
+	class Cache
+	{
+	public:
+		Cache();
+
+		enum
+		{
+			MAX_LEVELS = 16,
+			TILE_SIZE = 4
+		};
+
+		struct Level
+		{
+			TexLevel params;
+			u32 generation;
+			int tilesPerRow;
+			std::vector<u32> texels;
+			std::vector<u32> tileGenerations;
+		};
+
+		// Returns nullptr if the mip level is out of range.
+		Level* GetLevel(u8 texmap, int mip);
+
+		void GetTexel(Level& level, int s, int t, u8* texel);
+
+	private:
+		void DecodeTile(Level& level, int tileX, int tileY, u32* tile);
+
+		Level m_levels[8][MAX_LEVELS];
+		u32 m_generation;
+		u32 m_invalidation;
+	};
+
+	// Textures and their palettes can only change between draws, this has to
+	// be called before each one to make all caches decode their texels again.
+	void InvalidateCaches();
+
+	void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8 *sample, Cache* cache = nullptr);
 
-	void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample);
+	void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample, Cache* cache = nullptr);
 
 	enum
 	{
@@ -17,6 +17,7 @@
 #include "Core/HW/SystemTimers.h"
 #include "Core/HW/VideoInterface.h" //for TargetRefreshRate
 #include "VideoCommon/AVIDump.h"
+#include "VideoCommon/FrameDumpThread.h"
 #include "VideoCommon/VideoConfig.h"
 
 #ifdef _WIN32
@@ -72,7 +73,11 @@ bool AVIDump::Start(HWND hWnd, int w, int h)
 	SetBitmapFormat();
 	StoreFrame(nullptr);
 
-	return CreateFile();
+	if (!CreateFile())
+		return false;
+
+	FrameDumpThread::Start(EncodeFrame);
+	return true;
 }
 
 bool AVIDump::CreateFile()
@@ -103,7 +108,7 @@ bool AVIDump::CreateFile()
 		if (hr == AVIERR_FILEREAD) NOTICE_LOG(VIDEO, "A disk error occurred while reading the file.");
 		if (hr == AVIERR_FILEOPEN) NOTICE_LOG(VIDEO, "A disk error occurred while opening the file.");
 		if (hr == REGDB_E_CLASSNOTREG) NOTICE_LOG(VIDEO, "AVI class not registered");
-		Stop();
+		CloseFile();
 		return false;
 	}
 
@@ -112,7 +117,7 @@ bool AVIDump::CreateFile()
 	if (!SetVideoFormat())
 	{
 		NOTICE_LOG(VIDEO, "Setting video format failed");
-		Stop();
+		CloseFile();
 		return false;
 	}
 
@@ -121,7 +126,7 @@ bool AVIDump::CreateFile()
 		if (!SetCompressionOptions())
 		{
 			NOTICE_LOG(VIDEO, "SetCompressionOptions failed");
-			Stop();
+			CloseFile();
 			return false;
 		}
 	}
@@ -129,14 +134,14 @@ bool AVIDump::CreateFile()
 	if (FAILED(AVIMakeCompressedStream(&s_stream_compressed, s_stream, &s_options, nullptr)))
 	{
 		NOTICE_LOG(VIDEO, "AVIMakeCompressedStream failed");
-		Stop();
+		CloseFile();
 		return false;
 	}
 
 	if (FAILED(AVIStreamSetFormat(s_stream_compressed, 0, &s_bitmap, s_bitmap.biSize)))
 	{
 		NOTICE_LOG(VIDEO, "AVIStreamSetFormat failed");
-		Stop();
+		CloseFile();
 		return false;
 	}
 
@@ -168,6 +173,8 @@ void AVIDump::CloseFile()
 
 void AVIDump::Stop()
 {
+	FrameDumpThread::Stop();
+
 	// store one copy of the last video frame, CFR case
 	if (s_stream_compressed)
 		AVIStreamWrite(s_stream_compressed, s_frame_count++, 1, GetFrame(), s_bitmap.biSizeImage, AVIIF_KEYFRAME, nullptr, &s_byte_buffer);
@@ -189,10 +196,14 @@ void AVIDump::StoreFrame(const void* data)
 		else
 		{
 			free(s_stored_frame);
+			s_stored_frame = nullptr;
+			s_stored_frame_size = 0;
 			PanicAlert("Something has gone seriously wrong.\n"
 				"Stopping video recording.\n"
 				"Your video will likely be broken.");
-			Stop();
+			// This runs on the encoder thread, so it can't wait for it in Stop()
+			CloseFile();
+			return;
 		}
 		s_stored_frame_size = s_bitmap.biSizeImage;
 		memset(s_stored_frame, 0, s_bitmap.biSizeImage);
@@ -211,7 +222,7 @@ void* AVIDump::GetFrame()
 	return s_stored_frame;
 }
 
-void AVIDump::AddFrame(const u8* data, int w, int h)
+void AVIDump::AddFrame(const u8* data, int w, int h, u64 ticks)
 {
 	static bool shown_error = false;
 	if ((w != s_bitmap.biWidth || h != s_bitmap.biHeight) && !shown_error)
@@ -230,14 +241,13 @@ void AVIDump::AddFrame(const u8* data, int w, int h)
 	s64 delta;
 	if (!s_start_dumping && s_last_frame <= SystemTimers::GetTicksPerSecond())
 	{
-		delta = CoreTiming::GetTicks();
+		delta = ticks;
 		s_start_dumping = true;
 	}
 	else
 	{
-		delta = CoreTiming::GetTicks() - s_last_frame;
+		delta = ticks - s_last_frame;
 	}
-	bool b_frame_dumped = false;
 	// try really hard to place one copy of frame in stream (otherwise it's dropped)
 	if (delta > (s64)one_cfr * 3 / 10) // place if 3/10th of a frame space
 	{
@@ -250,7 +260,19 @@ void AVIDump::AddFrame(const u8* data, int w, int h)
 		delta -= one_cfr;
 		nplay++;
 	}
-	while (nplay--)
+	s_last_frame = ticks;
+
+	// The encoder writes the previous frame nplay times, and then stores this one
+	FrameDumpThread::AddFrame(data, w, h, 3, w * 3, 0, nplay);
+}
+
+void AVIDump::EncodeFrame(const FrameDumpThread::Frame& frame)
+{
+	if (!s_stream_compressed)
+		return;
+
+	bool b_frame_dumped = false;
+	for (int nplay = frame.repeat; nplay > 0; --nplay)
 	{
 		if (!b_frame_dumped)
 		{
@@ -268,11 +290,14 @@ void AVIDump::AddFrame(const u8* data, int w, int h)
 		{
 			CloseFile();
 			s_file_count++;
-			CreateFile();
+			if (!CreateFile())
+				return;
 		}
 	}
-	StoreFrame(data);
-	s_last_frame = CoreTiming::GetTicks();
+	if (frame.data.size() >= s_bitmap.biSizeImage)
+		StoreFrame(frame.data.data());
+	else
+		StoreFrame(nullptr);
 }
 
 void AVIDump::SetBitmapFormat()
@@ -326,7 +351,6 @@ extern "C" {
 
 static AVFormatContext* s_format_context = nullptr;
 static AVStream* s_stream = nullptr;
-static AVFrame* s_src_frame = nullptr;
 static AVFrame* s_scaled_frame = nullptr;
 static uint8_t* s_yuv_buffer = nullptr;
 static SwsContext* s_sws_context = nullptr;
@@ -365,35 +389,50 @@ bool AVIDump::Start(int w, int h)
 bool AVIDump::CreateFile()
 {
 	AVCodec* codec = nullptr;
+	AVDictionary* options = nullptr;
 
 	s_format_context = avformat_alloc_context();
 	snprintf(s_format_context->filename, sizeof(s_format_context->filename), "%s",
 	         (File::GetUserPath(D_DUMPFRAMES_IDX) + "framedump0.avi").c_str());
 	File::CreateFullPath(s_format_context->filename);
 
-	if (!(s_format_context->oformat = av_guess_format("avi", nullptr, nullptr)) ||
-	    !(s_stream = avformat_new_stream(s_format_context, codec)))
-	{
+	if (!(s_format_context->oformat = av_guess_format("avi", nullptr, nullptr)))
 		return false;
+
+	if (!g_Config.sDumpCodec.empty())
+	{
+		codec = avcodec_find_encoder_by_name(g_Config.sDumpCodec.c_str());
+		if (!codec)
+			WARN_LOG(VIDEO, "Unknown video codec %s, using the default one", g_Config.sDumpCodec.c_str());
 	}
+	if (!codec)
+		codec = avcodec_find_encoder(g_Config.bUseFFV1 ? AV_CODEC_ID_FFV1 : s_format_context->oformat->video_codec);
+
+	if (!codec || !(s_stream = avformat_new_stream(s_format_context, codec)))
+		return false;
 
-	s_stream->codec->codec_id = g_Config.bUseFFV1 ? AV_CODEC_ID_FFV1
-	                                              : s_format_context->oformat->video_codec;
+	s_stream->codec->codec_id = codec->id;
 	s_stream->codec->codec_type = AVMEDIA_TYPE_VIDEO;
 	s_stream->codec->bit_rate = 400000;
 	s_stream->codec->width = s_width;
 	s_stream->codec->height = s_height;
 	s_stream->codec->time_base = (AVRational){1, static_cast<int>(VideoInterface::TargetRefreshRate)};
 	s_stream->codec->gop_size = 12;
-	s_stream->codec->pix_fmt = g_Config.bUseFFV1 ? AV_PIX_FMT_BGRA : AV_PIX_FMT_YUV420P;
+	if (codec->id == AV_CODEC_ID_FFV1)
+		s_stream->codec->pix_fmt = AV_PIX_FMT_BGRA;
+	else if (codec->pix_fmts)
+		s_stream->codec->pix_fmt = codec->pix_fmts[0];
+	else
+		s_stream->codec->pix_fmt = AV_PIX_FMT_YUV420P;
 
-	if (!(codec = avcodec_find_encoder(s_stream->codec->codec_id)) ||
-	    (avcodec_open2(s_stream->codec, codec, nullptr) < 0))
-	{
+	if (!g_Config.sDumpPreset.empty())
+		av_dict_set(&options, "preset", g_Config.sDumpPreset.c_str(), 0);
+
+	const int error = avcodec_open2(s_stream->codec, codec, &options);
+	av_dict_free(&options);
+	if (error < 0)
 		return false;
-	}
 
-	s_src_frame = av_frame_alloc();
 	s_scaled_frame = av_frame_alloc();
 
 	s_size = avpicture_get_size(s_stream->codec->pix_fmt, s_width, s_height);
@@ -410,6 +449,8 @@ bool AVIDump::CreateFile()
 
 	avformat_write_header(s_format_context, nullptr);
 
+	FrameDumpThread::Start(EncodeFrame);
+
 	return true;
 }
 
@@ -420,51 +461,58 @@ static void PreparePacket(AVPacket* pkt)
 	pkt->size = 0;
 }
 
-void AVIDump::AddFrame(const u8* data, int width, int height)
+void AVIDump::AddFrame(const u8* data, int width, int height, u64 ticks)
 {
-	avpicture_fill((AVPicture*)s_src_frame, const_cast<u8*>(data), AV_PIX_FMT_BGR24, width, height);
+	u64 delta;
+	s64 last_pts;
+	if (!s_start_dumping && s_last_frame <= SystemTimers::GetTicksPerSecond())
+	{
+		delta = ticks;
+		last_pts = AV_NOPTS_VALUE;
+		s_start_dumping = true;
+	}
+	else
+	{
+		delta = ticks - s_last_frame;
+		last_pts = (s_last_pts * s_stream->codec->time_base.den) / SystemTimers::GetTicksPerSecond();
+	}
+	u64 pts_in_ticks = s_last_pts + delta;
+	s64 pts = (pts_in_ticks * s_stream->codec->time_base.den) / SystemTimers::GetTicksPerSecond();
+	if (pts == last_pts)
+		return;
+
+	s_last_frame = ticks;
+	s_last_pts = pts_in_ticks;
+	FrameDumpThread::AddFrame(data, width, height, 3, width * 3, pts, 1);
+}
 
+void AVIDump::EncodeFrame(const FrameDumpThread::Frame& frame)
+{
 	// Convert image from BGR24 to desired pixel format, and scale to initial
-	// width and height
+	// width and height. The rows are bottom-up, so start at the last one and
+	// go backwards to flip the image in the same pass.
+	const int row_size = frame.width * 3;
+	const uint8_t* const src_data[4] = { frame.data.data() + (frame.height - 1) * row_size, nullptr, nullptr, nullptr };
+	const int src_linesize[4] = { -row_size, 0, 0, 0 };
 	if ((s_sws_context = sws_getCachedContext(s_sws_context,
-	                                          width, height, AV_PIX_FMT_BGR24,
+	                                          frame.width, frame.height, AV_PIX_FMT_BGR24,
 	                                          s_width, s_height, s_stream->codec->pix_fmt,
 	                                          SWS_BICUBIC, nullptr, nullptr, nullptr)))
 	{
-		sws_scale(s_sws_context, s_src_frame->data, s_src_frame->linesize, 0,
-		          height, s_scaled_frame->data, s_scaled_frame->linesize);
+		sws_scale(s_sws_context, src_data, src_linesize, 0,
+		          frame.height, s_scaled_frame->data, s_scaled_frame->linesize);
 	}
 
 	s_scaled_frame->format = s_stream->codec->pix_fmt;
 	s_scaled_frame->width = s_width;
 	s_scaled_frame->height = s_height;
+	s_scaled_frame->pts = frame.timestamp;
 
 	// Encode and write the image.
 	AVPacket pkt;
 	PreparePacket(&pkt);
 	int got_packet = 0;
-	int error = 0;
-	u64 delta;
-	s64 last_pts;
-	if (!s_start_dumping && s_last_frame <= SystemTimers::GetTicksPerSecond())
-	{
-		delta = CoreTiming::GetTicks();
-		last_pts = AV_NOPTS_VALUE;
-		s_start_dumping = true;
-	}
-	else
-	{
-		delta = CoreTiming::GetTicks() - s_last_frame;
-		last_pts = (s_last_pts * s_stream->codec->time_base.den) / SystemTimers::GetTicksPerSecond();
-	}
-	u64 pts_in_ticks = s_last_pts + delta;
-	s_scaled_frame->pts = (pts_in_ticks * s_stream->codec->time_base.den) / SystemTimers::GetTicksPerSecond();
-	if (s_scaled_frame->pts != last_pts)
-	{
-		s_last_frame = CoreTiming::GetTicks();
-		s_last_pts = pts_in_ticks;
-		error = avcodec_encode_video2(s_stream->codec, &pkt, s_scaled_frame, &got_packet);
-	}
+	int error = avcodec_encode_video2(s_stream->codec, &pkt, s_scaled_frame, &got_packet);
 	while (!error && got_packet)
 	{
 		// Write the compressed frame in the media file.
@@ -493,6 +541,7 @@ void AVIDump::AddFrame(const u8* data, int width, int height)
 
 void AVIDump::Stop()
 {
+	FrameDumpThread::Stop();
 	av_write_trailer(s_format_context);
 	CloseFile();
 	NOTICE_LOG(VIDEO, "Stopping frame dump");
@@ -514,7 +563,6 @@ void AVIDump::CloseFile()
 		s_yuv_buffer = nullptr;
 	}
 
-	av_frame_free(&s_src_frame);
 	av_frame_free(&s_scaled_frame);
 
 	if (s_format_context)
@@ -534,6 +582,11 @@ void AVIDump::CloseFile()
 
 #endif
 
+void AVIDump::AddFrame(const u8* data, int width, int height)
+{
+	AddFrame(data, width, height, CoreTiming::GetTicks());
+}
+
 void AVIDump::DoState()
 {
 	s_last_frame = CoreTiming::GetTicks();
@@ -12,6 +12,10 @@
 
 #include "Common/CommonTypes.h"
 
+namespace FrameDumpThread { struct Frame; }
+
+// Frames are BGR24 with the bottom row first. They are queued and encoded on
+// a separate thread, see FrameDumpThread.
 class AVIDump
 {
 private:
@@ -24,6 +28,8 @@ private:
 	static void StoreFrame(const void* data);
 	static void* GetFrame();
 
+	static void EncodeFrame(const FrameDumpThread::Frame& frame);
+
 public:
 #ifdef _WIN32
 	static bool Start(HWND hWnd, int w, int h);
@@ -31,6 +37,9 @@ public:
 	static bool Start(int w, int h);
 #endif
 	static void AddFrame(const u8* data, int width, int height);
+	// ticks is the emulated time of the frame, for frames which were read
+	// back after it was shown.
+	static void AddFrame(const u8* data, int width, int height, u64 ticks);
 	static void Stop();
 	static void DoState();
 };
@@ -19,6 +19,7 @@
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
+#include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VertexLoader.h"
 #include "VideoCommon/VertexShaderManager.h"
@@ -41,6 +42,43 @@ void BPInit()
 	bpmem.bpMask = 0xFFFFFF;
 }
 
+// Registers which only hold parameters of a later command (EFB copies, clears,
+// TLUT loads and preloads) or aren't emulated at all. The command flushes by
+// itself, so pending draws don't need to be flushed when these are written.
+static bool IsDrawIndependentReg(u32 address)
+{
+	switch (address)
+	{
+	case BPMEM_DISPLAYCOPYFILTER:
+	case BPMEM_DISPLAYCOPYFILTER+1:
+	case BPMEM_DISPLAYCOPYFILTER+2:
+	case BPMEM_DISPLAYCOPYFILTER+3:
+	case BPMEM_COPYFILTER0:
+	case BPMEM_COPYFILTER1:
+	case BPMEM_FIELDMASK:
+	case BPMEM_FIELDMODE:
+	case BPMEM_BUSCLOCK0:
+	case BPMEM_BUSCLOCK1:
+	case BPMEM_EFB_TL:
+	case BPMEM_EFB_BR:
+	case BPMEM_EFB_ADDR:
+	case BPMEM_CLEAR_AR:
+	case BPMEM_CLEAR_GB:
+	case BPMEM_CLEAR_Z:
+	case BPMEM_MIPMAP_STRIDE:
+	case BPMEM_COPYYSCALE:
+	case BPMEM_BP_MASK:
+	case BPMEM_REVBITS:
+	case BPMEM_LOADTLUT0:
+	case BPMEM_PRELOAD_ADDR:
+	case BPMEM_PRELOAD_TMEMEVEN:
+	case BPMEM_PRELOAD_TMEMODD:
+		return true;
+	default:
+		return false;
+	}
+}
+
 static void BPWritten(const BPCmd& bp)
 {
 	/*
@@ -77,11 +115,19 @@ static void BPWritten(const BPCmd& bp)
 		      bp.address == BPMEM_PRELOAD_MODE ||
 		      bp.address == BPMEM_CLEAR_PIXEL_PERF))
 		{
+			INCSTAT(stats.thisFrame.numRedundantStateWrites);
 			return;
 		}
 	}
 
-	FlushPipeline();
+	if (IsDrawIndependentReg(bp.address))
+	{
+		INCSTAT(stats.thisFrame.numRedundantStateWrites);
+	}
+	else
+	{
+		FlushPipeline();
+	}
 
 	((u32*)&bpmem)[bp.address] = bp.newvalue;
 
@@ -174,6 +220,8 @@ static void BPWritten(const BPCmd& bp)
 		switch (bp.newvalue & 0xFF)
 		{
 		case 0x02:
+			// The game may read the results of EFB copies once it knows the GPU is done.
+			g_texture_cache->FlushEFBCopies();
 			if (!g_use_deterministic_gpu_thread)
 				PixelEngine::SetFinish(); // may generate interrupt
 			DEBUG_LOG(VIDEO, "GXSetDrawDone SetPEFinish (value: 0x%02X)", (bp.newvalue & 0xFFFF));
@@ -185,11 +233,13 @@ static void BPWritten(const BPCmd& bp)
 		}
 		return;
 	case BPMEM_PE_TOKEN_ID: // Pixel Engine Token ID
+		g_texture_cache->FlushEFBCopies();
 		if (!g_use_deterministic_gpu_thread)
 			PixelEngine::SetToken(static_cast<u16>(bp.newvalue & 0xFFFF), false);
 		DEBUG_LOG(VIDEO, "SetPEToken 0x%04x", (bp.newvalue & 0xFFFF));
 		return;
 	case BPMEM_PE_TOKEN_INT_ID: // Pixel Engine Interrupt Token ID
+		g_texture_cache->FlushEFBCopies();
 		if (!g_use_deterministic_gpu_thread)
 			PixelEngine::SetToken(static_cast<u16>(bp.newvalue & 0xFFFF), true);
 		DEBUG_LOG(VIDEO, "SetPEToken + INT 0x%04x", (bp.newvalue & 0xFFFF));
@@ -275,6 +325,7 @@ static void BPWritten(const BPCmd& bp)
 			if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bWii)
 				addr = addr & 0x01FFFFFF;
 
+			g_texture_cache->FlushEFBCopies(addr, tlutXferCount);
 			Memory::CopyFromEmu(texMem + tlutTMemAddr, addr, tlutXferCount);
 
 			return;
@@ -464,10 +515,12 @@ static void BPWritten(const BPCmd& bp)
 				if (tmem_addr_even + size > TMEM_SIZE)
 					size = TMEM_SIZE - tmem_addr_even;
 
+				g_texture_cache->FlushEFBCopies(src_addr, size);
 				Memory::CopyFromEmu(texMem + tmem_addr_even, src_addr, size);
 			}
 			else // RGBA8 tiles (and CI14, but that might just be stupid libogc!)
 			{
+				g_texture_cache->FlushEFBCopies(src_addr, size * 2);
 				u8* src_ptr = Memory::GetPointer(src_addr);
 
 				// AR and GB tiles are stored in separate TMEM banks => can't use a single memcpy for everything
@@ -375,6 +375,7 @@ void UpdateInterrupts(u64 userdata)
 	}
 	CoreTiming::ForceExceptionCheck(0);
 	interruptWaiting = false;
+	WakeGpuThread();
 }
 
 void UpdateInterruptsFromVideoBackend(u64 userdata)
@@ -481,10 +482,15 @@ void ProcessFifoAllDistance()
 
 void ProcessFifoEvents()
 {
-	if (IsOnThread() && (interruptWaiting || interruptFinishWaiting || interruptTokenWaiting))
+	if (IsOnThread() && IsInterruptWaiting())
 		CoreTiming::ProcessFifoWaitEvents();
 }
 
+bool IsInterruptWaiting()
+{
+	return interruptWaiting || interruptFinishWaiting || interruptTokenWaiting;
+}
+
 void Shutdown()
 {
 
@@ -550,6 +556,9 @@ void Update()
 		Common::YieldCPU();
 
 	if (fifo.isGpuReadingData)
+	{
 		Common::AtomicAdd(VITicks, SystemTimers::GetTicksPerSecond() / 10000);
+		WakeGpuThread();
+	}
 }
 } // end of namespace CommandProcessor
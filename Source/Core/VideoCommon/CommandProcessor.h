@@ -148,6 +148,10 @@ void SetCpStatusRegister();
 void ProcessFifoAllDistance();
 void ProcessFifoEvents();
 
+// Whether the GPU raised an interrupt, a PE token or a finish which the CPU
+// hasn't handled yet.
+bool IsInterruptWaiting();
+
 void Update();
 extern volatile u32 VITicks;
 
@@ -0,0 +1,389 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Timer.h"
+#include "Core/HW/Memmap.h"
+
+#include "VideoCommon/BoundingBox.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/CommandStream.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/Fifo.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VertexLoader.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace CommandStream
+{
+
+enum CommandType : u8
+{
+	CMD_LOAD_CP,
+	CMD_LOAD_XF,
+	CMD_LOAD_INDEXED_XF,
+	CMD_LOAD_BP,
+	CMD_DRAW,
+	CMD_DISPLAY_LIST_START,
+	CMD_DISPLAY_LIST_END,
+};
+
+// Some vertex loader stages store more than they write
+enum { VERTEX_PADDING = 16 };
+
+struct DrawCommand
+{
+	VertexLoader* loader;
+	u32 primitive;
+	u32 count;
+	u32 vertex_offset;
+};
+
+struct CommandList
+{
+	// Each command is its CommandType followed by its arguments
+	std::vector<u8> commands;
+	// Converted vertices of all draws, only grows
+	std::vector<u8> vertices;
+	size_t vertices_used;
+
+	CommandList() : vertices_used(0) {}
+
+	template <typename T>
+	void Write(const T& value)
+	{
+		const u8* bytes = reinterpret_cast<const u8*>(&value);
+		commands.insert(commands.end(), bytes, bytes + sizeof(T));
+	}
+
+	void WriteData(const u8* data, size_t size)
+	{
+		commands.insert(commands.end(), data, data + size);
+	}
+
+	u8* AllocateVertices(size_t size)
+	{
+		if (vertices_used + size + VERTEX_PADDING > vertices.size())
+			vertices.resize(std::max(vertices.size() * 2, vertices_used + size + VERTEX_PADDING));
+		u8* ptr = &vertices[vertices_used];
+		vertices_used += size;
+		return ptr;
+	}
+
+	bool IsEmpty() const
+	{
+		return commands.empty();
+	}
+
+	void Clear()
+	{
+		commands.clear();
+		vertices_used = 0;
+	}
+};
+
+// Only touched by the decode thread
+static std::unique_ptr<CommandList> s_recording;
+// Set once a bounding box register was written while the bounding box is
+// computed in software, until a draw finds it inactive.
+static bool s_bbox_may_be_active;
+
+// Everything below is guarded by s_lock
+static std::mutex s_lock;
+static std::condition_variable s_list_executed;
+static std::deque<std::unique_ptr<CommandList>> s_queue;
+// Lists which were already executed, so that their buffers can be reused
+static std::vector<std::unique_ptr<CommandList>> s_free_lists;
+// Queued lists and the one being executed
+static u32 s_pending_lists;
+
+template <typename T>
+static T ReadValue(const u8*& ptr)
+{
+	T value;
+	memcpy(&value, ptr, sizeof(T));
+	ptr += sizeof(T);
+	return value;
+}
+
+void RecordCPWrite(u8 sub_cmd, u32 value)
+{
+	// The vertex array registers are applied right away, everything else
+	// once the GPU thread gets to it.
+	LoadCPReg(sub_cmd, value, true);
+	if ((sub_cmd & 0xF0) == 0xA0 || (sub_cmd & 0xF0) == 0xB0)
+		LoadCPReg(sub_cmd, value);
+
+	s_recording->Write<u8>(CMD_LOAD_CP);
+	s_recording->Write(sub_cmd);
+	s_recording->Write(value);
+}
+
+void RecordXFWrite(u32 transfer_size, u32 address, u8* data)
+{
+	s_recording->Write<u8>(CMD_LOAD_XF);
+	s_recording->Write(transfer_size);
+	s_recording->Write(address);
+	s_recording->WriteData(data, transfer_size * sizeof(u32));
+}
+
+void RecordIndexedXFLoad(u32 val, int refarray)
+{
+	const u32 index = val >> 16;
+	const u32 size = ((val >> 12) & 0xF) + 1;
+	const u8* data = Memory::GetPointer(g_preprocess_cp_state.array_bases[refarray] + g_preprocess_cp_state.array_strides[refarray] * index);
+	if (!data)
+		return;
+
+	s_recording->Write<u8>(CMD_LOAD_INDEXED_XF);
+	s_recording->Write(val);
+	s_recording->WriteData(data, size * sizeof(u32));
+}
+
+void RecordBPWrite(u32 value)
+{
+	s_recording->Write<u8>(CMD_LOAD_BP);
+	s_recording->Write(value);
+
+	switch (value >> 24)
+	{
+	// The CPU may wait for these and look at what was drawn before them, so
+	// nothing after them is decoded before the GPU thread got to them.
+	case BPMEM_SETDRAWDONE:
+	case BPMEM_PE_TOKEN_ID:
+	case BPMEM_PE_TOKEN_INT_ID:
+		WaitForExecution();
+		break;
+
+	case BPMEM_CLEARBBOX1:
+	case BPMEM_CLEARBBOX2:
+		if (!g_ActiveConfig.backend_info.bSupportsBBox)
+			s_bbox_may_be_active = true;
+		break;
+	}
+}
+
+void RecordDisplayListStart()
+{
+	s_recording->Write<u8>(CMD_DISPLAY_LIST_START);
+}
+
+void RecordDisplayListEnd()
+{
+	s_recording->Write<u8>(CMD_DISPLAY_LIST_END);
+}
+
+int RecordDraw(int vtx_attr_group, int primitive, int count, DataReader src)
+{
+	VertexLoader* loader = VertexLoaderManager::GetVertexLoader(vtx_attr_group, true);
+	const int size = count * loader->GetVertexSize();
+	if ((int)src.size() < size)
+		return -1;
+
+	if (!count || g_bSkipCurrentFrame || g_ActiveConfig.bSkipVertexLoading)
+		return size;
+
+	// The software bounding box is computed by the vertex loader, which needs
+	// the state the GPU thread has when it gets to the draw.
+	if (s_bbox_may_be_active)
+	{
+		WaitForExecution();
+		s_bbox_may_be_active = BoundingBox::active;
+	}
+
+	const u32 stride = loader->GetNativeVertexDeclaration().stride;
+	const size_t vertex_offset = s_recording->vertices_used;
+	u8* dst = s_recording->AllocateVertices(count * stride);
+
+	// Only timed while the statistics are shown, the timer isn't free.
+	const u64 start_time = g_ActiveConfig.bOverlayStats ? Common::Timer::GetTimeUs() : 0;
+
+	count = loader->RunVertices(g_preprocess_cp_state.vtx_attr[vtx_attr_group], primitive, count, src, DataReader(dst, dst + count * stride));
+
+	if (g_ActiveConfig.bOverlayStats)
+		ADDSTAT(stats.thisFrame.usVertexLoading, Common::Timer::GetTimeUs() - start_time);
+
+	DrawCommand draw;
+	draw.loader = loader;
+	draw.primitive = primitive;
+	draw.count = count;
+	draw.vertex_offset = (u32)vertex_offset;
+	s_recording->Write<u8>(CMD_DRAW);
+	s_recording->Write(draw);
+
+	if (s_recording->vertices_used >= LIST_SUBMIT_VERTEX_BYTES)
+		Submit();
+
+	return size;
+}
+
+void Submit()
+{
+	if (s_recording->IsEmpty())
+		return;
+
+	std::unique_ptr<CommandList> next;
+	{
+		std::unique_lock<std::mutex> lk(s_lock);
+		if (s_pending_lists >= MAX_QUEUED_LISTS)
+		{
+			const u64 start_time = Common::Timer::GetTimeUs();
+			s_list_executed.wait(lk, [] { return s_pending_lists < MAX_QUEUED_LISTS; });
+			ADDSTAT(stats.thisFrame.usDecodeThreadWaiting, Common::Timer::GetTimeUs() - start_time);
+		}
+
+		s_queue.push_back(std::move(s_recording));
+		s_pending_lists++;
+		if (!s_free_lists.empty())
+		{
+			next = std::move(s_free_lists.back());
+			s_free_lists.pop_back();
+		}
+	}
+	WakeGpuThread();
+
+	s_recording = next ? std::move(next) : std::unique_ptr<CommandList>(new CommandList);
+}
+
+void WaitForExecution()
+{
+	Submit();
+
+	std::unique_lock<std::mutex> lk(s_lock);
+	if (s_pending_lists)
+	{
+		const u64 start_time = Common::Timer::GetTimeUs();
+		s_list_executed.wait(lk, [] { return s_pending_lists == 0; });
+		ADDSTAT(stats.thisFrame.usDecodeThreadWaiting, Common::Timer::GetTimeUs() - start_time);
+	}
+}
+
+void Start()
+{
+	if (!s_recording)
+		s_recording.reset(new CommandList);
+
+	// Bounding box registers written before the decode thread started aren't known
+	s_bbox_may_be_active = !g_ActiveConfig.backend_info.bSupportsBBox;
+}
+
+static void ExecuteList(const CommandList& list)
+{
+	const u8* cur = list.commands.data();
+	const u8* const end = cur + list.commands.size();
+	while (cur != end)
+	{
+		switch (ReadValue<u8>(cur))
+		{
+		case CMD_LOAD_CP:
+			{
+				const u8 sub_cmd = ReadValue<u8>(cur);
+				const u32 value = ReadValue<u32>(cur);
+				if ((sub_cmd & 0xF0) != 0xA0 && (sub_cmd & 0xF0) != 0xB0)
+					LoadCPReg(sub_cmd, value);
+				INCSTAT(stats.thisFrame.numCPLoads);
+			}
+			break;
+
+		case CMD_LOAD_XF:
+			{
+				const u32 transfer_size = ReadValue<u32>(cur);
+				const u32 address = ReadValue<u32>(cur);
+				u8* data = const_cast<u8*>(cur);
+				LoadXFReg(transfer_size, address, DataReader(data, data + transfer_size * sizeof(u32)));
+				cur += transfer_size * sizeof(u32);
+				INCSTAT(stats.thisFrame.numXFLoads);
+			}
+			break;
+
+		case CMD_LOAD_INDEXED_XF:
+			{
+				const u32 val = ReadValue<u32>(cur);
+				const u32 size = ((val >> 12) & 0xF) + 1;
+				u32 data[16];
+				memcpy(data, cur, size * sizeof(u32));
+				LoadIndexedXFData(val, data);
+				cur += size * sizeof(u32);
+			}
+			break;
+
+		case CMD_LOAD_BP:
+			LoadBPReg(ReadValue<u32>(cur));
+			INCSTAT(stats.thisFrame.numBPLoads);
+			break;
+
+		case CMD_DRAW:
+			{
+				const DrawCommand draw = ReadValue<DrawCommand>(cur);
+				VertexLoaderManager::DrawConvertedVertices(draw.loader, draw.primitive, draw.count, &list.vertices[draw.vertex_offset]);
+			}
+			break;
+
+		case CMD_DISPLAY_LIST_START:
+			// temporarily swap dl and non-dl (small "hack" for the stats)
+			Statistics::SwapDL();
+			break;
+
+		case CMD_DISPLAY_LIST_END:
+			INCSTAT(stats.thisFrame.numDListsCalled);
+			Statistics::SwapDL();
+			break;
+		}
+	}
+}
+
+bool ExecuteQueuedList()
+{
+	std::unique_ptr<CommandList> list;
+	{
+		std::lock_guard<std::mutex> lk(s_lock);
+		if (s_queue.empty())
+			return false;
+		list = std::move(s_queue.front());
+		s_queue.pop_front();
+	}
+
+	// Only timed while the statistics are shown, the timer isn't free.
+	const u64 start_time = g_ActiveConfig.bOverlayStats ? Common::Timer::GetTimeUs() : 0;
+
+	ExecuteList(*list);
+
+	if (g_ActiveConfig.bOverlayStats)
+		ADDSTAT(stats.thisFrame.usCommandExecution, Common::Timer::GetTimeUs() - start_time);
+
+	list->Clear();
+
+	std::lock_guard<std::mutex> lk(s_lock);
+	s_free_lists.push_back(std::move(list));
+	s_pending_lists--;
+	s_list_executed.notify_all();
+	return true;
+}
+
+bool HasQueuedLists()
+{
+	std::lock_guard<std::mutex> lk(s_lock);
+	return !s_queue.empty();
+}
+
+void Shutdown()
+{
+	std::lock_guard<std::mutex> lk(s_lock);
+	s_queue.clear();
+	s_free_lists.clear();
+	s_pending_lists = 0;
+	s_recording.reset();
+}
+
+}
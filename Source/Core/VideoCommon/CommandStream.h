@@ -0,0 +1,56 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/DataReader.h"
+
+// While the FIFO is decoded on a separate thread, the decode thread converts
+// the vertices of every draw and records them along with the register writes
+// in command lists. The GPU thread executes the lists in order, so it only
+// has to apply the state and hand the vertices to the backend.
+//
+// The decode thread tracks the CP state in g_preprocess_cp_state, and it
+// owns the array pointers in g_main_cp_state and cached_arraybases, which
+// only the vertex loaders and indexed XF loads read.
+namespace CommandStream
+{
+
+enum
+{
+	// The decode thread waits for the GPU thread once this many lists are queued
+	MAX_QUEUED_LISTS = 4,
+	// Lists are submitted once their vertices take this much space
+	LIST_SUBMIT_VERTEX_BYTES = 256 * 1024,
+};
+
+// Called on the decode thread
+void RecordCPWrite(u8 sub_cmd, u32 value);
+// data points to transfer_size words, byte swapped as in the FIFO
+void RecordXFWrite(u32 transfer_size, u32 address, u8* data);
+void RecordIndexedXFLoad(u32 val, int refarray);
+// Waits for the GPU thread after writes which signal the CPU, like PE tokens
+void RecordBPWrite(u32 value);
+void RecordDisplayListStart();
+void RecordDisplayListEnd();
+// Returns -1 if src doesn't hold all vertices yet, else the amount of bytes consumed
+int RecordDraw(int vtx_attr_group, int primitive, int count, DataReader src);
+
+// Queues everything recorded so far for the GPU thread.
+void Submit();
+// Submits and waits until the GPU thread executed all lists.
+void WaitForExecution();
+
+// Called on the decode thread before it decodes anything
+void Start();
+
+// Called on the GPU thread. Executes the oldest queued list, returns false
+// if none was queued.
+bool ExecuteQueuedList();
+bool HasQueuedLists();
+
+void Shutdown();
+
+}
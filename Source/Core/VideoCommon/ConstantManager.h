@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include "Common/CommonTypes.h"
 
 // all constant buffer attributes must be 16 bytes aligned, so this are the only allowed components:
@@ -11,6 +13,31 @@ typedef float float4[4];
 typedef u32 uint4[4];
 typedef s32 int4[4];
 
+// Byte range of a constant buffer which changed since the backend uploaded it.
+struct ConstantDirtyRange
+{
+	u32 begin;
+	u32 end;
+
+	void Add(u32 offset, u32 size)
+	{
+		if (IsEmpty())
+		{
+			begin = offset;
+			end = offset + size;
+		}
+		else
+		{
+			begin = std::min(begin, offset);
+			end = std::max(end, offset + size);
+		}
+	}
+
+	bool IsEmpty() const { return begin >= end; }
+	u32 Size() const { return IsEmpty() ? 0 : end - begin; }
+	void Clear() { begin = end = 0; }
+};
+
 struct PixelShaderConstants
 {
 	int4 colors[4];
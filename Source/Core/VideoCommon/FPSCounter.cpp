@@ -2,7 +2,9 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 
 #include "Common/FileUtil.h"
 #include "Common/StringUtil.h"
@@ -16,7 +18,12 @@ FPSCounter::FPSCounter()
 	: m_fps(0)
 	, m_counter(0)
 	, m_fps_last_counter(0)
+	, m_last_frame_time(0)
+	, m_num_frames_timed(0)
+	, m_total_frame_time(0)
+	, m_worst_frame_time(0)
 {
+	std::fill(std::begin(m_frame_time_histogram), std::end(m_frame_time_histogram), 0);
 	m_update_time.Update();
 	m_render_time.Update();
 }
@@ -45,6 +52,50 @@ int FPSCounter::Update()
 		m_render_time.Update();
 	}
 
+	const u64 now = Common::Timer::GetTimeUs();
+	if (m_last_frame_time)
+	{
+		const u32 time = (u32)(now - m_last_frame_time);
+		m_num_frames_timed++;
+		m_total_frame_time += time;
+		m_worst_frame_time = std::max(m_worst_frame_time, time);
+		m_frame_time_histogram[std::min<u32>(time / FRAME_TIME_BUCKET_US, NUM_FRAME_TIME_BUCKETS)]++;
+	}
+	m_last_frame_time = now;
+
 	m_counter++;
 	return m_fps;
 }
+
+u32 FPSCounter::GetFrameTimePercentile(double fraction) const
+{
+	const u32 target = (u32)(m_num_frames_timed * fraction);
+	u32 count = 0;
+	for (u32 i = 0; i < NUM_FRAME_TIME_BUCKETS; ++i)
+	{
+		count += m_frame_time_histogram[i];
+		if (count > target)
+			return std::min((i + 1) * FRAME_TIME_BUCKET_US, m_worst_frame_time);
+	}
+	return m_worst_frame_time;
+}
+
+void FPSCounter::LogFrameTimeSummary()
+{
+	if (m_num_frames_timed == 0)
+		return;
+
+	// A frame which takes more than twice as long as the median one is
+	// noticeable as a stutter.
+	const u32 median = GetFrameTimePercentile(0.5);
+	u32 num_stutters = 0;
+	for (u32 i = std::min<u32>(median * 2 / FRAME_TIME_BUCKET_US, NUM_FRAME_TIME_BUCKETS); i <= NUM_FRAME_TIME_BUCKETS; ++i)
+		num_stutters += m_frame_time_histogram[i];
+
+	NOTICE_LOG(VIDEO, "Frame times over %u frames: average %.2f ms, 99th percentile %.2f ms, worst %.2f ms, %u frames took more than twice the median",
+		m_num_frames_timed,
+		m_total_frame_time / 1000.0 / m_num_frames_timed,
+		GetFrameTimePercentile(0.99) / 1000.0,
+		m_worst_frame_time / 1000.0,
+		num_stutters);
+}
@@ -20,6 +20,12 @@ public:
 	// screen as the FPS counter (updated every second).
 	int Update();
 
+	// Logs the average and worst time between frames since the counter was
+	// created, which shows how much shader compilation and other hitches
+	// stutter. Replaying a FIFO log with looping disabled makes this a
+	// repeatable benchmark.
+	void LogFrameTimeSummary();
+
 private:
 	unsigned int m_counter;
 	unsigned int m_fps_last_counter;
@@ -28,5 +34,22 @@ private:
 	Common::Timer m_render_time;
 	std::ofstream m_bench_file;
 
+	// The frame times are kept in a histogram with 0.1 ms buckets, so that
+	// long sessions don't need more memory. Longer frames than it covers only
+	// count towards the worst time.
+	enum
+	{
+		FRAME_TIME_BUCKET_US = 100,
+		NUM_FRAME_TIME_BUCKETS = 2000,
+	};
+
+	u64 m_last_frame_time;
+	u32 m_num_frames_timed;
+	u64 m_total_frame_time; // in microseconds
+	u32 m_worst_frame_time; // in microseconds
+	u32 m_frame_time_histogram[NUM_FRAME_TIME_BUCKETS + 1];
+
 	void LogRenderTimeToFile(u64 val);
+	// Returns the upper bound of the bucket which holds this fraction of the frames, in microseconds.
+	u32 GetFrameTimePercentile(double fraction) const;
 };
@@ -2,12 +2,19 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "Common/Atomic.h"
 #include "Common/ChunkFile.h"
-#include "Common/CPUDetect.h"
+#include "Common/Event.h"
 #include "Common/FPURoundMode.h"
 #include "Common/MemoryUtil.h"
 #include "Common/Thread.h"
+#include "Common/Timer.h"
+#include "Common/WaitableAtomic.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
@@ -16,11 +23,14 @@
 #include "Core/HW/Memmap.h"
 
 #include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/CommandStream.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/PixelEngine.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -30,6 +40,35 @@ static volatile bool GpuRunningState = false;
 static volatile bool EmuRunningState = false;
 static std::mutex m_csHWVidOccupied;
 
+// Once it runs out of work, the GPU thread spins for a while before it goes
+// to sleep, as games usually submit a frame in many small bursts. The spin
+// time is doubled whenever work showed up while spinning and halved whenever
+// it didn't. The timeout is only a safety net, all the places which give the
+// GPU thread something to do wake it up.
+enum
+{
+	GPU_SPIN_MIN_US = 10,
+	GPU_SPIN_MAX_US = 500,
+	GPU_SLEEP_TIMEOUT_MS = 10,
+};
+
+// Without SyncGPU, the GPU thread reads up to this much of the FIFO at once,
+// rather than running the opcode decoder once per 32 byte block.
+enum { GPU_FIFO_READ_BATCH = 8 * 1024 };
+static Common::Event s_gpu_wakeup;
+static u64 s_gpu_spin_us = GPU_SPIN_MIN_US;
+static std::atomic<bool> s_gpu_sleeping;
+// When the first wakeup since the GPU thread went to sleep was requested
+static std::atomic<u64> s_gpu_wakeup_time;
+
+// With bDecodeThread, the FIFO is read and decoded on this thread, and the
+// GPU thread only executes the CommandStream. It's started and stopped by the
+// GPU thread, and it only runs while the GPU thread doesn't read the FIFO.
+static std::thread s_decode_thread;
+static Common::Event s_decode_wakeup;
+static volatile bool s_decode_thread_quit;
+static std::atomic<bool> s_decode_thread_done;
+
 // Most of this array is unlikely to be faulted in...
 static u8 s_fifo_aux_data[FIFO_SIZE];
 static u8* s_fifo_aux_write_ptr;
@@ -38,24 +77,24 @@ static u8* s_fifo_aux_read_ptr;
 bool g_use_deterministic_gpu_thread;
 
 // STATE_TO_SAVE
-static std::mutex s_video_buffer_lock;
-static std::condition_variable s_video_buffer_cond;
 static u8* s_video_buffer;
 static u8* s_video_buffer_read_ptr;
 static std::atomic<u8*> s_video_buffer_write_ptr;
-static std::atomic<u8*> s_video_buffer_seen_ptr;
+static Common::WaitableAtomic<u8*> s_video_buffer_seen_ptr;
 static u8* s_video_buffer_pp_read_ptr;
 // The read_ptr is always owned by the GPU thread.  In normal mode, so is the
 // write_ptr, despite it being atomic.  In g_use_deterministic_gpu_thread mode,
 // things get a bit more complicated:
 // - The seen_ptr is written by the GPU thread, and points to what it's already
 // processed as much of as possible - in the case of a partial command which
-// caused it to stop, not the same as the read ptr.  It's written by the GPU,
-// under the lock, and updating the cond.
+// caused it to stop, not the same as the read ptr.  SyncGPU waits on it, but
+// storing it only costs more than an atomic store if SyncGPU is asleep.
 // - The write_ptr is written by the CPU thread after it copies data from the
-// FIFO.  Maybe someday it will be under the lock.  For now, because RunGpuLoop
-// polls, it's just atomic.
+// FIFO, followed by WakeGpuThread in case the GPU thread is asleep.
 // - The pp_read_ptr is the CPU preprocessing version of the read_ptr.
+// No locks are involved: while SyncGPU moves the data back to the start of the
+// buffer, the GPU thread has seen everything up to the write_ptr, and it
+// doesn't touch the buffer again before the write_ptr moves.
 
 void Fifo_DoState(PointerWrap &p)
 {
@@ -72,14 +111,26 @@ void Fifo_DoState(PointerWrap &p)
 	p.Do(g_bSkipCurrentFrame);
 }
 
+// Only on the thread which owns the backend
+static void FlushPendingEFBCopies()
+{
+	if (g_texture_cache)
+		g_texture_cache->FlushEFBCopies();
+}
+
 void Fifo_PauseAndLock(bool doLock, bool unpauseOnUnlock)
 {
 	if (doLock)
 	{
 		SyncGPU(SYNC_GPU_OTHER);
 		EmulatorState(false);
+		// Savestates are made while locked, so the memory they save must
+		// include deferred EFB copies. The GPU thread writes them back
+		// before it pauses.
 		if (!Core::IsGPUThread())
 			m_csHWVidOccupied.lock();
+		else
+			FlushPendingEFBCopies();
 		_dbg_assert_(COMMON, !CommandProcessor::fifo.isGpuReadingData);
 	}
 	else
@@ -112,6 +163,7 @@ void Fifo_Shutdown()
 	s_video_buffer_seen_ptr = nullptr;
 	s_fifo_aux_write_ptr = nullptr;
 	s_fifo_aux_read_ptr = nullptr;
+	CommandStream::Shutdown();
 }
 
 u8* GetVideoBufferStartPtr()
@@ -140,21 +192,85 @@ void ExitGpuLoop()
 	// Terminate GPU thread loop
 	GpuRunningState = false;
 	EmuRunningState = true;
+	WakeGpuThread();
 }
 
 void EmulatorState(bool running)
 {
 	EmuRunningState = running;
+	WakeGpuThread();
+}
+
+void WakeGpuThread()
+{
+	if (s_gpu_sleeping.load(std::memory_order_relaxed))
+	{
+		u64 expected = 0;
+		s_gpu_wakeup_time.compare_exchange_strong(expected, Common::Timer::GetTimeUs());
+	}
+	s_gpu_wakeup.Set();
+	s_decode_wakeup.Set();
+}
+
+static bool FifoHasWork()
+{
+	const SCPFifoStruct &fifo = CommandProcessor::fifo;
+	return EmuRunningState && !CommandProcessor::interruptWaiting && fifo.bFF_GPReadEnable &&
+	       fifo.CPReadWriteDistance && !AtBreakpoint();
+}
+
+static bool GpuHasWork()
+{
+	if (g_use_deterministic_gpu_thread)
+		return s_video_buffer_write_ptr > s_video_buffer_seen_ptr;
+
+	if (s_decode_thread.joinable())
+		return CommandStream::HasQueuedLists();
+
+	return FifoHasWork();
+}
+
+static void WaitForGpuWork()
+{
+	const u64 spin_start = Common::Timer::GetTimeUs();
+	u64 now = spin_start;
+	while (now - spin_start < s_gpu_spin_us)
+	{
+		if (GpuHasWork())
+		{
+			s_gpu_spin_us = std::min<u64>(s_gpu_spin_us * 2, GPU_SPIN_MAX_US);
+			return;
+		}
+
+		// Something else was requested, like an EFB access
+		if (s_gpu_wakeup.WaitFor(std::chrono::microseconds(0)))
+			return;
+
+		Common::YieldCPU();
+		now = Common::Timer::GetTimeUs();
+	}
+	s_gpu_spin_us = std::max<u64>(s_gpu_spin_us / 2, GPU_SPIN_MIN_US);
+
+	s_gpu_sleeping = true;
+	const bool woken = s_gpu_wakeup.WaitFor(std::chrono::milliseconds(GPU_SLEEP_TIMEOUT_MS));
+	s_gpu_sleeping = false;
+
+	const u64 wakeup_time = s_gpu_wakeup_time.exchange(0);
+	const u64 end = Common::Timer::GetTimeUs();
+	ADDSTAT(stats.thisFrame.usGpuThreadSleeping, end - now);
+	if (woken)
+		INCSTAT(stats.thisFrame.numGpuThreadWakeups);
+	if (wakeup_time && end > wakeup_time)
+		stats.thisFrame.usGpuWakeupLatencyMax = std::max(stats.thisFrame.usGpuWakeupLatencyMax, (int)(end - wakeup_time));
 }
 
 void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr)
 {
 	if (g_use_deterministic_gpu_thread && GpuRunningState)
 	{
-		std::unique_lock<std::mutex> lk(s_video_buffer_lock);
 		u8* write_ptr = s_video_buffer_write_ptr;
-		s_video_buffer_cond.wait(lk, [&]() {
-			return !GpuRunningState || s_video_buffer_seen_ptr == write_ptr;
+		s_video_buffer_seen_ptr.Wait([&]() {
+			return !GpuRunningState || s_video_buffer_seen_ptr.Load() == write_ptr;
 		});
 		if (!GpuRunningState)
 			return;
@@ -209,9 +325,8 @@ void* PopFifoAuxBuffer(size_t size)
 }
 
 // Description: RunGpuLoop() sends data through this function.
-static void ReadDataFromFifo(u32 readPtr)
+static void ReadDataFromFifo(u32 readPtr, size_t len = 32)
 {
-	size_t len = 32;
 	if (len > (size_t)(s_video_buffer + FIFO_SIZE - s_video_buffer_write_ptr))
 	{
 		size_t existing_len = s_video_buffer_write_ptr - s_video_buffer_read_ptr;
@@ -254,7 +369,7 @@ static void ReadDataFromFifoOnCPU(u32 readPtr)
 	}
 	Memory::CopyFromEmu(s_video_buffer_write_ptr, readPtr, len);
 	s_video_buffer_pp_read_ptr = OpcodeDecoder_Run<true>(DataReader(s_video_buffer_pp_read_ptr, write_ptr + len), nullptr, false);
-	// This would have to be locked if the GPU thread didn't spin.
+	// RunGpu wakes up the GPU thread once all of the data was copied.
 	s_video_buffer_write_ptr = write_ptr + len;
 }
 
@@ -268,6 +383,167 @@ void ResetVideoBuffer()
 	s_fifo_aux_read_ptr = s_fifo_aux_data;
 }
 
+// Reads the FIFO and decodes it until it's empty or the CPU has to handle an
+// interrupt first. Runs on the decode thread while that one is used, and on
+// the GPU thread otherwise.
+static void RunFifo(bool decode_thread)
+{
+	SCPFifoStruct &fifo = CommandProcessor::fifo;
+	u32 cyclesExecuted = 0;
+
+	CommandProcessor::SetCPStatusFromGPU();
+
+	Common::AtomicStore(CommandProcessor::VITicks, CommandProcessor::m_cpClockOrigin);
+
+	// check if we are able to run this buffer
+	while (GpuRunningState && EmuRunningState && !CommandProcessor::interruptWaiting && fifo.bFF_GPReadEnable && fifo.CPReadWriteDistance && !AtBreakpoint() &&
+	       !(decode_thread && s_decode_thread_quit))
+	{
+		fifo.isGpuReadingData = true;
+		CommandProcessor::isPossibleWaitingSetDrawDone = fifo.bFF_GPLinkEnable ? true : false;
+
+		const bool sync_gpu = SConfig::GetInstance().m_LocalCoreStartupParameter.bSyncGPU;
+		if (!sync_gpu || Common::AtomicLoad(CommandProcessor::VITicks) > CommandProcessor::m_cpClockOrigin)
+		{
+			u32 readPtr = fifo.CPReadPointer;
+			const u32 distance = Common::AtomicLoad(fifo.CPReadWriteDistance);
+
+			// SyncGPU counts the cycles of every block and breakpoints are
+			// checked per block, otherwise everything up to the end of the
+			// FIFO can be decoded at once. While the CPU hasn't handled a PE
+			// token or finish yet, blocks are read one at a time as well.
+			const bool batch = !sync_gpu && !fifo.bFF_BPEnable && !CommandProcessor::IsInterruptWaiting();
+			u32 len = 32;
+			if (batch)
+			{
+				len = std::min<u32>(distance, std::min<u32>(fifo.CPEnd - readPtr + 32, GPU_FIFO_READ_BATCH));
+
+				// The underflow interrupt is raised after the block which
+				// crosses the low watermark, as when reading single blocks.
+				if (fifo.bFF_LoWatermarkInt && distance >= fifo.CPLoWatermark)
+					len = std::min<u32>(len, ((distance - fifo.CPLoWatermark) / 32 + 1) * 32);
+			}
+
+			ReadDataFromFifo(readPtr, len);
+
+			_assert_msg_(COMMANDPROCESSOR, (s32)distance - (s32)len >= 0 ,
+				"Negative fifo.CPReadWriteDistance = %i in FIFO Loop !\nThat can produce instability in the game. Please report it.", distance - len);
+
+			// Only timed while the statistics are shown, the timer isn't free.
+			const u64 start_time = g_ActiveConfig.bOverlayStats ? Common::Timer::GetTimeUs() : 0;
+
+			u8* write_ptr = s_video_buffer_write_ptr;
+			if (decode_thread)
+			{
+				s_video_buffer_read_ptr = OpcodeDecoder_RunToCommandStream(DataReader(s_video_buffer_read_ptr, write_ptr), false, batch);
+				CommandStream::Submit();
+			}
+			else
+			{
+				s_video_buffer_read_ptr = OpcodeDecoder_Run(DataReader(s_video_buffer_read_ptr, write_ptr), &cyclesExecuted, false, batch);
+			}
+
+			if (g_ActiveConfig.bOverlayStats)
+				ADDSTAT(stats.thisFrame.usFifoDecoding, Common::Timer::GetTimeUs() - start_time);
+
+			// Decoding stopped at a command which raised an interrupt, the
+			// blocks after the one it stopped in are read again once the CPU
+			// handled it.
+			if (batch && CommandProcessor::IsInterruptWaiting())
+			{
+				const u32 unread_blocks = std::min<u32>((u32)(write_ptr - s_video_buffer_read_ptr) / 32, len / 32 - 1);
+				len -= unread_blocks * 32;
+				write_ptr -= unread_blocks * 32;
+				s_video_buffer_write_ptr = write_ptr;
+			}
+
+			if (readPtr + len > fifo.CPEnd)
+				readPtr = fifo.CPBase;
+			else
+				readPtr += len;
+
+			if (sync_gpu && Common::AtomicLoad(CommandProcessor::VITicks) >= cyclesExecuted)
+				Common::AtomicAdd(CommandProcessor::VITicks, -(s32)cyclesExecuted);
+
+			Common::AtomicStore(fifo.CPReadPointer, readPtr);
+			Common::AtomicAdd(fifo.CPReadWriteDistance, -(s32)len);
+			if ((write_ptr - s_video_buffer_read_ptr) == 0)
+				Common::AtomicStore(fifo.SafeCPReadPointer, fifo.CPReadPointer);
+		}
+
+		CommandProcessor::SetCPStatusFromGPU();
+
+		// This call is pretty important in DualCore mode and must be called in the FIFO Loop.
+		// If we don't, s_swapRequested or s_efbAccessRequested won't be set to false
+		// leading the CPU thread to wait in Video_BeginField or Video_AccessEFB thus slowing things down.
+		// The GPU thread does that itself while the decode thread runs.
+		if (!decode_thread)
+			VideoFifo_CheckAsyncRequest();
+		CommandProcessor::isPossibleWaitingSetDrawDone = false;
+	}
+
+	fifo.isGpuReadingData = false;
+}
+
+// Whether the decode thread should run. SyncGPU counts the cycles of every
+// command, the deterministic mode decodes on the CPU thread already, and the
+// FIFO recorder records the commands as they are executed.
+static bool UseDecodeThread()
+{
+	return g_ActiveConfig.bDecodeThread && EmuRunningState && GpuRunningState &&
+	       !g_use_deterministic_gpu_thread && !g_bRecordFifoData &&
+	       !SConfig::GetInstance().m_LocalCoreStartupParameter.bSyncGPU;
+}
+
+static void DecodeThread()
+{
+	Common::SetCurrentThreadName("FIFO decode thread");
+
+	CommandStream::Start();
+	while (!s_decode_thread_quit)
+	{
+		RunFifo(true);
+		if (!FifoHasWork())
+			s_decode_wakeup.WaitFor(std::chrono::milliseconds(GPU_SLEEP_TIMEOUT_MS));
+	}
+	CommandStream::Submit();
+	s_decode_thread_done = true;
+	WakeGpuThread();
+}
+
+static void StartDecodeThread()
+{
+	// The decode thread tracks the CP state from here on.
+	CopyPreprocessCPStateFromMain();
+	VertexLoaderManager::MarkAllDirty();
+
+	s_decode_thread_quit = false;
+	s_decode_thread_done = false;
+	s_decode_thread = std::thread(DecodeThread);
+}
+
+// Executes everything the decode thread decoded until it stopped.
+static void StopDecodeThread()
+{
+	if (!s_decode_thread.joinable())
+		return;
+
+	// The decode thread may wait for the GPU thread to execute its lists
+	s_decode_thread_quit = true;
+	s_decode_wakeup.Set();
+	while (!s_decode_thread_done)
+	{
+		if (!CommandStream::ExecuteQueuedList())
+			s_gpu_wakeup.WaitFor(std::chrono::milliseconds(1));
+	}
+	s_decode_thread.join();
+
+	while (CommandStream::ExecuteQueuedList())
+	{
+	}
+
+	VertexLoaderManager::MarkAllDirty();
+}
 
 // Description: Main FIFO update loop
 // Purpose: Keep the Core HW updated about the CPU-GPU distance
@@ -275,18 +551,21 @@ void RunGpuLoop()
 {
 	std::lock_guard<std::mutex> lk(m_csHWVidOccupied);
 	GpuRunningState = true;
-	SCPFifoStruct &fifo = CommandProcessor::fifo;
-	u32 cyclesExecuted = 0;
-
-	// If the host CPU has only two cores, idle loop instead of busy loop
-	// This allows a system that we are maxing out in dual core mode to do other things
-	bool yield_cpu = cpu_info.num_cores <= 2;
 
 	while (GpuRunningState)
 	{
 		g_video_backend->PeekMessages();
 
 		VideoFifo_CheckAsyncRequest();
+
+		if (UseDecodeThread() != s_decode_thread.joinable())
+		{
+			if (s_decode_thread.joinable())
+				StopDecodeThread();
+			else
+				StartDecodeThread();
+		}
+
 		if (g_use_deterministic_gpu_thread)
 		{
 			// All the fifo/CP stuff is on the CPU.  We just need to run the opcode decoder.
@@ -295,76 +574,40 @@ void RunGpuLoop()
 			// See comment in SyncGPU
 			if (write_ptr > seen_ptr)
 			{
+				const u64 start_time = g_ActiveConfig.bOverlayStats ? Common::Timer::GetTimeUs() : 0;
+
 				s_video_buffer_read_ptr = OpcodeDecoder_Run(DataReader(s_video_buffer_read_ptr, write_ptr), nullptr, false);
 
-				{
-					std::lock_guard<std::mutex> vblk(s_video_buffer_lock);
-					s_video_buffer_seen_ptr = write_ptr;
-					s_video_buffer_cond.notify_all();
-				}
+				if (g_ActiveConfig.bOverlayStats)
+					ADDSTAT(stats.thisFrame.usFifoDecoding, Common::Timer::GetTimeUs() - start_time);
+
+				s_video_buffer_seen_ptr.Store(write_ptr);
 			}
 		}
-		else
+		else if (s_decode_thread.joinable())
 		{
-			CommandProcessor::SetCPStatusFromGPU();
-
-			Common::AtomicStore(CommandProcessor::VITicks, CommandProcessor::m_cpClockOrigin);
-
-			// check if we are able to run this buffer
-			while (GpuRunningState && EmuRunningState && !CommandProcessor::interruptWaiting && fifo.bFF_GPReadEnable && fifo.CPReadWriteDistance && !AtBreakpoint())
-			{
-				fifo.isGpuReadingData = true;
-				CommandProcessor::isPossibleWaitingSetDrawDone = fifo.bFF_GPLinkEnable ? true : false;
-
-				if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bSyncGPU || Common::AtomicLoad(CommandProcessor::VITicks) > CommandProcessor::m_cpClockOrigin)
-				{
-					u32 readPtr = fifo.CPReadPointer;
-					ReadDataFromFifo(readPtr);
-
-					if (readPtr == fifo.CPEnd)
-						readPtr = fifo.CPBase;
-					else
-						readPtr += 32;
-
-					_assert_msg_(COMMANDPROCESSOR, (s32)fifo.CPReadWriteDistance - 32 >= 0 ,
-						"Negative fifo.CPReadWriteDistance = %i in FIFO Loop !\nThat can produce instability in the game. Please report it.", fifo.CPReadWriteDistance - 32);
-
-
-					u8* write_ptr = s_video_buffer_write_ptr;
-					s_video_buffer_read_ptr = OpcodeDecoder_Run(DataReader(s_video_buffer_read_ptr, write_ptr), &cyclesExecuted, false);
-
-
-					if (SConfig::GetInstance().m_LocalCoreStartupParameter.bSyncGPU && Common::AtomicLoad(CommandProcessor::VITicks) >= cyclesExecuted)
-						Common::AtomicAdd(CommandProcessor::VITicks, -(s32)cyclesExecuted);
-
-					Common::AtomicStore(fifo.CPReadPointer, readPtr);
-					Common::AtomicAdd(fifo.CPReadWriteDistance, -32);
-					if ((write_ptr - s_video_buffer_read_ptr) == 0)
-						Common::AtomicStore(fifo.SafeCPReadPointer, fifo.CPReadPointer);
-				}
-
-				CommandProcessor::SetCPStatusFromGPU();
-
-				// This call is pretty important in DualCore mode and must be called in the FIFO Loop.
-				// If we don't, s_swapRequested or s_efbAccessRequested won't be set to false
-				// leading the CPU thread to wait in Video_BeginField or Video_AccessEFB thus slowing things down.
+			// The decode thread reads the FIFO, this thread only executes
+			// what it decoded.
+			while (GpuRunningState && EmuRunningState && CommandStream::ExecuteQueuedList())
 				VideoFifo_CheckAsyncRequest();
-				CommandProcessor::isPossibleWaitingSetDrawDone = false;
-			}
-
-			fifo.isGpuReadingData = false;
+		}
+		else
+		{
+			RunFifo(false);
 		}
 
 		if (EmuRunningState)
 		{
-			// NOTE(jsd): Calling SwitchToThread() on Windows 7 x64 is a hot spot, according to profiler.
-			// See https://docs.google.com/spreadsheet/ccc?key=0Ah4nh0yGtjrgdFpDeF9pS3V6RUotRVE3S3J4TGM1NlE#gid=0
-			// for benchmark details.
-			if (yield_cpu)
-				Common::YieldCPU();
+			if (!GpuHasWork())
+				WaitForGpuWork();
 		}
 		else
 		{
+			// Savestates are made while the emu is paused, so there mustn't be
+			// any decoded commands or EFB copies left.
+			StopDecodeThread();
+			FlushPendingEFBCopies();
+
 			// While the emu is paused, we still handle async requests then sleep.
 			while (!EmuRunningState)
 			{
@@ -375,8 +618,10 @@ void RunGpuLoop()
 			}
 		}
 	}
+	StopDecodeThread();
+
 	// wake up SyncGPU if we were interrupted
-	s_video_buffer_cond.notify_all();
+	s_video_buffer_seen_ptr.Notify();
 }
 
 
@@ -390,7 +635,10 @@ void RunGpu()
 {
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bCPUThread &&
 	    !g_use_deterministic_gpu_thread)
+	{
+		WakeGpuThread();
 		return;
+	}
 
 	SCPFifoStruct &fifo = CommandProcessor::fifo;
 	while (fifo.bFF_GPReadEnable && fifo.CPReadWriteDistance && !AtBreakpoint() )
@@ -418,6 +666,9 @@ void RunGpu()
 		fifo.CPReadWriteDistance -= 32;
 	}
 	CommandProcessor::SetCPStatusFromGPU();
+
+	if (g_use_deterministic_gpu_thread)
+		WakeGpuThread();
 }
 
 void Fifo_UpdateWantDeterminism(bool want)
@@ -48,6 +48,9 @@ void* PopFifoAuxBuffer(size_t size);
 
 void RunGpu();
 void RunGpuLoop();
+// Called whenever there may be new work for RunGpuLoop, so the GPU thread
+// doesn't have to poll for it.
+void WakeGpuThread();
 void ExitGpuLoop();
 void EmulatorState(bool running);
 bool AtBreakpoint();
@@ -0,0 +1,145 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/Logging/Log.h"
+#include "Common/Thread.h"
+
+#include "VideoCommon/FrameDumpThread.h"
+
+namespace FrameDumpThread
+{
+
+static std::thread s_thread;
+static EncodeFunction s_encode;
+
+// Everything below is guarded by s_lock
+static std::mutex s_lock;
+static std::condition_variable s_frame_queued;
+static std::condition_variable s_frame_done;
+static std::deque<std::unique_ptr<Frame>> s_queue;
+// Frames which were already encoded, so that their buffers can be reused
+static std::vector<std::unique_ptr<Frame>> s_free_frames;
+static u32 s_queued_frames;
+static bool s_quit;
+
+static u32 s_num_frames;
+// How often the GPU thread had to wait for the encoder
+static u32 s_num_stalls;
+
+static void EncoderThread()
+{
+	Common::SetCurrentThreadName("Frame dump encoder");
+
+	std::unique_lock<std::mutex> lk(s_lock);
+	while (true)
+	{
+		s_frame_queued.wait(lk, [] { return s_quit || !s_queue.empty(); });
+		if (s_queue.empty())
+			return;
+
+		std::unique_ptr<Frame> frame(std::move(s_queue.front()));
+		s_queue.pop_front();
+
+		lk.unlock();
+		s_encode(*frame);
+		lk.lock();
+
+		s_free_frames.push_back(std::move(frame));
+		s_queued_frames--;
+		s_frame_done.notify_all();
+	}
+}
+
+void Start(EncodeFunction encode)
+{
+	Stop();
+
+	s_encode = encode;
+	s_quit = false;
+	s_num_frames = 0;
+	s_num_stalls = 0;
+	s_thread = std::thread(EncoderThread);
+}
+
+void AddFrame(const u8* data, int width, int height, int bytes_per_pixel, int stride, s64 timestamp, int repeat)
+{
+	if (!IsRunning())
+		return;
+
+	std::unique_ptr<Frame> frame;
+	{
+		std::unique_lock<std::mutex> lk(s_lock);
+		if (s_queued_frames >= MAX_QUEUED_FRAMES)
+		{
+			s_num_stalls++;
+			s_frame_done.wait(lk, [] { return s_queued_frames < MAX_QUEUED_FRAMES; });
+		}
+
+		s_queued_frames++;
+		s_num_frames++;
+		if (!s_free_frames.empty())
+		{
+			frame = std::move(s_free_frames.back());
+			s_free_frames.pop_back();
+		}
+	}
+
+	if (!frame)
+		frame.reset(new Frame);
+
+	// The room in the queue is already reserved, so copying doesn't need the lock
+	const int row_size = width * bytes_per_pixel;
+	frame->data.resize(row_size * height);
+	if (stride == row_size)
+	{
+		memcpy(frame->data.data(), data, row_size * height);
+	}
+	else
+	{
+		for (int y = 0; y < height; ++y)
+			memcpy(&frame->data[y * row_size], data + y * stride, row_size);
+	}
+	frame->width = width;
+	frame->height = height;
+	frame->timestamp = timestamp;
+	frame->repeat = repeat;
+
+	std::lock_guard<std::mutex> lk(s_lock);
+	s_queue.push_back(std::move(frame));
+	s_frame_queued.notify_one();
+}
+
+void Stop()
+{
+	if (!s_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(s_lock);
+		// The encoder empties the queue before it quits
+		s_quit = true;
+		s_frame_queued.notify_one();
+	}
+	s_thread.join();
+
+	s_free_frames.clear();
+	s_encode = nullptr;
+
+	NOTICE_LOG(VIDEO, "Frame dump: encoded %u frames, waited for the encoder %u times", s_num_frames, s_num_stalls);
+}
+
+bool IsRunning()
+{
+	return s_thread.joinable();
+}
+
+}
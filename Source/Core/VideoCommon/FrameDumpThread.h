@@ -0,0 +1,51 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// Encodes dumped frames on a separate thread, so that the GPU thread only
+// has to copy each frame into a small queue. Frames are encoded one at a
+// time and in order, as video encoders need them.
+namespace FrameDumpThread
+{
+
+enum
+{
+	// 8 frames at 1080p are about 50 MB
+	MAX_QUEUED_FRAMES = 8,
+};
+
+struct Frame
+{
+	// Packed rows of width * bytes_per_pixel bytes, in the order they were
+	// passed in
+	std::vector<u8> data;
+	int width;
+	int height;
+	// For encoders which place frames by time, e.g. FFmpeg's pts
+	s64 timestamp;
+	// For encoders with a constant frame rate: how many times the previous
+	// frame is written before this one
+	int repeat;
+};
+
+typedef std::function<void(const Frame&)> EncodeFunction;
+
+void Start(EncodeFunction encode);
+
+// Copies the frame into the queue. Blocks while the queue is full: dropping
+// frames would break the recording.
+void AddFrame(const u8* data, int width, int height, int bytes_per_pixel, int stride, s64 timestamp, int repeat);
+
+// Encodes all queued frames and stops the thread.
+void Stop();
+
+bool IsRunning();
+
+}
@@ -0,0 +1,205 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+
+#include "VideoCommon/HiresTexturePack.h"
+
+namespace HiresTexturePack
+{
+
+static u64 AlignUp(u64 value)
+{
+	return (value + 15) & ~15ULL;
+}
+
+static bool CompareKeys(const Entry& a, const Entry& b)
+{
+	return a.key < b.key;
+}
+
+Reader::Reader() :
+	m_entryCount(0),
+	m_entriesOffset(0)
+{
+}
+
+bool Reader::Open(const std::string& filename)
+{
+	Close();
+
+	if (!m_file.Open(filename))
+		return false;
+
+	const u8* data = m_file.GetData();
+	Header header;
+	if (!m_file.Contains(0, sizeof(header)))
+	{
+		ERROR_LOG(VIDEO, "Texture pack %s is truncated", filename.c_str());
+		Close();
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	if (header.magic != MAGIC || header.version != VERSION)
+	{
+		ERROR_LOG(VIDEO, "%s is not a texture pack of version %u", filename.c_str(), (u32)VERSION);
+		Close();
+		return false;
+	}
+
+	// The entries are read in place, so they have to be aligned
+	if ((header.entriesOffset & 7) != 0 ||
+	    !m_file.Contains(header.entriesOffset, (u64)header.entryCount * sizeof(Entry)))
+	{
+		ERROR_LOG(VIDEO, "Texture pack %s has an invalid table of contents", filename.c_str());
+		Close();
+		return false;
+	}
+	m_entryCount = header.entryCount;
+	m_entriesOffset = header.entriesOffset;
+
+	const Entry* entries = GetEntries();
+	for (u32 i = 0; i < m_entryCount; ++i)
+	{
+		const Entry& entry = entries[i];
+		if (entry.width == 0 || entry.width > MAX_TEXTURE_SIZE ||
+		    entry.height == 0 || entry.height > MAX_TEXTURE_SIZE ||
+		    !m_file.Contains(entry.dataOffset, (u64)entry.width * entry.height * 4) ||
+		    (i > 0 && entries[i - 1].key >= entry.key))
+		{
+			ERROR_LOG(VIDEO, "Texture pack %s has an invalid entry %u", filename.c_str(), i);
+			Close();
+			return false;
+		}
+	}
+
+	INFO_LOG(VIDEO, "Opened texture pack %s with %u textures", filename.c_str(), m_entryCount);
+	return true;
+}
+
+void Reader::Close()
+{
+	m_file.Close();
+	m_entryCount = 0;
+	m_entriesOffset = 0;
+}
+
+const Entry* Reader::GetEntries() const
+{
+	return (const Entry*)(m_file.GetData() + m_entriesOffset);
+}
+
+const u8* Reader::Find(u64 key, u32* width, u32* height) const
+{
+	if (m_entryCount == 0)
+		return nullptr;
+
+	const Entry* begin = GetEntries();
+	const Entry* end = begin + m_entryCount;
+	Entry search;
+	search.key = key;
+	const Entry* entry = std::lower_bound(begin, end, search, CompareKeys);
+	if (entry == end || entry->key != key)
+		return nullptr;
+
+	*width = entry->width;
+	*height = entry->height;
+	return m_file.GetData() + entry->dataOffset;
+}
+
+void Reader::Prefetch(const Common::Flag& abort) const
+{
+	const Entry* entries = GetEntries();
+	volatile u8 sink = 0;
+	for (u32 i = 0; i < m_entryCount && !abort.IsSet(); ++i)
+	{
+		const u8* data = m_file.GetData() + entries[i].dataOffset;
+		const u64 size = (u64)entries[i].width * entries[i].height * 4;
+		for (u64 offset = 0; offset < size; offset += 4096)
+			sink += data[offset];
+	}
+}
+
+bool Writer::Open(const std::string& filename)
+{
+	m_filename = filename;
+	m_entries.clear();
+	m_keys.clear();
+
+	// Written for real by Finish, a pack which wasn't finished is rejected
+	// by its magic.
+	Header header;
+	memset(&header, 0, sizeof(header));
+	if (!m_file.Open(filename, "wb") ||
+	    !m_file.WriteBytes(&header, sizeof(header)) ||
+	    !WritePadding())
+	{
+		ERROR_LOG(VIDEO, "Failed to create texture pack %s", filename.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool Writer::WritePadding()
+{
+	const u8 padding[16] = {};
+	const u64 offset = m_file.Tell();
+	return m_file.WriteBytes(padding, (size_t)(AlignUp(offset) - offset));
+}
+
+bool Writer::AddTexture(u64 key, u32 width, u32 height, const u8* rgba)
+{
+	if (!m_keys.insert(key).second)
+		return true;
+
+	Entry entry;
+	entry.key = key;
+	entry.dataOffset = m_file.Tell();
+	entry.width = width;
+	entry.height = height;
+	m_entries.push_back(entry);
+
+	if (!m_file.WriteBytes(rgba, (size_t)width * height * 4) || !WritePadding())
+	{
+		ERROR_LOG(VIDEO, "Failed to write texture pack %s", m_filename.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool Writer::Finish()
+{
+	std::sort(m_entries.begin(), m_entries.end(), CompareKeys);
+
+	Header header;
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.entryCount = (u32)m_entries.size();
+	header.reserved = 0;
+	header.entriesOffset = m_file.Tell();
+
+	if (!m_file.WriteArray(m_entries.data(), m_entries.size()) ||
+	    !m_file.Seek(0, SEEK_SET) ||
+	    !m_file.WriteBytes(&header, sizeof(header)) ||
+	    !m_file.Close())
+	{
+		ERROR_LOG(VIDEO, "Failed to write texture pack %s", m_filename.c_str());
+		m_file.Close();
+		return false;
+	}
+
+	return true;
+}
+
+}  // namespace HiresTexturePack
@@ -0,0 +1,112 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Flag.h"
+#include "Common/MappedFile.h"
+
+// A texture pack holds all custom textures of a game in a single file, already
+// decoded to RGBA32. It's mapped into memory, so loading a texture from it
+// is a binary search in its table of contents and a copy, instead of opening
+// and decoding an image file.
+//
+// Layout, little endian:
+//   Header
+//   RGBA32 data of the textures, each 16 byte aligned
+//   Entry[entryCount], sorted by key
+namespace HiresTexturePack
+{
+
+enum
+{
+	MAGIC = 0x4b505444, // "DTPK"
+	VERSION = 1,
+	MAX_TEXTURE_SIZE = 16384,
+};
+
+#pragma pack(push, 4)
+
+struct Header
+{
+	u32 magic;
+	u32 version;
+	u32 entryCount;
+	u32 reserved;
+	u64 entriesOffset;
+};
+
+struct Entry
+{
+	u64 key;
+	u64 dataOffset;
+	u32 width;
+	u32 height;
+};
+
+#pragma pack(pop)
+
+// Identifies a texture the same way its file name does, see
+// TextureCache::LoadCustomTexture.
+inline u64 MakeKey(u32 hash, int texformat, unsigned int level)
+{
+	return ((u64)hash << 32) | ((u32)texformat << 16) | level;
+}
+
+class Reader : public NonCopyable
+{
+public:
+	Reader();
+
+	bool Open(const std::string& filename);
+	void Close();
+
+	bool IsOpen() const { return m_file.IsOpen(); }
+
+	// Returns the RGBA32 data of the texture, or nullptr if the pack doesn't
+	// contain it.
+	const u8* Find(u64 key, u32* width, u32* height) const;
+
+	// Reads all textures, so the OS has them in RAM by the time they're used.
+	// Returns early once abort is set.
+	void Prefetch(const Common::Flag& abort) const;
+
+private:
+	const Entry* GetEntries() const;
+
+	File::MappedFile m_file;
+	u32 m_entryCount;
+	u64 m_entriesOffset;
+};
+
+// Writes the textures to the file as they're added, so a pack doesn't have to
+// fit into memory. The table of contents and the header are written once all
+// textures were added; until then the file isn't a valid pack.
+class Writer : public NonCopyable
+{
+public:
+	bool Open(const std::string& filename);
+
+	// If a key is added more than once, the first texture is kept.
+	bool AddTexture(u64 key, u32 width, u32 height, const u8* rgba);
+
+	bool Finish();
+
+private:
+	bool WritePadding();
+
+	File::IOFile m_file;
+	std::string m_filename;
+	std::vector<Entry> m_entries;
+	std::set<u64> m_keys;
+};
+
+}  // namespace HiresTexturePack
@@ -2,32 +2,90 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
-#include <algorithm>
+#include <cstdio>
 #include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 #include <SOIL/SOIL.h>
 
 #include "Common/CommonPaths.h"
 #include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
+#include "Common/Flag.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
 
+#include "VideoCommon/HiresTexturePack.h"
 #include "VideoCommon/HiresTextures.h"
 
 namespace HiresTextures
 {
 
-static std::map<std::string, std::string> textureMap;
+struct DecodedTexture
+{
+	unsigned int width;
+	unsigned int height;
+	std::vector<u8> data;
+};
+
+static std::map<u64, std::string> textureMap;
+static HiresTexturePack::Reader s_pack;
 
-void Init(const std::string& gameCode)
+enum
 {
-	textureMap.clear();
+	// Prefetching stops once this much decoded texture data waits to be used
+	MAX_PREFETCHED_BYTES = 512 * 1024 * 1024,
+};
 
-	CFileSearch::XStringVector Directories;
+// Filled by the prefetch thread, an entry is freed once GetHiresTex used it
+static std::map<u64, std::unique_ptr<DecodedTexture>> s_decoded_textures;
+static size_t s_decoded_bytes;
+static std::mutex s_decoded_textures_lock;
+
+static std::thread s_prefetch_thread;
+static Common::Flag s_prefetch_abort;
 
-	std::string szDir = StringFromFormat("%s%s", File::GetUserPath(D_HIRESTEXTURES_IDX).c_str(), gameCode.c_str());
-	Directories.push_back(szDir);
+// Parses <gameCode>_<hash>_<texformat>[_mip<level>], see TextureCache::LoadCustomTexture
+static bool ParseTextureName(const std::string& name, const std::string& gameCode, u64* key)
+{
+	const std::string code = StringFromFormat("%s_", gameCode.c_str());
+	if (name.compare(0, code.length(), code) != 0)
+		return false;
+
+	const char* str = name.c_str() + code.length();
+	u32 hash;
+	int texformat;
+	unsigned int level = 0;
+	int length = 0;
+	if (sscanf(str, "%8x_%d%n", &hash, &texformat, &length) != 2)
+		return false;
+
+	str += length;
+	if (*str != '\0')
+	{
+		length = 0;
+		if (sscanf(str, "_mip%u%n", &level, &length) != 1 || str[length] != '\0')
+			return false;
+	}
+
+	*key = HiresTexturePack::MakeKey(hash, texformat & 0xFFFF, level);
+	return true;
+}
+
+std::string GetTexturePackPath(const std::string& gameCode)
+{
+	return StringFromFormat("%s%s.dtp", File::GetUserPath(D_HIRESTEXTURES_IDX).c_str(), gameCode.c_str());
+}
+
+void FindTextureFiles(const std::string& directory, const std::string& gameCode, std::map<u64, std::string>* files)
+{
+	CFileSearch::XStringVector Directories;
+	Directories.push_back(directory);
 
 	for (u32 i = 0; i < Directories.size(); i++)
 	{
@@ -65,100 +123,164 @@ void Init(const std::string& gameCode)
 	CFileSearch FileSearch(Extensions, Directories);
 	const CFileSearch::XStringVector& rFilenames = FileSearch.GetFileNames();
 
-	const std::string code = StringFromFormat("%s_", gameCode.c_str());
-
-	if (rFilenames.size() > 0)
+	for (auto& rFilename : rFilenames)
 	{
-		for (auto& rFilename : rFilenames)
-		{
-			std::string FileName;
-			SplitPath(rFilename, nullptr, &FileName, nullptr);
+		std::string FileName;
+		SplitPath(rFilename, nullptr, &FileName, nullptr);
 
-			if (FileName.substr(0, code.length()).compare(code) == 0 && textureMap.find(FileName) == textureMap.end())
-				textureMap.insert(std::map<std::string, std::string>::value_type(FileName, rFilename));
-		}
+		u64 key;
+		if (ParseTextureName(FileName, gameCode, &key) && files->find(key) == files->end())
+			files->insert(std::make_pair(key, rFilename));
 	}
 }
 
-bool HiresTexExists(const std::string& filename)
+bool LoadTextureFile(const std::string& filename, unsigned int* width, unsigned int* height, std::vector<u8>* data)
 {
-	return textureMap.find(filename) != textureMap.end();
+	std::string buffer;
+	if (!File::ReadFileToString(filename, buffer))
+		return false;
+
+	int w;
+	int h;
+	int channels;
+	u8* temp = SOIL_load_image_from_memory((const u8*)buffer.data(), (int)buffer.size(), &w, &h, &channels, SOIL_LOAD_RGBA);
+	if (temp == nullptr)
+	{
+		ERROR_LOG(VIDEO, "Custom texture %s failed to load", filename.c_str());
+		return false;
+	}
+
+	*width = w;
+	*height = h;
+	data->assign(temp, temp + w * h * 4);
+	SOIL_free_image_data(temp);
+	return true;
 }
 
-PC_TexFormat GetHiresTex(const std::string& filename, unsigned int* pWidth, unsigned int* pHeight, unsigned int* required_size, int texformat, unsigned int data_size, u8* data)
+// Brings everything the game can use into RAM, so that loading a custom
+// texture while the game is running doesn't stall on the disk or on decoding.
+static void PrefetchThread()
 {
-	if (textureMap.find(filename) == textureMap.end())
-		return PC_TEX_FMT_NONE;
+	Common::SetCurrentThreadName("Hires texture prefetch");
 
-	int width;
-	int height;
-	int channels;
+	if (s_pack.IsOpen())
+		s_pack.Prefetch(s_prefetch_abort);
 
-	File::IOFile file;
-	file.Open(textureMap[filename], "rb");
-	std::vector<u8> buffer(file.GetSize());
-	file.ReadBytes(buffer.data(), file.GetSize());
+	for (auto& file : textureMap)
+	{
+		if (s_prefetch_abort.IsSet())
+			break;
 
-	u8* temp = SOIL_load_image_from_memory(buffer.data(), (int)buffer.size(), &width, &height, &channels, SOIL_LOAD_RGBA);
+		u32 width, height;
+		if (s_pack.Find(file.first, &width, &height))
+			continue;
 
-	if (temp == nullptr)
+		std::unique_ptr<DecodedTexture> texture(new DecodedTexture);
+		if (!LoadTextureFile(file.second, &texture->width, &texture->height, &texture->data))
+			continue;
+
+		std::lock_guard<std::mutex> lk(s_decoded_textures_lock);
+		if (s_decoded_bytes + texture->data.size() > MAX_PREFETCHED_BYTES)
+		{
+			WARN_LOG(VIDEO, "Stopped prefetching custom textures after %u MB", (unsigned int)(s_decoded_bytes >> 20));
+			return;
+		}
+		s_decoded_bytes += texture->data.size();
+		s_decoded_textures[file.first] = std::move(texture);
+	}
+
+	INFO_LOG(VIDEO, "Finished prefetching custom textures");
+}
+
+void Init(const std::string& gameCode, bool prefetch)
+{
+	Shutdown();
+
+	if (s_pack.Open(GetTexturePackPath(gameCode)))
+		INFO_LOG(VIDEO, "Using texture pack %s", GetTexturePackPath(gameCode).c_str());
+
+	FindTextureFiles(File::GetUserPath(D_HIRESTEXTURES_IDX) + gameCode, gameCode, &textureMap);
+
+	if (prefetch)
 	{
-		ERROR_LOG(VIDEO, "Custom texture %s failed to load", textureMap[filename].c_str());
-		return PC_TEX_FMT_NONE;
+		s_prefetch_abort.Clear();
+		s_prefetch_thread = std::thread(PrefetchThread);
 	}
+}
 
+void Shutdown()
+{
+	if (s_prefetch_thread.joinable())
+	{
+		s_prefetch_abort.Set();
+		s_prefetch_thread.join();
+	}
+
+	s_decoded_textures.clear();
+	s_decoded_bytes = 0;
+	textureMap.clear();
+	s_pack.Close();
+}
+
+bool HiresTexExists(u32 hash, int texformat, unsigned int level)
+{
+	const u64 key = HiresTexturePack::MakeKey(hash, texformat & 0xFFFF, level);
+	u32 width, height;
+	return s_pack.Find(key, &width, &height) || textureMap.find(key) != textureMap.end();
+}
+
+static PC_TexFormat CopyTexture(const u8* src, unsigned int width, unsigned int height, unsigned int* pWidth, unsigned int* pHeight, unsigned int* required_size, unsigned int data_size, u8* data)
+{
 	*pWidth = width;
 	*pHeight = height;
 
-	//int offset = 0;
-	PC_TexFormat returnTex = PC_TEX_FMT_NONE;
+	// TODO(neobrain): There's currently no way to enforce RGBA32 output, which
+	// however is required on some configurations to function properly, so
+	// textures are never converted to smaller formats like IA8.
+	*required_size = width * height * 4;
+	if (data_size < *required_size)
+		return PC_TEX_FMT_NONE;
+
+	memcpy(data, src, width * height * 4);
+	return PC_TEX_FMT_RGBA32;
+}
+
+PC_TexFormat GetHiresTex(u32 hash, int texformat, unsigned int level, unsigned int* pWidth, unsigned int* pHeight, unsigned int* required_size, unsigned int data_size, u8* data)
+{
+	const u64 key = HiresTexturePack::MakeKey(hash, texformat & 0xFFFF, level);
+
+	u32 width, height;
+	const u8* src = s_pack.Find(key, &width, &height);
+	if (src)
+		return CopyTexture(src, width, height, pWidth, pHeight, required_size, data_size, data);
+
+	auto file = textureMap.find(key);
+	if (file == textureMap.end())
+		return PC_TEX_FMT_NONE;
 
-	// TODO(neobrain): This function currently has no way to enforce RGBA32
-	// output, which however is required on some configurations to function
-	// properly. As a lazy workaround, we hence disable the optimized code
-	// path for now.
-#if 0
-	switch (texformat)
 	{
-	case GX_TF_I4:
-	case GX_TF_I8:
-	case GX_TF_IA4:
-	case GX_TF_IA8:
-		*required_size = width * height * 8;
-		if (data_size < *required_size)
-			goto cleanup;
-
-		for (int i = 0; i < width * height * 4; i += 4)
+		std::lock_guard<std::mutex> lk(s_decoded_textures_lock);
+		auto decoded = s_decoded_textures.find(key);
+		if (decoded != s_decoded_textures.end())
 		{
-			// Rather than use a luminosity function, just use the most intense color for luminance
-			// TODO(neobrain): Isn't this kind of.. stupid?
-			data[offset++] = *std::max_element(temp+i, temp+i+3);
-			data[offset++] = temp[i+3];
+			const DecodedTexture& texture = *decoded->second;
+			PC_TexFormat ret = CopyTexture(texture.data.data(), texture.width, texture.height, pWidth, pHeight, required_size, data_size, data);
+			// The texture cache keeps its own copy, a later reload decodes the file again
+			if (ret != PC_TEX_FMT_NONE)
+			{
+				s_decoded_bytes -= texture.data.size();
+				s_decoded_textures.erase(decoded);
+			}
+			return ret;
 		}
-		returnTex = PC_TEX_FMT_IA8;
-		break;
-	default:
-		*required_size = width * height * 4;
-		if (data_size < *required_size)
-			goto cleanup;
-
-		memcpy(data, temp, width * height * 4);
-		returnTex = PC_TEX_FMT_RGBA32;
-		break;
 	}
-#else
-	*required_size = width * height * 4;
-	if (data_size < *required_size)
-		goto cleanup;
 
-	memcpy(data, temp, width * height * 4);
-	returnTex = PC_TEX_FMT_RGBA32;
-#endif
+	DecodedTexture texture;
+	if (!LoadTextureFile(file->second, &texture.width, &texture.height, &texture.data))
+		return PC_TEX_FMT_NONE;
 
-	INFO_LOG(VIDEO, "Loading custom texture from %s", textureMap[filename].c_str());
-cleanup:
-	SOIL_free_image_data(temp);
-	return returnTex;
+	INFO_LOG(VIDEO, "Loading custom texture from %s", file->second.c_str());
+	return CopyTexture(texture.data.data(), texture.width, texture.height, pWidth, pHeight, required_size, data_size, data);
 }
 
 }
@@ -6,13 +6,26 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VideoCommon.h"
 
 namespace HiresTextures
 {
-void Init(const std::string& gameCode);
-bool HiresTexExists(const std::string& filename);
-PC_TexFormat GetHiresTex(const std::string& fileName, unsigned int* pWidth, unsigned int* pHeight, unsigned int* required_size, int texformat, unsigned int data_size, u8* data);
+// Custom textures are looked up in <gameCode>.dtp in the hires textures
+// directory first, and then in the image files of the <gameCode> directory.
+// If prefetch is set, all of them are loaded into RAM by a background thread.
+void Init(const std::string& gameCode, bool prefetch);
+void Shutdown();
+
+bool HiresTexExists(u32 hash, int texformat, unsigned int level);
+PC_TexFormat GetHiresTex(u32 hash, int texformat, unsigned int level, unsigned int* pWidth, unsigned int* pHeight, unsigned int* required_size, unsigned int data_size, u8* data);
+
+// Used by the texture pack tool
+std::string GetTexturePackPath(const std::string& gameCode);
+// Finds the texture files of a game below directory, by texture pack key.
+void FindTextureFiles(const std::string& directory, const std::string& gameCode, std::map<u64, std::string>* files);
+// Decodes an image file to RGBA32.
+bool LoadTextureFile(const std::string& filename, unsigned int* width, unsigned int* height, std::vector<u8>* data);
 
 }
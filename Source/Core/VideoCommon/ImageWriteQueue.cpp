@@ -0,0 +1,201 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/CPUDetect.h"
+#include "Common/Logging/Log.h"
+#include "Common/Thread.h"
+
+#include "VideoCommon/ImageWrite.h"
+#include "VideoCommon/ImageWriteQueue.h"
+
+namespace ImageWriteQueue
+{
+
+struct Image
+{
+	std::string filename;
+	std::unique_ptr<u8[]> data;
+	int width;
+	int height;
+	bool save_alpha;
+	size_t size;
+};
+
+static std::vector<std::thread> s_threads;
+
+// Everything below is guarded by s_lock
+static std::mutex s_lock;
+static std::condition_variable s_work_available;
+// Signalled whenever an image is done, for producers which wait for room in
+// the queue and for Flush
+static std::condition_variable s_image_done;
+static std::deque<std::unique_ptr<Image>> s_queue;
+// Both include the images which are currently being written
+static size_t s_queued_bytes;
+static u32 s_pending_images;
+// A texture can be dumped again before its first dump is written, which
+// mustn't end up as two workers writing the same file
+static std::set<std::string> s_pending_filenames;
+static bool s_quit;
+static bool s_paused;
+static Stats s_stats;
+
+Stats::Stats() :
+	queued(0),
+	written(0),
+	failed(0),
+	dropped(0)
+{
+}
+
+static void WorkerThread()
+{
+	Common::SetCurrentThreadName("Image writer");
+
+	std::unique_lock<std::mutex> lk(s_lock);
+	while (true)
+	{
+		s_work_available.wait(lk, [] { return s_quit || (!s_paused && !s_queue.empty()); });
+		if (s_queue.empty())
+			return;
+
+		std::unique_ptr<Image> image(std::move(s_queue.front()));
+		s_queue.pop_front();
+
+		lk.unlock();
+		bool success = ::TextureToPng(image->data.get(), image->width * 4, image->filename, image->width, image->height, image->save_alpha);
+		lk.lock();
+
+		if (success)
+		{
+			s_stats.written++;
+		}
+		else
+		{
+			s_stats.failed++;
+			ERROR_LOG(VIDEO, "Failed to write %s", image->filename.c_str());
+		}
+
+		s_queued_bytes -= image->size;
+		s_pending_images--;
+		s_pending_filenames.erase(image->filename);
+		s_image_done.notify_all();
+	}
+}
+
+static void Start()
+{
+	const int num_threads = std::min(std::max(cpu_info.num_cores - 1, 1), (int)MAX_THREADS);
+
+	s_quit = false;
+	for (int i = 0; i < num_threads; i++)
+		s_threads.emplace_back(WorkerThread);
+}
+
+bool TextureToPng(const u8* data, int row_stride, const std::string& filename, int width, int height, bool saveAlpha, FullQueuePolicy policy)
+{
+	if (!data)
+		return false;
+
+	const size_t size = (size_t)width * height * 4;
+
+	std::unique_lock<std::mutex> lk(s_lock);
+
+	if (s_threads.empty())
+		Start();
+
+	if (s_pending_filenames.count(filename))
+		return true;
+
+	// An image which is larger than the whole queue is still written once
+	// everything before it is done
+	auto has_room = [size] { return s_queued_bytes == 0 || s_queued_bytes + size <= MAX_QUEUED_BYTES; };
+	if (!has_room())
+	{
+		if (policy == DROP_IF_FULL)
+		{
+			s_stats.dropped++;
+			WARN_LOG(VIDEO, "Image write queue is full, dropping %s", filename.c_str());
+			return false;
+		}
+
+		s_image_done.wait(lk, has_room);
+	}
+
+	s_queued_bytes += size;
+	s_pending_images++;
+	s_pending_filenames.insert(filename);
+	s_stats.queued++;
+	lk.unlock();
+
+	// Copying doesn't need the lock, the space is already reserved. Rows are
+	// packed, some backends hand over mapped textures with padded rows.
+	std::unique_ptr<Image> image(new Image);
+	image->filename = filename;
+	image->data.reset(new u8[size]);
+	for (int y = 0; y < height; ++y)
+		memcpy(&image->data[y * width * 4], data + y * row_stride, width * 4);
+	image->width = width;
+	image->height = height;
+	image->save_alpha = saveAlpha;
+	image->size = size;
+
+	lk.lock();
+	s_queue.push_back(std::move(image));
+	s_work_available.notify_one();
+	return true;
+}
+
+void Flush()
+{
+	std::unique_lock<std::mutex> lk(s_lock);
+	s_image_done.wait(lk, [] { return s_pending_images == 0; });
+}
+
+void SetPaused(bool paused)
+{
+	std::lock_guard<std::mutex> lk(s_lock);
+	s_paused = paused;
+	s_work_available.notify_all();
+}
+
+void Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lk(s_lock);
+		if (s_threads.empty())
+			return;
+
+		// The workers empty the queue before they quit
+		s_quit = true;
+		s_work_available.notify_all();
+	}
+
+	for (auto& thread : s_threads)
+		thread.join();
+	s_threads.clear();
+
+	Stats stats = GetStats();
+	NOTICE_LOG(VIDEO, "Image writer: %u images queued, %u written, %u failed, %u dropped",
+	           stats.queued, stats.written, stats.failed, stats.dropped);
+}
+
+Stats GetStats()
+{
+	std::lock_guard<std::mutex> lk(s_lock);
+	return s_stats;
+}
+
+}
@@ -0,0 +1,63 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include "Common/CommonTypes.h"
+
+// Encodes and writes PNGs on a small pool of worker threads, so that dumping
+// textures or frames doesn't stall the GPU thread on libpng and the disk.
+// The image is copied into the queue, so the caller can reuse or unmap its
+// buffer as soon as TextureToPng returns.
+namespace ImageWriteQueue
+{
+
+enum
+{
+	// Images which are queued or being written are limited to this much memory
+	MAX_QUEUED_BYTES = 256 * 1024 * 1024,
+	MAX_THREADS = 4,
+};
+
+// What to do with an image when the queue is full
+enum FullQueuePolicy
+{
+	// Block until the workers have made room for it
+	WAIT_IF_FULL,
+	// Don't write it at all, for dumps where losing some is better than
+	// slowing down the game
+	DROP_IF_FULL,
+};
+
+struct Stats
+{
+	Stats();
+
+	u32 queued;
+	u32 written;
+	u32 failed;
+	u32 dropped;
+};
+
+// Same arguments as ::TextureToPng. Returns true once the image is queued,
+// before it's written, and false if it was dropped. Whether the write itself
+// worked is only known to the worker: it logs failures and counts them in
+// Stats::failed.
+bool TextureToPng(const u8* data, int row_stride, const std::string& filename, int width, int height, bool saveAlpha, FullQueuePolicy policy);
+
+// Waits until all queued images are written. Mustn't be called while paused.
+void Flush();
+
+// While paused the workers don't start on any more images, so the queue
+// only fills up. Shutdown still writes everything.
+void SetPaused(bool paused);
+
+// Writes all queued images and stops the workers, they are restarted on
+// demand.
+void Shutdown();
+
+Stats GetStats();
+
+}
@@ -1,3 +1,6 @@
+#include <mutex>
+#include <vector>
+
 #include "Common/Event.h"
 #include "Core/ConfigManager.h"
 
@@ -49,6 +52,13 @@ static struct
 
 static u32 s_AccessEFBResult = 0;
 
+// Pokes don't return anything, so in dual core mode the CPU thread only
+// queues them up and the GPU thread applies them in batches.
+static std::mutex s_efbPokeLock;
+static std::vector<EfbPokeData> s_efbPokeQueue;
+static std::vector<EfbPokeData> s_efbPokesInFlight;
+static Common::Flag s_efbPokesQueued;
+
 void VideoBackendHardware::EmuStateChange(EMUSTATE_CHANGE newState)
 {
 	EmulatorState((newState == EMUSTATE_CHANGE_PLAY) ? true : false);
@@ -126,6 +136,7 @@ void VideoBackendHardware::Video_EndField()
 	{
 		SyncGPU(SYNC_GPU_SWAP);
 		s_swapRequested.Set();
+		WakeGpuThread();
 	}
 }
 
@@ -146,10 +157,28 @@ bool VideoBackendHardware::Video_Screenshot(const std::string& filename)
 	return true;
 }
 
+static void VideoFifo_FlushEFBPokes()
+{
+	if (!s_efbPokesQueued.TestAndClear())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(s_efbPokeLock);
+		s_efbPokesInFlight.swap(s_efbPokeQueue);
+	}
+	g_renderer->PokeEFB(s_efbPokesInFlight.data(), s_efbPokesInFlight.size());
+	s_efbPokesInFlight.clear();
+}
+
 void VideoFifo_CheckEFBAccess()
 {
+	VideoFifo_FlushEFBPokes();
+
 	if (s_efbAccessRequested.IsSet())
 	{
+		// Pokes which were queued right before this request have to land first.
+		VideoFifo_FlushEFBPokes();
+
 		s_AccessEFBResult = g_renderer->AccessEFB(s_accessEFBArgs.type, s_accessEFBArgs.x, s_accessEFBArgs.y, s_accessEFBArgs.Data);
 		s_efbAccessRequested.Clear();
 		s_efbAccessReadyEvent.Set();
@@ -162,6 +191,17 @@ u32 VideoBackendHardware::Video_AccessEFB(EFBAccessType type, u32 x, u32 y, u32
 	{
 		SyncGPU(SYNC_GPU_EFB_POKE);
 
+		if ((type == POKE_COLOR || type == POKE_Z) && SConfig::GetInstance().m_LocalCoreStartupParameter.bCPUThread)
+		{
+			{
+				std::lock_guard<std::mutex> lk(s_efbPokeLock);
+				s_efbPokeQueue.push_back({type, x, y, InputData});
+			}
+			s_efbPokesQueued.Set();
+			WakeGpuThread();
+			return 0;
+		}
+
 		s_accessEFBArgs.type = type;
 		s_accessEFBArgs.x = x;
 		s_accessEFBArgs.y = y;
@@ -175,6 +215,7 @@ u32 VideoBackendHardware::Video_AccessEFB(EFBAccessType type, u32 x, u32 y, u32
 			if (s_FifoShuttingDown.IsSet())
 				return 0;
 			s_efbAccessRequested.Set();
+			WakeGpuThread();
 			s_efbAccessReadyEvent.Wait();
 		}
 		else
@@ -214,6 +255,7 @@ u32 VideoBackendHardware::Video_GetQueryResult(PerfQueryType type)
 			if (s_FifoShuttingDown.IsSet())
 				return 0;
 			s_perfQueryRequested.Set();
+			WakeGpuThread();
 			s_perfQueryReadyEvent.Wait();
 		}
 		else
@@ -237,6 +279,7 @@ u16 VideoBackendHardware::Video_GetBoundingBox(int index)
 			return 0;
 		s_BBoxIndex = index;
 		s_BBoxRequested.Set();
+		WakeGpuThread();
 		s_BBoxReadyEvent.Wait();
 		return s_BBoxResult;
 	}
@@ -267,6 +310,8 @@ void VideoBackendHardware::InitializeShared()
 	memset((void*)&s_beginFieldArgs, 0, sizeof(s_beginFieldArgs));
 	memset(&s_accessEFBArgs, 0, sizeof(s_accessEFBArgs));
 	s_AccessEFBResult = 0;
+	s_efbPokeQueue.clear();
+	s_efbPokesQueued.Clear();
 	m_invalid = false;
 }
 
@@ -290,6 +335,11 @@ void VideoBackendHardware::DoState(PointerWrap& p)
 	p.Do(s_beginFieldArgs);
 	p.Do(s_accessEFBArgs);
 	p.Do(s_AccessEFBResult);
+	{
+		std::lock_guard<std::mutex> lk(s_efbPokeLock);
+		p.Do(s_efbPokeQueue);
+		s_efbPokesQueued.Set(!s_efbPokeQueue.empty());
+	}
 	p.DoMarker("VideoBackendHardware");
 
 	// Refresh state.
@@ -312,6 +362,7 @@ void VideoBackendHardware::CheckInvalidState()
 
 		BPReload();
 		TextureCache::Invalidate();
+		VertexLoaderManager::InvalidateVertexCache();
 	}
 }
 
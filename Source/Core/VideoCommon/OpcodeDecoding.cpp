@@ -20,6 +20,7 @@
 #include "Core/HW/Memmap.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/CommandStream.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/Fifo.h"
@@ -73,6 +74,18 @@ static void InterpretDisplayListPreprocess(u32 address, u32 size)
 	}
 }
 
+static void InterpretDisplayListToCommandStream(u32 address, u32 size)
+{
+	u8* startAddress = Memory::GetPointer(address);
+
+	if (startAddress != nullptr)
+	{
+		CommandStream::RecordDisplayListStart();
+		OpcodeDecoder_RunToCommandStream(DataReader(startAddress, startAddress + size), true);
+		CommandStream::RecordDisplayListEnd();
+	}
+}
+
 static void UnknownOpcode(u8 cmd_byte, void *buffer, bool preprocess)
 {
 	// TODO(Omega): Maybe dump FIFO to file on this error
@@ -131,7 +144,7 @@ void OpcodeDecoder_Shutdown()
 }
 
 template <bool is_preprocess>
-u8* OpcodeDecoder_Run(DataReader src, u32* cycles, bool in_display_list)
+u8* OpcodeDecoder_Run(DataReader src, u32* cycles, bool in_display_list, bool stop_on_interrupt)
 {
 	u32 totalCycles = 0;
 	u8* opcodeStart;
@@ -304,6 +317,12 @@ u8* OpcodeDecoder_Run(DataReader src, u32* cycles, bool in_display_list)
 			src.WritePointer(&opcodeEnd);
 			FifoRecorder::GetInstance().WriteGPCommand(opcodeStart, u32(opcodeEnd - opcodeStart));
 		}
+
+		if (stop_on_interrupt && CommandProcessor::IsInterruptWaiting())
+		{
+			src.WritePointer(&opcodeStart);
+			goto end;
+		}
 	}
 
 end:
@@ -314,5 +333,127 @@ end:
 	return opcodeStart;
 }
 
-template u8* OpcodeDecoder_Run<true>(DataReader src, u32* cycles, bool in_display_list);
-template u8* OpcodeDecoder_Run<false>(DataReader src, u32* cycles, bool in_display_list);
+template u8* OpcodeDecoder_Run<true>(DataReader src, u32* cycles, bool in_display_list, bool stop_on_interrupt);
+template u8* OpcodeDecoder_Run<false>(DataReader src, u32* cycles, bool in_display_list, bool stop_on_interrupt);
+
+u8* OpcodeDecoder_RunToCommandStream(DataReader src, bool in_display_list, bool stop_on_interrupt)
+{
+	u8* opcodeStart;
+	while (true)
+	{
+		src.WritePointer(&opcodeStart);
+
+		if (!src.size())
+			return opcodeStart;
+
+		u8 cmd_byte = src.Read<u8>();
+		int refarray;
+		switch (cmd_byte)
+		{
+		case GX_NOP:
+			break;
+
+		case GX_LOAD_CP_REG: //0x08
+			{
+				if (src.size() < 1 + 4)
+					return opcodeStart;
+				u8 sub_cmd = src.Read<u8>();
+				u32 value = src.Read<u32>();
+				CommandStream::RecordCPWrite(sub_cmd, value);
+			}
+			break;
+
+		case GX_LOAD_XF_REG:
+			{
+				if (src.size() < 4)
+					return opcodeStart;
+				u32 Cmd2 = src.Read<u32>();
+				int transfer_size = ((Cmd2 >> 16) & 15) + 1;
+				if (src.size() < transfer_size * sizeof(u32))
+					return opcodeStart;
+				u8* data;
+				src.WritePointer(&data);
+				CommandStream::RecordXFWrite(transfer_size, Cmd2 & 0xFFFF, data);
+				src.Skip<u32>(transfer_size);
+			}
+			break;
+
+		case GX_LOAD_INDX_A: //used for position matrices
+			refarray = 0xC;
+			goto load_indx;
+		case GX_LOAD_INDX_B: //used for normal matrices
+			refarray = 0xD;
+			goto load_indx;
+		case GX_LOAD_INDX_C: //used for postmatrices
+			refarray = 0xE;
+			goto load_indx;
+		case GX_LOAD_INDX_D: //used for lights
+			refarray = 0xF;
+			goto load_indx;
+		load_indx:
+			if (src.size() < 4)
+				return opcodeStart;
+			CommandStream::RecordIndexedXFLoad(src.Read<u32>(), refarray);
+			break;
+
+		case GX_CMD_CALL_DL:
+			{
+				if (src.size() < 8)
+					return opcodeStart;
+				u32 address = src.Read<u32>();
+				u32 count = src.Read<u32>();
+
+				if (in_display_list)
+					WARN_LOG(VIDEO,"recursive display list detected");
+				else
+					InterpretDisplayListToCommandStream(address, count);
+			}
+			break;
+
+		case GX_CMD_UNKNOWN_METRICS: // zelda 4 swords calls it and checks the metrics registers after that
+			DEBUG_LOG(VIDEO, "GX 0x44: %08x", cmd_byte);
+			break;
+
+		case GX_CMD_INVL_VC: // Invalidate Vertex Cache
+			DEBUG_LOG(VIDEO, "Invalidate (vertex cache?)");
+			break;
+
+		case GX_LOAD_BP_REG: //0x61
+			if (src.size() < 4)
+				return opcodeStart;
+			CommandStream::RecordBPWrite(src.Read<u32>());
+			break;
+
+		// draw primitives
+		default:
+			if ((cmd_byte & 0xC0) == 0x80)
+			{
+				// load vertices
+				if (src.size() < 2)
+					return opcodeStart;
+				u16 num_vertices = src.Read<u16>();
+
+				int bytes = CommandStream::RecordDraw(
+					cmd_byte & GX_VAT_MASK,   // Vertex loader index (0 - 7)
+					(cmd_byte & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT,
+					num_vertices,
+					src);
+
+				if (bytes < 0)
+					return opcodeStart;
+				src.Skip(bytes);
+			}
+			else
+			{
+				UnknownOpcode(cmd_byte, opcodeStart, false);
+			}
+			break;
+		}
+
+		if (stop_on_interrupt && CommandProcessor::IsInterruptWaiting())
+		{
+			src.WritePointer(&opcodeStart);
+			return opcodeStart;
+		}
+	}
+}
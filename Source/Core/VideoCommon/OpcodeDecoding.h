@@ -42,5 +42,11 @@ extern bool g_bRecordFifoData;
 void OpcodeDecoder_Init();
 void OpcodeDecoder_Shutdown();
 
+// With stop_on_interrupt, decoding stops after the first command which raised
+// an interrupt, so nothing after it is processed before the CPU handled it.
 template <bool is_preprocess = false>
-u8* OpcodeDecoder_Run(DataReader src, u32* cycles, bool in_display_list);
+u8* OpcodeDecoder_Run(DataReader src, u32* cycles, bool in_display_list, bool stop_on_interrupt = false);
+
+// The decode thread's version: converts the vertices and records the commands
+// in the CommandStream for the GPU thread instead of executing them.
+u8* OpcodeDecoder_RunToCommandStream(DataReader src, bool in_display_list, bool stop_on_interrupt = false);
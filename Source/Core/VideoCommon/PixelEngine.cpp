@@ -16,6 +16,7 @@
 #include "Core/HW/ProcessorInterface.h"
 #include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/Fifo.h"
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/VideoCommon.h"
@@ -279,6 +280,7 @@ void SetToken_OnMainThread(u64 userdata, int cyclesLate)
 		UpdateInterrupts();
 	}
 	CommandProcessor::interruptTokenWaiting = false;
+	WakeGpuThread();
 }
 
 void SetFinish_OnMainThread(u64 userdata, int cyclesLate)
@@ -287,6 +289,7 @@ void SetFinish_OnMainThread(u64 userdata, int cyclesLate)
 	UpdateInterrupts();
 	CommandProcessor::interruptFinishWaiting = false;
 	CommandProcessor::isPossibleWaitingSetDrawDone = false;
+	WakeGpuThread();
 }
 
 // SetToken
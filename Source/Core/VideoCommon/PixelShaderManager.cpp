@@ -20,6 +20,15 @@ std::array<int4,4> PixelShaderManager::s_tev_konst_color;
 
 PixelShaderConstants PixelShaderManager::constants;
 bool PixelShaderManager::dirty;
+ConstantDirtyRange PixelShaderManager::dirty_range;
+
+template <typename T>
+static void MarkDirty(const T& member)
+{
+	const u8* base = (const u8*)&PixelShaderManager::constants;
+	PixelShaderManager::dirty = true;
+	PixelShaderManager::dirty_range.Add((u32)((const u8*)&member - base), sizeof(T));
+}
 
 void PixelShaderManager::Init()
 {
@@ -32,6 +41,8 @@ void PixelShaderManager::Init()
 
 void PixelShaderManager::Dirty()
 {
+	MarkDirty(constants);
+
 	s_bFogRangeAdjustChanged = true;
 	s_bViewPortChanged = true;
 
@@ -100,7 +111,7 @@ void PixelShaderManager::SetConstants()
 			constants.fogf[0][1] = 1;
 			constants.fogf[0][2] = 1;
 		}
-		dirty = true;
+		MarkDirty(constants.fogf[0]);
 
 		s_bFogRangeAdjustChanged = false;
 	}
@@ -109,7 +120,7 @@ void PixelShaderManager::SetConstants()
 	{
 		constants.zbias[1][0] = static_cast<u32>(xfmem.viewport.farZ);
 		constants.zbias[1][1] = static_cast<u32>(xfmem.viewport.zRange);
-		dirty = true;
+		MarkDirty(constants.zbias[1]);
 		s_bViewPortChanged = false;
 	}
 }
@@ -118,7 +129,7 @@ void PixelShaderManager::SetTevColor(int index, int component, s32 value)
 {
 	auto& c = constants.colors[index];
 	c[component] = s_tev_color[index][component] = value;
-	dirty = true;
+	MarkDirty(c);
 
 	PRIM_LOG("tev color%d: %d %d %d %d\n", index, c[0], c[1], c[2], c[3]);
 }
@@ -127,7 +138,7 @@ void PixelShaderManager::SetTevKonstColor(int index, int component, s32 value)
 {
 	auto& c = constants.kcolors[index];
 	c[component] = s_tev_konst_color[index][component] = value;
-	dirty = true;
+	MarkDirty(c);
 
 	PRIM_LOG("tev konst color%d: %d %d %d %d\n", index, c[0], c[1], c[2], c[3]);
 }
@@ -136,13 +147,13 @@ void PixelShaderManager::SetAlpha()
 {
 	constants.alpha[0] = bpmem.alpha_test.ref0;
 	constants.alpha[1] = bpmem.alpha_test.ref1;
-	dirty = true;
+	MarkDirty(constants.alpha);
 }
 
 void PixelShaderManager::SetDestAlpha()
 {
 	constants.alpha[3] = bpmem.dstalpha.alpha;
-	dirty = true;
+	MarkDirty(constants.alpha);
 }
 
 void PixelShaderManager::SetTexDims(int texmapid, u32 width, u32 height, u32 wraps, u32 wrapt)
@@ -150,7 +161,7 @@ void PixelShaderManager::SetTexDims(int texmapid, u32 width, u32 height, u32 wra
 	// TODO: move this check out to callee. There we could just call this function on texture changes
 	// or better, use textureSize() in glsl
 	if (constants.texdims[texmapid][0] != 1.0f/width || constants.texdims[texmapid][1] != 1.0f/height)
-		dirty = true;
+		MarkDirty(constants.texdims[texmapid]);
 
 	constants.texdims[texmapid][0] = 1.0f/width;
 	constants.texdims[texmapid][1] = 1.0f/height;
@@ -159,7 +170,7 @@ void PixelShaderManager::SetTexDims(int texmapid, u32 width, u32 height, u32 wra
 void PixelShaderManager::SetZTextureBias()
 {
 	constants.zbias[1][3] = bpmem.ztex1.bias;
-	dirty = true;
+	MarkDirty(constants.zbias[1]);
 }
 
 void PixelShaderManager::SetViewportChanged()
@@ -174,7 +185,7 @@ void PixelShaderManager::SetIndTexScaleChanged(bool high)
 	constants.indtexscale[high][1] = bpmem.texscale[high].ts0;
 	constants.indtexscale[high][2] = bpmem.texscale[high].ss1;
 	constants.indtexscale[high][3] = bpmem.texscale[high].ts1;
-	dirty = true;
+	MarkDirty(constants.indtexscale[high]);
 }
 
 void PixelShaderManager::SetIndMatrixChanged(int matrixidx)
@@ -193,7 +204,8 @@ void PixelShaderManager::SetIndMatrixChanged(int matrixidx)
 	constants.indtexmtx[2*matrixidx+1][1] = bpmem.indmtx[matrixidx].col1.md;
 	constants.indtexmtx[2*matrixidx+1][2] = bpmem.indmtx[matrixidx].col2.mf;
 	constants.indtexmtx[2*matrixidx+1][3] = 17 - scale;
-	dirty = true;
+	MarkDirty(constants.indtexmtx[2*matrixidx]);
+	MarkDirty(constants.indtexmtx[2*matrixidx+1]);
 
 	PRIM_LOG("indmtx%d: scale=%d, mat=(%d %d %d; %d %d %d)\n",
 			matrixidx, scale,
@@ -226,8 +238,8 @@ void PixelShaderManager::SetZTextureTypeChanged()
 			break;
 		default:
 			break;
-        }
-        dirty = true;
+	}
+	MarkDirty(constants.zbias[0]);
 }
 
 void PixelShaderManager::SetTexCoordChanged(u8 texmapid)
@@ -235,7 +247,7 @@ void PixelShaderManager::SetTexCoordChanged(u8 texmapid)
 	TCoordInfo& tc = bpmem.texcoords[texmapid];
 	constants.texdims[texmapid][2] = (float)(tc.s.scale_minus_1 + 1);
 	constants.texdims[texmapid][3] = (float)(tc.t.scale_minus_1 + 1);
-	dirty = true;
+	MarkDirty(constants.texdims[texmapid]);
 }
 
 void PixelShaderManager::SetFogColorChanged()
@@ -246,7 +258,7 @@ void PixelShaderManager::SetFogColorChanged()
 	constants.fogcolor[0] = bpmem.fog.color.r;
 	constants.fogcolor[1] = bpmem.fog.color.g;
 	constants.fogcolor[2] = bpmem.fog.color.b;
-	dirty = true;
+	MarkDirty(constants.fogcolor);
 }
 
 void PixelShaderManager::SetFogParamChanged()
@@ -265,7 +277,8 @@ void PixelShaderManager::SetFogParamChanged()
 		constants.fogf[1][2] = 0.f;
 		constants.fogi[3] = 1;
 	}
-	dirty = true;
+	MarkDirty(constants.fogi);
+	MarkDirty(constants.fogf[1]);
 }
 
 void PixelShaderManager::SetFogRangeAdjustChanged()
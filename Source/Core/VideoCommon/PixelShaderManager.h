@@ -47,6 +47,8 @@ public:
 
 	static PixelShaderConstants constants;
 	static bool dirty;
+	// Part of the constants which changed since the backend last uploaded them.
+	static ConstantDirtyRange dirty_range;
 
 	static bool s_bFogRangeAdjustChanged;
 	static bool s_bViewPortChanged;
@@ -32,11 +32,13 @@
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/FPSCounter.h"
 #include "VideoCommon/FramebufferManagerBase.h"
+#include "VideoCommon/FrameDumpThread.h"
 #include "VideoCommon/MainBase.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/TextureCacheBase.h"
+#include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoConfig.h"
 #include "VideoCommon/XFMemory.h"
 
@@ -97,10 +99,13 @@ Renderer::~Renderer()
 
 	efb_scale_numeratorX = efb_scale_numeratorY = efb_scale_denominatorX = efb_scale_denominatorY = 1;
 
+	m_fps_counter.LogFrameTimeSummary();
+
 #if defined _WIN32 || defined HAVE_LIBAV
 	if (SConfig::GetInstance().m_DumpFrames && bLastFrameDumped && bAVIDumping)
 		AVIDump::Stop();
 #else
+	FrameDumpThread::Stop();
 	if (pFrameDump.IsOpen())
 		pFrameDump.Close();
 #endif
@@ -117,6 +122,11 @@ void Renderer::RenderToXFB(u32 xfbAddr, const EFBRectangle& sourceRc, u32 fbWidt
 	VideoFifo_CheckSwapRequestAt(xfbAddr, fbWidth, fbHeight);
 	XFBWrited = true;
 
+	g_renderer->PrefetchEFB();
+
+	// Nothing tells us when the CPU reads the EFB copies, so they don't stay pending for longer than a frame.
+	g_texture_cache->FlushEFBCopies();
+
 	if (g_ActiveConfig.bUseXFB)
 	{
 		FramebufferManagerBase::CopyToXFB(xfbAddr, fbWidth, fbHeight, sourceRc,Gamma);
@@ -128,6 +138,12 @@ void Renderer::RenderToXFB(u32 xfbAddr, const EFBRectangle& sourceRc, u32 fbWidt
 	}
 }
 
+void Renderer::PokeEFB(const EfbPokeData* pokes, size_t num_pokes)
+{
+	for (size_t i = 0; i < num_pokes; i++)
+		AccessEFB(pokes[i].type, pokes[i].x, pokes[i].y, pokes[i].data);
+}
+
 int Renderer::EFBToScaledX(int x)
 {
 	switch (g_ActiveConfig.iEFBScale)
@@ -553,6 +569,8 @@ void Renderer::RecordVideoMemory()
 
 void Renderer::Swap(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const EFBRectangle& rc, float Gamma)
 {
+	const u64 start_time = Common::Timer::GetTimeUs();
+
 	// TODO: merge more generic parts into VideoCommon
 	g_renderer->SwapImpl(xfbAddr, fbWidth, fbStride, fbHeight, rc, Gamma);
 
@@ -562,11 +580,16 @@ void Renderer::Swap(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const
 	frameCount++;
 	GFX_DEBUGGER_PAUSE_AT(NEXT_FRAME, true);
 
+	VertexLoaderManager::CleanupVertexCache();
+
 	// Begin new frame
 	// Set default viewport and scissor, for the clear to work correctly
 	// New frame
 	stats.ResetFrame();
 
+	// Shown with the next frame, the statistics are drawn during SwapImpl.
+	stats.thisFrame.usSwap = (int)(Common::Timer::GetTimeUs() - start_time);
+
 	Core::Callback_VideoCopiedToXFB(XFBWrited || (g_ActiveConfig.bUseXFB && g_ActiveConfig.bUseRealXFB));
 	XFBWrited = false;
 }
@@ -32,6 +32,15 @@ extern int OSDChoice;
 
 extern bool bLastFrameDumped;
 
+// An EFB write of the CPU, queued up until the GPU thread gets to it.
+struct EfbPokeData
+{
+	EFBAccessType type;
+	u32 x;
+	u32 y;
+	u32 data;
+};
+
 // Renderer really isn't a very good name for this class - it's more like "Misc".
 // The long term goal is to get rid of this class and replace it with others that make
 // more sense.
@@ -105,6 +114,11 @@ public:
 	static void RenderToXFB(u32 xfbAddr, const EFBRectangle& sourceRc, u32 fbWidth, u32 fbHeight, float Gamma = 1.0f);
 
 	virtual u32 AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data) = 0;
+	// Backends can override this to set up their state only once for a batch of pokes.
+	virtual void PokeEFB(const EfbPokeData* pokes, size_t num_pokes);
+	// Called when a frame was copied to the XFB, before the EFB is cleared.
+	// Backends which answer peeks from an asynchronous readback start it here.
+	virtual void PrefetchEFB() {}
 
 	virtual u16 BBoxRead(int index) = 0;
 	virtual void BBoxWrite(int index, u16 value) = 0;
@@ -117,6 +131,7 @@ public:
 	static void Swap(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const EFBRectangle& rc,float Gamma = 1.0f);
 	virtual void SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const EFBRectangle& rc, float Gamma = 1.0f) = 0;
 
+	// Returns true once the screenshot is queued, it's written in the background
 	virtual bool SaveScreenshot(const std::string &filename, const TargetRectangle &rc) = 0;
 
 	static PEControl::PixelFormat GetPrevPixelFormat() { return prev_efb_format; }
@@ -13,6 +13,7 @@ Statistics stats;
 
 void Statistics::ResetFrame()
 {
+	numDrawCallsInPastFrames += thisFrame.numDrawCalls;
 	memset(&thisFrame, 0, sizeof(ThisFrame));
 }
 
@@ -34,9 +35,14 @@ std::string Statistics::ToString()
 	str += StringFromFormat("vshaders created: %i\n", stats.numVertexShadersCreated);
 	str += StringFromFormat("vshaders alive: %i\n", stats.numVertexShadersAlive);
 	str += StringFromFormat("shaders changes: %i\n", stats.thisFrame.numShaderChanges);
+	str += StringFromFormat("shaders precompiled: %i\n", stats.numShadersPrecompiled);
+	str += StringFromFormat("shader stalls avoided: %i\n", stats.numShaderStallsAvoided);
+	str += StringFromFormat("shaders compiled async: %i\n", stats.numShadersCompiledAsync);
 	str += StringFromFormat("dlists called: %i\n", stats.thisFrame.numDListsCalled);
 	str += StringFromFormat("Primitive joins: %i\n", stats.thisFrame.numPrimitiveJoins);
 	str += StringFromFormat("Draw calls: %i\n", stats.thisFrame.numDrawCalls);
+	str += StringFromFormat("Draw calls skipped: %i\n", stats.thisFrame.numDrawsSkipped);
+	str += StringFromFormat("Redundant state writes: %i\n", stats.thisFrame.numRedundantStateWrites);
 	str += StringFromFormat("Primitives: %i\n", stats.thisFrame.numPrims);
 	str += StringFromFormat("Primitives (DL): %i\n", stats.thisFrame.numDLPrims);
 	str += StringFromFormat("XF loads: %i\n", stats.thisFrame.numXFLoads);
@@ -48,7 +54,24 @@ std::string Statistics::ToString()
 	str += StringFromFormat("Vertex streamed: %i kB\n", stats.thisFrame.bytesVertexStreamed/1024);
 	str += StringFromFormat("Index streamed: %i kB\n", stats.thisFrame.bytesIndexStreamed/1024);
 	str += StringFromFormat("Uniform streamed: %i kB\n", stats.thisFrame.bytesUniformStreamed/1024);
+	str += StringFromFormat("Uploaded: %i kB\n", stats.thisFrame.bytesUploaded/1024);
+	str += StringFromFormat("Streaming GL calls: %i\n", stats.thisFrame.numStreamingGLCalls);
+	str += StringFromFormat("GL state calls: %i\n", stats.thisFrame.numGLStateCalls);
 	str += StringFromFormat("Vertex Loaders: %i\n", stats.numVertexLoaders);
+	str += StringFromFormat("Vertex cache hits: %i\n", stats.thisFrame.numVertexCacheHits);
+	str += StringFromFormat("Vertex cache misses: %i\n", stats.thisFrame.numVertexCacheMisses);
+	str += StringFromFormat("FIFO decoding: %i us\n", stats.thisFrame.usFifoDecoding);
+	str += StringFromFormat("Vertex loading: %i us\n", stats.thisFrame.usVertexLoading);
+	str += StringFromFormat("Backend draws: %i us\n", stats.thisFrame.usBackendDraws);
+	str += StringFromFormat("Swap (last frame): %i us\n", stats.thisFrame.usSwap);
+	str += StringFromFormat("Command list execution: %i us\n", stats.thisFrame.usCommandExecution);
+	str += StringFromFormat("Decode thread waiting: %i us\n", stats.thisFrame.usDecodeThreadWaiting);
+	str += StringFromFormat("GPU thread sleeping: %i us\n", stats.thisFrame.usGpuThreadSleeping);
+	str += StringFromFormat("GPU thread wakeups: %i\n", stats.thisFrame.numGpuThreadWakeups);
+	str += StringFromFormat("GPU thread max wakeup latency: %i us\n", stats.thisFrame.usGpuWakeupLatencyMax);
+	str += StringFromFormat("EFB peeks: %i\n", stats.thisFrame.numEFBPeeks);
+	str += StringFromFormat("EFB peeks which stalled: %i\n", stats.thisFrame.numEFBPeekStalls);
+	str += StringFromFormat("EFB pokes: %i\n", stats.thisFrame.numEFBPokes);
 
 	std::string vertex_list;
 	VertexLoaderManager::AppendListToString(&vertex_list);
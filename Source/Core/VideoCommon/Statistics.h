@@ -22,6 +22,14 @@ struct Statistics
 
 	int numVertexLoaders;
 
+	int numShadersPrecompiled;
+	int numShaderStallsAvoided;
+	int numShadersCompiledAsync;
+
+	// Draw calls of all frames before thisFrame, so that tools can count
+	// the draws between two points in time even if a swap is in between.
+	int numDrawCallsInPastFrames;
+
 	float proj_0, proj_1, proj_2, proj_3, proj_4, proj_5;
 	float gproj_0, gproj_1, gproj_2, gproj_3, gproj_4, gproj_5;
 	float gproj_6, gproj_7, gproj_8, gproj_9, gproj_10, gproj_11, gproj_12, gproj_13, gproj_14, gproj_15;
@@ -47,12 +55,44 @@ struct Statistics
 
 		int numPrimitiveJoins;
 		int numDrawCalls;
+		int numDrawsSkipped;
+		// Register writes which didn't change any state relevant to
+		// pending draws, so the batch wasn't flushed.
+		int numRedundantStateWrites;
 
 		int numDListsCalled;
 
+		int numVertexCacheHits;
+		int numVertexCacheMisses;
+		// Time spent per stage. Decoding includes vertex loading and the
+		// backend draws, which happen while the FIFO is decoded. With the
+		// decode thread, decoding and vertex loading happen on that thread,
+		// and the backend draws are part of the command list execution.
+		int usFifoDecoding;
+		int usVertexLoading;
+		int usBackendDraws;
+		int usSwap;
+		int usCommandExecution;
+		int usDecodeThreadWaiting;
+
+		int usGpuThreadSleeping;
+		int numGpuThreadWakeups;
+		int usGpuWakeupLatencyMax;
+
+		int numEFBPeeks;
+		int numEFBPeekStalls;
+		int numEFBPokes;
+
 		int bytesVertexStreamed;
 		int bytesIndexStreamed;
 		int bytesUniformStreamed;
+		// Everything written to stream buffers (vertices, indices, uniforms and
+		// texture staging) plus textures which are uploaded directly.
+		int bytesUploaded;
+		// GL calls spent on streaming: mapping, syncing and buffer uploads.
+		int numStreamingGLCalls;
+		// Fixed function state changes, e.g. blending or depth test.
+		int numGLStateCalls;
 	};
 	ThisFrame thisFrame;
 	void ResetFrame();
@@ -50,7 +50,7 @@ TextureCache::TextureCache()
 	TexDecoder_SetTexFmtOverlayOptions(g_ActiveConfig.bTexFmtOverlayEnable, g_ActiveConfig.bTexFmtOverlayCenter);
 
 	if (g_ActiveConfig.bHiresTextures && !g_ActiveConfig.bDumpTextures)
-		HiresTextures::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID);
+		HiresTextures::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID, g_ActiveConfig.bCacheHiresTextures);
 
 	SetHash64Function(g_ActiveConfig.bHiresTextures || g_ActiveConfig.bDumpTextures);
 
@@ -82,6 +82,8 @@ TextureCache::~TextureCache()
 	Invalidate();
 	FreeAlignedMemory(temp);
 	temp = nullptr;
+
+	HiresTextures::Shutdown();
 }
 
 void TextureCache::OnConfigChanged(VideoConfig& config)
@@ -93,12 +95,15 @@ void TextureCache::OnConfigChanged(VideoConfig& config)
 			config.bTexFmtOverlayEnable != backup_config.s_texfmt_overlay ||
 			config.bTexFmtOverlayCenter != backup_config.s_texfmt_overlay_center ||
 			config.bHiresTextures != backup_config.s_hires_textures ||
+			config.bCacheHiresTextures != backup_config.s_cache_hires_textures ||
 			invalidate_texture_cache_requested)
 		{
 			g_texture_cache->Invalidate();
 
 			if (g_ActiveConfig.bHiresTextures)
-				HiresTextures::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID);
+				HiresTextures::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID, g_ActiveConfig.bCacheHiresTextures);
+			else
+				HiresTextures::Shutdown();
 
 			SetHash64Function(g_ActiveConfig.bHiresTextures || g_ActiveConfig.bDumpTextures);
 			TexDecoder_SetTexFmtOverlayOptions(g_ActiveConfig.bTexFmtOverlayEnable, g_ActiveConfig.bTexFmtOverlayCenter);
@@ -132,6 +137,7 @@ void TextureCache::OnConfigChanged(VideoConfig& config)
 	backup_config.s_texfmt_overlay = config.bTexFmtOverlayEnable;
 	backup_config.s_texfmt_overlay_center = config.bTexFmtOverlayCenter;
 	backup_config.s_hires_textures = config.bHiresTextures;
+	backup_config.s_cache_hires_textures = config.bCacheHiresTextures;
 	backup_config.s_copy_cache_enable = config.bEFBCopyCacheEnable;
 	backup_config.s_stereo_3d = config.iStereoMode > 0;
 	backup_config.s_mono_efb_depth = config.bStereoMonoEFBDepth;
@@ -222,6 +228,21 @@ bool TextureCache::Find(u32 start_address, u64 hash)
 	return false;
 }
 
+void TextureCache::FinishEFBCopyToRam(u32 address, u32 size)
+{
+	u64 const new_hash = GetHash64(Memory::GetPointer(address), size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+
+	// Mark texture entries in destination address range dynamic unless caching is enabled and the texture entry is up to date
+	if (!g_ActiveConfig.bEFBCopyCacheEnable)
+		MakeRangeDynamic(address, size);
+	else if (!Find(address, new_hash))
+		MakeRangeDynamic(address, size);
+
+	TexCache::iterator iter = textures.find(address);
+	if (iter != textures.end())
+		iter->second->hash = new_hash;
+}
+
 int TextureCache::TCacheEntryBase::IntersectsMemoryRange(u32 range_address, u32 range_size) const
 {
 	if (addr + size_in_bytes < range_address)
@@ -259,15 +280,15 @@ bool TextureCache::CheckForCustomTextureLODs(u64 tex_hash, int texformat, unsign
 		return false;
 
 	// Just checking if the necessary files exist, if they can't be loaded or have incorrect dimensions LODs will be black
-	std::string texBasePathTemp = StringFromFormat("%s_%08x_%i", SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID.c_str(), (u32) (tex_hash & 0x00000000FFFFFFFFLL), texformat);
+	u32 tex_hash_u32 = tex_hash & 0x00000000FFFFFFFFLL;
 
 	for (unsigned int level = 1; level < levels; ++level)
 	{
-		std::string texPathTemp = StringFromFormat("%s_mip%u", texBasePathTemp.c_str(), level);
-		if (!HiresTextures::HiresTexExists(texPathTemp))
+		if (!HiresTextures::HiresTexExists(tex_hash_u32, texformat, level))
 		{
 			if (level > 1)
-				WARN_LOG(VIDEO, "Couldn't find custom texture LOD with index %u (filename: %s), disabling custom LODs for this texture", level, texPathTemp.c_str());
+				WARN_LOG(VIDEO, "Couldn't find custom texture LOD with index %u (filename: %s_%08x_%i_mip%u), disabling custom LODs for this texture", level,
+				         SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID.c_str(), tex_hash_u32, texformat, level);
 
 			return false;
 		}
@@ -289,7 +310,7 @@ PC_TexFormat TextureCache::LoadCustomTexture(u64 tex_hash, int texformat, unsign
 		texPathTemp = StringFromFormat("%s_%08x_%i_mip%u", SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID.c_str(), tex_hash_u32, texformat, level);
 
 	unsigned int required_size = 0;
-	PC_TexFormat ret = HiresTextures::GetHiresTex(texPathTemp, &newWidth, &newHeight, &required_size, texformat, temp_size, temp);
+	PC_TexFormat ret = HiresTextures::GetHiresTex(tex_hash_u32, texformat, level, &newWidth, &newHeight, &required_size, temp_size, temp);
 	if (ret == PC_TEX_FMT_NONE && temp_size < required_size)
 	{
 		// Allocate more memory and try again
@@ -297,7 +318,7 @@ PC_TexFormat TextureCache::LoadCustomTexture(u64 tex_hash, int texformat, unsign
 		temp_size = required_size;
 		FreeAlignedMemory(temp);
 		temp = (u8*)AllocateAlignedMemory(temp_size, 16);
-		ret = HiresTextures::GetHiresTex(texPathTemp, &newWidth, &newHeight, &required_size, texformat, temp_size, temp);
+		ret = HiresTextures::GetHiresTex(tex_hash_u32, texformat, level, &newWidth, &newHeight, &required_size, temp_size, temp);
 	}
 
 	if (ret != PC_TEX_FMT_NONE)
@@ -393,9 +414,14 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 
 	const u8* src_data;
 	if (from_tmem)
+	{
 		src_data = &texMem[bpmem.tex[stage / 4].texImage1[stage % 4].tmem_even * TMEM_LINE_SIZE];
+	}
 	else
+	{
+		g_texture_cache->FlushEFBCopies(address, texture_size);
 		src_data = Memory::GetPointer(address);
+	}
 
 	// TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data from the low tmem bank than it should)
 	tex_hash = GetHash64(src_data, texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
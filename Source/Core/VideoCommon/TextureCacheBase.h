@@ -113,6 +113,17 @@ public:
 
 	static void RequestInvalidateTextureCache();
 
+	// Backends may write EFB copies to RAM lazily. These write back the copies
+	// which are still pending before anything else reads guest memory.
+	virtual void FlushEFBCopies() {}
+	virtual void FlushEFBCopies(u32 address, u32 size) {}
+	// Drops the pending copies without writing them, as loading a state
+	// replaces guest memory. Called on the CPU thread, so without GL calls.
+	virtual void DiscardEFBCopies() {}
+
+	// Updates the cache once an EFB copy reached RAM.
+	static void FinishEFBCopyToRam(u32 address, u32 size);
+
 protected:
 	TextureCache();
 
@@ -144,6 +155,7 @@ private:
 		bool s_texfmt_overlay;
 		bool s_texfmt_overlay_center;
 		bool s_hires_textures;
+		bool s_cache_hires_textures;
 		bool s_copy_cache_enable;
 		bool s_stereo_3d;
 		bool s_mono_efb_depth;
@@ -15,6 +15,7 @@
 #include "VideoCommon/LookUpTables.h"
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/VertexLoader.h"
+#include "VideoCommon/VertexLoaderWorkers.h"
 #include "VideoCommon/VertexLoader_Color.h"
 #include "VideoCommon/VertexLoader_Normal.h"
 #include "VideoCommon/VertexLoader_Position.h"
@@ -60,7 +61,9 @@ static const float fractionTable[32] = {
 	1.0f / (1U << 28), 1.0f / (1U << 29), 1.0f / (1U << 30), 1.0f / (1U << 31),
 };
 
+#ifdef _M_X86
 using namespace Gen;
+#endif
 
 static void LOADERDECL PosMtx_ReadDirect_UByte()
 {
@@ -108,9 +111,10 @@ static void LOADERDECL TexMtx_Write_Float4()
 #endif
 }
 
-VertexLoader::VertexLoader(const TVtxDesc &vtx_desc, const VAT &vtx_attr)
+VertexLoader::VertexLoader(const TVtxDesc &vtx_desc, const VAT &vtx_attr, VertexLoaderType type)
 {
 	m_compiledCode = nullptr;
+	m_templateLoader = nullptr;
 	m_numLoadedVertices = 0;
 	m_VertexSize = 0;
 	m_native_vertex_format = nullptr;
@@ -121,63 +125,49 @@ VertexLoader::VertexLoader(const TVtxDesc &vtx_desc, const VAT &vtx_attr)
 	m_VtxDesc = vtx_desc;
 	SetVAT(vtx_attr);
 
-	#ifdef USE_VERTEX_LOADER_JIT
-	AllocCodeSpace(COMPILED_CODE_SIZE);
-	CompileVertexTranslator();
-	WriteProtect();
-	#else
 	m_numPipelineStages = 0;
 	CompileVertexTranslator();
-	#endif
 
+	m_type = VERTEX_LOADER_PIPELINE;
+
+	if (type == VERTEX_LOADER_TEMPLATE || type == VERTEX_LOADER_DEFAULT)
+	{
+		m_templateLoader = VertexLoaderTemplate::GetFunction(m_VtxDesc, m_VtxAttr);
+		if (m_templateLoader)
+			m_type = VERTEX_LOADER_TEMPLATE;
+	}
+
+	// The template loaders don't update the bounding box, so the JIT is still
+	// needed as a fallback for them if it has to be emulated.
+	#ifdef USE_VERTEX_LOADER_JIT
+	bool needs_jit = type == VERTEX_LOADER_JIT || type == VERTEX_LOADER_DEFAULT;
+	if (needs_jit)
+	{
+		AllocCodeSpace(COMPILED_CODE_SIZE);
+		GenerateVertexLoader();
+		WriteProtect();
+		if (m_type != VERTEX_LOADER_TEMPLATE)
+			m_type = VERTEX_LOADER_JIT;
+	}
+	#endif
 }
 
 VertexLoader::~VertexLoader()
 {
 	#ifdef USE_VERTEX_LOADER_JIT
-	FreeCodeSpace();
+	if (m_compiledCode)
+		FreeCodeSpace();
 	#endif
 }
 
 void VertexLoader::CompileVertexTranslator()
 {
 	m_VertexSize = 0;
+	m_numIndexedAttributes = 0;
 	const TVtxAttr &vtx_attr = m_VtxAttr;
 
-#ifdef USE_VERTEX_LOADER_JIT
-	if (m_compiledCode)
-		PanicAlert("Trying to recompile a vertex translator");
-
-	m_compiledCode = GetCodePtr();
-	// We only use RAX (caller saved) and RBX (callee saved).
-	ABI_PushRegistersAndAdjustStack({RBX}, 8);
-
-	// save count
-	MOV(64, R(RBX), R(ABI_PARAM1));
-
-	// Start loop here
-	const u8 *loop_start = GetCodePtr();
-
-	// Reset component counters if present in vertex format only.
-	if (m_VtxDesc.Tex0Coord || m_VtxDesc.Tex1Coord || m_VtxDesc.Tex2Coord || m_VtxDesc.Tex3Coord ||
-		m_VtxDesc.Tex4Coord || m_VtxDesc.Tex5Coord || m_VtxDesc.Tex6Coord || m_VtxDesc.Tex7Coord)
-	{
-		WriteSetVariable(32, &tcIndex, Imm32(0));
-	}
-	if (m_VtxDesc.Color0 || m_VtxDesc.Color1)
-	{
-		WriteSetVariable(32, &colIndex, Imm32(0));
-	}
-	if (m_VtxDesc.Tex0MatIdx || m_VtxDesc.Tex1MatIdx || m_VtxDesc.Tex2MatIdx || m_VtxDesc.Tex3MatIdx ||
-		m_VtxDesc.Tex4MatIdx || m_VtxDesc.Tex5MatIdx || m_VtxDesc.Tex6MatIdx || m_VtxDesc.Tex7MatIdx)
-	{
-		WriteSetVariable(32, &s_texmtxwrite, Imm32(0));
-		WriteSetVariable(32, &s_texmtxread, Imm32(0));
-	}
-#else
 	// Reset pipeline
 	m_numPipelineStages = 0;
-#endif
 
 	// Get the pointer to this vertex's buffer data for the bounding box
 	if (!g_ActiveConfig.backend_info.bSupportsBBox)
@@ -217,6 +207,8 @@ void VertexLoader::CompileVertexTranslator()
 	// Write vertex position loader
 	WriteCall(VertexLoader_Position::GetFunction(m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements));
 
+	AddIndexedAttribute(m_VtxDesc.Position, ARRAY_POSITION,
+		VertexLoader_Position::GetSize(DIRECT, m_VtxAttr.PosFormat, m_VtxAttr.PosElements));
 	m_VertexSize += VertexLoader_Position::GetSize(m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements);
 	nat_offset += 12;
 	m_native_vtx_decl.position.components = 3;
@@ -228,6 +220,14 @@ void VertexLoader::CompileVertexTranslator()
 	// Normals
 	if (m_VtxDesc.Normal != NOT_PRESENT)
 	{
+		// With three indices each one selects a single vector of the NBT
+		// triple, but listing the whole triple keeps the range conservative.
+		const int nbt_size = VertexLoader_Normal::GetSize(DIRECT,
+			m_VtxAttr.NormalFormat, m_VtxAttr.NormalElements, false);
+		const int num_indices = (m_VtxAttr.NormalElements && m_VtxAttr.NormalIndex3) ? 3 : 1;
+		for (int i = 0; i < num_indices; i++)
+			AddIndexedAttribute(m_VtxDesc.Normal, ARRAY_NORMAL, nbt_size, i);
+
 		m_VertexSize += VertexLoader_Normal::GetSize(m_VtxDesc.Normal,
 			m_VtxAttr.NormalFormat, m_VtxAttr.NormalElements, m_VtxAttr.NormalIndex3);
 
@@ -262,6 +262,8 @@ void VertexLoader::CompileVertexTranslator()
 		m_native_vtx_decl.colors[i].components = 4;
 		m_native_vtx_decl.colors[i].type = VAR_UNSIGNED_BYTE;
 		m_native_vtx_decl.colors[i].integer = false;
+		static const int color_sizes[8] = {2, 3, 4, 2, 3, 4, 4, 4};
+		AddIndexedAttribute(col[i], ARRAY_COLOR + i, color_sizes[m_VtxAttr.color[i].Comp]);
 		switch (col[i])
 		{
 		case NOT_PRESENT:
@@ -337,6 +339,7 @@ void VertexLoader::CompileVertexTranslator()
 
 			components |= VB_HAS_UV0 << i;
 			WriteCall(VertexLoader_TextCoord::GetFunction(tc[i], format, elements));
+			AddIndexedAttribute(tc[i], ARRAY_TEXCOORD0 + i, VertexLoader_TextCoord::GetSize(DIRECT, format, elements));
 			m_VertexSize += VertexLoader_TextCoord::GetSize(tc[i], format, elements);
 		}
 
@@ -406,44 +409,135 @@ void VertexLoader::CompileVertexTranslator()
 
 	m_native_components = components;
 	m_native_vtx_decl.stride = nat_offset;
+}
+
+void VertexLoader::WriteCall(TPipelineFunction func)
+{
+	m_PipelineStages[m_numPipelineStages++] = func;
+}
 
 #ifdef USE_VERTEX_LOADER_JIT
+// Emits a loop calling all the pipeline stages, which saves the indirect calls
+// and the counter resets of the loop in ConvertVertices.
+void VertexLoader::GenerateVertexLoader()
+{
+	if (m_compiledCode)
+		PanicAlert("Trying to recompile a vertex translator");
+
+	bool reset_tc = m_VtxDesc.Tex0Coord || m_VtxDesc.Tex1Coord || m_VtxDesc.Tex2Coord || m_VtxDesc.Tex3Coord ||
+		m_VtxDesc.Tex4Coord || m_VtxDesc.Tex5Coord || m_VtxDesc.Tex6Coord || m_VtxDesc.Tex7Coord;
+	bool reset_col = m_VtxDesc.Color0 || m_VtxDesc.Color1;
+	bool reset_texmtx = m_VtxDesc.Tex0MatIdx || m_VtxDesc.Tex1MatIdx || m_VtxDesc.Tex2MatIdx || m_VtxDesc.Tex3MatIdx ||
+		m_VtxDesc.Tex4MatIdx || m_VtxDesc.Tex5MatIdx || m_VtxDesc.Tex6MatIdx || m_VtxDesc.Tex7MatIdx;
+
+	m_compiledCode = GetCodePtr();
+
+#if defined(_M_X86)
+	// We only use RAX (caller saved) and RBX (callee saved).
+	ABI_PushRegistersAndAdjustStack({RBX}, 8);
+
+	// save count
+	MOV(64, R(RBX), R(ABI_PARAM1));
+
+	// Start loop here
+	const u8 *loop_start = GetCodePtr();
+
+	// Reset component counters if present in vertex format only.
+	if (reset_tc)
+		WriteSetVariable(32, &tcIndex, Imm32(0));
+	if (reset_col)
+		WriteSetVariable(32, &colIndex, Imm32(0));
+	if (reset_texmtx)
+	{
+		WriteSetVariable(32, &s_texmtxwrite, Imm32(0));
+		WriteSetVariable(32, &s_texmtxread, Imm32(0));
+	}
+
+	for (int i = 0; i < m_numPipelineStages; i++)
+		ABI_CallFunction((const void*)m_PipelineStages[i]);
+
 	// End loop here
 	SUB(64, R(RBX), Imm8(1));
 
 	J_CC(CC_NZ, loop_start);
 	ABI_PopRegistersAndAdjustStack({RBX}, 8);
 	RET();
-#endif
-}
+#elif defined(_M_ARM_64)
+	using namespace Arm64Gen;
 
-void VertexLoader::WriteCall(TPipelineFunction func)
-{
-#ifdef USE_VERTEX_LOADER_JIT
-	ABI_CallFunction((const void*)func);
-#else
-	m_PipelineStages[m_numPipelineStages++] = func;
+	// We only use X0 (caller saved) and X19 (callee saved) besides the link register.
+	SUB(SP, SP, 16);
+	STR(INDEX_UNSIGNED, X30, SP, 0);
+	STR(INDEX_UNSIGNED, X19, SP, 8);
+
+	// save count
+	MOV(W19, W0);
+
+	// Start loop here
+	const u8 *loop_start = GetCodePtr();
+
+	// Reset component counters if present in vertex format only.
+	// WSP encodes the zero register when used as the source of a store.
+	auto reset_variable = [&](int* address) {
+		MOVI2R(X0, (u64)address);
+		STR(INDEX_UNSIGNED, WSP, X0, 0);
+	};
+	if (reset_tc)
+		reset_variable(&tcIndex);
+	if (reset_col)
+		reset_variable(&colIndex);
+	if (reset_texmtx)
+	{
+		reset_variable(&s_texmtxwrite);
+		reset_variable(&s_texmtxread);
+	}
+
+	for (int i = 0; i < m_numPipelineStages; i++)
+	{
+		MOVI2R(X30, (u64)m_PipelineStages[i]);
+		BLR(X30);
+	}
+
+	// End loop here
+	SUBS(W19, W19, 1);
+	B(CC_NEQ, loop_start);
+
+	LDR(INDEX_UNSIGNED, X19, SP, 8);
+	LDR(INDEX_UNSIGNED, X30, SP, 0);
+	ADD(SP, SP, 16);
+	RET(X30);
+
+	FlushIcache();
 #endif
 }
-// ARMTODO: This should be done in a better way
-#ifndef _M_GENERIC
+#endif
+
+#ifdef _M_X86
 void VertexLoader::WriteGetVariable(int bits, OpArg dest, void *address)
 {
-#ifdef USE_VERTEX_LOADER_JIT
 	MOV(64, R(RAX), Imm64((u64)address));
 	MOV(bits, dest, MatR(RAX));
-#endif
 }
 
 void VertexLoader::WriteSetVariable(int bits, void *address, OpArg value)
 {
-#ifdef USE_VERTEX_LOADER_JIT
 	MOV(64, R(RAX), Imm64((u64)address));
 	MOV(bits, MatR(RAX), value);
-#endif
 }
 #endif
 
+void VertexLoader::AddIndexedAttribute(u64 type, int array, int element_size, int index_number)
+{
+	if (type != INDEX8 && type != INDEX16)
+		return;
+
+	IndexedAttribute& attr = m_indexedAttributes[m_numIndexedAttributes++];
+	attr.array = array;
+	attr.index_size = type == INDEX16 ? 2 : 1;
+	attr.offset = m_VertexSize + index_number * attr.index_size;
+	attr.element_size = element_size;
+}
+
 void VertexLoader::SetupRunVertices(const VAT& vat, int primitive, int const count)
 {
 	m_numLoadedVertices += count;
@@ -473,12 +567,30 @@ void VertexLoader::SetupRunVertices(const VAT& vat, int primitive, int const cou
 
 void VertexLoader::ConvertVertices ( int count )
 {
+	if (count <= 0)
+		return;
+
+	// The template loaders skip the bounding box stages.
+	if (m_templateLoader && (g_ActiveConfig.backend_info.bSupportsBBox || !BoundingBox::active))
+	{
+		if (!VertexLoaderWorkers::Convert(m_templateLoader, g_video_buffer_read_ptr, g_vertex_manager_write_ptr,
+		                                  count, m_VertexSize, m_native_vtx_decl.stride))
+		{
+			m_templateLoader(g_video_buffer_read_ptr, g_vertex_manager_write_ptr, count);
+		}
+		g_video_buffer_read_ptr += count * m_VertexSize;
+		g_vertex_manager_write_ptr += count * m_native_vtx_decl.stride;
+		return;
+	}
+
 #ifdef USE_VERTEX_LOADER_JIT
-	if (count > 0)
+	if (m_compiledCode)
 	{
 		((void (*)(int))(void*)m_compiledCode)(count);
+		return;
 	}
-#else
+#endif
+
 	for (int s = 0; s < count; s++)
 	{
 		tcIndex = 0;
@@ -488,7 +600,6 @@ void VertexLoader::ConvertVertices ( int count )
 			m_PipelineStages[i]();
 		PRIM_LOG("\n");
 	}
-#endif
 }
 
 int VertexLoader::RunVertices(const VAT& vat, int primitive, int count, DataReader src, DataReader dst)
@@ -599,7 +710,12 @@ void VertexLoader::AppendToString(std::string *dest) const
 				i, m_VtxAttr.texCoord[i].Elements, posMode[tex_mode[i]], posFormats[m_VtxAttr.texCoord[i].Format]));
 		}
 	}
-	dest->append(StringFromFormat(" - %i v\n", m_numLoadedVertices));
+	static const char *loaderTypes[3] = {
+		"Pipeline",
+		"JIT",
+		"Template",
+	};
+	dest->append(StringFromFormat(" - %i v (%s)\n", m_numLoadedVertices, loaderTypes[m_type]));
 }
 
 NativeVertexFormat* VertexLoader::GetNativeVertexFormat()
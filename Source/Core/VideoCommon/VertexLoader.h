@@ -14,10 +14,14 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/x64Emitter.h"
+#ifdef _M_ARM_64
+#include "Common/Arm64Emitter.h"
+#endif
 
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/VertexLoaderTemplate.h"
 #include "VideoCommon/VertexLoaderUtils.h"
 
 #if _M_SSE >= 0x401
@@ -27,7 +31,7 @@
 #include <tmmintrin.h>
 #endif
 
-#ifdef _M_X86
+#if defined(_M_X86) || defined(_M_ARM_64)
 #define USE_VERTEX_LOADER_JIT
 #endif
 
@@ -101,15 +105,30 @@ private:
 	}
 };
 
-// ARMTODO: This should be done in a better way
-#ifndef _M_GENERIC
+// The ways a vertex loader can run its translator, from slowest to fastest.
+enum VertexLoaderType
+{
+	// Calls every pipeline stage through the function pointer table.
+	VERTEX_LOADER_PIPELINE,
+	// Calls every pipeline stage from generated code (x86-64 and AArch64 only).
+	VERTEX_LOADER_JIT,
+	// Runs a loader specialized at compile time, see VertexLoaderTemplate.h.
+	// Only exists for some common formats.
+	VERTEX_LOADER_TEMPLATE,
+	// Picks the fastest of the above that is available for the format.
+	VERTEX_LOADER_DEFAULT,
+};
+
+#if defined(_M_X86)
 class VertexLoader : public Gen::X64CodeBlock
+#elif defined(_M_ARM_64)
+class VertexLoader : public Arm64Gen::ARM64CodeBlock
 #else
 class VertexLoader
 #endif
 {
 public:
-	VertexLoader(const TVtxDesc &vtx_desc, const VAT &vtx_attr);
+	VertexLoader(const TVtxDesc &vtx_desc, const VAT &vtx_attr, VertexLoaderType type = VERTEX_LOADER_DEFAULT);
 	~VertexLoader();
 
 	int GetVertexSize() const {return m_VertexSize;}
@@ -120,6 +139,21 @@ public:
 	void SetupRunVertices(const VAT& vat, int primitive, int const count);
 	int RunVertices(const VAT& vat, int primitive, int count, DataReader src, DataReader dst);
 
+	// The translator that is actually used, which may be slower than the
+	// requested one if that isn't available for this format or host.
+	VertexLoaderType GetType() const { return m_type; }
+
+	// An attribute which is stored as an index into one of the CP arrays.
+	struct IndexedAttribute
+	{
+		u8 array;        // ARRAY_POSITION, ARRAY_NORMAL, ...
+		u8 offset;       // offset of the index in the raw GC vertex
+		u8 index_size;   // 1 or 2 bytes, 16 bit indices are big endian
+		u8 element_size; // bytes read from the array for each index
+	};
+	int GetNumIndexedAttributes() const { return m_numIndexedAttributes; }
+	const IndexedAttribute* GetIndexedAttributes() const { return m_indexedAttributes; }
+
 	// For debugging / profiling
 	void AppendToString(std::string *dest) const;
 	int GetNumLoadedVerts() const { return m_numLoadedVertices; }
@@ -138,13 +172,17 @@ private:
 	u32 m_native_components;
 	PortableVertexDeclaration m_native_vtx_decl;
 
-#ifndef USE_VERTEX_LOADER_JIT
-	// Pipeline.
+	// Pipeline. Always built, the JIT just calls the same stages.
 	TPipelineFunction m_PipelineStages[64];  // TODO - figure out real max. it's lower.
 	int m_numPipelineStages;
-#endif
 
+	// Position, three normal indices, two colors and eight texture coordinates
+	IndexedAttribute m_indexedAttributes[14];
+	int m_numIndexedAttributes;
+
+	VertexLoaderType m_type;
 	const u8 *m_compiledCode;
+	TTemplateLoaderFunction m_templateLoader;
 
 	int m_numLoadedVertices;
 
@@ -154,11 +192,13 @@ private:
 	void SetVAT(const VAT& vat);
 
 	void CompileVertexTranslator();
+	void AddIndexedAttribute(u64 type, int array, int element_size, int index_number = 0);
+	void GenerateVertexLoader();
 	void ConvertVertices(int count);
 
 	void WriteCall(TPipelineFunction);
 
-#ifndef _M_GENERIC
+#ifdef _M_X86
 	void WriteGetVariable(int bits, Gen::OpArg dest, void *address);
 	void WriteSetVariable(int bits, void *address, Gen::OpArg dest);
 #endif
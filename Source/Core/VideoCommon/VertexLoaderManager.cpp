@@ -10,16 +10,22 @@
 #include <vector>
 
 #include "Common/CommonFuncs.h"
+#include "Common/Hash.h"
+#include "Common/Timer.h"
 #include "Core/HW/Memmap.h"
 
+#include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoader.h"
 #include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VertexLoaderWorkers.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
 
 static NativeVertexFormat* s_current_vtx_fmt;
 
@@ -46,6 +52,27 @@ static std::mutex s_vertex_loader_map_lock;
 static VertexLoaderMap s_vertex_loader_map;
 // TODO - change into array of pointers. Keep a map of all seen so far.
 
+// Cache of converted vertices for draws which are submitted again unchanged,
+// which is the common case for static level geometry in display lists.
+// Entries are keyed by a hash of everything the conversion reads, so like the
+// safe texture cache it doesn't need to be told when game memory changes.
+// Only accessed from the GPU thread.
+enum
+{
+	VERTEX_CACHE_MIN_VERTICES = 64,         // smaller draws are cheaper to convert than to hash
+	VERTEX_CACHE_KILL_THRESHOLD = 60,       // frames an unused entry is kept
+	VERTEX_CACHE_MAX_SIZE = 32 * 1024 * 1024,
+};
+
+struct CachedVertices
+{
+	std::vector<u8> data;
+	int frameCount;
+};
+
+static std::unordered_map<u64, CachedVertices> s_vertex_cache;
+static size_t s_vertex_cache_size;
+
 void Init()
 {
 	MarkAllDirty();
@@ -58,11 +85,158 @@ void Init()
 
 void Shutdown()
 {
+	InvalidateVertexCache();
+	VertexLoaderWorkers::Shutdown();
+
 	std::lock_guard<std::mutex> lk(s_vertex_loader_map_lock);
 	s_vertex_loader_map.clear();
 	VertexLoader::ClearNativeVertexFormatCache();
 }
 
+void InvalidateVertexCache()
+{
+	s_vertex_cache.clear();
+	s_vertex_cache_size = 0;
+}
+
+void CleanupVertexCache()
+{
+	if (!g_ActiveConfig.bVertexCacheEnable)
+	{
+		if (!s_vertex_cache.empty())
+			InvalidateVertexCache();
+		return;
+	}
+
+	auto iter = s_vertex_cache.begin();
+	while (iter != s_vertex_cache.end())
+	{
+		if (frameCount > VERTEX_CACHE_KILL_THRESHOLD + iter->second.frameCount)
+		{
+			s_vertex_cache_size -= iter->second.data.size();
+			s_vertex_cache.erase(iter++);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+}
+
+static inline u64 HashCombine(u64 seed, u64 value)
+{
+	return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+// Hashes the vertex stream together with the parts of the CP arrays it
+// indexes. Returns false if the draw references memory we can't hash.
+static bool ComputeVertexCacheKey(const VertexLoader* loader, const VAT& vat, const u8* src, int count, u64* key)
+{
+	const int vertex_size = loader->GetVertexSize();
+
+	u64 hash = GetMurmurHash3(src, count * vertex_size, 0);
+	hash = HashCombine(hash, g_main_cp_state.vtx_desc.Hex);
+	hash = HashCombine(hash, vat.g0.Hex | ((u64)vat.g1.Hex << 32));
+	hash = HashCombine(hash, vat.g2.Hex);
+
+	const int num_attributes = loader->GetNumIndexedAttributes();
+	const VertexLoader::IndexedAttribute* attributes = loader->GetIndexedAttributes();
+	if (num_attributes == 0)
+	{
+		*key = hash;
+		return true;
+	}
+
+	u32 min_index[16];
+	u32 max_index[16];
+	int element_size[16];
+	BitSet32 used_arrays;
+	for (int i = 0; i < num_attributes; i++)
+	{
+		const int array = attributes[i].array;
+		min_index[array] = UINT_MAX;
+		max_index[array] = 0;
+		element_size[array] = attributes[i].element_size;
+		used_arrays[array] = true;
+	}
+
+	for (int v = 0; v < count; v++)
+	{
+		const u8* vertex = src + v * vertex_size;
+		for (int i = 0; i < num_attributes; i++)
+		{
+			const VertexLoader::IndexedAttribute& attr = attributes[i];
+			const u32 index = attr.index_size == 1 ? vertex[attr.offset] :
+				Common::swap16(vertex + attr.offset);
+			min_index[attr.array] = std::min(min_index[attr.array], index);
+			max_index[attr.array] = std::max(max_index[attr.array], index);
+		}
+	}
+
+	for (int array : used_arrays)
+	{
+		const u8* base = cached_arraybases[array];
+		if (!base)
+			return false;
+
+		const u32 stride = g_main_cp_state.array_strides[array];
+		const int size = (max_index[array] - min_index[array]) * stride + element_size[array];
+		hash = HashCombine(hash, stride);
+		hash = HashCombine(hash, GetMurmurHash3(base + min_index[array] * stride, size, 0));
+	}
+
+	*key = hash;
+	return true;
+}
+
+// Converts the vertices, or copies them from the cache if this exact draw has
+// been converted before.
+static int ConvertVertices(VertexLoader* loader, const VAT& vat, int primitive, int count, DataReader src, DataReader dst)
+{
+	// The software bounding box runs as part of the vertex loader.
+	if (!g_ActiveConfig.bVertexCacheEnable || count < VERTEX_CACHE_MIN_VERTICES ||
+	    (BoundingBox::active && !g_ActiveConfig.backend_info.bSupportsBBox))
+	{
+		return loader->RunVertices(vat, primitive, count, src, dst);
+	}
+
+	u8* src_ptr;
+	u8* dst_ptr;
+	src.WritePointer(&src_ptr);
+	dst.WritePointer(&dst_ptr);
+
+	u64 key;
+	if (!ComputeVertexCacheKey(loader, vat, src_ptr, count, &key))
+		return loader->RunVertices(vat, primitive, count, src, dst);
+
+	const size_t size = count * loader->GetNativeVertexDeclaration().stride;
+	auto iter = s_vertex_cache.find(key);
+	if (iter != s_vertex_cache.end() && iter->second.data.size() == size)
+	{
+		memcpy(dst_ptr, iter->second.data.data(), size);
+		iter->second.frameCount = frameCount;
+		INCSTAT(stats.thisFrame.numVertexCacheHits);
+		return count;
+	}
+
+	INCSTAT(stats.thisFrame.numVertexCacheMisses);
+
+	if (s_vertex_cache_size + size > VERTEX_CACHE_MAX_SIZE)
+		return loader->RunVertices(vat, primitive, count, src, dst);
+
+	// dst may be a write-only mapping of a GPU buffer, so the vertices are
+	// converted into the cache and copied from there, like on a hit.
+	CachedVertices& entry = s_vertex_cache[key];
+	s_vertex_cache_size -= entry.data.size();
+	entry.data.resize(size);
+	count = loader->RunVertices(vat, primitive, count, src, DataReader(entry.data.data(), entry.data.data() + size));
+	memcpy(dst_ptr, entry.data.data(), size);
+	entry.frameCount = frameCount;
+	s_vertex_cache_size += size;
+
+	return count;
+}
+
 namespace
 {
 struct entry
@@ -130,6 +304,30 @@ static VertexLoader* RefreshLoader(int vtx_attr_group, CPState* state)
 	return loader;
 }
 
+// Flushes if the native vertex format changes and returns where the vertices go.
+static DataReader BeginDraw(VertexLoader* loader, int primitive, int count)
+{
+	NativeVertexFormat* native = loader->GetNativeVertexFormat();
+
+	// If the native vertex format changed, force a flush.
+	if (native != s_current_vtx_fmt)
+		VertexManager::Flush();
+	s_current_vtx_fmt = native;
+
+	return VertexManager::PrepareForAdditionalData(primitive, count,
+			loader->GetNativeVertexDeclaration().stride);
+}
+
+static void EndDraw(VertexLoader* loader, int primitive, int count)
+{
+	IndexGenerator::AddIndices(primitive, count);
+
+	VertexManager::FlushData(count, loader->GetNativeVertexDeclaration().stride);
+
+	ADDSTAT(stats.thisFrame.numPrims, count);
+	INCSTAT(stats.thisFrame.numPrimitiveJoins);
+}
+
 int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bool skip_drawing)
 {
 	if (!count)
@@ -143,36 +341,47 @@ int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bo
 	if ((int)src.size() < size)
 		return -1;
 
-	if (skip_drawing || (bpmem.genMode.cullmode == GenMode::CULL_ALL && primitive < 5))
+	if (skip_drawing || g_ActiveConfig.bSkipVertexLoading ||
+	    (bpmem.genMode.cullmode == GenMode::CULL_ALL && primitive < 5))
 	{
 		// if cull mode is CULL_ALL, ignore triangles and quads
 		return size;
 	}
 
-	NativeVertexFormat* native = loader->GetNativeVertexFormat();
-
-	// If the native vertex format changed, force a flush.
-	if (native != s_current_vtx_fmt)
-		VertexManager::Flush();
-	s_current_vtx_fmt = native;
-
-	DataReader dst = VertexManager::PrepareForAdditionalData(primitive, count,
-			loader->GetNativeVertexDeclaration().stride);
+	DataReader dst = BeginDraw(loader, primitive, count);
 
-	count = loader->RunVertices(state->vtx_attr[vtx_attr_group], primitive, count, src, dst);
+	// Only timed while the statistics are shown, the timer isn't free.
+	const u64 start_time = g_ActiveConfig.bOverlayStats ? Common::Timer::GetTimeUs() : 0;
 
-	IndexGenerator::AddIndices(primitive, count);
+	count = ConvertVertices(loader, state->vtx_attr[vtx_attr_group], primitive, count, src, dst);
 
-	VertexManager::FlushData(count, loader->GetNativeVertexDeclaration().stride);
+	if (g_ActiveConfig.bOverlayStats)
+		ADDSTAT(stats.thisFrame.usVertexLoading, Common::Timer::GetTimeUs() - start_time);
 
-	ADDSTAT(stats.thisFrame.numPrims, count);
-	INCSTAT(stats.thisFrame.numPrimitiveJoins);
+	EndDraw(loader, primitive, count);
 	return size;
 }
 
+void DrawConvertedVertices(VertexLoader* loader, int primitive, int count, const u8* vertices)
+{
+	if (bpmem.genMode.cullmode == GenMode::CULL_ALL && primitive < 5)
+		return;
+
+	DataReader dst = BeginDraw(loader, primitive, count);
+	u8* dst_ptr;
+	dst.WritePointer(&dst_ptr);
+	memcpy(dst_ptr, vertices, count * loader->GetNativeVertexDeclaration().stride);
+	EndDraw(loader, primitive, count);
+}
+
 int GetVertexSize(int vtx_attr_group, bool preprocess)
 {
-	return RefreshLoader(vtx_attr_group, preprocess ? &g_preprocess_cp_state : &g_main_cp_state)->GetVertexSize();
+	return GetVertexLoader(vtx_attr_group, preprocess)->GetVertexSize();
+}
+
+VertexLoader* GetVertexLoader(int vtx_attr_group, bool preprocess)
+{
+	return RefreshLoader(vtx_attr_group, preprocess ? &g_preprocess_cp_state : &g_main_cp_state);
 }
 
 NativeVertexFormat* GetCurrentVertexFormat()
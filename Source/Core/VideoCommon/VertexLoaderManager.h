@@ -10,6 +10,8 @@
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/NativeVertexFormat.h"
 
+class VertexLoader;
+
 namespace VertexLoaderManager
 {
 	void Init();
@@ -17,11 +19,20 @@ namespace VertexLoaderManager
 
 	void MarkAllDirty();
 
+	// Drops all cached converted vertices
+	void InvalidateVertexCache();
+	// Frees cached vertices which haven't been used for a while, call once per frame
+	void CleanupVertexCache();
+
 	int GetVertexSize(int vtx_attr_group, bool preprocess);
+	VertexLoader* GetVertexLoader(int vtx_attr_group, bool preprocess);
 
 	// Returns -1 if buf_size is insufficient, else the amount of bytes consumed
 	int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bool skip_drawing = false);
 
+	// Draws vertices the decode thread already converted with the loader
+	void DrawConvertedVertices(VertexLoader* loader, int primitive, int count, const u8* vertices);
+
 	// For debugging
 	void AppendListToString(std::string *dest);
 
@@ -0,0 +1,353 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <type_traits>
+
+#include "Common/CommonFuncs.h"
+#include "Common/CommonTypes.h"
+
+#include "VideoCommon/VertexLoader.h"
+#include "VideoCommon/VertexLoader_Color.h"
+#include "VideoCommon/VertexLoaderTemplate.h"
+
+namespace VertexLoaderTemplate
+{
+
+namespace
+{
+
+template <typename T> struct FormatOf;
+template <> struct FormatOf<u8>    { static const int value = FORMAT_UBYTE; };
+template <> struct FormatOf<s8>    { static const int value = FORMAT_BYTE; };
+template <> struct FormatOf<u16>   { static const int value = FORMAT_USHORT; };
+template <> struct FormatOf<s16>   { static const int value = FORMAT_SHORT; };
+template <> struct FormatOf<float> { static const int value = FORMAT_FLOAT; };
+
+// Scale factors which the pipeline stages read from globals. They are loaded
+// once per batch here instead of once per attribute.
+struct Scales
+{
+	float pos;
+	float tc;
+	bool color_alpha;
+};
+
+template <typename T>
+__forceinline float Scale(T val, float scale)
+{
+	return val * scale;
+}
+
+template <>
+__forceinline float Scale(float val, float scale)
+{
+	return val;
+}
+
+// Same as FracAdjust in VertexLoader_Normal.cpp.
+template <typename T>
+__forceinline float NormalScale(T val)
+{
+	return val / float(1u << (sizeof(T) * 8 - std::is_signed<T>::value - 1));
+}
+
+template <>
+__forceinline float NormalScale(float val)
+{
+	return val;
+}
+
+template <typename T>
+__forceinline T ReadBigEndian(const u8* data, int i)
+{
+	return Common::FromBigEndian(reinterpret_cast<const T*>(data)[i]);
+}
+
+// Returns the attribute data of the current vertex, either inline in the
+// stream or looked up in the array through the index in the stream.
+template <u64 Type>
+__forceinline const u8* AttributeData(const u8*& src, int array, int direct_size)
+{
+	static_assert(Type == DIRECT || Type == INDEX8 || Type == INDEX16, "Attribute has to be present!");
+
+	if (Type == DIRECT)
+	{
+		const u8* data = src;
+		src += direct_size;
+		return data;
+	}
+
+	u32 index;
+	if (Type == INDEX8)
+	{
+		index = *src;
+		src += 1;
+	}
+	else
+	{
+		index = Common::swap16(src);
+		src += 2;
+	}
+	return cached_arraybases[array] + index * g_main_cp_state.array_strides[array];
+}
+
+struct NoAttribute
+{
+	static void SetDesc(TVtxDesc* desc) {}
+	static void SetAttr(VAT* vat) {}
+	static bool Matches(const TVtxAttr& attr) { return true; }
+	static __forceinline void Load(const u8*& src, u8*& dst, const Scales& scales) {}
+};
+
+template <bool Present>
+struct PosMtx : NoAttribute
+{
+};
+
+template <>
+struct PosMtx<true>
+{
+	static void SetDesc(TVtxDesc* desc) { desc->PosMatIdx = 1; }
+	static bool Matches(const TVtxAttr& attr) { return true; }
+
+	// Read before all other attributes, but written after them.
+	static __forceinline u32 Read(const u8*& src)
+	{
+		return *src++ & 0x3f;
+	}
+};
+
+template <u64 Type, typename T, int N>
+struct Position
+{
+	static void SetDesc(TVtxDesc* desc) { desc->Position = Type; }
+	static void SetAttr(VAT* vat)
+	{
+		vat->g0.PosFormat = FormatOf<T>::value;
+		vat->g0.PosElements = (N == 3);
+	}
+	static bool Matches(const TVtxAttr& attr)
+	{
+		return attr.PosFormat == FormatOf<T>::value && attr.PosElements == (N == 3);
+	}
+
+	static __forceinline void Load(const u8*& src, u8*& dst, const Scales& scales)
+	{
+		const u8* data = AttributeData<Type>(src, ARRAY_POSITION, N * sizeof(T));
+		float* out = reinterpret_cast<float*>(dst);
+		for (int i = 0; i < 3; ++i)
+			out[i] = i < N ? Scale(ReadBigEndian<T>(data, i), scales.pos) : 0.f;
+		dst += 3 * sizeof(float);
+	}
+};
+
+// Only a single normal (no binormal/tangent) is handled here.
+template <u64 Type, typename T>
+struct Normal
+{
+	static void SetDesc(TVtxDesc* desc) { desc->Normal = Type; }
+	static void SetAttr(VAT* vat)
+	{
+		vat->g0.NormalFormat = FormatOf<T>::value;
+		vat->g0.NormalElements = 0;
+	}
+	static bool Matches(const TVtxAttr& attr)
+	{
+		return attr.NormalFormat == FormatOf<T>::value && attr.NormalElements == 0;
+	}
+
+	static __forceinline void Load(const u8*& src, u8*& dst, const Scales& scales)
+	{
+		const u8* data = AttributeData<Type>(src, ARRAY_NORMAL, 3 * sizeof(T));
+		float* out = reinterpret_cast<float*>(dst);
+		for (int i = 0; i < 3; ++i)
+			out[i] = NormalScale(ReadBigEndian<T>(data, i));
+		dst += 3 * sizeof(float);
+	}
+};
+
+template <u64 Type, int Comp>
+struct Color0
+{
+	static void SetDesc(TVtxDesc* desc) { desc->Color0 = Type; }
+	static void SetAttr(VAT* vat) { vat->g0.Color0Comp = Comp; }
+	static bool Matches(const TVtxAttr& attr) { return attr.color[0].Comp == Comp; }
+
+	static __forceinline void Load(const u8*& src, u8*& dst, const Scales& scales)
+	{
+		static const int size = (Comp == FORMAT_16B_565 || Comp == FORMAT_16B_4444) ? 2 :
+		                        (Comp == FORMAT_24B_888 || Comp == FORMAT_24B_6666) ? 3 : 4;
+		const u8* data = AttributeData<Type>(src, ARRAY_COLOR, size);
+
+		u32 col;
+		switch (Comp)
+		{
+		case FORMAT_16B_565:  col = Color_Convert565(Common::swap16(data)); break;
+		case FORMAT_24B_888:  col = Color_Read24(data); break;
+		case FORMAT_32B_888x: col = Color_Read24(data); break;
+		case FORMAT_16B_4444: col = Color_Convert4444(*reinterpret_cast<const u16*>(data)); break;
+		case FORMAT_24B_6666: col = Color_Convert6666(Common::swap32(data - 1)); break;
+		case FORMAT_32B_8888:
+			col = Color_Read32(data);
+			// Only the direct loader kills the alpha, see Color_ReadDirect_32b_8888.
+			if (Type == DIRECT && !scales.color_alpha)
+				col |= 0xFF000000;
+			break;
+		}
+
+		*reinterpret_cast<u32*>(dst) = col;
+		dst += sizeof(u32);
+	}
+};
+
+template <u64 Type, typename T, int N>
+struct TexCoord0
+{
+	static void SetDesc(TVtxDesc* desc) { desc->Tex0Coord = Type; }
+	static void SetAttr(VAT* vat)
+	{
+		vat->g0.Tex0CoordFormat = FormatOf<T>::value;
+		vat->g0.Tex0CoordElements = (N == 2);
+	}
+	static bool Matches(const TVtxAttr& attr)
+	{
+		return attr.texCoord[0].Format == FormatOf<T>::value && attr.texCoord[0].Elements == (N == 2);
+	}
+
+	static __forceinline void Load(const u8*& src, u8*& dst, const Scales& scales)
+	{
+		const u8* data = AttributeData<Type>(src, ARRAY_TEXCOORD0, N * sizeof(T));
+		float* out = reinterpret_cast<float*>(dst);
+		for (int i = 0; i < N; ++i)
+			out[i] = Scale(ReadBigEndian<T>(data, i), scales.tc);
+		dst += N * sizeof(float);
+	}
+};
+
+template <bool HasPosMtx, typename P, typename N, typename C, typename T>
+void LOADERDECL LoadVertices(const u8* src, u8* dst, int count)
+{
+	const Scales scales = { posScale[0], tcScale[0][0], colElements[0] != 0 };
+
+	for (int i = 0; i < count; ++i)
+	{
+		u32 posmtx = 0;
+		if (HasPosMtx)
+			posmtx = PosMtx<true>::Read(src);
+
+		P::Load(src, dst, scales);
+		N::Load(src, dst, scales);
+		C::Load(src, dst, scales);
+		T::Load(src, dst, scales);
+
+		if (HasPosMtx)
+		{
+			*reinterpret_cast<u32*>(dst) = posmtx;
+			dst += sizeof(u32);
+		}
+	}
+}
+
+template <bool HasPosMtx, typename P, typename N, typename C, typename T>
+bool Matches(const TVtxDesc& vtx_desc, const TVtxAttr& vtx_attr)
+{
+	TVtxDesc desc;
+	desc.Hex = 0;
+	PosMtx<HasPosMtx>::SetDesc(&desc);
+	P::SetDesc(&desc);
+	N::SetDesc(&desc);
+	C::SetDesc(&desc);
+	T::SetDesc(&desc);
+
+	return vtx_desc.Hex == desc.Hex &&
+		P::Matches(vtx_attr) && N::Matches(vtx_attr) && C::Matches(vtx_attr) && T::Matches(vtx_attr);
+}
+
+template <bool HasPosMtx, typename P, typename N, typename C, typename T>
+void Setup(TVtxDesc* vtx_desc, VAT* vtx_attr)
+{
+	PosMtx<HasPosMtx>::SetDesc(vtx_desc);
+	P::SetDesc(vtx_desc);
+	N::SetDesc(vtx_desc);
+	C::SetDesc(vtx_desc);
+	T::SetDesc(vtx_desc);
+
+	P::SetAttr(vtx_attr);
+	N::SetAttr(vtx_attr);
+	C::SetAttr(vtx_attr);
+	T::SetAttr(vtx_attr);
+}
+
+struct Entry
+{
+	bool (*matches)(const TVtxDesc& vtx_desc, const TVtxAttr& vtx_attr);
+	void (*setup)(TVtxDesc* vtx_desc, VAT* vtx_attr);
+	TTemplateLoaderFunction function;
+};
+
+template <bool HasPosMtx, typename P, typename N, typename C, typename T>
+Entry MakeEntry()
+{
+	Entry entry = { Matches<HasPosMtx, P, N, C, T>, Setup<HasPosMtx, P, N, C, T>, LoadVertices<HasPosMtx, P, N, C, T> };
+	return entry;
+}
+
+typedef NoAttribute NoNormal;
+typedef NoAttribute NoColor;
+typedef NoAttribute NoTexCoord;
+
+// The formats which showed up most in the vertex loader statistics of a bunch
+// of games. Everything else goes through the JIT or the pipeline stages.
+const Entry s_entries[] = {
+	// Immediate mode: 2D overlays, particles, fonts.
+	MakeEntry<false, Position<DIRECT, float, 3>, NoNormal, Color0<DIRECT, FORMAT_32B_8888>, TexCoord0<DIRECT, float, 2>>(),
+	MakeEntry<false, Position<DIRECT, float, 3>, NoNormal, Color0<DIRECT, FORMAT_32B_8888>, NoTexCoord>(),
+	MakeEntry<false, Position<DIRECT, float, 3>, NoNormal, NoColor, TexCoord0<DIRECT, float, 2>>(),
+	MakeEntry<false, Position<DIRECT, s16, 3>, NoNormal, Color0<DIRECT, FORMAT_32B_8888>, TexCoord0<DIRECT, s16, 2>>(),
+	MakeEntry<false, Position<DIRECT, s16, 3>, NoNormal, Color0<DIRECT, FORMAT_32B_8888>, NoTexCoord>(),
+	MakeEntry<false, Position<DIRECT, s16, 2>, NoNormal, NoColor, TexCoord0<DIRECT, s16, 2>>(),
+
+	// Indexed model data.
+	MakeEntry<false, Position<INDEX16, float, 3>, NoNormal, NoColor, NoTexCoord>(),
+	MakeEntry<false, Position<INDEX16, s16, 3>, NoNormal, NoColor, NoTexCoord>(),
+	MakeEntry<false, Position<INDEX16, float, 3>, NoNormal, NoColor, TexCoord0<INDEX16, float, 2>>(),
+	MakeEntry<false, Position<INDEX16, float, 3>, Normal<INDEX16, float>, NoColor, NoTexCoord>(),
+	MakeEntry<false, Position<INDEX16, float, 3>, Normal<INDEX16, float>, NoColor, TexCoord0<INDEX16, float, 2>>(),
+	MakeEntry<false, Position<INDEX16, float, 3>, Normal<INDEX16, s16>, NoColor, TexCoord0<INDEX16, u16, 2>>(),
+	MakeEntry<false, Position<INDEX16, float, 3>, Normal<INDEX16, float>, Color0<INDEX16, FORMAT_32B_8888>, TexCoord0<INDEX16, float, 2>>(),
+	MakeEntry<false, Position<INDEX16, float, 3>, NoNormal, Color0<INDEX16, FORMAT_32B_8888>, TexCoord0<INDEX16, float, 2>>(),
+	MakeEntry<false, Position<INDEX16, s16, 3>, Normal<INDEX16, s8>, NoColor, TexCoord0<INDEX16, s16, 2>>(),
+	MakeEntry<false, Position<INDEX16, s16, 3>, Normal<INDEX16, s16>, NoColor, TexCoord0<INDEX16, s16, 2>>(),
+	MakeEntry<false, Position<INDEX16, s16, 3>, Normal<INDEX16, s8>, Color0<INDEX16, FORMAT_32B_8888>, TexCoord0<INDEX16, s16, 2>>(),
+	MakeEntry<false, Position<INDEX8, s16, 3>, Normal<INDEX8, s8>, NoColor, TexCoord0<INDEX8, s16, 2>>(),
+
+	// Skinned model data.
+	MakeEntry<true, Position<INDEX16, float, 3>, Normal<INDEX16, float>, NoColor, TexCoord0<INDEX16, float, 2>>(),
+	MakeEntry<true, Position<INDEX16, s16, 3>, Normal<INDEX16, s8>, NoColor, TexCoord0<INDEX16, s16, 2>>(),
+	MakeEntry<true, Position<INDEX16, s16, 3>, Normal<INDEX16, s16>, NoColor, TexCoord0<INDEX16, s16, 2>>(),
+};
+
+}  // namespace
+
+TTemplateLoaderFunction GetFunction(const TVtxDesc& vtx_desc, const TVtxAttr& vtx_attr)
+{
+	for (const Entry& entry : s_entries)
+	{
+		if (entry.matches(vtx_desc, vtx_attr))
+			return entry.function;
+	}
+	return nullptr;
+}
+
+int GetNumFormats()
+{
+	return (int)ArraySize(s_entries);
+}
+
+void GetFormat(int index, TVtxDesc* vtx_desc, VAT* vtx_attr)
+{
+	s_entries[index].setup(vtx_desc, vtx_attr);
+}
+
+}
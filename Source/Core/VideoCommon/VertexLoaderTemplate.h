@@ -0,0 +1,32 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/NativeVertexFormat.h"
+
+// Converts count vertices from src to dst. Doesn't write any global state, so
+// separate parts of a draw can be converted in parallel.
+typedef void (LOADERDECL *TTemplateLoaderFunction)(const u8* src, u8* dst, int count);
+
+// Whole-vertex loaders which are specialized at compile time for the most
+// common vertex formats. Unlike the pipeline stages, which are called once per
+// attribute and communicate through globals, these keep the stream pointers in
+// registers and let the compiler inline the attribute conversions.
+//
+// Hosts without a vertex loader JIT benefit the most, but the conversions are
+// written to give bit-identical output to the pipeline stages on every host.
+namespace VertexLoaderTemplate
+{
+
+// Returns the specialized loader for this format, or nullptr if there is none.
+TTemplateLoaderFunction GetFunction(const TVtxDesc& vtx_desc, const TVtxAttr& vtx_attr);
+
+// Enumerates the specialized formats, so the tests can compare each of them
+// against the pipeline. GetFormat only sets the fields the format uses.
+int GetNumFormats();
+void GetFormat(int index, TVtxDesc* vtx_desc, VAT* vtx_attr);
+
+}
@@ -0,0 +1,135 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Common/Event.h"
+#include "Common/Flag.h"
+#include "Common/Thread.h"
+
+#include "VideoCommon/VertexLoaderWorkers.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace VertexLoaderWorkers
+{
+
+// Chunks are handed out dynamically, so a worker which wakes up late just
+// ends up converting fewer of them.
+enum { MIN_CHUNK_VERTICES = 256 };
+
+struct Job
+{
+	TTemplateLoaderFunction loader;
+	const u8* src;
+	u8* dst;
+	int count;
+	int src_stride;
+	int dst_stride;
+	int chunk_size;
+	int num_chunks;
+};
+
+static std::vector<std::thread> s_threads;
+static std::vector<std::unique_ptr<Common::Event>> s_wake_events;
+static Common::Event s_done_event;
+static Common::Flag s_quit;
+
+// Only written by the GPU thread while all workers are idle.
+static Job s_job;
+static std::atomic<int> s_next_chunk;
+static std::atomic<int> s_workers_running;
+
+static void RunChunks()
+{
+	int chunk;
+	while ((chunk = s_next_chunk++) < s_job.num_chunks)
+	{
+		const int first = chunk * s_job.chunk_size;
+		const int count = std::min(s_job.chunk_size, s_job.count - first);
+		s_job.loader(s_job.src + first * s_job.src_stride, s_job.dst + first * s_job.dst_stride, count);
+	}
+}
+
+static void WorkerThread(int id)
+{
+	Common::SetCurrentThreadName("Vertex loader worker");
+
+	while (true)
+	{
+		s_wake_events[id]->Wait();
+		if (s_quit.IsSet())
+			return;
+
+		RunChunks();
+
+		// Once all workers are done, every chunk has been converted: a worker
+		// only stops after it failed to grab another one.
+		if (--s_workers_running == 0)
+			s_done_event.Set();
+	}
+}
+
+static void Start(int num_threads)
+{
+	s_quit.Clear();
+	for (int i = 0; i < num_threads; i++)
+	{
+		s_wake_events.emplace_back(new Common::Event);
+		s_threads.emplace_back(WorkerThread, i);
+	}
+}
+
+void Shutdown()
+{
+	s_quit.Set();
+	for (auto& event : s_wake_events)
+		event->Set();
+	for (auto& thread : s_threads)
+		thread.join();
+
+	s_threads.clear();
+	s_wake_events.clear();
+}
+
+bool Convert(TTemplateLoaderFunction loader, const u8* src, u8* dst, int count,
+             int src_stride, int dst_stride)
+{
+	const int num_threads = std::max(g_ActiveConfig.iVertexLoaderThreads, 0);
+	if (count < MIN_PARALLEL_VERTICES || num_threads == 0)
+		return false;
+
+	if (num_threads != (int)s_threads.size())
+	{
+		Shutdown();
+		Start(num_threads);
+	}
+
+	s_job.loader = loader;
+	s_job.src = src;
+	s_job.dst = dst;
+	s_job.count = count;
+	s_job.src_stride = src_stride;
+	s_job.dst_stride = dst_stride;
+	s_job.chunk_size = std::max<int>(MIN_CHUNK_VERTICES, count / (4 * (num_threads + 1)));
+	s_job.num_chunks = (count + s_job.chunk_size - 1) / s_job.chunk_size;
+	s_next_chunk = 0;
+	s_workers_running = num_threads;
+
+	for (auto& event : s_wake_events)
+		event->Set();
+
+	// The GPU thread doesn't wait idly for the workers to wake up.
+	RunChunks();
+
+	while (s_workers_running != 0)
+		s_done_event.Wait();
+
+	return true;
+}
+
+}
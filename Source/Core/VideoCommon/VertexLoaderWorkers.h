@@ -0,0 +1,27 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/VertexLoaderTemplate.h"
+
+// A small pool of threads which help the GPU thread convert large draws.
+// Every vertex is converted independently and the output position of a vertex
+// only depends on its index, so a draw is simply split into ranges.
+namespace VertexLoaderWorkers
+{
+
+// Draws with fewer vertices aren't worth waking up the workers for.
+enum { MIN_PARALLEL_VERTICES = 1024 };
+
+// Stops all worker threads, they are restarted on demand.
+void Shutdown();
+
+// Returns false if the draw should be converted on the calling thread,
+// either because it's too small or because no workers are configured.
+bool Convert(TTemplateLoaderFunction loader, const u8* src, u8* dst, int count,
+             int src_stride, int dst_stride);
+
+}
@@ -14,7 +14,6 @@
 #define GSHIFT 8
 #define BSHIFT 16
 #define ASHIFT 24
-#define AMASK 0xFF000000
 
 __forceinline void _SetCol(u32 val)
 {
@@ -22,62 +21,31 @@ __forceinline void _SetCol(u32 val)
 	colIndex++;
 }
 
-//color comes in format BARG in 16 bits
-//BARG -> AABBGGRR
 __forceinline void _SetCol4444(u16 val)
 {
-	u32 col = (val & 0xF0);             // col  = 000000R0;
-	col |=    (val & 0xF ) << 12;       // col |= 0000G000;
-	col |= (((u32)val) & 0xF000) << 8;  // col |= 00B00000;
-	col |= (((u32)val) & 0x0F00) << 20; // col |= A0000000;
-	col |= col >> 4;                    // col =  A0B0G0R0 | 0A0B0G0R;
-	_SetCol(col);
+	_SetCol(Color_Convert4444(val));
 }
 
-//color comes in format RGBA
-//RRRRRRGG GGGGBBBB BBAAAAAA
 __forceinline void _SetCol6666(u32 val)
 {
-	u32 col = (val >> 16) & 0xFC;
-	col |=    (val >>  2) & 0xFC00;
-	col |=    (val << 12) & 0xFC0000;
-	col |=    (val << 26) & 0xFC000000;
-	col |=    (col >>  6) & 0x03030303;
-	_SetCol(col);
+	_SetCol(Color_Convert6666(val));
 }
 
-//color comes in RGB
-//RRRRRGGG GGGBBBBB
 __forceinline void _SetCol565(u16 val)
 {
-	u32 col =   (val  >>  8) & 0xF8;
-	col |=      (val  <<  5) & 0xFC00;
-	col |=(((u32)val) << 19) & 0xF80000;
-	col |= (col >> 5) & 0x070007;
-	col |= (col >> 6) & 0x000300;
-	_SetCol(col | AMASK);
-}
-
-__forceinline u32 _Read24(const u8 *addr)
-{
-	return (*(const u32 *)addr) | AMASK;
-}
-
-__forceinline u32 _Read32(const u8 *addr)
-{
-	return *(const u32 *)addr;
+	_SetCol(Color_Convert565(val));
 }
 
 
 void LOADERDECL Color_ReadDirect_24b_888()
 {
-	_SetCol(_Read24(DataGetPosition()));
+	_SetCol(Color_Read24(DataGetPosition()));
 	DataSkip(3);
 }
 
 void LOADERDECL Color_ReadDirect_32b_888x()
 {
-	_SetCol(_Read24(DataGetPosition()));
+	_SetCol(Color_Read24(DataGetPosition()));
 	DataSkip(4);
 }
 void LOADERDECL Color_ReadDirect_16b_565()
@@ -126,7 +94,7 @@ void Color_ReadIndex_24b_888()
 {
 	auto const Index = DataRead<I>();
 	const u8 *iAddress = cached_arraybases[ARRAY_COLOR+colIndex] + (Index * g_main_cp_state.array_strides[ARRAY_COLOR+colIndex]);
-	_SetCol(_Read24(iAddress));
+	_SetCol(Color_Read24(iAddress));
 }
 
 template <typename I>
@@ -134,7 +102,7 @@ void Color_ReadIndex_32b_888x()
 {
 	auto const Index = DataRead<I>();
 	const u8 *iAddress = cached_arraybases[ARRAY_COLOR+colIndex] + (Index * g_main_cp_state.array_strides[ARRAY_COLOR+colIndex]);
-	_SetCol(_Read24(iAddress));
+	_SetCol(Color_Read24(iAddress));
 }
 
 template <typename I>
@@ -159,7 +127,7 @@ void Color_ReadIndex_32b_8888()
 {
 	auto const Index = DataRead<I>();
 	const u8 *iAddress = cached_arraybases[ARRAY_COLOR+colIndex] + (Index * g_main_cp_state.array_strides[ARRAY_COLOR+colIndex]);
-	_SetCol(_Read32(iAddress));
+	_SetCol(Color_Read32(iAddress));
 }
 
 void LOADERDECL Color_ReadIndex8_16b_565() { Color_ReadIndex_16b_565<u8>(); }
@@ -4,8 +4,58 @@
 
 #pragma once
 
+#include "Common/Common.h"
 #include "VideoCommon/NativeVertexFormat.h"
 
+// Conversions from the GC color formats to the native AABBGGRR layout. These
+// are shared between the pipeline stages and the template vertex loader.
+
+//color comes in format BARG in 16 bits
+//BARG -> AABBGGRR
+__forceinline u32 Color_Convert4444(u16 val)
+{
+	u32 col = (val & 0xF0);             // col  = 000000R0;
+	col |=    (val & 0xF ) << 12;       // col |= 0000G000;
+	col |= (((u32)val) & 0xF000) << 8;  // col |= 00B00000;
+	col |= (((u32)val) & 0x0F00) << 20; // col |= A0000000;
+	col |= col >> 4;                    // col =  A0B0G0R0 | 0A0B0G0R;
+	return col;
+}
+
+//color comes in format RGBA
+//RRRRRRGG GGGGBBBB BBAAAAAA
+__forceinline u32 Color_Convert6666(u32 val)
+{
+	u32 col = (val >> 16) & 0xFC;
+	col |=    (val >>  2) & 0xFC00;
+	col |=    (val << 12) & 0xFC0000;
+	col |=    (val << 26) & 0xFC000000;
+	col |=    (col >>  6) & 0x03030303;
+	return col;
+}
+
+//color comes in RGB
+//RRRRRGGG GGGBBBBB
+__forceinline u32 Color_Convert565(u16 val)
+{
+	u32 col =   (val  >>  8) & 0xF8;
+	col |=      (val  <<  5) & 0xFC00;
+	col |=(((u32)val) << 19) & 0xF80000;
+	col |= (col >> 5) & 0x070007;
+	col |= (col >> 6) & 0x000300;
+	return col | 0xFF000000;
+}
+
+__forceinline u32 Color_Read24(const u8 *addr)
+{
+	return (*(const u32 *)addr) | 0xFF000000;
+}
+
+__forceinline u32 Color_Read32(const u8 *addr)
+{
+	return *(const u32 *)addr;
+}
+
 void LOADERDECL Color_ReadDirect_24b_888();
 void LOADERDECL Color_ReadDirect_32b_888x();
 void LOADERDECL Color_ReadDirect_16b_565();
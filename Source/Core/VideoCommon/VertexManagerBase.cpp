@@ -1,4 +1,5 @@
 #include "Common/CommonTypes.h"
+#include "Common/Timer.h"
 
 #include "VideoCommon/BPStructs.h"
 #include "VideoCommon/Debugger.h"
@@ -155,6 +156,9 @@ void VertexManager::Flush()
 	if (IsFlushed)
 		return;
 
+	// Only timed while the statistics are shown, the timer isn't free.
+	const u64 start_time = g_ActiveConfig.bOverlayStats ? Common::Timer::GetTimeUs() : 0;
+
 	// loading a state will invalidate BP, so check for it
 	g_video_backend->CheckInvalidState();
 
@@ -241,6 +245,9 @@ void VertexManager::Flush()
 		ERROR_LOG(VIDEO, "xf.numtexgens (%d) does not match bp.numtexgens (%d). Error in command stream.", xfmem.numTexGen.numTexGens, bpmem.genMode.numtexgens.Value());
 
 	IsFlushed = true;
+
+	if (g_ActiveConfig.bOverlayStats)
+		ADDSTAT(stats.thisFrame.usBackendDraws, Common::Timer::GetTimeUs() - start_time);
 }
 
 void VertexManager::DoState(PointerWrap& p)
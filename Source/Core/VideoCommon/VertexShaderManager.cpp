@@ -38,6 +38,15 @@ static float s_fViewRotation[2];
 
 VertexShaderConstants VertexShaderManager::constants;
 bool VertexShaderManager::dirty;
+ConstantDirtyRange VertexShaderManager::dirty_range;
+
+template <typename T>
+static void MarkDirty(const T& member, int count = 1)
+{
+	const u8* base = (const u8*)&VertexShaderManager::constants;
+	VertexShaderManager::dirty = true;
+	VertexShaderManager::dirty_range.Add((u32)((const u8*)&member - base), sizeof(T) * count);
+}
 
 struct ProjectionHack
 {
@@ -206,7 +215,7 @@ void VertexShaderManager::Dirty()
 
 	nMaterialsChanged = BitSet32::AllTrue(4);
 
-	dirty = true;
+	MarkDirty(constants);
 }
 
 // Syncs the shader constant buffers with xfmem
@@ -218,7 +227,7 @@ void VertexShaderManager::SetConstants()
 		int startn = nTransformMatricesChanged[0] / 4;
 		int endn = (nTransformMatricesChanged[1] + 3) / 4;
 		memcpy(constants.transformmatrices[startn], &xfmem.posMatrices[startn * 4], (endn - startn) * 16);
-		dirty = true;
+		MarkDirty(constants.transformmatrices[startn], endn - startn);
 		nTransformMatricesChanged[0] = nTransformMatricesChanged[1] = -1;
 	}
 
@@ -230,7 +239,7 @@ void VertexShaderManager::SetConstants()
 		{
 			memcpy(constants.normalmatrices[i], &xfmem.normalMatrices[3*i], 12);
 		}
-		dirty = true;
+		MarkDirty(constants.normalmatrices[startn], endn - startn);
 		nNormalMatricesChanged[0] = nNormalMatricesChanged[1] = -1;
 	}
 
@@ -239,7 +248,7 @@ void VertexShaderManager::SetConstants()
 		int startn = nPostTransformMatricesChanged[0] / 4;
 		int endn = (nPostTransformMatricesChanged[1] + 3 ) / 4;
 		memcpy(constants.posttransformmatrices[startn], &xfmem.postMatrices[startn * 4], (endn - startn) * 16);
-		dirty = true;
+		MarkDirty(constants.posttransformmatrices[startn], endn - startn);
 		nPostTransformMatricesChanged[0] = nPostTransformMatricesChanged[1] = -1;
 	}
 
@@ -292,7 +301,7 @@ void VertexShaderManager::SetConstants()
 			dstlight.dir[1] = light.ddir[1] * norm_float;
 			dstlight.dir[2] = light.ddir[2] * norm_float;
 		}
-		dirty = true;
+		MarkDirty(constants.lights[istart], iend - istart);
 
 		nLightsChanged[0] = nLightsChanged[1] = -1;
 	}
@@ -304,7 +313,7 @@ void VertexShaderManager::SetConstants()
 		constants.materials[i][1] = (data >> 16) & 0xFF;
 		constants.materials[i][2] = (data >>  8) & 0xFF;
 		constants.materials[i][3] =  data        & 0xFF;
-		dirty = true;
+		MarkDirty(constants.materials[i]);
 	}
 	nMaterialsChanged = BitSet32(0);
 
@@ -319,7 +328,7 @@ void VertexShaderManager::SetConstants()
 		memcpy(constants.posnormalmatrix[3], norm, 12);
 		memcpy(constants.posnormalmatrix[4], norm+3, 12);
 		memcpy(constants.posnormalmatrix[5], norm+6, 12);
-		dirty = true;
+		MarkDirty(constants.posnormalmatrix);
 	}
 
 	if (bTexMatricesChanged[0])
@@ -337,7 +346,7 @@ void VertexShaderManager::SetConstants()
 		{
 			memcpy(constants.texmatrices[3*i], fptrs[i], 3*16);
 		}
-		dirty = true;
+		MarkDirty(constants.texmatrices[0], 12);
 	}
 
 	if (bTexMatricesChanged[1])
@@ -354,7 +363,7 @@ void VertexShaderManager::SetConstants()
 		{
 			memcpy(constants.texmatrices[3*i+12], fptrs[i], 3*16);
 		}
-		dirty = true;
+		MarkDirty(constants.texmatrices[12], 12);
 	}
 
 	if (bViewportChanged)
@@ -371,7 +380,7 @@ void VertexShaderManager::SetConstants()
 		const float pixel_size_y = 2.f / Renderer::EFBToScaledXf(2.f * xfmem.viewport.ht);
 		constants.pixelcentercorrection[0] = pixel_center_correction * pixel_size_x;
 		constants.pixelcentercorrection[1] = pixel_center_correction * pixel_size_y;
-		dirty = true;
+		MarkDirty(constants.pixelcentercorrection);
 		// This is so implementation-dependent that we can't have it here.
 		g_renderer->SetViewport();
 
@@ -524,7 +533,8 @@ void VertexShaderManager::SetConstants()
 			constants.stereoparams[0] = constants.stereoparams[1] = 0;
 		}
 
-		dirty = true;
+		MarkDirty(constants.projection);
+		MarkDirty(constants.stereoparams);
 	}
 }
 
@@ -36,4 +36,6 @@ public:
 
 	static VertexShaderConstants constants;
 	static bool dirty;
+	// Part of the constants which changed since the backend last uploaded them.
+	static ConstantDirtyRange dirty_range;
 };
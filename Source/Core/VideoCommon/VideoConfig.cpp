@@ -29,6 +29,7 @@ VideoConfig::VideoConfig()
 {
 	bRunning = false;
 	bFullscreen = false;
+	bSkipVertexLoading = false;
 
 	// Needed for the first frame, I think
 	fAspectRatioHackW = 1;
@@ -68,9 +69,12 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("ShowEFBCopyRegions", &bShowEFBCopyRegions, false);
 	settings->Get("DumpTextures", &bDumpTextures, 0);
 	settings->Get("HiresTextures", &bHiresTextures, 0);
+	settings->Get("CacheHiresTextures", &bCacheHiresTextures, 0);
 	settings->Get("DumpEFBTarget", &bDumpEFBTarget, 0);
 	settings->Get("FreeLook", &bFreeLook, 0);
 	settings->Get("UseFFV1", &bUseFFV1, 0);
+	settings->Get("DumpCodec", &sDumpCodec, "");
+	settings->Get("DumpPreset", &sDumpPreset, "");
 	settings->Get("EnablePixelLighting", &bEnablePixelLighting, 0);
 	settings->Get("FastDepthCalc", &bFastDepthCalc, true);
 	settings->Get("MSAA", &iMultisampleMode, 0);
@@ -81,6 +85,8 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("WireFrame", &bWireFrame, 0);
 	settings->Get("DisableFog", &bDisableFog, 0);
 	settings->Get("EnableShaderDebugging", &bEnableShaderDebugging, false);
+	settings->Get("PrecompileShaders", &bPrecompileShaders, true);
+	settings->Get("AsyncShaderCompilation", &bAsyncShaderCompilation, false);
 	settings->Get("BorderlessFullscreen", &bBorderlessFullscreen, false);
 
 	IniFile::Section* enhancements = iniFile.GetOrCreateSection("Enhancements");
@@ -94,10 +100,15 @@ void VideoConfig::Load(const std::string& ini_file)
 
 	IniFile::Section* hacks = iniFile.GetOrCreateSection("Hacks");
 	hacks->Get("EFBAccessEnable", &bEFBAccessEnable, true);
+	hacks->Get("EFBFastAccess", &bEFBFastAccess, false);
 	hacks->Get("EFBCopyEnable", &bEFBCopyEnable, true);
 	hacks->Get("EFBToTextureEnable", &bCopyEFBToTexture, true);
 	hacks->Get("EFBScaledCopy", &bCopyEFBScaled, true);
 	hacks->Get("EFBCopyCacheEnable", &bEFBCopyCacheEnable, false);
+	hacks->Get("DeferEFBCopies", &bDeferEFBCopies, false);
+	hacks->Get("VertexCacheEnable", &bVertexCacheEnable, false);
+	hacks->Get("DecodeThread", &bDecodeThread, false);
+	hacks->Get("VertexLoaderThreads", &iVertexLoaderThreads, 0);
 	hacks->Get("EFBEmulateFormatChanges", &bEFBEmulateFormatChanges, false);
 
 	// Load common settings
@@ -146,6 +157,7 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Settings", "UseRealXFB", bUseRealXFB);
 	CHECK_SETTING("Video_Settings", "SafeTextureCacheColorSamples", iSafeTextureCache_ColorSamples);
 	CHECK_SETTING("Video_Settings", "HiresTextures", bHiresTextures);
+	CHECK_SETTING("Video_Settings", "CacheHiresTextures", bCacheHiresTextures);
 	CHECK_SETTING("Video_Settings", "EnablePixelLighting", bEnablePixelLighting);
 	CHECK_SETTING("Video_Settings", "FastDepthCalc", bFastDepthCalc);
 	CHECK_SETTING("Video_Settings", "MSAA", iMultisampleMode);
@@ -192,10 +204,15 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Stereoscopy", "StereoConvergencePercent", iStereoConvergencePercent);
 
 	CHECK_SETTING("Video_Hacks", "EFBAccessEnable", bEFBAccessEnable);
+	CHECK_SETTING("Video_Hacks", "EFBFastAccess", bEFBFastAccess);
 	CHECK_SETTING("Video_Hacks", "EFBCopyEnable", bEFBCopyEnable);
 	CHECK_SETTING("Video_Hacks", "EFBToTextureEnable", bCopyEFBToTexture);
 	CHECK_SETTING("Video_Hacks", "EFBScaledCopy", bCopyEFBScaled);
 	CHECK_SETTING("Video_Hacks", "EFBCopyCacheEnable", bEFBCopyCacheEnable);
+	CHECK_SETTING("Video_Hacks", "DeferEFBCopies", bDeferEFBCopies);
+	CHECK_SETTING("Video_Hacks", "VertexCacheEnable", bVertexCacheEnable);
+	CHECK_SETTING("Video_Hacks", "DecodeThread", bDecodeThread);
+	CHECK_SETTING("Video_Hacks", "VertexLoaderThreads", iVertexLoaderThreads);
 	CHECK_SETTING("Video_Hacks", "EFBEmulateFormatChanges", bEFBEmulateFormatChanges);
 
 	CHECK_SETTING("Video", "ProjectionHack", iPhackvalue[0]);
@@ -239,9 +256,12 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("OverlayProjStats", bOverlayProjStats);
 	settings->Set("DumpTextures", bDumpTextures);
 	settings->Set("HiresTextures", bHiresTextures);
+	settings->Set("CacheHiresTextures", bCacheHiresTextures);
 	settings->Set("DumpEFBTarget", bDumpEFBTarget);
 	settings->Set("FreeLook", bFreeLook);
 	settings->Set("UseFFV1", bUseFFV1);
+	settings->Set("DumpCodec", sDumpCodec);
+	settings->Set("DumpPreset", sDumpPreset);
 	settings->Set("EnablePixelLighting", bEnablePixelLighting);
 	settings->Set("FastDepthCalc", bFastDepthCalc);
 	settings->Set("ShowEFBCopyRegions", bShowEFBCopyRegions);
@@ -253,6 +273,8 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("DstAlphaPass", bDstAlphaPass);
 	settings->Set("DisableFog", bDisableFog);
 	settings->Set("EnableShaderDebugging", bEnableShaderDebugging);
+	settings->Set("PrecompileShaders", bPrecompileShaders);
+	settings->Set("AsyncShaderCompilation", bAsyncShaderCompilation);
 	settings->Set("BorderlessFullscreen", bBorderlessFullscreen);
 
 	IniFile::Section* enhancements = iniFile.GetOrCreateSection("Enhancements");
@@ -266,10 +288,15 @@ void VideoConfig::Save(const std::string& ini_file)
 
 	IniFile::Section* hacks = iniFile.GetOrCreateSection("Hacks");
 	hacks->Set("EFBAccessEnable", bEFBAccessEnable);
+	hacks->Set("EFBFastAccess", bEFBFastAccess);
 	hacks->Set("EFBCopyEnable", bEFBCopyEnable);
 	hacks->Set("EFBToTextureEnable", bCopyEFBToTexture);
 	hacks->Set("EFBScaledCopy", bCopyEFBScaled);
 	hacks->Set("EFBCopyCacheEnable", bEFBCopyCacheEnable);
+	hacks->Set("DeferEFBCopies", bDeferEFBCopies);
+	hacks->Set("VertexCacheEnable", bVertexCacheEnable);
+	hacks->Set("DecodeThread", bDecodeThread);
+	hacks->Set("VertexLoaderThreads", iVertexLoaderThreads);
 	hacks->Set("EFBEmulateFormatChanges", bEFBEmulateFormatChanges);
 
 	iniFile.Save(ini_file);
@@ -102,17 +102,29 @@ struct VideoConfig final
 	// Utility
 	bool bDumpTextures;
 	bool bHiresTextures;
+	bool bCacheHiresTextures;
 	bool bDumpEFBTarget;
 	bool bUseFFV1;
+	// libavcodec encoder and its preset for frame dumps, empty for the defaults
+	std::string sDumpCodec;
+	std::string sDumpPreset;
 	bool bFreeLook;
 	bool bBorderlessFullscreen;
 
 	// Hacks
 	bool bEFBAccessEnable;
+	bool bEFBFastAccess;
 	bool bPerfQueriesEnable;
 
 	bool bEFBCopyEnable;
 	bool bEFBCopyCacheEnable;
+	bool bDeferEFBCopies;
+	bool bVertexCacheEnable;
+	bool bDecodeThread;
+	int iVertexLoaderThreads;
+	// Nothing is drawn, for measuring everything else. Only set by the Null
+	// backend while it's running, it's not saved with the other settings.
+	bool bSkipVertexLoading;
 	bool bEFBEmulateFormatChanges;
 	bool bCopyEFBToTexture;
 	bool bCopyEFBScaled;
@@ -135,6 +147,8 @@ struct VideoConfig final
 
 	// Debugging
 	bool bEnableShaderDebugging;
+	bool bPrecompileShaders;
+	bool bAsyncShaderCompilation;
 
 	// Static config per API
 	// TODO: Move this out of VideoConfig
@@ -10,6 +10,7 @@
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
@@ -56,6 +57,11 @@ static void DoState(PointerWrap &p)
 	BoundingBox::DoState(p);
 	p.DoMarker("BoundingBox");
 
+	// Pending EFB copies were written back before saving, see Fifo_PauseAndLock,
+	// but the ones made since then would overwrite the loaded memory.
+	if (p.GetMode() == PointerWrap::MODE_READ && g_texture_cache)
+		g_texture_cache->DiscardEFBCopies();
+
 
 	// TODO: search for more data that should be saved and add it here
 }
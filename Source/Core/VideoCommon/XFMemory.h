@@ -276,4 +276,6 @@ extern XFMemory xfmem;
 
 void LoadXFReg(u32 transferSize, u32 address, DataReader src);
 void LoadIndexedXF(u32 val, int array);
+// Like LoadIndexedXF, with the big endian words the array holds at the index
+void LoadIndexedXFData(u32 val, const u32* data);
 void PreprocessIndexedXF(u32 val, int refarray);
@@ -2,12 +2,15 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "Common/Common.h"
 #include "Core/HW/Memmap.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoCommon.h"
@@ -19,6 +22,21 @@ static void XFMemWritten(u32 transferSize, u32 baseAddress)
 	VertexShaderManager::InvalidateXFRange(baseAddress, baseAddress + transferSize);
 }
 
+// Returns true if the registers from address up to end, as far as they are
+// covered by the transfer, would change their value.
+static bool XFRegsChanged(u32 address, u32 end, int transferSize, DataReader src, u32 dataIndex)
+{
+	const u32 count = std::min<u32>(end - address, transferSize);
+	for (u32 i = 0; i < count; i++)
+	{
+		if (((u32*)&xfmem)[address + i] != src.Peek<u32>((dataIndex + i) * sizeof(u32)))
+			return true;
+	}
+
+	INCSTAT(stats.thisFrame.numRedundantStateWrites);
+	return false;
+}
+
 static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
 {
 	u32 address = baseAddress;
@@ -107,9 +125,12 @@ static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
 		case XFMEM_SETVIEWPORT+3:
 		case XFMEM_SETVIEWPORT+4:
 		case XFMEM_SETVIEWPORT+5:
-			VertexManager::Flush();
-			VertexShaderManager::SetViewportChanged();
-			PixelShaderManager::SetViewportChanged();
+			if (XFRegsChanged(address, XFMEM_SETVIEWPORT + 6, transferSize, src, dataIndex))
+			{
+				VertexManager::Flush();
+				VertexShaderManager::SetViewportChanged();
+				PixelShaderManager::SetViewportChanged();
+			}
 
 			nextAddress = XFMEM_SETVIEWPORT + 6;
 			break;
@@ -121,8 +142,11 @@ static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
 		case XFMEM_SETPROJECTION+4:
 		case XFMEM_SETPROJECTION+5:
 		case XFMEM_SETPROJECTION+6:
-			VertexManager::Flush();
-			VertexShaderManager::SetProjectionChanged();
+			if (XFRegsChanged(address, XFMEM_SETPROJECTION + 7, transferSize, src, dataIndex))
+			{
+				VertexManager::Flush();
+				VertexShaderManager::SetProjectionChanged();
+			}
 
 			nextAddress = XFMEM_SETPROJECTION + 7;
 			break;
@@ -140,7 +164,8 @@ static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
 		case XFMEM_SETTEXMTXINFO+5:
 		case XFMEM_SETTEXMTXINFO+6:
 		case XFMEM_SETTEXMTXINFO+7:
-			VertexManager::Flush();
+			if (XFRegsChanged(address, XFMEM_SETTEXMTXINFO + 8, transferSize, src, dataIndex))
+				VertexManager::Flush();
 
 			nextAddress = XFMEM_SETTEXMTXINFO + 8;
 			break;
@@ -153,7 +178,8 @@ static void XFRegWritten(int transferSize, u32 baseAddress, DataReader src)
 		case XFMEM_SETPOSMTXINFO+5:
 		case XFMEM_SETPOSMTXINFO+6:
 		case XFMEM_SETPOSMTXINFO+7:
-			VertexManager::Flush();
+			if (XFRegsChanged(address, XFMEM_SETPOSMTXINFO + 8, transferSize, src, dataIndex))
+				VertexManager::Flush();
 
 			nextAddress = XFMEM_SETPOSMTXINFO + 8;
 			break;
@@ -226,7 +252,10 @@ void LoadXFReg(u32 transferSize, u32 baseAddress, DataReader src)
 			transferSize = 0;
 		}
 
-		XFMemWritten(xfMemTransferSize, xfMemBase);
+		// Games tend to reload the same matrices for every draw, which
+		// doesn't need to split the batch.
+		if (XFRegsChanged(xfMemBase, xfMemBase + xfMemTransferSize, xfMemTransferSize, src, 0))
+			XFMemWritten(xfMemTransferSize, xfMemBase);
 		for (u32 i = 0; i < xfMemTransferSize; i++)
 		{
 			((u32*)&xfmem)[xfMemBase + i] = src.Read<u32>();
@@ -248,11 +277,9 @@ void LoadXFReg(u32 transferSize, u32 baseAddress, DataReader src)
 void LoadIndexedXF(u32 val, int refarray)
 {
 	int index = val >> 16;
-	int address = val & 0xFFF; // check mask
 	int size = ((val >> 12) & 0xF) + 1;
 	//load stuff from array to address in xf mem
 
-	u32* currData = (u32*)(&xfmem) + address;
 	u32* newData;
 	if (g_use_deterministic_gpu_thread)
 	{
@@ -262,6 +289,15 @@ void LoadIndexedXF(u32 val, int refarray)
 	{
 		newData = (u32*)Memory::GetPointer(g_main_cp_state.array_bases[refarray] + g_main_cp_state.array_strides[refarray] * index);
 	}
+	LoadIndexedXFData(val, newData);
+}
+
+void LoadIndexedXFData(u32 val, const u32* newData)
+{
+	int address = val & 0xFFF; // check mask
+	int size = ((val >> 12) & 0xF) + 1;
+
+	u32* currData = (u32*)(&xfmem) + address;
 	bool changed = false;
 	for (int i = 0; i < size; ++i)
 	{
@@ -0,0 +1,86 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/HiresTexturePack.h"
+#include "VideoCommon/HiresTextures.h"
+
+// Converts the custom textures of a game from a directory of image files to a
+// texture pack, which Dolphin can load much faster.
+int main(int argc, const char *argv[])
+{
+	if (argc != 4 || !strcmp(argv[1], "--help") || !strcmp(argv[1], "-?"))
+	{
+		printf("USAGE: TexturePackTool <GAME ID> <TEXTURE DIRECTORY> <PACK FILE>\n");
+		printf("Converts the custom textures of a game to a texture pack.\n");
+		printf("Dolphin loads User/Load/Textures/<GAME ID>.dtp before the image files.\n");
+		return 1;
+	}
+
+	const std::string gameCode = argv[1];
+	const std::string directory = argv[2];
+	const std::string packFilename = argv[3];
+
+	if (!File::IsDirectory(directory))
+	{
+		printf("ERROR: %s is not a directory.\n", directory.c_str());
+		return 1;
+	}
+
+	std::map<u64, std::string> files;
+	HiresTextures::FindTextureFiles(directory, gameCode, &files);
+	if (files.empty())
+	{
+		printf("ERROR: No textures of %s found in %s.\n", gameCode.c_str(), directory.c_str());
+		return 1;
+	}
+
+	// Textures are written as they're converted, so only one is in memory at a time
+	HiresTexturePack::Writer writer;
+	if (!writer.Open(packFilename))
+	{
+		printf("ERROR: Failed to create %s.\n", packFilename.c_str());
+		return 1;
+	}
+
+	u32 converted = 0;
+	for (auto& file : files)
+	{
+		unsigned int width, height;
+		std::vector<u8> data;
+		if (!HiresTextures::LoadTextureFile(file.second, &width, &height, &data))
+		{
+			printf("Skipping %s: failed to load it.\n", file.second.c_str());
+			continue;
+		}
+		if (width > HiresTexturePack::MAX_TEXTURE_SIZE || height > HiresTexturePack::MAX_TEXTURE_SIZE)
+		{
+			printf("Skipping %s: it's larger than %ux%u.\n", file.second.c_str(), (u32)HiresTexturePack::MAX_TEXTURE_SIZE, (u32)HiresTexturePack::MAX_TEXTURE_SIZE);
+			continue;
+		}
+
+		if (!writer.AddTexture(file.first, width, height, data.data()))
+		{
+			printf("ERROR: Failed to write %s.\n", packFilename.c_str());
+			return 1;
+		}
+		converted++;
+	}
+
+	if (!writer.Finish())
+	{
+		printf("ERROR: Failed to write %s.\n", packFilename.c_str());
+		return 1;
+	}
+
+	printf("Converted %u of %u textures to %s.\n", converted, (u32)files.size(), packFilename.c_str());
+	return 0;
+}
@@ -0,0 +1,112 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "Common/Event.h"
+#include "Common/Timer.h"
+#include "Common/WaitableAtomic.h"
+
+using Common::Event;
+using Common::WaitableAtomic;
+
+// A producer fills a small ring buffer and a consumer reports its progress,
+// which is how the deterministic GPU thread mode hands data around.
+TEST(WaitableAtomic, ProducerConsumer)
+{
+	const u32 BUFFER_SIZE = 64;
+	const u32 ITERATIONS_COUNT = 200000;
+	u32 buffer[BUFFER_SIZE];
+	WaitableAtomic<u32> written(0), seen(0);
+
+	auto producer = [&]() {
+		for (u32 i = 0; i < ITERATIONS_COUNT; ++i)
+		{
+			seen.Wait([&]() { return i - seen.Load() < BUFFER_SIZE; });
+			buffer[i % BUFFER_SIZE] = i;
+			written.Store(i + 1);
+		}
+	};
+
+	auto consumer = [&]() {
+		for (u32 i = 0; i < ITERATIONS_COUNT; ++i)
+		{
+			written.Wait([&]() { return written.Load() > i; });
+			EXPECT_EQ(i, buffer[i % BUFFER_SIZE]);
+			seen.Store(i + 1);
+		}
+	};
+
+	std::thread producer_thread(producer);
+	std::thread consumer_thread(consumer);
+
+	producer_thread.join();
+	consumer_thread.join();
+
+	EXPECT_EQ(ITERATIONS_COUNT, seen.Load());
+}
+
+TEST(WaitableAtomic, NotifyOtherState)
+{
+	WaitableAtomic<int> value(0);
+	std::atomic<bool> quit(false);
+
+	std::thread waiter([&]() {
+		value.Wait([&]() { return quit.load() || value.Load() == 1; });
+	});
+
+	quit = true;
+	value.Notify();
+	waiter.join();
+
+	EXPECT_EQ(0, value.Load());
+}
+
+// Not a correctness test, this compares the cost of a handoff against the
+// Event based ping-pong it replaced.
+TEST(WaitableAtomic, Throughput)
+{
+	const int ITERATIONS_COUNT = 200000;
+
+	WaitableAtomic<int> ping(0), pong(0);
+	u64 start = Common::Timer::GetTimeUs();
+	std::thread atomic_thread([&]() {
+		for (int i = 1; i <= ITERATIONS_COUNT; ++i)
+		{
+			ping.Wait([&]() { return ping.Load() == i; });
+			pong.Store(i);
+		}
+	});
+	for (int i = 1; i <= ITERATIONS_COUNT; ++i)
+	{
+		ping.Store(i);
+		pong.Wait([&]() { return pong.Load() == i; });
+	}
+	atomic_thread.join();
+	u64 atomic_us = Common::Timer::GetTimeUs() - start;
+
+	Event ping_event, pong_event;
+	start = Common::Timer::GetTimeUs();
+	std::thread event_thread([&]() {
+		for (int i = 0; i < ITERATIONS_COUNT; ++i)
+		{
+			ping_event.Wait();
+			pong_event.Set();
+		}
+	});
+	for (int i = 0; i < ITERATIONS_COUNT; ++i)
+	{
+		ping_event.Set();
+		pong_event.Wait();
+	}
+	event_thread.join();
+	u64 event_us = Common::Timer::GetTimeUs() - start;
+
+	printf("WaitableAtomic: %d round trips in %llu us, Event: %llu us\n", ITERATIONS_COUNT,
+	       (unsigned long long)atomic_us, (unsigned long long)event_us);
+	EXPECT_EQ(ITERATIONS_COUNT, pong.Load());
+}
@@ -0,0 +1,264 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+#include "Core/FifoPlayer/FifoFileStruct.h"
+#include "TestUtils/TempDir.h"
+
+static u8* MakeData(u32 size, u8 seed)
+{
+	u8* data = new u8[size];
+	for (u32 i = 0; i < size; ++i)
+		data[i] = (u8)(seed + i * 7);
+	return data;
+}
+
+static std::shared_ptr<u8> MakeFifoData(u32 size, u8 seed)
+{
+	return std::shared_ptr<u8>(MakeData(size, seed), std::default_delete<u8[]>());
+}
+
+static bool HasData(const u8* data, u32 size, u8 seed)
+{
+	std::unique_ptr<u8[]> expected(MakeData(size, seed));
+	return memcmp(data, expected.get(), size) == 0;
+}
+
+static MemoryUpdate MakeUpdate(u32 address, u32 size, u8 seed)
+{
+	MemoryUpdate update;
+	update.fifoPosition = 0;
+	update.address = address;
+	update.size = size;
+	update.data = MakeData(size, seed);
+	update.type = MemoryUpdate::TEXTURE_MAP;
+	return update;
+}
+
+static void AddTestFrame(FifoDataFile* file, u32 size, u8 seed)
+{
+	FifoFrameInfo frame;
+	frame.fifoData = MakeFifoData(size, seed);
+	frame.fifoDataSize = size;
+	frame.fifoStart = 0x1000;
+	frame.fifoEnd = 0x2000;
+	file->AddFrame(frame);
+}
+
+class FifoDataFileTest : public testing::Test
+{
+protected:
+	virtual void SetUp() override
+	{
+		ASSERT_TRUE(m_dir.IsValid());
+		m_filename = m_dir.GetFilename("FifoDataFileTest.dff");
+	}
+
+	TempDir m_dir;
+	std::string m_filename;
+};
+
+TEST_F(FifoDataFileTest, SaveAndLoad)
+{
+	std::unique_ptr<FifoDataFile> file(new FifoDataFile);
+	file->SetIsWii(true);
+	file->GetBPMem()[0x10] = 0x12345678;
+	file->GetXFRegs()[FifoDataFile::XF_REGS_SIZE - 1] = 0xabcdef;
+
+	// Both frames upload the same texture
+	FifoFrameInfo frame;
+	frame.fifoData = MakeFifoData(5000, 1);
+	frame.fifoDataSize = 5000;
+	frame.fifoStart = 0x1000;
+	frame.fifoEnd = 0x2000;
+	frame.memoryUpdates.push_back(MakeUpdate(0x80001000, 1024, 2));
+	frame.memoryUpdates.push_back(MakeUpdate(0x80002000, 32, 3));
+	file->AddFrame(frame);
+
+	frame.fifoData = MakeFifoData(300, 4);
+	frame.fifoDataSize = 300;
+	frame.memoryUpdates.clear();
+	frame.memoryUpdates.push_back(MakeUpdate(0x80003000, 1024, 2));
+	file->AddFrame(frame);
+
+	ASSERT_EQ(2u, file->GetFrameCount());
+	EXPECT_EQ(file->GetMemoryUpdates(0)[0].data, file->GetMemoryUpdates(1)[0].data);
+	EXPECT_TRUE(HasData(file->GetFrame(0).fifoData.get(), 5000, 1));
+	EXPECT_TRUE(HasData(file->GetFrame(1).fifoData.get(), 300, 4));
+
+	ASSERT_TRUE(file->Save(m_filename));
+
+	std::unique_ptr<FifoDataFile> loaded(FifoDataFile::Load(m_filename, false));
+	ASSERT_NE(nullptr, loaded.get());
+	EXPECT_TRUE(loaded->GetIsWii());
+	EXPECT_EQ(0x12345678u, loaded->GetBPMem()[0x10]);
+	EXPECT_EQ(0xabcdefu, loaded->GetXFRegs()[FifoDataFile::XF_REGS_SIZE - 1]);
+
+	ASSERT_EQ(2u, loaded->GetFrameCount());
+	EXPECT_EQ(5000u, loaded->GetFifoDataSize(0));
+	EXPECT_EQ(300u, loaded->GetFifoDataSize(1));
+
+	const FifoFrameInfo frame0 = loaded->GetFrame(0);
+	EXPECT_EQ(0x1000u, frame0.fifoStart);
+	EXPECT_EQ(0x2000u, frame0.fifoEnd);
+	EXPECT_TRUE(HasData(frame0.fifoData.get(), 5000, 1));
+	EXPECT_TRUE(HasData(loaded->GetFrame(1).fifoData.get(), 300, 4));
+
+	const std::vector<MemoryUpdate>& updates0 = loaded->GetMemoryUpdates(0);
+	const std::vector<MemoryUpdate>& updates1 = loaded->GetMemoryUpdates(1);
+	ASSERT_EQ(2u, updates0.size());
+	ASSERT_EQ(1u, updates1.size());
+	EXPECT_EQ(0x80001000u, updates0[0].address);
+	EXPECT_EQ(MemoryUpdate::TEXTURE_MAP, updates0[0].type);
+	EXPECT_TRUE(HasData(updates0[0].data, 1024, 2));
+	EXPECT_TRUE(HasData(updates0[1].data, 32, 3));
+	// The repeated texture is only stored once
+	EXPECT_EQ(updates0[0].data, updates1[0].data);
+	EXPECT_EQ(0x80003000u, updates1[0].address);
+}
+
+TEST_F(FifoDataFileTest, DecompressesEvictedFrames)
+{
+	std::unique_ptr<FifoDataFile> file(new FifoDataFile);
+	const u32 numFrames = FifoDataFile::MAX_CACHED_FRAMES + 2;
+	for (u32 i = 0; i < numFrames; ++i)
+		AddTestFrame(file.get(), 100 + i, (u8)i);
+
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (u32 i = 0; i < numFrames; ++i)
+		{
+			const FifoFrameInfo frame = file->GetFrame(i);
+			ASSERT_EQ(100 + i, frame.fifoDataSize);
+			EXPECT_TRUE(HasData(frame.fifoData.get(), frame.fifoDataSize, (u8)i));
+		}
+	}
+
+	// Frames which are used again and again stay decompressed
+	const u8* data = file->GetFrame(0).fifoData.get();
+	for (u32 i = 1; i < FifoDataFile::MAX_CACHED_FRAMES; ++i)
+		file->GetFrame(i);
+	EXPECT_EQ(data, file->GetFrame(0).fifoData.get());
+}
+
+TEST_F(FifoDataFileTest, KeepsFramesInUseAlive)
+{
+	std::unique_ptr<FifoDataFile> file(new FifoDataFile);
+	const u32 numFrames = FifoDataFile::MAX_CACHED_FRAMES + 1;
+	for (u32 i = 0; i < numFrames; ++i)
+		AddTestFrame(file.get(), 100 + i, (u8)i);
+
+	// Evicting the frame from the cache doesn't free the data still in use
+	const FifoFrameInfo frame = file->GetFrame(0);
+	for (u32 i = 1; i < numFrames; ++i)
+		file->GetFrame(i);
+	EXPECT_EQ(1, frame.fifoData.use_count());
+	EXPECT_TRUE(HasData(frame.fifoData.get(), 100, 0));
+}
+
+TEST_F(FifoDataFileTest, LoadsVersion1)
+{
+	using namespace FifoFileStruct;
+
+	// A version 1 file with a single uncompressed frame with one memory update
+	const u32 fifoSize = 64;
+	const u32 updateSize = 16;
+	const u64 frameListOffset = sizeof(FileHeader);
+	const u64 registersOffset = frameListOffset + sizeof(FileFrameInfo);
+	const u64 fifoOffset = registersOffset + sizeof(u32);
+	const u64 updatesOffset = fifoOffset + fifoSize;
+	const u64 updateDataOffset = updatesOffset + sizeof(FileMemoryUpdate);
+
+	FileHeader header;
+	memset(&header, 0, sizeof(header));
+	header.fileId = FILE_ID;
+	header.file_version = 1;
+	header.min_loader_version = 1;
+	header.bpMemOffset = registersOffset;
+	header.bpMemSize = 1;
+	header.cpMemOffset = registersOffset;
+	header.xfMemOffset = registersOffset;
+	header.xfRegsOffset = registersOffset;
+	header.frameListOffset = frameListOffset;
+	header.frameCount = 1;
+
+	FileFrameInfo frameInfo;
+	memset(&frameInfo, 0xcc, sizeof(frameInfo));
+	frameInfo.fifoDataOffset = fifoOffset;
+	frameInfo.fifoDataSize = fifoSize;
+	frameInfo.fifoStart = 0x1000;
+	frameInfo.fifoEnd = 0x2000;
+	frameInfo.memoryUpdatesOffset = updatesOffset;
+	frameInfo.numMemoryUpdates = 1;
+
+	FileMemoryUpdate update;
+	memset(&update, 0, sizeof(update));
+	update.fifoPosition = 8;
+	update.address = 0x80004000;
+	update.dataOffset = updateDataOffset;
+	update.dataSize = updateSize;
+	update.type = MemoryUpdate::XF_DATA;
+
+	const u32 bpReg = 0x61000000;
+	std::unique_ptr<u8[]> fifoData(MakeData(fifoSize, 5));
+	std::unique_ptr<u8[]> updateData(MakeData(updateSize, 6));
+
+	{
+		File::IOFile out(m_filename, "wb");
+		out.WriteBytes(&header, sizeof(header));
+		out.WriteBytes(&frameInfo, sizeof(frameInfo));
+		out.WriteBytes(&bpReg, sizeof(bpReg));
+		out.WriteBytes(fifoData.get(), fifoSize);
+		out.WriteBytes(&update, sizeof(update));
+		out.WriteBytes(updateData.get(), updateSize);
+	}
+
+	std::unique_ptr<FifoDataFile> file(FifoDataFile::Load(m_filename, false));
+	ASSERT_NE(nullptr, file.get());
+	EXPECT_EQ(bpReg, file->GetBPMem()[0]);
+	ASSERT_EQ(1u, file->GetFrameCount());
+
+	const FifoFrameInfo frame = file->GetFrame(0);
+	EXPECT_EQ(fifoSize, frame.fifoDataSize);
+	EXPECT_EQ(0x1000u, frame.fifoStart);
+	EXPECT_TRUE(HasData(frame.fifoData.get(), fifoSize, 5));
+
+	const std::vector<MemoryUpdate>& updates = file->GetMemoryUpdates(0);
+	ASSERT_EQ(1u, updates.size());
+	EXPECT_EQ(8u, updates[0].fifoPosition);
+	EXPECT_EQ(0x80004000u, updates[0].address);
+	EXPECT_EQ(MemoryUpdate::XF_DATA, updates[0].type);
+	EXPECT_TRUE(HasData(updates[0].data, updateSize, 6));
+
+	// Saving converts it to the current version
+	const std::string convertedFilename = m_dir.GetFilename("FifoDataFileTest.v2.dff");
+	ASSERT_TRUE(file->Save(convertedFilename));
+	std::unique_ptr<FifoDataFile> converted(FifoDataFile::Load(convertedFilename, false));
+	ASSERT_NE(nullptr, converted.get());
+	EXPECT_TRUE(HasData(converted->GetFrame(0).fifoData.get(), fifoSize, 5));
+	EXPECT_TRUE(HasData(converted->GetMemoryUpdates(0)[0].data, updateSize, 6));
+}
+
+TEST_F(FifoDataFileTest, RejectsTruncatedFiles)
+{
+	std::unique_ptr<FifoDataFile> file(new FifoDataFile);
+	AddTestFrame(file.get(), 1000, 7);
+	ASSERT_TRUE(file->Save(m_filename));
+
+	std::string contents;
+	ASSERT_TRUE(File::ReadFileToString(m_filename, contents));
+	contents.resize(contents.size() - 1);
+	ASSERT_TRUE(File::WriteStringToFile(contents, m_filename));
+
+	EXPECT_EQ(nullptr, FifoDataFile::Load(m_filename, false));
+	EXPECT_EQ(nullptr, FifoDataFile::Load(m_dir.GetFilename("missing.dff"), false));
+}
@@ -0,0 +1,200 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+#include "Core/FifoPlayer/FifoStatsAnalyzer.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/TextureDecoder.h"
+
+// Needs to be included later because it defines a TEST macro that conflicts
+// with a TEST method definition in x64Emitter.h.
+#include <gtest/gtest.h>  // NOLINT
+
+class FifoStatsAnalyzerTest : public testing::Test
+{
+protected:
+	virtual void SetUp() override
+	{
+		m_file.reset(new FifoDataFile);
+		memset(m_file->GetBPMem(), 0, FifoDataFile::BP_MEM_SIZE * sizeof(u32));
+		memset(m_file->GetCPMem(), 0, FifoDataFile::CP_MEM_SIZE * sizeof(u32));
+		memset(m_file->GetXFMem(), 0, FifoDataFile::XF_MEM_SIZE * sizeof(u32));
+		memset(m_file->GetXFRegs(), 0, FifoDataFile::XF_REGS_SIZE * sizeof(u32));
+		m_file->GetBPMem()[BPMEM_BP_MASK] = 0xFFFFFF;
+	}
+
+	void Write8(u8 value)
+	{
+		m_fifo.push_back(value);
+	}
+
+	void Write16(u16 value)
+	{
+		Write8(value >> 8);
+		Write8((u8)value);
+	}
+
+	void Write32(u32 value)
+	{
+		Write16(value >> 16);
+		Write16((u16)value);
+	}
+
+	void WriteCP(u8 address, u32 value)
+	{
+		Write8(GX_LOAD_CP_REG);
+		Write8(address);
+		Write32(value);
+	}
+
+	void WriteBP(u32 value)
+	{
+		Write8(GX_LOAD_BP_REG);
+		Write32(value);
+	}
+
+	void WritePrimitive(u8 primitive, u16 numVertices)
+	{
+		Write8(0x80 | (primitive << GX_PRIMITIVE_SHIFT));
+		Write16(numVertices);
+	}
+
+	// Triangles with float XYZ positions
+	void Draw(u16 numVertices)
+	{
+		WritePrimitive(GX_DRAW_TRIANGLES, numVertices);
+		for (u32 i = 0; i < numVertices * 3; ++i)
+			Write32(0);
+	}
+
+	void EndFrame()
+	{
+		FifoFrameInfo frame;
+		frame.fifoDataSize = (u32)m_fifo.size();
+		frame.fifoData.reset(new u8[m_fifo.size()], std::default_delete<u8[]>());
+		memcpy(frame.fifoData.get(), m_fifo.data(), m_fifo.size());
+		frame.fifoStart = 0;
+		frame.fifoEnd = 0;
+		m_file->AddFrame(frame);
+		m_fifo.clear();
+	}
+
+	std::vector<FifoFrameStats> Analyze()
+	{
+		std::vector<FifoFrameStats> stats;
+		FifoStatsAnalyzer analyzer;
+		analyzer.AnalyzeFrames(m_file.get(), stats);
+		return stats;
+	}
+
+	std::unique_ptr<FifoDataFile> m_file;
+	std::vector<u8> m_fifo;
+};
+
+TEST_F(FifoStatsAnalyzerTest, CountsDraws)
+{
+	WriteCP(0x50, 1 << 9);           // Direct positions
+	WriteCP(0x70, 1 | (4 << 1));     // XYZ, float
+	Draw(3);
+	Draw(6);
+	WritePrimitive(GX_DRAW_QUADS, 0);
+	EndFrame();
+
+	std::vector<FifoFrameStats> stats = Analyze();
+	ASSERT_EQ(1u, stats.size());
+	EXPECT_TRUE(stats[0].complete);
+	EXPECT_EQ(m_file->GetFifoDataSize(0), stats[0].fifoBytes);
+	EXPECT_EQ(2u, stats[0].draws[GX_DRAW_TRIANGLES]);
+	EXPECT_EQ(9u, stats[0].vertices[GX_DRAW_TRIANGLES]);
+	EXPECT_EQ(1u, stats[0].draws[GX_DRAW_QUADS]);
+	EXPECT_EQ(0u, stats[0].vertices[GX_DRAW_QUADS]);
+
+	ASSERT_EQ(1u, stats[0].vertexFormats.size());
+	const FifoVertexFormatStats& format = stats[0].vertexFormats.begin()->second;
+	EXPECT_EQ(12u, format.vertexSize);
+	EXPECT_EQ(3u, format.draws);
+	EXPECT_EQ(9u, format.vertices);
+	EXPECT_EQ(1u << 9, format.vtxDesc);
+}
+
+TEST_F(FifoStatsAnalyzerTest, CountsRedundantWrites)
+{
+	WriteCP(0x50, 1 << 9);
+	WriteCP(0x50, 1 << 9);
+	WriteBP((BPMEM_ZMODE << 24) | 0x17);
+	WriteBP((BPMEM_ZMODE << 24) | 0x17);
+	WriteBP(BPMEM_TRIGGER_EFB_COPY << 24);
+	WriteBP(BPMEM_TRIGGER_EFB_COPY << 24);
+
+	// Two matrix entries, the first of which doesn't change
+	Write8(GX_LOAD_XF_REG);
+	Write32((1 << 16) | 0x0000);
+	Write32(0);
+	Write32(5);
+
+	// A register after the matrices
+	Write8(GX_LOAD_XF_REG);
+	Write32(0x1009);
+	Write32(0);
+
+	Write8(GX_LOAD_INDX_A);
+	Write32(0);
+	EndFrame();
+
+	std::vector<FifoFrameStats> stats = Analyze();
+	ASSERT_EQ(1u, stats.size());
+	EXPECT_EQ(2u, stats[0].cp.writes);
+	EXPECT_EQ(1u, stats[0].cp.redundantWrites);
+	EXPECT_EQ(4u, stats[0].bp.writes);
+	EXPECT_EQ(1u, stats[0].bp.redundantWrites);
+	EXPECT_EQ(3u, stats[0].xf.writes);
+	EXPECT_EQ(2u, stats[0].xf.redundantWrites);
+	EXPECT_EQ(1u, stats[0].xfIndexedLoads);
+	EXPECT_EQ(2u, stats[0].efbCopiesToTexture);
+	EXPECT_EQ(0u, stats[0].efbCopiesToXfb);
+}
+
+TEST_F(FifoStatsAnalyzerTest, CountsTexturesAndCopies)
+{
+	WriteCP(0x50, 1 << 9);
+	WriteCP(0x70, 1 | (4 << 1));
+
+	// One TEV stage, which uses texture map 0: a 64x32 RGB565 texture
+	WriteBP((BPMEM_TREF << 24) | (1 << 6));
+	WriteBP((BPMEM_TX_SETIMAGE0 << 24) | 63 | (31 << 10) | (GX_TF_RGB565 << 20));
+	WriteBP((BPMEM_TX_SETIMAGE3 << 24) | (0x10000 >> 5));
+	Draw(3);
+	Draw(3);
+
+	// Copy to the XFB and clear the EFB
+	WriteBP((BPMEM_TRIGGER_EFB_COPY << 24) | (1 << 14) | (1 << 11));
+	EndFrame();
+
+	// Textures are counted again in each frame, and an unknown opcode ends
+	// the analysis of a frame
+	Draw(3);
+	Write8(0x01);
+	Draw(3);
+	EndFrame();
+
+	std::vector<FifoFrameStats> stats = Analyze();
+	ASSERT_EQ(2u, stats.size());
+
+	ASSERT_EQ(1u, stats[0].textureFormats.size());
+	EXPECT_EQ((u32)GX_TF_RGB565, stats[0].textureFormats.begin()->first);
+	EXPECT_EQ(1u, stats[0].textureFormats.begin()->second.textures);
+	EXPECT_EQ(64u * 32u * 2u, stats[0].textureFormats.begin()->second.bytes);
+	EXPECT_EQ(1u, stats[0].efbCopiesToXfb);
+	EXPECT_EQ(1u, stats[0].efbClears);
+	EXPECT_TRUE(stats[0].complete);
+
+	EXPECT_EQ(1u, stats[1].textureFormats.begin()->second.textures);
+	EXPECT_EQ(1u, stats[1].draws[GX_DRAW_TRIANGLES]);
+	EXPECT_FALSE(stats[1].complete);
+}
@@ -0,0 +1,35 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+
+#include "Common/Common.h"
+#include "Common/CommonPaths.h"
+#include "Common/FileUtil.h"
+
+// A fresh directory in the system's temp directory for tests which write
+// files. It's deleted along with everything in it when the object goes away.
+class TempDir : public NonCopyable
+{
+public:
+	TempDir() : m_path(File::CreateTempDir()) {}
+
+	~TempDir()
+	{
+		if (!m_path.empty())
+			File::DeleteDirRecursively(m_path);
+	}
+
+	bool IsValid() const { return !m_path.empty(); }
+
+	std::string GetFilename(const std::string& name) const
+	{
+		return m_path + DIR_SEP + name;
+	}
+
+private:
+	std::string m_path;
+};
@@ -0,0 +1,20 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/Rasterizer.h"
+#include "VideoBackends/Software/SWVideoConfig.h"
+
+#include "SWTestUtil.h"
+
+#include <gtest/gtest.h>  // NOLINT
+
+// Hash of the EFB contents the original scalar rasterizer produced.
+static const u32 REFERENCE_HASH = 782024730u;
+
+TEST(Rasterizer, MatchesReferenceOutput)
+{
+	g_SWVideoConfig.iRasterizerThreads = 0;
+	EXPECT_EQ(REFERENCE_HASH, DrawRandomTriangles());
+}
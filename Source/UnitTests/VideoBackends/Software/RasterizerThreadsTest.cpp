@@ -0,0 +1,29 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/Rasterizer.h"
+#include "VideoBackends/Software/SWVideoConfig.h"
+
+#include "SWTestUtil.h"
+
+#include <gtest/gtest.h>  // NOLINT
+
+// Big triangles are split into tiles of rows which the rasterizer threads
+// draw at the same time. The result has to be the same as drawing everything
+// on the calling thread.
+TEST(RasterizerThreads, MatchSerialOutput)
+{
+	g_SWVideoConfig.iRasterizerThreads = 0;
+	const u32 serial_hash = DrawRandomTriangles();
+
+	for (int threads = 1; threads <= 4; threads++)
+	{
+		g_SWVideoConfig.iRasterizerThreads = threads;
+		EXPECT_EQ(serial_hash, DrawRandomTriangles()) << threads << " threads";
+		Rasterizer::Shutdown();
+	}
+
+	g_SWVideoConfig.iRasterizerThreads = 0;
+}
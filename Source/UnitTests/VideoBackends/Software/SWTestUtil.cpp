@@ -0,0 +1,175 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <random>
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/BPMemLoader.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/Rasterizer.h"
+#include "VideoBackends/Software/Tev.h"
+#include "VideoBackends/Software/TextureSampler.h"
+#include "VideoBackends/Software/XFMemLoader.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/TextureDecoder.h"
+
+#include "SWTestUtil.h"
+
+static const int s_formats[] = {
+	GX_TF_I4, GX_TF_I8, GX_TF_IA4, GX_TF_IA8, GX_TF_RGB565, GX_TF_RGB5A3, GX_TF_RGBA8,
+	GX_TF_C4, GX_TF_C8, GX_TF_C14X2, GX_TF_CMPR
+};
+
+void RandomizeTextureMap(std::mt19937& rng, int tex_unit, int i)
+{
+	FourTexUnits& texUnit = bpmem.tex[tex_unit];
+	texUnit.texMode0[i].hex = rng();
+	texUnit.texMode0[i].wrap_s = rng() % 3;
+	texUnit.texMode0[i].wrap_t = rng() % 3;
+	texUnit.texMode1[i].hex = rng();
+	texUnit.texImage0[i].width = rng() & 0x3f;
+	texUnit.texImage0[i].height = rng() & 0x3f;
+	texUnit.texImage0[i].format = s_formats[rng() % (sizeof(s_formats) / sizeof(s_formats[0]))];
+	texUnit.texImage1[i].image_type = 1;
+	texUnit.texImage1[i].tmem_even = rng() & 0xfff;
+	texUnit.texImage2[i].tmem_odd = rng() & 0xfff;
+	texUnit.texTlut[i].tmem_offset = rng() & 0x1ff;
+	texUnit.texTlut[i].tlut_format = rng() % 3;
+}
+
+void RandomizeTMEM(std::mt19937& rng)
+{
+	for (u8& byte : texMem)
+		byte = (u8)rng();
+}
+
+void InvalidateRegisterCaches()
+{
+	Tev::InvalidateConfig();
+	TextureSampler::InvalidateCaches();
+}
+
+void EFBHash::AddColor(u16 x, u16 y)
+{
+	u8 color[4];
+	EfbInterface::GetColor(x, y, color);
+	for (u8 comp : color)
+		Add(comp);
+}
+
+void EFBHash::AddDepth(u16 x, u16 y)
+{
+	u32 depth = EfbInterface::GetDepth(x, y);
+	for (int i = 0; i < 3; i++)
+		Add((depth >> (i * 8)) & 0xff);
+}
+
+static float RandomFloat(std::mt19937& rng, float min, float max)
+{
+	return min + (max - min) * (float)(rng() & 0xffff) / 65536.0f;
+}
+
+static void RandomizeRasterizerState(std::mt19937& rng)
+{
+	InitBPMemory();
+
+	bpmem.genMode.numcolchans = rng() % 3;
+	bpmem.genMode.numtexgens = rng() % 9;
+	bpmem.genMode.numtevstages = rng() & 0xf;
+	for (auto& combiner : bpmem.combiners)
+	{
+		combiner.colorC.hex = rng() & 0xffffff;
+		combiner.alphaC.hex = rng() & 0xffffff;
+	}
+	for (auto& order : bpmem.tevorders)
+		order.hex = rng() & 0x3fffff;
+	for (auto& ksel : bpmem.tevksel)
+		ksel.hex = rng() & 0xffffff;
+	bpmem.alpha_test.hex = rng() & 0xffffff;
+
+	for (int tex_unit = 0; tex_unit < 2; tex_unit++)
+		for (int i = 0; i < 4; i++)
+			RandomizeTextureMap(rng, tex_unit, i);
+	for (auto& info : xfmem.texMtxInfo)
+		info.projection = rng() & 1;
+
+	bpmem.zmode.testenable = rng() & 1;
+	bpmem.zmode.func = (ZMode::CompareMode)(rng() & 7);
+	bpmem.zmode.updateenable = rng() & 1;
+	bpmem.zcontrol.pixel_format = (rng() & 1) ? PEControl::RGBA6_Z24 : PEControl::RGB8_Z24;
+	bpmem.blendmode.colorupdate = 1;
+	bpmem.blendmode.alphaupdate = 1;
+
+	bpmem.scissorOffset.x = 171;
+	bpmem.scissorOffset.y = 171;
+	bpmem.scissorTL.x = 342;
+	bpmem.scissorTL.y = 342;
+	bpmem.scissorBR.x = 341 + TEST_AREA_SIZE;
+	bpmem.scissorBR.y = 341 + TEST_AREA_SIZE;
+	Rasterizer::SetScissor();
+
+	RandomizeTMEM(rng);
+
+	InvalidateRegisterCaches();
+}
+
+static void RandomizeVertex(std::mt19937& rng, OutputVertexData* vertex)
+{
+	vertex->screenPosition.x = RandomFloat(rng, -16.0f, TEST_AREA_SIZE + 16.0f);
+	vertex->screenPosition.y = RandomFloat(rng, -16.0f, TEST_AREA_SIZE + 16.0f);
+	vertex->screenPosition.z = RandomFloat(rng, 0.0f, 16777215.0f);
+	vertex->projectedPosition.w = RandomFloat(rng, 0.25f, 4.0f);
+	for (auto& color : vertex->color)
+		for (u8& comp : color)
+			comp = (u8)rng();
+	for (auto& texCoord : vertex->texCoords)
+	{
+		texCoord.x = RandomFloat(rng, -8.0f, 8.0f);
+		texCoord.y = RandomFloat(rng, -8.0f, 8.0f);
+		texCoord.z = RandomFloat(rng, -2.0f, 2.0f);
+	}
+}
+
+u32 DrawRandomTriangles()
+{
+	std::mt19937 rng(1234);
+	Rasterizer::Init();
+
+	for (u16 y = 0; y < TEST_AREA_SIZE; y++)
+	{
+		for (u16 x = 0; x < TEST_AREA_SIZE; x++)
+		{
+			EfbInterface::SetColor(x, y, (u8*)"\0\0\0\0");
+			EfbInterface::SetDepth(x, y, 0x800000);
+		}
+	}
+
+	for (int config = 0; config < 32; config++)
+	{
+		RandomizeRasterizerState(rng);
+
+		for (int triangle = 0; triangle < 16; triangle++)
+		{
+			OutputVertexData vertices[3];
+			for (auto& vertex : vertices)
+				RandomizeVertex(rng, &vertex);
+
+			Rasterizer::DrawTriangleFrontFace(&vertices[0], &vertices[1], &vertices[2]);
+			Rasterizer::DrawTriangleFrontFace(&vertices[0], &vertices[2], &vertices[1]);
+		}
+	}
+
+	EFBHash hash;
+	for (u16 y = 0; y < TEST_AREA_SIZE; y++)
+	{
+		for (u16 x = 0; x < TEST_AREA_SIZE; x++)
+		{
+			hash.AddColor(x, y);
+			hash.AddDepth(x, y);
+		}
+	}
+
+	return hash.Get();
+}
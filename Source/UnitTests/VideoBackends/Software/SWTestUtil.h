@@ -0,0 +1,49 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <random>
+
+#include "Common/CommonTypes.h"
+
+// Helpers shared by the software renderer tests, which draw random state and
+// compare hashes of the results against the ones the original code produced.
+
+// Only the top left corner of the EFB is drawn to, to keep the tests fast.
+enum { TEST_AREA_SIZE = 128 };
+
+// Sets up texture map i of texture unit tex_unit with random parameters and
+// one of the texture formats the software renderer decodes.
+void RandomizeTextureMap(std::mt19937& rng, int tex_unit, int i);
+void RandomizeTMEM(std::mt19937& rng);
+
+// Has to be called after the registers were written directly instead of
+// through SWLoadBPReg.
+void InvalidateRegisterCaches();
+
+// FNV-1a hash over the bytes of what was drawn.
+class EFBHash
+{
+public:
+	EFBHash() : m_hash(2166136261u) {}
+
+	void Add(u8 byte)
+	{
+		m_hash = (m_hash ^ byte) * 16777619u;
+	}
+
+	void AddColor(u16 x, u16 y);
+	void AddDepth(u16 x, u16 y);
+
+	u32 Get() const { return m_hash; }
+
+private:
+	u32 m_hash;
+};
+
+// Draws random triangles with random pipeline state into the test area and
+// returns a hash of the resulting EFB contents. Each triangle is drawn with
+// both windings, so half of them are culled.
+u32 DrawRandomTriangles();
@@ -0,0 +1,52 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <random>
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/BPMemLoader.h"
+#include "VideoBackends/Software/TextureSampler.h"
+#include "VideoCommon/BPMemory.h"
+
+#include "SWTestUtil.h"
+
+#include <gtest/gtest.h>  // NOLINT
+
+// Sets up texture map 0 with a random texture preloaded to TMEM.
+static void RandomizeTexture(std::mt19937& rng)
+{
+	InitBPMemory();
+	RandomizeTMEM(rng);
+	RandomizeTextureMap(rng, 0, 0);
+	InvalidateRegisterCaches();
+}
+
+// Cached samples have to match the texels decoded straight from TMEM.
+TEST(TextureSampler, CacheMatchesDirectDecoding)
+{
+	std::mt19937 rng(1234);
+	TextureSampler::Cache cache;
+
+	for (int texture = 0; texture < 256; texture++)
+	{
+		RandomizeTexture(rng);
+
+		for (int sample = 0; sample < 256; sample++)
+		{
+			s32 s = (s32)(rng() & 0x7fff) - 0x4000;
+			s32 t = (s32)(rng() & 0x7fff) - 0x4000;
+			s32 lod = rng() & 0x3f;
+			bool linear = (rng() & 1) != 0;
+
+			u8 expected[4], cached[4];
+			TextureSampler::Sample(s, t, lod, linear, 0, expected);
+			TextureSampler::Sample(s, t, lod, linear, 0, cached, &cache);
+
+			EXPECT_EQ(expected[0], cached[0]);
+			EXPECT_EQ(expected[1], cached[1]);
+			EXPECT_EQ(expected[2], cached[2]);
+			EXPECT_EQ(expected[3], cached[3]);
+		}
+	}
+}
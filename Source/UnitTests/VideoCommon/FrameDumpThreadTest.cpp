@@ -0,0 +1,58 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/FrameDumpThread.h"
+
+TEST(FrameDumpThread, EncodesAllFramesInOrder)
+{
+	// Rows with padding, bottom-up like a readback
+	const int width = 5, height = 3, stride = 16;
+	std::vector<u8> data(stride * height);
+
+	std::vector<s64> timestamps;
+	std::vector<int> repeats;
+	std::vector<u8> first_pixels;
+	FrameDumpThread::Start([&](const FrameDumpThread::Frame& frame) {
+		// A slow encoder makes the queue fill up
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		EXPECT_EQ(width, frame.width);
+		EXPECT_EQ(height, frame.height);
+		EXPECT_EQ((size_t)(width * 3 * height), frame.data.size());
+		EXPECT_EQ(frame.data[0], frame.data[(height - 1) * width * 3]);
+		timestamps.push_back(frame.timestamp);
+		repeats.push_back(frame.repeat);
+		first_pixels.push_back(frame.data[0]);
+	});
+	EXPECT_TRUE(FrameDumpThread::IsRunning());
+
+	const int num_frames = FrameDumpThread::MAX_QUEUED_FRAMES * 4;
+	for (int i = 0; i < num_frames; ++i)
+	{
+		for (int y = 0; y < height; ++y)
+			data[y * stride] = (u8)i;
+		FrameDumpThread::AddFrame(data.data(), width, height, 3, stride, i * 100, i % 3);
+	}
+
+	// Stopping encodes the frames which are still queued
+	FrameDumpThread::Stop();
+	EXPECT_FALSE(FrameDumpThread::IsRunning());
+
+	ASSERT_EQ((size_t)num_frames, timestamps.size());
+	for (int i = 0; i < num_frames; ++i)
+	{
+		EXPECT_EQ(i * 100, timestamps[i]);
+		EXPECT_EQ(i % 3, repeats[i]);
+		EXPECT_EQ((u8)i, first_pixels[i]);
+	}
+
+	// Frames added while it isn't running are ignored
+	FrameDumpThread::AddFrame(data.data(), width, height, 3, stride, 0, 1);
+	EXPECT_EQ((size_t)num_frames, timestamps.size());
+}
@@ -0,0 +1,114 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "TestUtils/TempDir.h"
+#include "VideoCommon/HiresTexturePack.h"
+
+static std::vector<u8> MakeTexture(u32 width, u32 height, u8 seed)
+{
+	std::vector<u8> data(width * height * 4);
+	for (size_t i = 0; i < data.size(); ++i)
+		data[i] = (u8)(seed + i * 3);
+	return data;
+}
+
+class HiresTexturePackTest : public testing::Test
+{
+protected:
+	virtual void SetUp() override
+	{
+		ASSERT_TRUE(m_dir.IsValid());
+		m_filename = m_dir.GetFilename("HiresTexturePackTest.dtp");
+	}
+
+	TempDir m_dir;
+	std::string m_filename;
+};
+
+TEST_F(HiresTexturePackTest, WriteAndFind)
+{
+	using namespace HiresTexturePack;
+
+	const u64 key0 = MakeKey(0xdeadbeef, 14, 0);
+	const u64 key1 = MakeKey(0xdeadbeef, 14, 1);
+	const u64 key2 = MakeKey(0x00001234, 5, 0);
+
+	// Added out of order, with odd sizes which need padding
+	std::vector<u8> tex0 = MakeTexture(5, 3, 1);
+	std::vector<u8> tex1 = MakeTexture(2, 1, 2);
+	std::vector<u8> tex2 = MakeTexture(64, 32, 3);
+	Writer writer;
+	ASSERT_TRUE(writer.Open(m_filename));
+	ASSERT_TRUE(writer.AddTexture(key0, 5, 3, tex0.data()));
+	ASSERT_TRUE(writer.AddTexture(key2, 64, 32, tex2.data()));
+	ASSERT_TRUE(writer.AddTexture(key1, 2, 1, tex1.data()));
+	// Duplicates are ignored
+	ASSERT_TRUE(writer.AddTexture(key2, 2, 1, tex1.data()));
+	ASSERT_TRUE(writer.Finish());
+
+	Reader reader;
+	ASSERT_TRUE(reader.Open(m_filename));
+
+	u32 width = 0, height = 0;
+	const u8* data = reader.Find(key0, &width, &height);
+	ASSERT_NE(nullptr, data);
+	EXPECT_EQ(5u, width);
+	EXPECT_EQ(3u, height);
+	EXPECT_EQ(0, memcmp(tex0.data(), data, tex0.size()));
+
+	data = reader.Find(key1, &width, &height);
+	ASSERT_NE(nullptr, data);
+	EXPECT_EQ(2u, width);
+	EXPECT_EQ(0, memcmp(tex1.data(), data, tex1.size()));
+
+	data = reader.Find(key2, &width, &height);
+	ASSERT_NE(nullptr, data);
+	EXPECT_EQ(64u, width);
+	EXPECT_EQ(32u, height);
+	EXPECT_EQ(0u, (uintptr_t)data & 15);
+	EXPECT_EQ(0, memcmp(tex2.data(), data, tex2.size()));
+
+	EXPECT_EQ(nullptr, reader.Find(MakeKey(0xdeadbeef, 14, 2), &width, &height));
+	EXPECT_EQ(nullptr, reader.Find(0, &width, &height));
+
+	Common::Flag abort;
+	reader.Prefetch(abort);
+}
+
+TEST_F(HiresTexturePackTest, RejectsInvalidFiles)
+{
+	using namespace HiresTexturePack;
+
+	std::vector<u8> tex = MakeTexture(16, 16, 4);
+	Writer writer;
+	ASSERT_TRUE(writer.Open(m_filename));
+	ASSERT_TRUE(writer.AddTexture(MakeKey(1, 2, 0), 16, 16, tex.data()));
+	ASSERT_TRUE(writer.Finish());
+
+	std::string contents;
+	ASSERT_TRUE(File::ReadFileToString(m_filename, contents));
+	contents.resize(contents.size() - 1);
+	ASSERT_TRUE(File::WriteStringToFile(contents, m_filename));
+
+	Reader reader;
+	EXPECT_FALSE(reader.Open(m_filename));
+	EXPECT_FALSE(reader.IsOpen());
+
+	ASSERT_TRUE(File::WriteStringToFile("not a texture pack, but long enough", m_filename));
+	EXPECT_FALSE(reader.Open(m_filename));
+	EXPECT_FALSE(reader.Open(m_dir.GetFilename("missing.dtp")));
+
+	// A pack which was never finished
+	Writer unfinished;
+	ASSERT_TRUE(unfinished.Open(m_filename));
+	ASSERT_TRUE(unfinished.AddTexture(MakeKey(1, 2, 0), 16, 16, tex.data()));
+	EXPECT_FALSE(reader.Open(m_filename));
+}
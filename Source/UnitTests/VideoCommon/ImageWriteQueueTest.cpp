@@ -0,0 +1,104 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "TestUtils/TempDir.h"
+#include "VideoCommon/ImageWriteQueue.h"
+
+TEST(ImageWriteQueue, WritesQueuedImages)
+{
+	TempDir dir;
+	ASSERT_TRUE(dir.IsValid());
+
+	// Rows with padding, like a mapped texture
+	const int width = 13, height = 7, row_stride = 64;
+	std::vector<u8> data(row_stride * height, 0x80);
+
+	ImageWriteQueue::Stats before = ImageWriteQueue::GetStats();
+
+	std::vector<std::string> filenames;
+	for (int i = 0; i < 8; ++i)
+	{
+		filenames.push_back(dir.GetFilename(StringFromFormat("image_%d.png", i)));
+		ASSERT_TRUE(ImageWriteQueue::TextureToPng(data.data(), row_stride, filenames.back(), width, height, true, ImageWriteQueue::WAIT_IF_FULL));
+	}
+
+	// The buffer can be reused right away
+	data.assign(data.size(), 0);
+
+	ImageWriteQueue::Flush();
+
+	ImageWriteQueue::Stats after = ImageWriteQueue::GetStats();
+	EXPECT_EQ(8u, after.queued - before.queued);
+	EXPECT_EQ(8u, after.written - before.written);
+	EXPECT_EQ(0u, after.failed - before.failed);
+	EXPECT_EQ(0u, after.dropped - before.dropped);
+
+	for (const std::string& filename : filenames)
+	{
+		EXPECT_TRUE(File::Exists(filename));
+		EXPECT_LT(8u, File::GetSize(filename));
+	}
+
+	ImageWriteQueue::Shutdown();
+}
+
+TEST(ImageWriteQueue, HandlesFullQueue)
+{
+	TempDir dir;
+	ASSERT_TRUE(dir.IsValid());
+
+	// Two images fill the queue exactly
+	const int width = 8192;
+	const int height = ImageWriteQueue::MAX_QUEUED_BYTES / (2 * width * 4);
+	std::vector<u8> data((size_t)width * height * 4, 0x80);
+	const u8 pixel[4] = {};
+
+	ImageWriteQueue::Stats before = ImageWriteQueue::GetStats();
+
+	// Keeps the workers from making room
+	ImageWriteQueue::SetPaused(true);
+	ASSERT_TRUE(ImageWriteQueue::TextureToPng(data.data(), width * 4, dir.GetFilename("full_0.png"), width, height, false, ImageWriteQueue::DROP_IF_FULL));
+	ASSERT_TRUE(ImageWriteQueue::TextureToPng(data.data(), width * 4, dir.GetFilename("full_1.png"), width, height, false, ImageWriteQueue::DROP_IF_FULL));
+	data.clear();
+	data.shrink_to_fit();
+
+	EXPECT_FALSE(ImageWriteQueue::TextureToPng(pixel, 4, dir.GetFilename("dropped.png"), 1, 1, false, ImageWriteQueue::DROP_IF_FULL));
+
+	std::atomic<bool> queued(false);
+	std::thread waiter([&] {
+		EXPECT_TRUE(ImageWriteQueue::TextureToPng(pixel, 4, dir.GetFilename("waited.png"), 1, 1, false, ImageWriteQueue::WAIT_IF_FULL));
+		queued = true;
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	EXPECT_FALSE(queued);
+
+	ImageWriteQueue::SetPaused(false);
+	waiter.join();
+	EXPECT_TRUE(queued);
+
+	ImageWriteQueue::Flush();
+
+	ImageWriteQueue::Stats after = ImageWriteQueue::GetStats();
+	EXPECT_EQ(3u, after.queued - before.queued);
+	EXPECT_EQ(3u, after.written - before.written);
+	EXPECT_EQ(0u, after.failed - before.failed);
+	EXPECT_EQ(1u, after.dropped - before.dropped);
+
+	EXPECT_TRUE(File::Exists(dir.GetFilename("full_0.png")));
+	EXPECT_TRUE(File::Exists(dir.GetFilename("waited.png")));
+	EXPECT_FALSE(File::Exists(dir.GetFilename("dropped.png")));
+
+	ImageWriteQueue::Shutdown();
+}
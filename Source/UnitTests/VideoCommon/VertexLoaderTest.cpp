@@ -1,8 +1,17 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "Common/Common.h"
+#include "Common/StringUtil.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/VertexLoader.h"
+#include "VideoCommon/VertexLoaderTemplate.h"
+#include "VideoCommon/VertexLoaderWorkers.h"
+#include "VideoCommon/VideoConfig.h"
 
 // Needs to be included later because it defines a TEST macro that conflicts
 // with a TEST method definition in x64Emitter.h.
@@ -263,3 +272,258 @@ TEST_F(VertexLoaderTest, LargeFloatVertexSpeed)
 		dst.Skip(count * loader.GetNativeVertexDeclaration().stride);
 	}
 }
+
+TEST_F(VertexLoaderTest, IndexedAttributes)
+{
+	m_vtx_desc.PosMatIdx = 1;
+	m_vtx_desc.Position = 3;              // Index16
+	m_vtx_desc.Normal = 2;                // Index8
+	m_vtx_desc.Color0 = 1;                // Direct
+	m_vtx_desc.Tex0Coord = 2;             // Index8
+	m_vtx_attr.g0.PosElements = 1;        // XYZ
+	m_vtx_attr.g0.PosFormat = 3;          // S16
+	m_vtx_attr.g0.NormalElements = 1;     // NBT
+	m_vtx_attr.g0.NormalFormat = 1;       // S8
+	m_vtx_attr.g0.NormalIndex3 = 1;
+	m_vtx_attr.g0.Color0Comp = 1;         // RGB888
+	m_vtx_attr.g0.Tex0CoordElements = 1;  // ST
+	m_vtx_attr.g0.Tex0CoordFormat = 4;    // Float
+
+	VertexLoader loader(m_vtx_desc, m_vtx_attr);
+	ASSERT_EQ(1 + 2 + 3 + 3 + 1, loader.GetVertexSize());
+	ASSERT_EQ(5, loader.GetNumIndexedAttributes());
+
+	const VertexLoader::IndexedAttribute* attr = loader.GetIndexedAttributes();
+	const int expected[5][4] = {
+		// array, offset, index size, element size
+		{ ARRAY_POSITION, 1, 2, 6 },
+		{ ARRAY_NORMAL, 3, 1, 9 },
+		{ ARRAY_NORMAL, 4, 1, 9 },
+		{ ARRAY_NORMAL, 5, 1, 9 },
+		{ ARRAY_TEXCOORD0, 9, 1, 8 },
+	};
+	for (int i = 0; i < 5; ++i)
+	{
+		EXPECT_EQ(expected[i][0], attr[i].array);
+		EXPECT_EQ(expected[i][1], attr[i].offset);
+		EXPECT_EQ(expected[i][2], attr[i].index_size);
+		EXPECT_EQ(expected[i][3], attr[i].element_size);
+	}
+}
+
+// Vertex formats taken from the vertex loader statistics of some games, plus a
+// few which have no template loader, to compare all loader types.
+static const struct
+{
+	const char* name;
+	void (*setup)(TVtxDesc* vtx_desc, VAT* vtx_attr);
+} s_recorded_formats[] = {
+	{"P Dir-flt C0 Dir-8888 T0 Dir-flt", [](TVtxDesc* vtx_desc, VAT* vtx_attr) {
+		vtx_desc->Position = DIRECT; vtx_attr->g0.PosElements = 1; vtx_attr->g0.PosFormat = FORMAT_FLOAT;
+		vtx_desc->Color0 = DIRECT; vtx_attr->g0.Color0Elements = 1; vtx_attr->g0.Color0Comp = FORMAT_32B_8888;
+		vtx_desc->Tex0Coord = DIRECT; vtx_attr->g0.Tex0CoordElements = 1; vtx_attr->g0.Tex0CoordFormat = FORMAT_FLOAT;
+	}},
+	{"P Dir-s16 C0 Dir-8888(no alpha) T0 Dir-s16", [](TVtxDesc* vtx_desc, VAT* vtx_attr) {
+		vtx_desc->Position = DIRECT; vtx_attr->g0.PosElements = 1; vtx_attr->g0.PosFormat = FORMAT_SHORT; vtx_attr->g0.PosFrac = 4;
+		vtx_desc->Color0 = DIRECT; vtx_attr->g0.Color0Elements = 0; vtx_attr->g0.Color0Comp = FORMAT_32B_8888;
+		vtx_desc->Tex0Coord = DIRECT; vtx_attr->g0.Tex0CoordElements = 1; vtx_attr->g0.Tex0CoordFormat = FORMAT_SHORT; vtx_attr->g0.Tex0Frac = 8;
+	}},
+	{"P I16-flt N I16-s16 T0 I16-u16", [](TVtxDesc* vtx_desc, VAT* vtx_attr) {
+		vtx_desc->Position = INDEX16; vtx_attr->g0.PosElements = 1; vtx_attr->g0.PosFormat = FORMAT_FLOAT;
+		vtx_desc->Normal = INDEX16; vtx_attr->g0.NormalFormat = FORMAT_SHORT;
+		vtx_desc->Tex0Coord = INDEX16; vtx_attr->g0.Tex0CoordElements = 1; vtx_attr->g0.Tex0CoordFormat = FORMAT_USHORT; vtx_attr->g0.Tex0Frac = 10;
+	}},
+	{"P I16-s16 N I16-s8 C0 I16-8888 T0 I16-s16", [](TVtxDesc* vtx_desc, VAT* vtx_attr) {
+		vtx_desc->Position = INDEX16; vtx_attr->g0.PosElements = 1; vtx_attr->g0.PosFormat = FORMAT_SHORT; vtx_attr->g0.PosFrac = 6;
+		vtx_desc->Normal = INDEX16; vtx_attr->g0.NormalFormat = FORMAT_BYTE;
+		vtx_desc->Color0 = INDEX16; vtx_attr->g0.Color0Elements = 1; vtx_attr->g0.Color0Comp = FORMAT_32B_8888;
+		vtx_desc->Tex0Coord = INDEX16; vtx_attr->g0.Tex0CoordElements = 1; vtx_attr->g0.Tex0CoordFormat = FORMAT_SHORT; vtx_attr->g0.Tex0Frac = 12;
+	}},
+	{"skin P I16-s16 N I16-s8 T0 I16-s16", [](TVtxDesc* vtx_desc, VAT* vtx_attr) {
+		vtx_desc->PosMatIdx = 1;
+		vtx_desc->Position = INDEX16; vtx_attr->g0.PosElements = 1; vtx_attr->g0.PosFormat = FORMAT_SHORT; vtx_attr->g0.PosFrac = 6;
+		vtx_desc->Normal = INDEX16; vtx_attr->g0.NormalFormat = FORMAT_BYTE;
+		vtx_desc->Tex0Coord = INDEX16; vtx_attr->g0.Tex0CoordElements = 1; vtx_attr->g0.Tex0CoordFormat = FORMAT_SHORT; vtx_attr->g0.Tex0Frac = 12;
+	}},
+	{"P I8-s16 N I8-s8 T0 I8-s16", [](TVtxDesc* vtx_desc, VAT* vtx_attr) {
+		vtx_desc->Position = INDEX8; vtx_attr->g0.PosElements = 1; vtx_attr->g0.PosFormat = FORMAT_SHORT;
+		vtx_desc->Normal = INDEX8; vtx_attr->g0.NormalFormat = FORMAT_BYTE;
+		vtx_desc->Tex0Coord = INDEX8; vtx_attr->g0.Tex0CoordElements = 1; vtx_attr->g0.Tex0CoordFormat = FORMAT_SHORT;
+	}},
+	{"P Dir-u8 C0 Dir-565 C1 Dir-4444 (no template)", [](TVtxDesc* vtx_desc, VAT* vtx_attr) {
+		vtx_desc->Position = DIRECT; vtx_attr->g0.PosElements = 0; vtx_attr->g0.PosFormat = FORMAT_UBYTE;
+		vtx_desc->Color0 = DIRECT; vtx_attr->g0.Color0Comp = FORMAT_16B_565;
+		vtx_desc->Color1 = DIRECT; vtx_attr->g0.Color1Comp = FORMAT_16B_4444;
+	}},
+	{"P I16-flt N I16-flt(NBT) T0 I16-flt T1 I16-flt (no template)", [](TVtxDesc* vtx_desc, VAT* vtx_attr) {
+		vtx_desc->Position = INDEX16; vtx_attr->g0.PosElements = 1; vtx_attr->g0.PosFormat = FORMAT_FLOAT;
+		vtx_desc->Normal = INDEX16; vtx_attr->g0.NormalElements = 1; vtx_attr->g0.NormalFormat = FORMAT_FLOAT;
+		vtx_desc->Tex0Coord = INDEX16; vtx_attr->g0.Tex0CoordElements = 1; vtx_attr->g0.Tex0CoordFormat = FORMAT_FLOAT;
+		vtx_desc->Tex1Coord = INDEX16; vtx_attr->g1.Tex1CoordElements = 1; vtx_attr->g1.Tex1CoordFormat = FORMAT_FLOAT;
+	}},
+};
+
+static const char* const s_loader_type_names[] = { "Pipeline", "JIT", "Template" };
+
+class VertexLoaderCompareTest : public VertexLoaderTest
+{
+protected:
+	void SetUp() override
+	{
+		VertexLoaderTest::SetUp();
+
+		// Unmasked random data, so signed components are negative half of the
+		// time. Floats are only copied, so NaNs compare equal with memcmp.
+		std::mt19937 rng(1234);
+		for (u8& byte : input_memory)
+			byte = (u8)rng();
+
+		m_arrays.resize(16 * ARRAY_SIZE);
+		for (u8& byte : m_arrays)
+			byte = (u8)rng();
+		for (int i = 0; i < 16; ++i)
+		{
+			cached_arraybases[i] = &m_arrays[i * ARRAY_SIZE];
+			g_main_cp_state.array_strides[i] = 16;
+		}
+	}
+
+	// Runs the loader and returns the time taken in nanoseconds per vertex.
+	double Run(VertexLoader* loader, int count, u8* output)
+	{
+		ResetPointers();
+		dst = DataReader(output, output + sizeof(output_memory));
+
+		auto start = std::chrono::high_resolution_clock::now();
+		loader->RunVertices(m_vtx_attr, 7, count, src, dst);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		EXPECT_EQ(input_memory + count * loader->GetVertexSize(), g_video_buffer_read_ptr);
+		EXPECT_EQ(output + count * loader->GetNativeVertexDeclaration().stride, g_vertex_manager_write_ptr);
+		return std::chrono::duration<double, std::nano>(end - start).count() / count;
+	}
+
+	// Compares the output of the JIT and template loaders against the
+	// pipeline for the current format.
+	void CompareLoaders(const char* name)
+	{
+		static std::vector<u8> reference(sizeof(output_memory));
+		const int count = 50000;
+
+		VertexLoader pipeline(m_vtx_desc, m_vtx_attr, VERTEX_LOADER_PIPELINE);
+		ASSERT_EQ(VERTEX_LOADER_PIPELINE, pipeline.GetType());
+		double pipeline_time = Run(&pipeline, count, reference.data());
+		size_t size = count * pipeline.GetNativeVertexDeclaration().stride;
+
+		printf("%-64s %8s: %6.2f ns/vertex\n", name, s_loader_type_names[VERTEX_LOADER_PIPELINE], pipeline_time);
+
+		for (VertexLoaderType type : { VERTEX_LOADER_JIT, VERTEX_LOADER_TEMPLATE })
+		{
+			VertexLoader loader(m_vtx_desc, m_vtx_attr, type);
+			if (loader.GetType() != type)
+				continue;
+
+			ASSERT_EQ(pipeline.GetVertexSize(), loader.GetVertexSize());
+			ASSERT_EQ(0, memcmp(&pipeline.GetNativeVertexDeclaration(), &loader.GetNativeVertexDeclaration(), sizeof (PortableVertexDeclaration)));
+
+			memset(output_memory, 0, size);
+			double time = Run(&loader, count, output_memory);
+			EXPECT_EQ(0, memcmp(reference.data(), output_memory, size)) << name << " with " << s_loader_type_names[type];
+
+			printf("%-64s %8s: %6.2f ns/vertex\n", name, s_loader_type_names[type], time);
+		}
+	}
+
+	// Large enough for any 16 bit index.
+	static const size_t ARRAY_SIZE = 0x10000 * 16;
+
+	std::vector<u8> m_arrays;
+};
+
+TEST_F(VertexLoaderCompareTest, AllLoadersMatchPipeline)
+{
+	for (const auto& format : s_recorded_formats)
+	{
+		memset(&m_vtx_desc, 0, sizeof (m_vtx_desc));
+		memset(&m_vtx_attr, 0, sizeof (m_vtx_attr));
+		m_vtx_attr.g0.ByteDequant = 1;
+		format.setup(&m_vtx_desc, &m_vtx_attr);
+
+		CompareLoaders(format.name);
+	}
+}
+
+TEST_F(VertexLoaderCompareTest, AllTemplateFormatsMatchPipeline)
+{
+	for (int i = 0; i < VertexLoaderTemplate::GetNumFormats(); ++i)
+	{
+		// Both with and without the alpha of direct colors, and with scaled
+		// integer positions and texture coordinates.
+		for (int color_elements = 0; color_elements < 2; ++color_elements)
+		{
+			memset(&m_vtx_desc, 0, sizeof (m_vtx_desc));
+			memset(&m_vtx_attr, 0, sizeof (m_vtx_attr));
+			m_vtx_attr.g0.ByteDequant = 1;
+			m_vtx_attr.g0.PosFrac = 5;
+			m_vtx_attr.g0.Tex0Frac = 9;
+			m_vtx_attr.g0.Color0Elements = color_elements;
+			VertexLoaderTemplate::GetFormat(i, &m_vtx_desc, &m_vtx_attr);
+
+			VertexLoader loader(m_vtx_desc, m_vtx_attr, VERTEX_LOADER_TEMPLATE);
+			ASSERT_EQ(VERTEX_LOADER_TEMPLATE, loader.GetType()) << "format " << i;
+
+			std::string name = StringFromFormat("template format %d, color elements %d", i, color_elements);
+			CompareLoaders(name.c_str());
+		}
+	}
+}
+
+TEST_F(VertexLoaderCompareTest, TemplateLoaderSelection)
+{
+	for (const auto& format : s_recorded_formats)
+	{
+		memset(&m_vtx_desc, 0, sizeof (m_vtx_desc));
+		memset(&m_vtx_attr, 0, sizeof (m_vtx_attr));
+		format.setup(&m_vtx_desc, &m_vtx_attr);
+
+		VertexLoader loader(m_vtx_desc, m_vtx_attr, VERTEX_LOADER_TEMPLATE);
+		bool expect_template = strstr(format.name, "(no template)") == nullptr;
+		EXPECT_EQ(expect_template ? VERTEX_LOADER_TEMPLATE : VERTEX_LOADER_PIPELINE, loader.GetType()) << format.name;
+	}
+}
+
+TEST_F(VertexLoaderCompareTest, ParallelConversion)
+{
+	static std::vector<u8> reference(sizeof(output_memory));
+	const int count = 50000;
+
+	for (const auto& format : s_recorded_formats)
+	{
+		memset(&m_vtx_desc, 0, sizeof (m_vtx_desc));
+		memset(&m_vtx_attr, 0, sizeof (m_vtx_attr));
+		m_vtx_attr.g0.ByteDequant = 1;
+		format.setup(&m_vtx_desc, &m_vtx_attr);
+
+		VertexLoader loader(m_vtx_desc, m_vtx_attr, VERTEX_LOADER_TEMPLATE);
+		if (loader.GetType() != VERTEX_LOADER_TEMPLATE)
+			continue;
+		size_t size = count * loader.GetNativeVertexDeclaration().stride;
+
+		g_ActiveConfig.iVertexLoaderThreads = 0;
+		double serial_time = Run(&loader, count, reference.data());
+
+		// Also restarts the workers with a different thread count.
+		for (int threads : { 1, 3 })
+		{
+			g_ActiveConfig.iVertexLoaderThreads = threads;
+			memset(output_memory, 0, size);
+			double time = Run(&loader, count, output_memory);
+			EXPECT_EQ(0, memcmp(reference.data(), output_memory, size)) << format.name << " with " << threads << " threads";
+
+			printf("%-64s %d threads: %6.2f ns/vertex (serial %6.2f)\n", format.name, threads, time, serial_time);
+		}
+	}
+
+	g_ActiveConfig.iVertexLoaderThreads = 0;
+	VertexLoaderWorkers::Shutdown();
+}